@@ -0,0 +1,1000 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SyrupBenchmarkCommandlet.h"
+
+#include "Syrup/MapUtilities/GroundPlane.h"
+#include "Syrup/Systems/AsyncSaveSubsystem.h"
+#include "Syrup/Systems/InstanceCustomDataBatcher.h"
+#include "Syrup/Systems/SyrupGameMode.h"
+#include "Syrup/Systems/SyrupSaveGame.h"
+#include "Syrup/Systems/TileEffectDispatcher.h"
+#include "Syrup/Tiles/Plant.h"
+#include "Syrup/Tiles/Tile.h"
+#include "Syrup/Tiles/Resources/Resource.h"
+#include "Syrup/Tiles/Resources/ResourceAllocationSolver.h"
+#include "Syrup/Tiles/Resources/ResourcePool.h"
+#include "Syrup/Tiles/Resources/ResourceSink.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformMemory.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/Crc.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "UObject/UObjectArray.h"
+
+DEFINE_LOG_CATEGORY(LogSyrupBenchmark);
+
+/**
+ * Ends the player's turn without running the night's blueprint, so the benchmark can trigger each phase itself. The
+ * player turn phase gives the turn back.
+ *
+ * @param GameMode - The game mode of the world being benchmarked.
+ */
+static void BeginBenchmarkNight(ASyrupGameMode* GameMode)
+{
+#if !UE_BUILD_SHIPPING
+	GameMode->SetPlayerTurnForTesting(false);
+#endif
+}
+
+/* \/ ========================= \/ *\
+|  \/ USyrupBenchmarkCommandlet \/  |
+\* \/ ========================= \/ */
+
+/**
+ * Sets up the commandlet to run without a renderer.
+ */
+USyrupBenchmarkCommandlet::USyrupBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+	ShowErrorCount = true;
+}
+
+/**
+ * Runs the benchmark selected by the parameters.
+ *
+ * @param Params - The command line parameters.
+ * @return Zero if the benchmark succeeded.
+ */
+int32 USyrupBenchmarkCommandlet::Main(const FString& Params)
+{
+	FString Benchmark = TEXT("Night");
+	FParse::Value(*Params, TEXT("Benchmark="), Benchmark);
+
+	TSharedRef<FJsonObject> Report = MakeShared<FJsonObject>();
+	Report->SetStringField(TEXT("benchmark"), Benchmark);
+	Report->SetStringField(TEXT("timestamp"), FDateTime::UtcNow().ToIso8601());
+	Report->SetStringField(TEXT("buildConfiguration"), LexToString(FApp::GetBuildConfiguration()));
+
+	bool bSucceeded = false;
+	if (Benchmark.Equals(TEXT("Night"), ESearchCase::IgnoreCase))
+	{
+		bSucceeded = RunNightBenchmark(Params, Report);
+	}
+	else if (Benchmark.Equals(TEXT("GroundPlane"), ESearchCase::IgnoreCase))
+	{
+		bSucceeded = RunGroundPlaneBenchmark(Params, Report);
+	}
+	else if (Benchmark.Equals(TEXT("Resources"), ESearchCase::IgnoreCase))
+	{
+		bSucceeded = RunResourceBenchmark(Params, Report);
+	}
+	else if (Benchmark.Equals(TEXT("Allocation"), ESearchCase::IgnoreCase))
+	{
+		bSucceeded = RunAllocationBenchmark(Params, Report);
+	}
+	else if (Benchmark.Equals(TEXT("Save"), ESearchCase::IgnoreCase))
+	{
+		bSucceeded = RunSaveBenchmark(Params, Report);
+	}
+	else if (Benchmark.Equals(TEXT("Load"), ESearchCase::IgnoreCase))
+	{
+		bSucceeded = RunLoadBenchmark(Params, Report);
+	}
+	else
+	{
+		UE_LOG(LogSyrupBenchmark, Error, TEXT("Unknown benchmark %s."), *Benchmark);
+		return 1;
+	}
+
+	FString OutputPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / FString::Printf(TEXT("%s_%s.json"), *Benchmark, *FDateTime::Now().ToString());
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+	if (!WriteReport(Report, OutputPath))
+	{
+		return 1;
+	}
+
+	return bSucceeded ? 0 : 1;
+}
+
+/**
+ * Simulates back to back nights without any of the blueprint delays and times each phase.
+ *
+ * @param Params - The command line parameters.
+ * @param Report - The report to add the results to.
+ * @return Whether the benchmark succeeded.
+ */
+bool USyrupBenchmarkCommandlet::RunNightBenchmark(const FString& Params, const TSharedRef<FJsonObject>& Report)
+{
+	FString MapName = TEXT("/Game/Levels/L_Test_2");
+	FParse::Value(*Params, TEXT("Map="), MapName);
+	int NumNights = 10;
+	FParse::Value(*Params, TEXT("Nights="), NumNights);
+	int SettleTicks = 30;
+	FParse::Value(*Params, TEXT("SettleTicks="), SettleTicks);
+
+	Report->SetStringField(TEXT("map"), MapName);
+	Report->SetNumberField(TEXT("nights"), NumNights);
+	Report->SetNumberField(TEXT("settleTicks"), SettleTicks);
+
+	UWorld* World = BeginPlayInMap(MapName);
+	if (!IsValid(World))
+	{
+		return false;
+	}
+
+	ASyrupGameMode* GameMode = World->GetAuthGameMode<ASyrupGameMode>();
+	UTileEffectDispatcher* Dispatcher = UTileEffectDispatcher::Get(World);
+	if (!IsValid(GameMode) || !IsValid(Dispatcher))
+	{
+		UE_LOG(LogSyrupBenchmark, Error, TEXT("%s is not using a syrup game mode."), *MapName);
+		EndPlayInWorld(World);
+		return false;
+	}
+
+	//Let anything spawned while beginning play settle before measuring.
+	TickWorld(World, SettleTicks);
+
+	int NumTilesBefore = 0;
+	for (TActorIterator<ATile> TileIterator(World); TileIterator; ++TileIterator)
+	{
+		NumTilesBefore++;
+	}
+	const int64 NumObjectsBefore = GetNumObjects();
+	const int64 UsedMemoryBefore = GetUsedPhysicalMemory();
+
+	/**
+	 * The measurements of a single phase across every night.
+	 */
+	struct FPhaseMeasurements
+	{
+		TArray<double> Seconds;
+		int64 NumDispatches = 0;
+		int64 NumListenerCalls = 0;
+		int64 NumObjectsCreated = 0;
+		int64 NumRenderStateDirties = 0;
+	};
+	const int NumPhases = (int)LAST_PHASE_TRIGGER + 1;
+	TArray<FPhaseMeasurements> PhaseMeasurements = TArray<FPhaseMeasurements>();
+	PhaseMeasurements.SetNum(NumPhases);
+	TArray<double> NightSeconds = TArray<double>();
+
+	UInstanceCustomDataBatcher* CustomDataBatcher = UInstanceCustomDataBatcher::Get(World);
+	Dispatcher->ResetStats();
+	if (IsValid(CustomDataBatcher))
+	{
+		CustomDataBatcher->Flush();
+		CustomDataBatcher->ResetStats();
+	}
+	for (int NightIndex = 0; NightIndex < NumNights; NightIndex++)
+	{
+		BeginBenchmarkNight(GameMode);
+		double NightStartTime = FPlatformTime::Seconds();
+		for (int PhaseIndex = 0; PhaseIndex < NumPhases; PhaseIndex++)
+		{
+			check(!ASyrupGameMode::IsPlayerTurn(GameMode));
+			int64 DispatchesBefore = 0;
+			int64 ListenerCallsBefore = 0;
+			for (int TriggerIndex = 0; TriggerIndex < 32; TriggerIndex++)
+			{
+				DispatchesBefore += Dispatcher->GetStats().NumDispatches[TriggerIndex];
+				ListenerCallsBefore += Dispatcher->GetStats().NumListenerCalls[TriggerIndex];
+			}
+			int64 PhaseObjectsBefore = GetNumObjects();
+			int64 RenderStateDirtiesBefore = IsValid(CustomDataBatcher) ? CustomDataBatcher->GetNumRenderStateDirties() : 0;
+
+			double PhaseStartTime = FPlatformTime::Seconds();
+			GameMode->TriggerPhaseEvent((ETileEffectTriggerType)PhaseIndex);
+			PhaseMeasurements[PhaseIndex].Seconds.Add(FPlatformTime::Seconds() - PhaseStartTime);
+
+			for (int TriggerIndex = 0; TriggerIndex < 32; TriggerIndex++)
+			{
+				PhaseMeasurements[PhaseIndex].NumDispatches += Dispatcher->GetStats().NumDispatches[TriggerIndex];
+				PhaseMeasurements[PhaseIndex].NumListenerCalls += Dispatcher->GetStats().NumListenerCalls[TriggerIndex];
+			}
+			PhaseMeasurements[PhaseIndex].NumDispatches -= DispatchesBefore;
+			PhaseMeasurements[PhaseIndex].NumListenerCalls -= ListenerCallsBefore;
+			PhaseMeasurements[PhaseIndex].NumObjectsCreated += GetNumObjects() - PhaseObjectsBefore;
+			if (IsValid(CustomDataBatcher))
+			{
+				//Attribute the render state updates to the phase that caused them rather than the next tick.
+				CustomDataBatcher->Flush();
+				PhaseMeasurements[PhaseIndex].NumRenderStateDirties += CustomDataBatcher->GetNumRenderStateDirties() - RenderStateDirtiesBefore;
+			}
+		}
+		NightSeconds.Add(FPlatformTime::Seconds() - NightStartTime);
+
+		//Give falling trash and other ticking objects a chance to finish before the next night.
+		TickWorld(World, SettleTicks);
+	}
+
+	//Phases
+	TArray<TSharedPtr<FJsonValue>> PhaseValues = TArray<TSharedPtr<FJsonValue>>();
+	for (int PhaseIndex = 0; PhaseIndex < NumPhases; PhaseIndex++)
+	{
+		const FPhaseMeasurements& Measurements = PhaseMeasurements[PhaseIndex];
+		TSharedRef<FJsonObject> PhaseObject = MakeShared<FJsonObject>();
+		PhaseObject->SetStringField(TEXT("phase"), StaticEnum<ETileEffectTriggerType>()->GetNameStringByValue(PhaseIndex));
+		AddTimingFields(PhaseObject, Measurements.Seconds);
+		PhaseObject->SetNumberField(TEXT("dispatches"), Measurements.NumDispatches);
+		PhaseObject->SetNumberField(TEXT("listenerCalls"), Measurements.NumListenerCalls);
+		PhaseObject->SetNumberField(TEXT("objectsCreated"), Measurements.NumObjectsCreated);
+		PhaseObject->SetNumberField(TEXT("renderStateDirties"), Measurements.NumRenderStateDirties);
+		PhaseValues.Add(MakeShared<FJsonValueObject>(PhaseObject));
+	}
+	Report->SetArrayField(TEXT("phases"), PhaseValues);
+
+	//Nights
+	TArray<TSharedPtr<FJsonValue>> NightValues = TArray<TSharedPtr<FJsonValue>>();
+	for (double EachNightSeconds : NightSeconds)
+	{
+		NightValues.Add(MakeShared<FJsonValueNumber>(EachNightSeconds));
+	}
+	Report->SetArrayField(TEXT("nightSeconds"), NightValues);
+
+	//Triggers
+	TSharedRef<FJsonObject> TriggersObject = MakeShared<FJsonObject>();
+	UEnum* TriggerEnum = StaticEnum<ETileEffectTriggerType>();
+	for (int EnumIndex = 0; EnumIndex < TriggerEnum->NumEnums() - 1; EnumIndex++)
+	{
+		int64 TriggerIndex = TriggerEnum->GetValueByIndex(EnumIndex);
+		TSharedRef<FJsonObject> TriggerObject = MakeShared<FJsonObject>();
+		TriggerObject->SetNumberField(TEXT("dispatches"), Dispatcher->GetStats().NumDispatches[TriggerIndex]);
+		TriggerObject->SetNumberField(TEXT("listenerCalls"), Dispatcher->GetStats().NumListenerCalls[TriggerIndex]);
+		TriggersObject->SetObjectField(TriggerEnum->GetNameStringByIndex(EnumIndex), TriggerObject);
+	}
+	Report->SetObjectField(TEXT("triggers"), TriggersObject);
+
+	//Board
+	int NumTilesAfter = 0;
+	for (TActorIterator<ATile> TileIterator(World); TileIterator; ++TileIterator)
+	{
+		NumTilesAfter++;
+	}
+	TSharedRef<FJsonObject> BoardObject = MakeShared<FJsonObject>();
+	BoardObject->SetNumberField(TEXT("tilesBefore"), NumTilesBefore);
+	BoardObject->SetNumberField(TEXT("tilesAfter"), NumTilesAfter);
+	BoardObject->SetNumberField(TEXT("listeners"), Dispatcher->GetNumListeners());
+	Report->SetObjectField(TEXT("board"), BoardObject);
+
+	//Rendering
+	if (IsValid(CustomDataBatcher))
+	{
+		TSharedRef<FJsonObject> RenderingObject = MakeShared<FJsonObject>();
+		RenderingObject->SetNumberField(TEXT("customDataWrites"), CustomDataBatcher->GetNumCustomDataWrites());
+		RenderingObject->SetNumberField(TEXT("renderStateDirties"), CustomDataBatcher->GetNumRenderStateDirties());
+		RenderingObject->SetNumberField(TEXT("renderStateDirtiesLastTurn"), CustomDataBatcher->GetNumRenderStateDirtiesLastTurn());
+		Report->SetObjectField(TEXT("rendering"), RenderingObject);
+	}
+
+	//Allocations
+	TSharedRef<FJsonObject> AllocationObject = MakeShared<FJsonObject>();
+	AllocationObject->SetNumberField(TEXT("objectsBefore"), NumObjectsBefore);
+	AllocationObject->SetNumberField(TEXT("objectsAfter"), GetNumObjects());
+	AllocationObject->SetNumberField(TEXT("usedPhysicalBytesBefore"), UsedMemoryBefore);
+	AllocationObject->SetNumberField(TEXT("usedPhysicalBytesAfter"), GetUsedPhysicalMemory());
+	Report->SetObjectField(TEXT("allocations"), AllocationObject);
+
+	EndPlayInWorld(World);
+	return true;
+}
+
+/**
+ * Times generating a large ground plane with the original one chunk at a time generation as the baseline and then
+ * with parallel generation.
+ *
+ * @param Params - The command line parameters.
+ * @param Report - The report to add the results to.
+ * @return Whether the benchmark succeeded.
+ */
+bool USyrupBenchmarkCommandlet::RunGroundPlaneBenchmark(const FString& Params, const TSharedRef<FJsonObject>& Report)
+{
+	int TargetCells = 100000;
+	FParse::Value(*Params, TEXT("Cells="), TargetCells);
+	int NumRuns = 5;
+	FParse::Value(*Params, TEXT("Runs="), NumRuns);
+	FString GroundPlaneClassPath = TEXT("/Game/LevelUtilities/GroundPlane/BP_GroundPlane.BP_GroundPlane_C");
+	FParse::Value(*Params, TEXT("GroundPlaneClass="), GroundPlaneClassPath);
+
+	UClass* GroundPlaneClass = LoadClass<AGroundPlane>(nullptr, *GroundPlaneClassPath);
+	IConsoleVariable* ParallelGenerationVariable = IConsoleManager::Get().FindConsoleVariable(TEXT("Syrup.Ground.ParallelGeneration"));
+	if (!IsValid(GroundPlaneClass) || !ParallelGenerationVariable)
+	{
+		UE_LOG(LogSyrupBenchmark, Error, TEXT("Could not load ground plane class %s."), *GroundPlaneClassPath);
+		return false;
+	}
+
+	//A plane of scale 1 covers about 5773.5 grid locations and the number covered grows with the square of the scale.
+	const double PlaneScale = FMath::Sqrt(TargetCells / 5773.5);
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+	AGroundPlane* GroundPlane = World->SpawnActor<AGroundPlane>(GroundPlaneClass, FTransform(FRotator::ZeroRotator, FVector::ZeroVector, FVector(PlaneScale, PlaneScale, 1)));
+	const bool bWasParallel = ParallelGenerationVariable->GetBool();
+
+	Report->SetNumberField(TEXT("planeScale"), PlaneScale);
+	Report->SetNumberField(TEXT("cells"), GroundPlane->GetGridLocations().Num());
+	Report->SetNumberField(TEXT("runs"), NumRuns);
+	for (const bool bParallel : { false, true })
+	{
+		ParallelGenerationVariable->Set(bParallel, ECVF_SetByCode);
+		TArray<double> Seconds = TArray<double>();
+		for (int RunIndex = 0; RunIndex < NumRuns; RunIndex++)
+		{
+			double StartTime = FPlatformTime::Seconds();
+			GroundPlane->OnConstruction(GroundPlane->GetActorTransform());
+			Seconds.Add(FPlatformTime::Seconds() - StartTime);
+		}
+
+		TSharedRef<FJsonObject> TimingObject = MakeShared<FJsonObject>();
+		AddTimingFields(TimingObject, Seconds);
+		Report->SetObjectField(bParallel ? TEXT("parallel") : TEXT("baseline"), TimingObject);
+	}
+	ParallelGenerationVariable->Set(bWasParallel, ECVF_SetByCode);
+
+	World->DestroyWorld(false);
+	World->RemoveFromRoot();
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	return true;
+}
+
+/**
+ * Simulates nights of allocating and freeing resources, once with a facade fetched for every resource as if each were
+ * still its own object and once through handles alone, and measures the garbage created and the time spent collecting
+ * it. Also times the sink accessors bound by name against native bindings.
+ *
+ * @param Params - The command line parameters.
+ * @param Report - The report to add the results to.
+ * @return Whether the benchmark succeeded.
+ */
+bool USyrupBenchmarkCommandlet::RunResourceBenchmark(const FString& Params, const TSharedRef<FJsonObject>& Report)
+{
+	FString MapName = TEXT("/Game/Levels/L_Test_2");
+	FParse::Value(*Params, TEXT("Map="), MapName);
+	int NumNights = 100;
+	FParse::Value(*Params, TEXT("Nights="), NumNights);
+	int Seed = 0;
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	int NumSinkCalls = 100000;
+	FParse::Value(*Params, TEXT("SinkCalls="), NumSinkCalls);
+
+	IConsoleVariable* RecycleFacadesVariable = IConsoleManager::Get().FindConsoleVariable(TEXT("Syrup.Resources.RecycleFacades"));
+	if (!RecycleFacadesVariable)
+	{
+		return false;
+	}
+	const bool bWasRecycling = RecycleFacadesVariable->GetBool();
+	RecycleFacadesVariable->Set(false, ECVF_SetByCode);
+
+	Report->SetStringField(TEXT("map"), MapName);
+	Report->SetNumberField(TEXT("nights"), NumNights);
+	Report->SetNumberField(TEXT("seed"), Seed);
+	bool bSucceeded = true;
+	for (const bool bUseFacades : { true, false })
+	{
+		UWorld* World = BeginPlayInMap(MapName);
+		ASyrupGameMode* GameMode = IsValid(World) ? World->GetAuthGameMode<ASyrupGameMode>() : nullptr;
+		UResourcePool* Pool = UResourcePool::Get(World);
+		if (!IsValid(GameMode) || !IsValid(Pool))
+		{
+			UE_LOG(LogSyrupBenchmark, Error, TEXT("%s is not using a syrup game mode."), *MapName);
+			if (IsValid(World))
+			{
+				EndPlayInWorld(World);
+			}
+			bSucceeded = false;
+			break;
+		}
+
+		FRandomStream Random = FRandomStream(Seed);
+		Pool->ResetStats();
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+		const int64 NumObjectsBefore = GetNumObjects();
+		TArray<double> GarbageCollectionSeconds = TArray<double>();
+		int64 NumAllocations = 0;
+		int64 NumFrees = 0;
+		int32 PeakSlots = Pool->GetNumSlots();
+
+		for (int NightIndex = 0; NightIndex < NumNights; NightIndex++)
+		{
+			//Simulate the player allocating every free resource they can.
+			TArray<UResourceSink*> Sinks = TArray<UResourceSink*>();
+			TArray<IResourceFaucet*> Faucets = TArray<IResourceFaucet*>();
+			for (TActorIterator<ATile> TileIterator(World); TileIterator; ++TileIterator)
+			{
+				TArray<UResourceSink*> TileSinks = TArray<UResourceSink*>();
+				TileIterator->GetComponents<UResourceSink>(TileSinks);
+				Sinks.Append(TileSinks);
+				if (IResourceFaucet* Faucet = Cast<IResourceFaucet>(*TileIterator))
+				{
+					Faucets.Add(Faucet);
+				}
+			}
+
+			TArray<FResourceHandle> AllocatedThisNight = TArray<FResourceHandle>();
+			for (IResourceFaucet* EachFaucet : Faucets)
+			{
+				//The baseline gives every resource an object, like the UI showing every resource would.
+				if (bUseFacades)
+				{
+					Pool->GetFacades(EachFaucet->GetProducedResourceHandles());
+				}
+
+				for (const FResourceHandle& EachResource : EachFaucet->GetProducedResourceHandles())
+				{
+					if (!Pool->IsAlive(EachResource) || Pool->IsAllocated(EachResource))
+					{
+						continue;
+					}
+
+					for (UResourceSink* EachSink : Sinks)
+					{
+						if (IsValid(EachSink) && Pool->CanAllocateTo(EachResource, EachSink) && EachSink->AllocateResource(EachResource))
+						{
+							AllocatedThisNight.Add(EachResource);
+							NumAllocations++;
+							break;
+						}
+					}
+				}
+			}
+
+			BeginBenchmarkNight(GameMode);
+			for (int PhaseIndex = 0; PhaseIndex <= (int)LAST_PHASE_TRIGGER; PhaseIndex++)
+			{
+				check(!ASyrupGameMode::IsPlayerTurn(GameMode));
+				GameMode->TriggerPhaseEvent((ETileEffectTriggerType)PhaseIndex);
+			}
+			TickWorld(World, 1);
+
+			//Undo about half of the night's allocations so that production keeps changing.
+			for (const FResourceHandle& EachResource : AllocatedThisNight)
+			{
+				if (Pool->IsAllocated(EachResource) && Random.FRand() < 0.5f)
+				{
+					Pool->FreeResource(EachResource);
+					NumFrees++;
+				}
+			}
+			PeakSlots = FMath::Max(PeakSlots, Pool->GetNumSlots());
+
+			double StartTime = FPlatformTime::Seconds();
+			CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+			GarbageCollectionSeconds.Add(FPlatformTime::Seconds() - StartTime);
+		}
+
+		TSharedRef<FJsonObject> ModeObject = MakeShared<FJsonObject>();
+		ModeObject->SetNumberField(TEXT("allocations"), NumAllocations);
+		ModeObject->SetNumberField(TEXT("frees"), NumFrees);
+		ModeObject->SetNumberField(TEXT("resourcesCreated"), Pool->GetNumResourcesCreated());
+		ModeObject->SetNumberField(TEXT("facadesCreated"), Pool->GetNumFacadesCreated());
+		ModeObject->SetNumberField(TEXT("aliveResources"), Pool->GetNumAliveResources());
+		ModeObject->SetNumberField(TEXT("peakSlots"), PeakSlots);
+		ModeObject->SetNumberField(TEXT("objectsBefore"), NumObjectsBefore);
+		ModeObject->SetNumberField(TEXT("objectsAfter"), GetNumObjects());
+		TSharedRef<FJsonObject> GarbageCollectionObject = MakeShared<FJsonObject>();
+		AddTimingFields(GarbageCollectionObject, GarbageCollectionSeconds);
+		ModeObject->SetObjectField(TEXT("garbageCollection"), GarbageCollectionObject);
+		Report->SetObjectField(bUseFacades ? TEXT("baseline") : TEXT("handles"), ModeObject);
+
+		//The bindings do not depend on facades, so only time them once.
+		TActorIterator<APlant> PlantIterator = TActorIterator<APlant>(World);
+		if (!bUseFacades && PlantIterator)
+		{
+			TSharedRef<FJsonObject> SinkBindingObject = MakeShared<FJsonObject>();
+			AddSinkBindingTimings(SinkBindingObject, *PlantIterator, NumSinkCalls);
+			Report->SetObjectField(TEXT("sinkBindings"), SinkBindingObject);
+		}
+
+		EndPlayInWorld(World);
+	}
+	RecycleFacadesVariable->Set(bWasRecycling, ECVF_SetByCode);
+
+	return bSucceeded;
+}
+
+/**
+ * Times solving the auto allocation of resources on a generated problem and optionally on the board of a map.
+ *
+ * @param Params - The command line parameters.
+ * @param Report - The report to add the results to.
+ * @return Whether the benchmark succeeded.
+ */
+bool USyrupBenchmarkCommandlet::RunAllocationBenchmark(const FString& Params, const TSharedRef<FJsonObject>& Report)
+{
+	int NumSinks = 5000;
+	FParse::Value(*Params, TEXT("Sinks="), NumSinks);
+	int NumFaucets = 2500;
+	FParse::Value(*Params, TEXT("Faucets="), NumFaucets);
+	int ResourcesPerFaucet = 2;
+	FParse::Value(*Params, TEXT("ResourcesPerFaucet="), ResourcesPerFaucet);
+	int Reach = 12;
+	FParse::Value(*Params, TEXT("Reach="), Reach);
+	int NumRuns = 5;
+	FParse::Value(*Params, TEXT("Runs="), NumRuns);
+	int Seed = 0;
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+
+	//Generate a board where each faucet reaches sinks near it along a line, like plants reaching their neighbors.
+	FRandomStream Random = FRandomStream(Seed);
+	const EResourceType Types[] = { EResourceType::Any, EResourceType::Water, EResourceType::Sugar, EResourceType::Nitrogen };
+	TArray<UResourceAllocationSolver::FDemand> Demands = TArray<UResourceAllocationSolver::FDemand>();
+	for (int SinkIndex = 0; SinkIndex < NumSinks; SinkIndex++)
+	{
+		UResourceAllocationSolver::FDemand NewDemand = UResourceAllocationSolver::FDemand();
+		NewDemand.Capacity = Random.RandRange(1, 3);
+		NewDemand.SlotTypes.Add(Types[Random.RandRange(0, 3)]);
+		NewDemand.Priority = Random.RandRange(0, 2);
+		Demands.Add(NewDemand);
+	}
+
+	TArray<UResourceAllocationSolver::FSupply> Supplies = TArray<UResourceAllocationSolver::FSupply>();
+	int64 NumCandidateLinks = 0;
+	for (int FaucetIndex = 0; FaucetIndex < NumFaucets; FaucetIndex++)
+	{
+		const int CenterSink = NumFaucets > 1 ? (int)((int64)FaucetIndex * (NumSinks - 1) / (NumFaucets - 1)) : 0;
+		TArray<int32> ReachableDemands = TArray<int32>();
+		for (int Offset = -Reach / 2; Offset <= Reach / 2; Offset++)
+		{
+			if (Demands.IsValidIndex(CenterSink + Offset))
+			{
+				ReachableDemands.Add(CenterSink + Offset);
+			}
+		}
+
+		for (int ResourceIndex = 0; ResourceIndex < ResourcesPerFaucet; ResourceIndex++)
+		{
+			UResourceAllocationSolver::FSupply NewSupply = UResourceAllocationSolver::FSupply();
+			NewSupply.Amount = 1;
+			NewSupply.Type = Types[Random.RandRange(1, 3)];
+			NewSupply.DemandIndices = ReachableDemands;
+			NumCandidateLinks += ReachableDemands.Num();
+			Supplies.Add(NewSupply);
+		}
+	}
+
+	int32 TotalFlow = 0;
+	TArray<double> Seconds = TArray<double>();
+	for (int RunIndex = 0; RunIndex < NumRuns; RunIndex++)
+	{
+		TArray<UResourceAllocationSolver::FFlow> Flows = TArray<UResourceAllocationSolver::FFlow>();
+		double StartTime = FPlatformTime::Seconds();
+		TotalFlow = UResourceAllocationSolver::Solve(Supplies, Demands, Flows);
+		Seconds.Add(FPlatformTime::Seconds() - StartTime);
+	}
+
+	TSharedRef<FJsonObject> GeneratedObject = MakeShared<FJsonObject>();
+	GeneratedObject->SetNumberField(TEXT("sinks"), NumSinks);
+	GeneratedObject->SetNumberField(TEXT("resources"), Supplies.Num());
+	GeneratedObject->SetNumberField(TEXT("candidateLinks"), NumCandidateLinks);
+	GeneratedObject->SetNumberField(TEXT("allocated"), TotalFlow);
+	AddTimingFields(GeneratedObject, Seconds);
+	Report->SetObjectField(TEXT("generated"), GeneratedObject);
+
+	//Solve the board of a real map without applying the result.
+	FString MapName = TEXT("");
+	if (FParse::Value(*Params, TEXT("Map="), MapName))
+	{
+		UWorld* World = BeginPlayInMap(MapName);
+		if (!IsValid(World))
+		{
+			return false;
+		}
+
+		int32 NumAllocated = 0;
+		TArray<double> MapSeconds = TArray<double>();
+		for (int RunIndex = 0; RunIndex < NumRuns; RunIndex++)
+		{
+			double StartTime = FPlatformTime::Seconds();
+			NumAllocated = UResourceAllocationSolver::AutoAllocateResources(World, false);
+			MapSeconds.Add(FPlatformTime::Seconds() - StartTime);
+		}
+
+		TSharedRef<FJsonObject> MapObject = MakeShared<FJsonObject>();
+		MapObject->SetStringField(TEXT("map"), MapName);
+		MapObject->SetNumberField(TEXT("allocated"), NumAllocated);
+		AddTimingFields(MapObject, MapSeconds);
+		Report->SetObjectField(TEXT("board"), MapObject);
+
+		EndPlayInWorld(World);
+	}
+
+	return true;
+}
+
+/**
+ * Compares the size and serialize time of the generic and compact save formats, including a compact save stored as
+ * the differences from the night before. Use a stress map generated with 10000 tiles for the reference board.
+ *
+ * @param Params - The command line parameters.
+ * @param Report - The report to add the results to.
+ * @return Whether the benchmark succeeded.
+ */
+bool USyrupBenchmarkCommandlet::RunSaveBenchmark(const FString& Params, const TSharedRef<FJsonObject>& Report)
+{
+	FString MapName = TEXT("/Game/Benchmarks/L_Stress");
+	FParse::Value(*Params, TEXT("Map="), MapName);
+	int NumRuns = 5;
+	FParse::Value(*Params, TEXT("Runs="), NumRuns);
+	NumRuns = FMath::Max(NumRuns, 1);
+
+	Report->SetStringField(TEXT("map"), MapName);
+	Report->SetNumberField(TEXT("runs"), NumRuns);
+
+	UWorld* World = BeginPlayInMap(MapName);
+	ASyrupGameMode* GameMode = IsValid(World) ? World->GetAuthGameMode<ASyrupGameMode>() : nullptr;
+	if (!IsValid(GameMode))
+	{
+		UE_LOG(LogSyrupBenchmark, Error, TEXT("%s is not using a syrup game mode."), *MapName);
+		if (IsValid(World))
+		{
+			EndPlayInWorld(World);
+		}
+		return false;
+	}
+
+	TArray<double> CaptureSeconds = TArray<double>();
+	double StartTime = FPlatformTime::Seconds();
+	USyrupSaveGame* Save = USyrupSaveGame::CaptureWorld(World);
+	CaptureSeconds.Add(FPlatformTime::Seconds() - StartTime);
+	Report->SetNumberField(TEXT("tiles"), Save->GetNumTiles());
+
+	//Times writing and reading a save in one format and returns the bytes written.
+	const auto MeasureFormat = [NumRuns](const TCHAR* FieldName, const TSharedRef<FJsonObject>& Object, const TFunctionRef<void(TArray<uint8>&)> Write, const TFunctionRef<bool(const TArray<uint8>&)> Read)
+	{
+		TArray<uint8> Bytes = TArray<uint8>();
+		TArray<double> WriteSeconds = TArray<double>();
+		TArray<double> ReadSeconds = TArray<double>();
+		bool bRead = true;
+		for (int RunIndex = 0; RunIndex < NumRuns; RunIndex++)
+		{
+			double RunStartTime = FPlatformTime::Seconds();
+			Write(Bytes);
+			WriteSeconds.Add(FPlatformTime::Seconds() - RunStartTime);
+
+			RunStartTime = FPlatformTime::Seconds();
+			bRead &= Read(Bytes);
+			ReadSeconds.Add(FPlatformTime::Seconds() - RunStartTime);
+		}
+
+		TSharedRef<FJsonObject> FormatObject = MakeShared<FJsonObject>();
+		FormatObject->SetNumberField(TEXT("bytes"), Bytes.Num());
+		FormatObject->SetBoolField(TEXT("readSucceeded"), bRead);
+		TSharedRef<FJsonObject> WriteObject = MakeShared<FJsonObject>();
+		AddTimingFields(WriteObject, WriteSeconds);
+		FormatObject->SetObjectField(TEXT("write"), WriteObject);
+		TSharedRef<FJsonObject> ReadObject = MakeShared<FJsonObject>();
+		AddTimingFields(ReadObject, ReadSeconds);
+		FormatObject->SetObjectField(TEXT("read"), ReadObject);
+		Object->SetObjectField(FieldName, FormatObject);
+		return Bytes;
+	};
+
+	MeasureFormat(TEXT("generic"), Report,
+		[Save](TArray<uint8>& Bytes) { Bytes.Reset(); UGameplayStatics::SaveGameToMemory(Save, Bytes); },
+		[](const TArray<uint8>& Bytes) { return IsValid(UGameplayStatics::LoadGameFromMemory(Bytes)); });
+	const TArray<uint8> CompactBytes = MeasureFormat(TEXT("compact"), Report,
+		[Save](TArray<uint8>& Bytes) { Save->WriteCompact(Bytes); },
+		[](const TArray<uint8>& Bytes) { return IsValid(USyrupSaveGame::LoadFromBytes(Bytes)); });
+
+	//Play a night and store it as the differences from the save before it. Reading it needs the base in a slot.
+	BeginBenchmarkNight(GameMode);
+	for (int PhaseIndex = 0; PhaseIndex <= (int)LAST_PHASE_TRIGGER; PhaseIndex++)
+	{
+		check(!ASyrupGameMode::IsPlayerTurn(GameMode));
+		GameMode->TriggerPhaseEvent((ETileEffectTriggerType)PhaseIndex);
+	}
+	TickWorld(World, 1);
+	StartTime = FPlatformTime::Seconds();
+	USyrupSaveGame* NextSave = USyrupSaveGame::CaptureWorld(World);
+	CaptureSeconds.Add(FPlatformTime::Seconds() - StartTime);
+
+	const FString BaseSlotName = TEXT("SyrupBenchmarkBase");
+	bool bSucceeded = UGameplayStatics::SaveDataToSlot(CompactBytes, BaseSlotName, 0);
+	const uint32 BaseChecksum = FCrc::MemCrc32(CompactBytes.GetData(), CompactBytes.Num());
+	MeasureFormat(TEXT("compactDelta"), Report,
+		[NextSave, Save, &BaseSlotName, BaseChecksum](TArray<uint8>& Bytes) { NextSave->WriteCompact(Bytes, Save, BaseSlotName, BaseChecksum); },
+		[](const TArray<uint8>& Bytes) { return IsValid(USyrupSaveGame::LoadFromBytes(Bytes)); });
+	UGameplayStatics::DeleteGameInSlot(BaseSlotName, 0);
+
+	TSharedRef<FJsonObject> CaptureObject = MakeShared<FJsonObject>();
+	AddTimingFields(CaptureObject, CaptureSeconds);
+	Report->SetObjectField(TEXT("capture"), CaptureObject);
+
+	EndPlayInWorld(World);
+	return bSucceeded;
+}
+
+/**
+ * Times loading a save of the board of a map with and without batching the per tile notifications, and counts the
+ * triggers dispatched by each. Loading without batching runs the load as it was before batching was added, so it is
+ * reported as the baseline. Use a stress map generated with 10000 tiles for the reference board.
+ *
+ * @param Params - The command line parameters.
+ * @param Report - The report to add the results to.
+ * @return Whether the benchmark succeeded.
+ */
+bool USyrupBenchmarkCommandlet::RunLoadBenchmark(const FString& Params, const TSharedRef<FJsonObject>& Report)
+{
+	FString MapName = TEXT("/Game/Benchmarks/L_Stress");
+	FParse::Value(*Params, TEXT("Map="), MapName);
+	int NumRuns = 5;
+	FParse::Value(*Params, TEXT("Runs="), NumRuns);
+	NumRuns = FMath::Max(NumRuns, 1);
+
+	Report->SetStringField(TEXT("map"), MapName);
+	Report->SetNumberField(TEXT("runs"), NumRuns);
+
+	UWorld* World = BeginPlayInMap(MapName);
+	UTileEffectDispatcher* Dispatcher = UTileEffectDispatcher::Get(World);
+	if (!IsValid(World) || !IsValid(World->GetAuthGameMode<ASyrupGameMode>()) || !IsValid(Dispatcher))
+	{
+		UE_LOG(LogSyrupBenchmark, Error, TEXT("%s is not using a syrup game mode."), *MapName);
+		if (IsValid(World))
+		{
+			EndPlayInWorld(World);
+		}
+		return false;
+	}
+
+	//Every run loads the same board over itself. The save may be written in the background, so wait for it before reading it back.
+	const FString SlotName = TEXT("SyrupBenchmarkLoad");
+	USyrupSaveGame::SaveGame(World, SlotName);
+	UAsyncSaveSubsystem* AsyncSaveSubsystem = UAsyncSaveSubsystem::Get(World);
+	if (IsValid(AsyncSaveSubsystem))
+	{
+		AsyncSaveSubsystem->WaitForSaves();
+	}
+	USyrupSaveGame* Save = USyrupSaveGame::LoadFromSlot(SlotName);
+	if (!IsValid(Save))
+	{
+		UE_LOG(LogSyrupBenchmark, Error, TEXT("Could not save the board of %s."), *MapName);
+		EndPlayInWorld(World);
+		return false;
+	}
+	Report->SetNumberField(TEXT("tiles"), Save->GetNumTiles());
+
+	IConsoleVariable* BatchedLoadVariable = IConsoleManager::Get().FindConsoleVariable(TEXT("Syrup.Save.BatchedLoad"));
+	if (!BatchedLoadVariable)
+	{
+		UE_LOG(LogSyrupBenchmark, Error, TEXT("Syrup.Save.BatchedLoad is not registered."));
+		EndPlayInWorld(World);
+		return false;
+	}
+	const bool bWasBatched = BatchedLoadVariable->GetBool();
+	for (bool bBatched : { false, true })
+	{
+		BatchedLoadVariable->Set(bBatched, ECVF_SetByCode);
+
+		TArray<double> LoadSeconds = TArray<double>();
+		int64 NumDispatches = 0;
+		int64 NumListenerCalls = 0;
+		for (int RunIndex = 0; RunIndex < NumRuns; RunIndex++)
+		{
+			Dispatcher->ResetStats();
+			const double StartTime = FPlatformTime::Seconds();
+			USyrupSaveGame::LoadGame(World, SlotName);
+			LoadSeconds.Add(FPlatformTime::Seconds() - StartTime);
+
+			const UTileEffectDispatcher::FDispatchStats& Stats = Dispatcher->GetStats();
+			for (int TriggerIndex = 0; TriggerIndex < 32; TriggerIndex++)
+			{
+				NumDispatches += Stats.NumDispatches[TriggerIndex];
+				NumListenerCalls += Stats.NumListenerCalls[TriggerIndex];
+			}
+
+			//Let the tiles destroyed by the load leave the world before the next one.
+			TickWorld(World, 1);
+		}
+
+		TSharedRef<FJsonObject> ModeObject = MakeShared<FJsonObject>();
+		AddTimingFields(ModeObject, LoadSeconds);
+		ModeObject->SetNumberField(TEXT("dispatchesPerLoad"), (double)NumDispatches / NumRuns);
+		ModeObject->SetNumberField(TEXT("listenerCallsPerLoad"), (double)NumListenerCalls / NumRuns);
+		Report->SetObjectField(bBatched ? TEXT("batched") : TEXT("baseline"), ModeObject);
+	}
+	BatchedLoadVariable->Set(bWasBatched, ECVF_SetByCode);
+
+	UGameplayStatics::DeleteGameInSlot(SlotName, 0);
+	EndPlayInWorld(World);
+	return true;
+}
+
+/**
+ * Times calling the sink accessors of a plant through delegates bound by function name and through native delegates.
+ *
+ * @param Object - The object to add the timings to.
+ * @param Plant - The plant to call the accessors of.
+ * @param NumCalls - The number of times to call each accessor.
+ */
+void USyrupBenchmarkCommandlet::AddSinkBindingTimings(const TSharedRef<FJsonObject>& Object, APlant* Plant, const int NumCalls)
+{
+	FSinkAmountDelegate DynamicAmountGetter;
+	DynamicAmountGetter.BindUFunction(Plant, FName("GetHealth"));
+	FSinkLocationsDelegate DynamicLocationsGetter;
+	DynamicLocationsGetter.BindUFunction(Plant, FName("GetSubTileLocations"));
+	FSinkAmountUpdateDelegate DynamicAmountSetter;
+	DynamicAmountSetter.BindUFunction(Plant, FName("SetHealth"));
+	FNativeSinkAmountDelegate NativeAmountGetter = FNativeSinkAmountDelegate::CreateUObject(Plant, &APlant::GetHealth);
+	FNativeSinkLocationsDelegate NativeLocationsGetter = FNativeSinkLocationsDelegate::CreateUObject(Plant, &APlant::GetSubTileLocations);
+	FNativeSinkAmountUpdateDelegate NativeAmountSetter = FNativeSinkAmountUpdateDelegate::CreateUObject(Plant, &APlant::SetHealth);
+
+	//Setting the health to its current value has no side effects.
+	const int Health = Plant->GetHealth();
+	int64 Checksum = 0;
+	const auto TimeCalls = [NumCalls](const TFunctionRef<void()> Call)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		for (int CallIndex = 0; CallIndex < NumCalls; CallIndex++)
+		{
+			Call();
+		}
+		return (FPlatformTime::Seconds() - StartTime) * 1e9 / FMath::Max(NumCalls, 1);
+	};
+
+	Object->SetNumberField(TEXT("calls"), NumCalls);
+	Object->SetNumberField(TEXT("dynamicAmountGetterNanoseconds"), TimeCalls([&]() { Checksum += DynamicAmountGetter.Execute(); }));
+	Object->SetNumberField(TEXT("nativeAmountGetterNanoseconds"), TimeCalls([&]() { Checksum += NativeAmountGetter.Execute(); }));
+	Object->SetNumberField(TEXT("dynamicLocationsGetterNanoseconds"), TimeCalls([&]() { Checksum += DynamicLocationsGetter.Execute().Num(); }));
+	Object->SetNumberField(TEXT("nativeLocationsGetterNanoseconds"), TimeCalls([&]() { Checksum += NativeLocationsGetter.Execute().Num(); }));
+	Object->SetNumberField(TEXT("dynamicAmountSetterNanoseconds"), TimeCalls([&]() { DynamicAmountSetter.Execute(Health); }));
+	Object->SetNumberField(TEXT("nativeAmountSetterNanoseconds"), TimeCalls([&]() { NativeAmountSetter.Execute(Health); }));
+	UE_LOG(LogSyrupBenchmark, Verbose, TEXT("Sink binding checksum: %lld"), Checksum);
+}
+
+/**
+ * Adds the total, mean, min, and max of a set of timings to a json object.
+ *
+ * @param Object - The object to add the fields to.
+ * @param Seconds - The timings in seconds.
+ */
+void USyrupBenchmarkCommandlet::AddTimingFields(const TSharedRef<FJsonObject>& Object, const TArray<double>& Seconds)
+{
+	double TotalSeconds = 0;
+	for (double EachSeconds : Seconds)
+	{
+		TotalSeconds += EachSeconds;
+	}
+
+	Object->SetNumberField(TEXT("totalSeconds"), TotalSeconds);
+	Object->SetNumberField(TEXT("meanSeconds"), Seconds.IsEmpty() ? 0 : TotalSeconds / Seconds.Num());
+	Object->SetNumberField(TEXT("minSeconds"), Seconds.IsEmpty() ? 0 : FMath::Min(Seconds));
+	Object->SetNumberField(TEXT("maxSeconds"), Seconds.IsEmpty() ? 0 : FMath::Max(Seconds));
+}
+
+/**
+ * Loads a map and begins play in it as a game world.
+ *
+ * @param MapName - The package name of the map to load.
+ * @return The world that is being played. Nullptr if the map could not be loaded.
+ */
+UWorld* USyrupBenchmarkCommandlet::BeginPlayInMap(const FString& MapName)
+{
+	UPackage* MapPackage = LoadPackage(nullptr, *MapName, LOAD_None);
+	UWorld* World = IsValid(MapPackage) ? UWorld::FindWorldInPackage(MapPackage) : nullptr;
+	if (!IsValid(World))
+	{
+		UE_LOG(LogSyrupBenchmark, Error, TEXT("Could not load map %s. Stress maps can be generated with -run=SyrupStressMap."), *MapName);
+		return nullptr;
+	}
+
+	World->AddToRoot();
+	World->WorldType = EWorldType::Game;
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	if (!World->bIsWorldInitialized)
+	{
+		World->InitWorld(UWorld::InitializationValues()
+			.AllowAudioPlayback(false)
+			.CreatePhysicsScene(true)
+			.EnableTraceCollision(true)
+			.CreateNavigation(false)
+			.CreateAISystem(false));
+	}
+	World->UpdateWorldComponents(true, true);
+
+	FURL URL = FURL();
+	World->SetGameMode(URL);
+	World->InitializeActorsForPlay(URL);
+	World->BeginPlay();
+
+	return World;
+}
+
+/**
+ * Ends play in and destroys a world created by BeginPlayInMap.
+ *
+ * @param World - The world to destroy.
+ */
+void USyrupBenchmarkCommandlet::EndPlayInWorld(UWorld* World)
+{
+	World->EndPlay(EEndPlayReason::Quit);
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	World->RemoveFromRoot();
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+}
+
+/**
+ * Ticks a world a number of times at a fixed rate.
+ *
+ * @param World - The world to tick.
+ * @param NumTicks - The number of ticks to perform.
+ */
+void USyrupBenchmarkCommandlet::TickWorld(UWorld* World, const int NumTicks)
+{
+	for (int TickIndex = 0; TickIndex < NumTicks; TickIndex++)
+	{
+		World->Tick(ELevelTick::LEVELTICK_All, 1.f / 30.f);
+	}
+}
+
+/**
+ * Gets the number of UObjects currently alive.
+ *
+ * @return The number of UObjects currently alive.
+ */
+int64 USyrupBenchmarkCommandlet::GetNumObjects()
+{
+	return GUObjectArray.GetObjectArrayNumMinusAvailable();
+}
+
+/**
+ * Gets the physical memory currently used by the process.
+ *
+ * @return The physical memory used in bytes.
+ */
+int64 USyrupBenchmarkCommandlet::GetUsedPhysicalMemory()
+{
+	return (int64)FPlatformMemory::GetStats().UsedPhysical;
+}
+
+/**
+ * Writes a report to a file.
+ *
+ * @param Report - The report to write.
+ * @param OutputPath - The path of the file to write to.
+ * @return Whether the file was written.
+ */
+bool USyrupBenchmarkCommandlet::WriteReport(const TSharedRef<FJsonObject>& Report, const FString& OutputPath)
+{
+	FString ReportString = FString();
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ReportString);
+	if (!FJsonSerializer::Serialize(Report, Writer))
+	{
+		UE_LOG(LogSyrupBenchmark, Error, TEXT("Could not serialize benchmark report."));
+		return false;
+	}
+
+	if (!FFileHelper::SaveStringToFile(ReportString, *OutputPath))
+	{
+		UE_LOG(LogSyrupBenchmark, Error, TEXT("Could not write benchmark report to %s."), *OutputPath);
+		return false;
+	}
+
+	UE_LOG(LogSyrupBenchmark, Display, TEXT("Wrote benchmark report to %s:\n%s"), *OutputPath, *ReportString);
+	return true;
+}
+
+/* /\ ========================= /\ *\
+|  /\ USyrupBenchmarkCommandlet /\  |
+\* /\ ========================= /\ */
@@ -0,0 +1,172 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SyrupBenchmarkCommandlet.generated.h"
+
+class APlant;
+class FJsonObject;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogSyrupBenchmark, Log, All);
+
+/* \/ ========================= \/ *\
+|  \/ USyrupBenchmarkCommandlet \/  |
+\* \/ ========================= \/ */
+/**
+ * Runs headless benchmarks of the game and writes the results as json.
+ *
+ * Usage: UnrealEditor-Cmd Syrup.uproject -run=SyrupBenchmark -nullrhi [-Benchmark=Night] [-Map=/Game/Levels/L_Test_2] [-Nights=10] [-SettleTicks=30] [-Output=Path.json]
+ *        UnrealEditor-Cmd Syrup.uproject -run=SyrupBenchmark -nullrhi -Benchmark=GroundPlane [-Cells=100000] [-Runs=5] [-GroundPlaneClass=Path] [-Output=Path.json]
+ *        UnrealEditor-Cmd Syrup.uproject -run=SyrupBenchmark -nullrhi -Benchmark=Resources [-Map=/Game/Levels/L_Test_2] [-Nights=100] [-Seed=0] [-SinkCalls=100000] [-Output=Path.json]
+ *        UnrealEditor-Cmd Syrup.uproject -run=SyrupBenchmark -nullrhi -Benchmark=Allocation [-Sinks=5000] [-Faucets=2500] [-ResourcesPerFaucet=2] [-Reach=12] [-Runs=5] [-Seed=0] [-Map=Path] [-Output=Path.json]
+ *        UnrealEditor-Cmd Syrup.uproject -run=SyrupBenchmark -nullrhi -Benchmark=Save [-Map=/Game/Benchmarks/L_Stress] [-Runs=5] [-Output=Path.json]
+ *        UnrealEditor-Cmd Syrup.uproject -run=SyrupBenchmark -nullrhi -Benchmark=Load [-Map=/Game/Benchmarks/L_Stress] [-Runs=5] [-Output=Path.json]
+ */
+UCLASS()
+class SYRUP_API USyrupBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Sets up the commandlet to run without a renderer.
+	 */
+	USyrupBenchmarkCommandlet();
+
+	/**
+	 * Runs the benchmark selected by the parameters.
+	 *
+	 * @param Params - The command line parameters.
+	 * @return Zero if the benchmark succeeded.
+	 */
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	/**
+	 * Simulates back to back nights without any of the blueprint delays and times each phase.
+	 *
+	 * @param Params - The command line parameters.
+	 * @param Report - The report to add the results to.
+	 * @return Whether the benchmark succeeded.
+	 */
+	bool RunNightBenchmark(const FString& Params, const TSharedRef<FJsonObject>& Report);
+
+	/**
+	 * Times generating a large ground plane with the original one chunk at a time generation as the baseline and then
+	 * with parallel generation.
+	 *
+	 * @param Params - The command line parameters.
+	 * @param Report - The report to add the results to.
+	 * @return Whether the benchmark succeeded.
+	 */
+	bool RunGroundPlaneBenchmark(const FString& Params, const TSharedRef<FJsonObject>& Report);
+
+	/**
+	 * Simulates nights of allocating and freeing resources, once with a facade fetched for every resource as if each
+	 * were still its own object and once through handles alone, and measures the garbage created and the time spent
+	 * collecting it. Also times the sink accessors bound by name against native bindings.
+	 *
+	 * @param Params - The command line parameters.
+	 * @param Report - The report to add the results to.
+	 * @return Whether the benchmark succeeded.
+	 */
+	bool RunResourceBenchmark(const FString& Params, const TSharedRef<FJsonObject>& Report);
+
+	/**
+	 * Times solving the auto allocation of resources on a generated problem and optionally on the board of a map.
+	 *
+	 * @param Params - The command line parameters.
+	 * @param Report - The report to add the results to.
+	 * @return Whether the benchmark succeeded.
+	 */
+	bool RunAllocationBenchmark(const FString& Params, const TSharedRef<FJsonObject>& Report);
+
+	/**
+	 * Compares the size and serialize time of the generic and compact save formats, including a compact save stored as
+	 * the differences from the night before. Use a stress map generated with 10000 tiles for the reference board.
+	 *
+	 * @param Params - The command line parameters.
+	 * @param Report - The report to add the results to.
+	 * @return Whether the benchmark succeeded.
+	 */
+	bool RunSaveBenchmark(const FString& Params, const TSharedRef<FJsonObject>& Report);
+
+	/**
+	 * Times loading a save of the board of a map with and without batching the per tile notifications, and counts the
+	 * triggers dispatched by each. Loading without batching runs the load as it was before batching was added, so it is
+	 * reported as the baseline. Use a stress map generated with 10000 tiles for the reference board.
+	 *
+	 * @param Params - The command line parameters.
+	 * @param Report - The report to add the results to.
+	 * @return Whether the benchmark succeeded.
+	 */
+	bool RunLoadBenchmark(const FString& Params, const TSharedRef<FJsonObject>& Report);
+
+	/**
+	 * Times calling the sink accessors of a plant through delegates bound by function name and through native delegates.
+	 *
+	 * @param Object - The object to add the timings to.
+	 * @param Plant - The plant to call the accessors of.
+	 * @param NumCalls - The number of times to call each accessor.
+	 */
+	static void AddSinkBindingTimings(const TSharedRef<FJsonObject>& Object, APlant* Plant, const int NumCalls);
+
+	/**
+	 * Adds the total, mean, min, and max of a set of timings to a json object.
+	 *
+	 * @param Object - The object to add the fields to.
+	 * @param Seconds - The timings in seconds.
+	 */
+	static void AddTimingFields(const TSharedRef<FJsonObject>& Object, const TArray<double>& Seconds);
+
+	/**
+	 * Loads a map and begins play in it as a game world.
+	 *
+	 * @param MapName - The package name of the map to load.
+	 * @return The world that is being played. Nullptr if the map could not be loaded.
+	 */
+	static UWorld* BeginPlayInMap(const FString& MapName);
+
+	/**
+	 * Ends play in and destroys a world created by BeginPlayInMap.
+	 *
+	 * @param World - The world to destroy.
+	 */
+	static void EndPlayInWorld(UWorld* World);
+
+	/**
+	 * Ticks a world a number of times at a fixed rate.
+	 *
+	 * @param World - The world to tick.
+	 * @param NumTicks - The number of ticks to perform.
+	 */
+	static void TickWorld(UWorld* World, const int NumTicks);
+
+	/**
+	 * Gets the number of UObjects currently alive.
+	 *
+	 * @return The number of UObjects currently alive.
+	 */
+	static int64 GetNumObjects();
+
+	/**
+	 * Gets the physical memory currently used by the process.
+	 *
+	 * @return The physical memory used in bytes.
+	 */
+	static int64 GetUsedPhysicalMemory();
+
+	/**
+	 * Writes a report to a file.
+	 *
+	 * @param Report - The report to write.
+	 * @param OutputPath - The path of the file to write to.
+	 * @return Whether the file was written.
+	 */
+	static bool WriteReport(const TSharedRef<FJsonObject>& Report, const FString& OutputPath);
+};
+/* /\ ========================= /\ *\
+|  /\ USyrupBenchmarkCommandlet /\  |
+\* /\ ========================= /\ */
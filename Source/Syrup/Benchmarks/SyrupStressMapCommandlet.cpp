@@ -0,0 +1,224 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SyrupStressMapCommandlet.h"
+
+#include "SyrupBenchmarkCommandlet.h"
+#include "Syrup/MapUtilities/GroundPlane.h"
+#include "Syrup/MapUtilities/TrashfallVolume.h"
+#include "Syrup/Tiles/GridLibrary.h"
+#include "Syrup/Tiles/Plant.h"
+#include "Syrup/Tiles/SpiritPlant.h"
+#include "Syrup/Tiles/Trash.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerStart.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+#include "UObject/SavePackage.h"
+
+/* \/ ========================= \/ *\
+|  \/ USyrupStressMapCommandlet \/  |
+\* \/ ========================= \/ */
+
+/**
+ * Sets up the commandlet to run in the editor without a renderer.
+ */
+USyrupStressMapCommandlet::USyrupStressMapCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+	ShowErrorCount = true;
+}
+
+/**
+ * Generates and saves the map described by the parameters.
+ *
+ * @param Params - The command line parameters.
+ * @return Zero if the map was saved.
+ */
+int32 USyrupStressMapCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	FString PackageName = TEXT("/Game/Benchmarks/L_Stress");
+	FParse::Value(*Params, TEXT("Output="), PackageName);
+	int Seed = 1;
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	float PlaneScale = 20;
+	FParse::Value(*Params, TEXT("PlaneScale="), PlaneScale);
+	int NumPlants = 2000;
+	FParse::Value(*Params, TEXT("Plants="), NumPlants);
+	int NumTrash = 2000;
+	FParse::Value(*Params, TEXT("Trash="), NumTrash);
+	int NumSpiritPlants = 50;
+	FParse::Value(*Params, TEXT("SpiritPlants="), NumSpiritPlants);
+	int NumTrashfallVolumes = 20;
+	FParse::Value(*Params, TEXT("TrashfallVolumes="), NumTrashfallVolumes);
+	float TrashfallScale = 4;
+	FParse::Value(*Params, TEXT("TrashfallScale="), TrashfallScale);
+	int TrashPerVolume = 5;
+	FParse::Value(*Params, TEXT("TrashPerVolume="), TrashPerVolume);
+
+	TArray<UClass*> GroundPlaneClasses = ParseClasses(Params, TEXT("GroundPlaneClass="), TEXT("/Game/LevelUtilities/GroundPlane/BP_GroundPlane.BP_GroundPlane_C"), AGroundPlane::StaticClass());
+	TArray<UClass*> TrashfallVolumeClasses = ParseClasses(Params, TEXT("TrashfallVolumeClass="), TEXT("/Game/LevelUtilities/TashfallVolume/BP_TrashfallVolume.BP_TrashfallVolume_C"), ATrashfallVolume::StaticClass());
+	TArray<UClass*> PlantClasses = ParseClasses(Params, TEXT("PlantClasses="), TEXT("/Game/Tiles/Plants/Grass/BP_Grass.BP_Grass_C,/Game/Tiles/Plants/Shrub/BP_Shrub.BP_Shrub_C,/Game/Tiles/Plants/Tree/BP_Tree.BP_Tree_C,/Game/Tiles/Plants/Bramble/BP_Bramble.BP_Bramble_C,/Game/Tiles/Plants/Mushroom/BP_Mushroom.BP_Mushroom_C"), APlant::StaticClass());
+	TArray<UClass*> TrashClasses = ParseClasses(Params, TEXT("TrashClasses="), TEXT("/Game/Tiles/Trash/Litter/BP_Litter.BP_Litter_C,/Game/Tiles/Trash/Rubble/BP_Rubble.BP_Rubble_C,/Game/Tiles/Trash/RottingPile/BP_RottingPile.BP_RottingPile_C,/Game/Tiles/Trash/Sewage/BP_Sewage.BP_Sewage_C,/Game/Tiles/Trash/Pesticides/BP_Pesticides.BP_Pesticides_C"), ATrash::StaticClass());
+	TArray<UClass*> SpiritPlantClasses = ParseClasses(Params, TEXT("SpiritPlantClasses="), TEXT("/Game/Tiles/SpiritPlants/BP_SpiritPlant.BP_SpiritPlant_C"), ASpiritPlant::StaticClass());
+	if (GroundPlaneClasses.IsEmpty() || TrashfallVolumeClasses.IsEmpty() || PlantClasses.IsEmpty() || TrashClasses.IsEmpty() || SpiritPlantClasses.IsEmpty())
+	{
+		UE_LOG(LogSyrupBenchmark, Error, TEXT("Could not load the classes needed to generate a stress map."));
+		return 1;
+	}
+
+	//Create world
+	UPackage* Package = CreatePackage(*PackageName);
+	UWorld* World = UWorld::CreateWorld(EWorldType::Editor, false, FPackageName::GetShortFName(PackageName), Package);
+	if (!IsValid(World))
+	{
+		UE_LOG(LogSyrupBenchmark, Error, TEXT("Could not create world %s."), *PackageName);
+		return 1;
+	}
+	World->SetFlags(RF_Public | RF_Standalone);
+	Package->SetPackageFlags(PKG_ContainsMap);
+
+	FRandomStream RNG = FRandomStream(Seed);
+
+	//Ground
+	AGroundPlane* GroundPlane = World->SpawnActor<AGroundPlane>(GroundPlaneClasses[0], FTransform(FRotator::ZeroRotator, FVector::ZeroVector, FVector(PlaneScale, PlaneScale, 1)));
+	TArray<FIntPoint> Candidates = GroundPlane->GetGridLocations();
+	Candidates.Sort([](const FIntPoint& A, const FIntPoint& B) { return A.X == B.X ? A.Y < B.Y : A.X < B.X; });
+
+	//Keep the player start clear.
+	TSet<FIntPoint> OccupiedLocations = UGridLibrary::ScaleShapeUp(TSet<FIntPoint>({ FIntPoint::ZeroValue }), 2);
+	World->SpawnActor<APlayerStart>(APlayerStart::StaticClass(), FTransform(FVector(0, 0, 100)));
+
+	//Tiles
+	int NumSpawnedSpiritPlants = SpawnTiles(World, SpiritPlantClasses, NumSpiritPlants, Candidates, OccupiedLocations, RNG);
+	int NumSpawnedPlants = SpawnTiles(World, PlantClasses, NumPlants, Candidates, OccupiedLocations, RNG);
+	int NumSpawnedTrash = SpawnTiles(World, TrashClasses, NumTrash, Candidates, OccupiedLocations, RNG);
+
+	//Trashfall
+	int NumSpawnedTrashfallVolumes = 0;
+	for (int VolumeIndex = 0; VolumeIndex < NumTrashfallVolumes && !Candidates.IsEmpty(); VolumeIndex++)
+	{
+		FVector VolumeLocation = UGridLibrary::GridLocationToWorldLocation(Candidates[RNG.RandHelper(Candidates.Num())]);
+		ATrashfallVolume* Volume = World->SpawnActorDeferred<ATrashfallVolume>(TrashfallVolumeClasses[0], FTransform(FRotator::ZeroRotator, VolumeLocation, FVector(TrashfallScale)));
+		if (!IsValid(Volume))
+		{
+			continue;
+		}
+
+		Volume->TrashType = TrashClasses[RNG.RandHelper(TrashClasses.Num())];
+		Volume->NumToMaintain = TrashPerVolume;
+		Volume->SpawnSeed = RNG.RandHelper(MAX_int32);
+		Volume->FinishSpawning(FTransform(FRotator::ZeroRotator, VolumeLocation, FVector(TrashfallScale)));
+		NumSpawnedTrashfallVolumes++;
+	}
+
+	//Save
+	FString Filename = FPackageName::LongPackageNameToFilename(PackageName, FPackageName::GetMapPackageExtension());
+	FSavePackageArgs SaveArgs = FSavePackageArgs();
+	SaveArgs.TopLevelFlags = RF_Standalone;
+	SaveArgs.SaveFlags = SAVE_NoError;
+	bool bSaved = UPackage::SavePackage(Package, World, *Filename, SaveArgs);
+
+	UE_LOG(LogSyrupBenchmark, Display, TEXT("%s %s with seed %d: %d grid locations, %d spirit plants, %d plants, %d trash, %d trashfall volumes."),
+		bSaved ? TEXT("Saved") : TEXT("Failed to save"), *Filename, Seed, Candidates.Num(), NumSpawnedSpiritPlants, NumSpawnedPlants, NumSpawnedTrash, NumSpawnedTrashfallVolumes);
+
+	World->DestroyWorld(false);
+	World->RemoveFromRoot();
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+	return bSaved ? 0 : 1;
+#else
+	UE_LOG(LogSyrupBenchmark, Error, TEXT("Stress maps can only be generated in the editor."));
+	return 1;
+#endif
+}
+
+/**
+ * Loads a comma separated list of classes from the command line.
+ *
+ * @param Params - The command line parameters.
+ * @param Key - The parameter containing the class list.
+ * @param DefaultClassPaths - The class paths used if the parameter is not present.
+ * @param BaseClass - The class that each loaded class must be a child of.
+ * @return The classes that could be loaded.
+ */
+TArray<UClass*> USyrupStressMapCommandlet::ParseClasses(const FString& Params, const TCHAR* Key, const FString& DefaultClassPaths, UClass* BaseClass)
+{
+	FString ClassPaths = DefaultClassPaths;
+	FParse::Value(*Params, Key, ClassPaths, false);
+
+	TArray<FString> EachClassPath = TArray<FString>();
+	ClassPaths.ParseIntoArray(EachClassPath, TEXT(","));
+
+	TArray<UClass*> ReturnValue = TArray<UClass*>();
+	for (const FString& ClassPath : EachClassPath)
+	{
+		UClass* LoadedClass = LoadClass<UObject>(nullptr, *ClassPath);
+		if (!IsValid(LoadedClass) || !LoadedClass->IsChildOf(BaseClass))
+		{
+			UE_LOG(LogSyrupBenchmark, Warning, TEXT("%s is not a valid %s class."), *ClassPath, *BaseClass->GetName());
+			continue;
+		}
+		ReturnValue.Add(LoadedClass);
+	}
+	return ReturnValue;
+}
+
+/**
+ * Spawns tiles at random unoccupied locations.
+ *
+ * @param World - The world to spawn the tiles in.
+ * @param TileClasses - The classes to pick from for each tile.
+ * @param NumTiles - The number of tiles to try to spawn.
+ * @param Candidates - The locations that tiles may be placed at.
+ * @param OccupiedLocations - The locations already taken. Updated with the locations of the spawned tiles.
+ * @param RNG - The random stream to draw from.
+ * @return The number of tiles spawned.
+ */
+int USyrupStressMapCommandlet::SpawnTiles(UWorld* World, const TArray<UClass*>& TileClasses, const int NumTiles, const TArray<FIntPoint>& Candidates, TSet<FIntPoint>& OccupiedLocations, FRandomStream& RNG)
+{
+	if (TileClasses.IsEmpty() || Candidates.IsEmpty())
+	{
+		return 0;
+	}
+
+	const TSet<FIntPoint> CandidateSet = TSet<FIntPoint>(Candidates);
+	int ReturnValue = 0;
+	for (int TileIndex = 0; TileIndex < NumTiles; TileIndex++)
+	{
+		UClass* TileClass = TileClasses[RNG.RandHelper(TileClasses.Num())];
+		TSet<FIntPoint> RelativeTileLocations = TileClass->GetDefaultObject<ATile>()->GetRelativeSubTileLocations();
+
+		int Count = 0;
+		while (Count++ < 50)
+		{
+			FGridTransform SpawnTransform = FGridTransform(Candidates[RNG.RandHelper(Candidates.Num())], (EGridDirection)RNG.RandHelper(6));
+			if (!UGridLibrary::IsDirectionValidAtLocation(SpawnTransform.Direction, SpawnTransform.Location))
+			{
+				SpawnTransform.Direction = UGridLibrary::FlipDirection(SpawnTransform.Direction);
+			}
+
+			TSet<FIntPoint> SpawnLocations = UGridLibrary::TransformShape(RelativeTileLocations, SpawnTransform);
+			if (!CandidateSet.Includes(SpawnLocations) || !OccupiedLocations.Intersect(SpawnLocations).IsEmpty())
+			{
+				continue;
+			}
+
+			if (IsValid(World->SpawnActor<ATile>(TileClass, UGridLibrary::GridTransformToWorldTransform(SpawnTransform))))
+			{
+				OccupiedLocations.Append(SpawnLocations);
+				ReturnValue++;
+			}
+			break;
+		}
+	}
+	return ReturnValue;
+}
+
+/* /\ ========================= /\ *\
+|  /\ USyrupStressMapCommandlet /\  |
+\* /\ ========================= /\ */
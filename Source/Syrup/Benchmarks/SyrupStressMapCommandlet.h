@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SyrupStressMapCommandlet.generated.h"
+
+class ATile;
+
+/* \/ ========================= \/ *\
+|  \/ USyrupStressMapCommandlet \/  |
+\* \/ ========================= \/ */
+/**
+ * Generates a large, reproducible map to use as the input of the performance benchmarks.
+ *
+ * Usage: UnrealEditor-Cmd Syrup.uproject -run=SyrupStressMap [-Output=/Game/Benchmarks/L_Stress] [-Seed=1] [-PlaneScale=20]
+ *        [-Plants=2000] [-Trash=2000] [-SpiritPlants=50] [-TrashfallVolumes=20] [-TrashfallScale=4] [-TrashPerVolume=5]
+ *        [-GroundPlaneClass=Path] [-PlantClasses=Path,Path] [-TrashClasses=Path,Path] [-SpiritPlantClasses=Path] [-TrashfallVolumeClass=Path]
+ */
+UCLASS()
+class SYRUP_API USyrupStressMapCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Sets up the commandlet to run in the editor without a renderer.
+	 */
+	USyrupStressMapCommandlet();
+
+	/**
+	 * Generates and saves the map described by the parameters.
+	 *
+	 * @param Params - The command line parameters.
+	 * @return Zero if the map was saved.
+	 */
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	/**
+	 * Loads a comma separated list of classes from the command line.
+	 *
+	 * @param Params - The command line parameters.
+	 * @param Key - The parameter containing the class list.
+	 * @param DefaultClassPaths - The class paths used if the parameter is not present.
+	 * @param BaseClass - The class that each loaded class must be a child of.
+	 * @return The classes that could be loaded.
+	 */
+	static TArray<UClass*> ParseClasses(const FString& Params, const TCHAR* Key, const FString& DefaultClassPaths, UClass* BaseClass);
+
+	/**
+	 * Spawns tiles at random unoccupied locations.
+	 *
+	 * @param World - The world to spawn the tiles in.
+	 * @param TileClasses - The classes to pick from for each tile.
+	 * @param NumTiles - The number of tiles to try to spawn.
+	 * @param Candidates - The locations that tiles may be placed at.
+	 * @param OccupiedLocations - The locations already taken. Updated with the locations of the spawned tiles.
+	 * @param RNG - The random stream to draw from.
+	 * @return The number of tiles spawned.
+	 */
+	static int SpawnTiles(UWorld* World, const TArray<UClass*>& TileClasses, const int NumTiles, const TArray<FIntPoint>& Candidates, TSet<FIntPoint>& OccupiedLocations, FRandomStream& RNG);
+};
+/* /\ ========================= /\ *\
+|  /\ USyrupStressMapCommandlet /\  |
+\* /\ ========================= /\ */
@@ -4,7 +4,17 @@
 #include "GroundPlane.h"
 
 #include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/Texture2D.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "Syrup/Systems/InstanceCustomDataBatcher.h"
 #include "Syrup/Tiles/GridLibrary.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<bool> CVarParallelGroundGeneration(
+	TEXT("Syrup.Ground.ParallelGeneration"),
+	true,
+	TEXT("Whether ground plane chunks generate their cells and instance transforms in parallel. When off, chunks are generated one at a time as before parallel generation was added."));
 
 
 /**
@@ -33,6 +43,60 @@ bool AGroundPlane::RemoveField(const EFieldType Type, const TSet<FIntPoint>& Loc
 	return AddFieldStrength(Type, -1, Locations);
 }
 
+/**
+ * Holds back uploading field changes to the field texture until the matching EndFieldUpdates. Calls may be nested.
+ */
+void AGroundPlane::BeginFieldUpdates()
+{
+	FieldUpdateDepth++;
+}
+
+/**
+ * Ends holding back started by BeginFieldUpdates. Ending the outermost one uploads every field change made during it at once.
+ */
+void AGroundPlane::EndFieldUpdates()
+{
+	if (FieldUpdateDepth <= 0 || --FieldUpdateDepth > 0)
+	{
+		return;
+	}
+
+	if (PendingMaxChangedOffset.X >= 0)
+	{
+		UpdateFieldTexture(PendingMinChangedOffset, PendingMaxChangedOffset);
+		PendingMinChangedOffset = FIntPoint::ZeroValue;
+		PendingMaxChangedOffset = FIntPoint(-1, -1);
+	}
+}
+
+/**
+ * Gets the grid locations covered by this plane.
+ *
+ * @return The grid locations covered by this plane.
+ */
+TArray<FIntPoint> AGroundPlane::GetGridLocations() const
+{
+	return CellLocations;
+}
+
+/**
+ * Gets the strength of a field at a location.
+ *
+ * @param FieldType - The type of the field.
+ * @param Location - The grid location to get the strength at.
+ *
+ * @return The strength of the field. 0 if there is no field or this plane does not cover the location.
+ */
+int AGroundPlane::GetFieldStrength(const EFieldType FieldType, const FIntPoint Location) const
+{
+	const int32 CellIndex = GetCellIndex(Location);
+	if (CellIndex == INDEX_NONE || !FieldTypeToStrengths.IsValidIndex((uint8)FieldType) || !FieldTypeToStrengths[(uint8)FieldType].IsValidIndex(CellIndex))
+	{
+		return 0;
+	}
+	return FieldTypeToStrengths[(uint8)FieldType][CellIndex];
+}
+
 /**
  * Creates and sets up the ground mesh.
  */
@@ -40,10 +104,9 @@ AGroundPlane::AGroundPlane()
 {
 	RootComponent = CreateDefaultSubobject<USceneComponent>(FName("Root"));
 
-	//Create ground plane
-	GroundMeshComponent = CreateDefaultSubobject<UInstancedStaticMeshComponent>(FName("GroundPlane"));
-	GroundMeshComponent->AttachToComponent(RootComponent, FAttachmentTransformRules::KeepRelativeTransform);
-	GroundMeshComponent->SetAbsolute(true, true, true);
+	//Create field texture plane
+	FieldTexturePlaneComponent = CreateDefaultSubobject<UStaticMeshComponent>(FName("FieldTexturePlane"));
+	FieldTexturePlaneComponent->AttachToComponent(RootComponent, FAttachmentTransformRules::KeepRelativeTransform);
 }
 
 
@@ -54,20 +117,25 @@ AGroundPlane::AGroundPlane()
  */
 void AGroundPlane::OnConstruction(const FTransform& Transform)
 {
-	GroundMeshComponent->SetStaticMesh(GroundMesh);
-	GroundMeshComponent->SetMaterial(0, Material);
-	GroundMeshComponent->CastShadow = false;
-	GroundMeshComponent->NumCustomDataFloats = 3;
-	GroundMeshComponent->SetCollisionObjectType(ECollisionChannel::ECC_WorldStatic);
-	GroundMeshComponent->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-	GroundMeshComponent->SetCollisionResponseToChannel(ECollisionChannel::ECC_Pawn, ECollisionResponse::ECR_Block);
-	GroundMeshComponent->ClearInstances();
-	GroundMeshComponent->InstancingRandomSeed = FMath::Rand();
-	LocationsToInstanceIndices.Empty();
-	FieldTypeToLocationToStrengths.Empty();
-
-
+	for (UInstancedStaticMeshComponent* EachChunkComponent : ChunkComponents)
+	{
+		if (IsValid(EachChunkComponent))
+		{
+			EachChunkComponent->DestroyComponent();
+		}
+	}
+	ChunkComponents.Empty();
+	ChunkFirstCellIndices.Empty();
+	CellChunkIndices.Empty();
+	GridToCellIndices.Empty();
+	CellLocations.Empty();
+	FieldTypeToStrengths.Empty();
+	FieldTexels.Empty();
+	FieldTexture = nullptr;
+	FieldTextureMaterial = nullptr;
 
+	//Find the locations covered by this plane.
+	TArray<FIntPoint> PlaneLocations = TArray<FIntPoint>();
 	const double ActorAngle = FMath::Fmod(GetActorRotation().Yaw, 360);
 	const FVector2D PlaneSize = FVector2D(UGridLibrary::GetGridSideLength() * 25 * GetActorScale());
 
@@ -79,7 +147,7 @@ void AGroundPlane::OnConstruction(const FTransform& Transform)
 			for (int IndexY = -(BoundsSize.Y / 2); IndexY < BoundsSize.Y / 2 + (int)BoundsSize.Y % 2; IndexY++)
 			{
 				FIntPoint GridLocation = FIntPoint(IndexX, IndexY) + UGridLibrary::WorldLocationToGridLocation(GetActorLocation());
-				LocationsToInstanceIndices.Add(GridLocation, GroundMeshComponent->AddInstance(UGridLibrary::GridTransformToWorldTransform(FGridTransform(GridLocation)) * FTransform(FVector(0, 0, -0.1)), true));
+				PlaneLocations.Add(GridLocation);
 			}
 		}
 	}
@@ -116,10 +184,174 @@ void AGroundPlane::OnConstruction(const FTransform& Transform)
 			FIntPoint EndGridLocation = UGridLibrary::WorldLocationToGridLocation(GetActorLocation() + FVector(RowEndLocation, 0));
 			for (FIntPoint GridLocation = UGridLibrary::WorldLocationToGridLocation(GetActorLocation() + FVector(RowStartLocation, 0)); GridLocation.Y <= EndGridLocation.Y; GridLocation.Y++)
 			{
-				LocationsToInstanceIndices.Add(GridLocation, GroundMeshComponent->AddInstance(UGridLibrary::GridTransformToWorldTransform(FGridTransform(GridLocation)) * FTransform(FVector(0, 0, -0.1)), true));
+				PlaneLocations.Add(GridLocation);
+			}
+		}
+	}
+
+	//Set up the single plane used with the field texture.
+	FieldTexturePlaneComponent->SetStaticMesh(bUseFieldTexture ? FieldTexturePlaneMesh : nullptr);
+	if (bUseFieldTexture)
+	{
+		FieldTexturePlaneComponent->CastShadow = false;
+		FieldTexturePlaneComponent->SetCollisionObjectType(ECollisionChannel::ECC_WorldStatic);
+		FieldTexturePlaneComponent->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
+		FieldTexturePlaneComponent->SetCollisionResponseToChannel(ECollisionChannel::ECC_Pawn, ECollisionResponse::ECR_Block);
+		FieldTexturePlaneComponent->SetRelativeLocation(FVector(0, 0, -0.1));
+		FieldTexturePlaneComponent->SetRelativeScale3D(FVector(FVector2D(UGridLibrary::GetGridSideLength() * 50 / FieldTexturePlaneMeshSize), 1));
+	}
+
+	if (PlaneLocations.IsEmpty())
+	{
+		GridMinLocation = FIntPoint::ZeroValue;
+		GridSize = FIntPoint::ZeroValue;
+		return;
+	}
+
+	//Lay the cells out in the rectangle containing them.
+	GridMinLocation = PlaneLocations[0];
+	FIntPoint GridMaxLocation = PlaneLocations[0];
+	for (FIntPoint EachPlaneLocation : PlaneLocations)
+	{
+		GridMinLocation = GridMinLocation.ComponentMin(EachPlaneLocation);
+		GridMaxLocation = GridMaxLocation.ComponentMax(EachPlaneLocation);
+	}
+	GridSize = GridMaxLocation - GridMinLocation + FIntPoint(1, 1);
+	GridToCellIndices.Init(INDEX_NONE, GridSize.X * GridSize.Y);
+
+	//Sort the locations into square chunks.
+	const FIntPoint NumChunks = FIntPoint(FMath::DivideAndRoundUp(GridSize.X, ChunkSize), FMath::DivideAndRoundUp(GridSize.Y, ChunkSize));
+	TArray<TArray<FIntPoint>> ChunksToLocations = TArray<TArray<FIntPoint>>();
+	ChunksToLocations.SetNum(NumChunks.X * NumChunks.Y);
+	for (FIntPoint EachPlaneLocation : PlaneLocations)
+	{
+		const FIntPoint GridOffset = EachPlaneLocation - GridMinLocation;
+		int32& CellIndex = GridToCellIndices[GridOffset.X * GridSize.Y + GridOffset.Y];
+		if (CellIndex != INDEX_NONE)
+		{
+			continue;
+		}
+
+		//Mark the location as seen so duplicates are skipped. The real index is assigned below.
+		CellIndex = 0;
+		ChunksToLocations[(GridOffset.X / ChunkSize) * NumChunks.Y + GridOffset.Y / ChunkSize].Add(EachPlaneLocation);
+	}
+
+	if (!CVarParallelGroundGeneration.GetValueOnGameThread())
+	{
+		//Give each chunk its own mesh and consecutive cell indices one chunk at a time.
+		CellLocations.Reserve(PlaneLocations.Num());
+		CellChunkIndices.Reserve(PlaneLocations.Num());
+		TArray<FTransform> InstanceTransforms = TArray<FTransform>();
+		for (const TArray<FIntPoint>& EachChunkLocations : ChunksToLocations)
+		{
+			if (EachChunkLocations.IsEmpty())
+			{
+				continue;
+			}
+
+			const int32 ChunkIndex = ChunkFirstCellIndices.Add(CellLocations.Num());
+			InstanceTransforms.Reset();
+			for (FIntPoint EachChunkLocation : EachChunkLocations)
+			{
+				const FIntPoint GridOffset = EachChunkLocation - GridMinLocation;
+				GridToCellIndices[GridOffset.X * GridSize.Y + GridOffset.Y] = CellLocations.Add(EachChunkLocation);
+				CellChunkIndices.Add(ChunkIndex);
+				InstanceTransforms.Add(UGridLibrary::GridTransformToWorldTransform(FGridTransform(EachChunkLocation)) * FTransform(FVector(0, 0, -0.1)));
+			}
+
+			if (!bUseFieldTexture)
+			{
+				CreateChunkComponent()->AddInstances(InstanceTransforms, false, true);
+			}
+		}
+	}
+	else
+	{
+		//Give each chunk consecutive cell indices.
+		ChunksToLocations.RemoveAll([](const TArray<FIntPoint>& EachChunkLocations) { return EachChunkLocations.IsEmpty(); });
+		int32 NumCells = 0;
+		for (const TArray<FIntPoint>& EachChunkLocations : ChunksToLocations)
+		{
+			ChunkFirstCellIndices.Add(NumCells);
+			NumCells += EachChunkLocations.Num();
+		}
+		CellLocations.SetNumUninitialized(NumCells);
+		CellChunkIndices.SetNumUninitialized(NumCells);
+
+		//Fill in each chunk's cells and instance transforms. Chunks write to disjoint cells so they can be done in parallel.
+		TArray<TArray<FTransform>> ChunksToInstanceTransforms = TArray<TArray<FTransform>>();
+		ChunksToInstanceTransforms.SetNum(ChunksToLocations.Num());
+		ParallelFor(ChunksToLocations.Num(), [&](const int32 ChunkIndex)
+			{
+				const TArray<FIntPoint>& ChunkLocations = ChunksToLocations[ChunkIndex];
+				TArray<FTransform>& InstanceTransforms = ChunksToInstanceTransforms[ChunkIndex];
+				InstanceTransforms.Reserve(ChunkLocations.Num());
+				for (int32 LocationIndex = 0; LocationIndex < ChunkLocations.Num(); LocationIndex++)
+				{
+					const FIntPoint GridOffset = ChunkLocations[LocationIndex] - GridMinLocation;
+					const int32 CellIndex = ChunkFirstCellIndices[ChunkIndex] + LocationIndex;
+					GridToCellIndices[GridOffset.X * GridSize.Y + GridOffset.Y] = CellIndex;
+					CellLocations[CellIndex] = ChunkLocations[LocationIndex];
+					CellChunkIndices[CellIndex] = ChunkIndex;
+					if (!bUseFieldTexture)
+					{
+						InstanceTransforms.Add(UGridLibrary::GridTransformToWorldTransform(FGridTransform(ChunkLocations[LocationIndex])) * FTransform(FVector(0, 0, -0.1)));
+					}
+				}
+			});
+
+		//Give each chunk its own mesh.
+		if (!bUseFieldTexture)
+		{
+			for (const TArray<FTransform>& EachInstanceTransforms : ChunksToInstanceTransforms)
+			{
+				CreateChunkComponent()->AddInstances(EachInstanceTransforms, false, true);
 			}
 		}
 	}
+
+	if (bUseFieldTexture)
+	{
+		CreateFieldTexture();
+	}
+}
+
+/**
+ * Creates the instanced mesh of a new chunk.
+ *
+ * @return The new chunk's instanced mesh.
+ */
+UInstancedStaticMeshComponent* AGroundPlane::CreateChunkComponent()
+{
+	UInstancedStaticMeshComponent* ChunkComponent = NewObject<UInstancedStaticMeshComponent>(this, NAME_None, RF_Transactional);
+	ChunkComponent->CreationMethod = EComponentCreationMethod::UserConstructionScript;
+	ChunkComponent->SetupAttachment(RootComponent);
+	ChunkComponent->SetAbsolute(true, true, true);
+	ChunkComponent->SetStaticMesh(GroundMesh);
+	ChunkComponent->SetMaterial(0, Material);
+	ChunkComponent->CastShadow = false;
+	ChunkComponent->NumCustomDataFloats = 3;
+	ChunkComponent->SetCollisionObjectType(ECollisionChannel::ECC_WorldStatic);
+	ChunkComponent->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
+	ChunkComponent->SetCollisionResponseToChannel(ECollisionChannel::ECC_Pawn, ECollisionResponse::ECR_Block);
+	ChunkComponent->InstancingRandomSeed = FMath::Rand();
+	ChunkComponent->RegisterComponent();
+	ChunkComponents.Add(ChunkComponent);
+	return ChunkComponent;
+}
+
+/**
+ * Creates the field texture if it is being used.
+ */
+void AGroundPlane::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (bUseFieldTexture && !IsValid(FieldTexture))
+	{
+		CreateFieldTexture();
+	}
 }
 
 /**
@@ -135,51 +367,172 @@ bool AGroundPlane::AddFieldStrength(const EFieldType FieldType, const int Streng
 {
 	bool ReturnValue = false;
 
-	//Create field map if not it doesn't exist
-	if (LocationsToInstanceIndices.IsEmpty())
+	//Create cells if they don't exist
+	if (CellLocations.IsEmpty())
 	{
 		OnConstruction(GetActorTransform());
 	}
-	if (!FieldTypeToLocationToStrengths.Contains(FieldType))
+	if (bUseFieldTexture && !IsValid(FieldTexture))
 	{
-		FieldTypeToLocationToStrengths.Add(FieldType, TMap<FIntPoint, int>());
+		CreateFieldTexture();
 	}
+	TArray<int>& Strengths = GetFieldStrengths(FieldType);
+	TArray<int> ChunksToNumCustomDataWrites = TArray<int>();
+	ChunksToNumCustomDataWrites.SetNumZeroed(ChunkComponents.Num());
+	FIntPoint MinChangedOffset = GridSize;
+	FIntPoint MaxChangedOffset = FIntPoint(-1, -1);
 
 	for (FIntPoint EachLocation : Locations)
 	{
 		//Skip if outside domain
-		if (!LocationsToInstanceIndices.Contains(EachLocation))
+		const int32 CellIndex = GetCellIndex(EachLocation);
+		if (CellIndex == INDEX_NONE)
 		{
 			continue;
 		}
 		ReturnValue = true;
 
-		//Create new entry if needed
-		if (!FieldTypeToLocationToStrengths.Find(FieldType)->Contains(EachLocation))
+		//Change strength a location, only updating the mesh if the field appeared or disappeared.
+		const int OldValue = Strengths[CellIndex];
+		const int NewValue = FMath::Max(0, OldValue + Strength);
+		Strengths[CellIndex] = NewValue;
+		if ((OldValue > 0) == (NewValue > 0))
 		{
-			if (Strength > 0)
-			{
-				FieldTypeToLocationToStrengths.Find(FieldType)->Add(EachLocation, Strength);
-				GroundMeshComponent->SetCustomDataValue(LocationsToInstanceIndices.FindRef(EachLocation), (uint8)FieldType, 1, true);
-			}
+			continue;
+		}
+
+		if (bUseFieldTexture)
+		{
+			const FIntPoint GridOffset = EachLocation - GridMinLocation;
+			FColor& Texel = FieldTexels[GridOffset.X * GridSize.Y + GridOffset.Y];
+			uint8& Channel = FieldType == EFieldType::Protection ? Texel.R : FieldType == EFieldType::Damage ? Texel.G : Texel.B;
+			Channel = NewValue > 0 ? 255 : 0;
+			MinChangedOffset = MinChangedOffset.ComponentMin(GridOffset);
+			MaxChangedOffset = MaxChangedOffset.ComponentMax(GridOffset);
 		}
 		else
 		{
-			//Change strength a location
-			int NewValue = FieldTypeToLocationToStrengths.Find(FieldType)->FindRef(EachLocation);
-			NewValue += Strength;
-			if (NewValue <= 0)
-			{
-				//Eliminate value at location if field is too weak.
-				FieldTypeToLocationToStrengths.Find(FieldType)->Remove(EachLocation);
-				GroundMeshComponent->SetCustomDataValue(LocationsToInstanceIndices.FindRef(EachLocation), (uint8)FieldType, 0, true);
-			}
-			else
-			{
-				FieldTypeToLocationToStrengths.Find(FieldType)->Add(EachLocation, NewValue);
-			}
+			const int32 ChunkIndex = CellChunkIndices[CellIndex];
+			ChunksToNumCustomDataWrites[ChunkIndex] += ChunkComponents[ChunkIndex]->SetCustomDataValue(CellIndex - ChunkFirstCellIndices[ChunkIndex], (uint8)FieldType, NewValue > 0 ? 1 : 0, false);
+		}
+	}
+
+	//Upload only the rectangle of texels that changed, growing the pending rectangle instead while updates are held back.
+	if (MaxChangedOffset.X >= 0)
+	{
+		if (FieldUpdateDepth > 0)
+		{
+			PendingMinChangedOffset = PendingMaxChangedOffset.X >= 0 ? PendingMinChangedOffset.ComponentMin(MinChangedOffset) : MinChangedOffset;
+			PendingMaxChangedOffset = PendingMaxChangedOffset.ComponentMax(MaxChangedOffset);
+		}
+		else
+		{
+			UpdateFieldTexture(MinChangedOffset, MaxChangedOffset);
+		}
+	}
+
+	//Update the render state once for each chunk with changed cells.
+	for (int32 ChunkIndex = 0; ChunkIndex < ChunksToNumCustomDataWrites.Num(); ChunkIndex++)
+	{
+		if (ChunksToNumCustomDataWrites[ChunkIndex])
+		{
+			UInstanceCustomDataBatcher::MarkComponentDirty(ChunkComponents[ChunkIndex], ChunksToNumCustomDataWrites[ChunkIndex]);
 		}
 	}
 
 	return ReturnValue;
+}
+
+/**
+ * Gets the strengths of a field at every cell, creating them if needed.
+ *
+ * @param FieldType - The type of the field.
+ *
+ * @return The strength of the field at each cell index.
+ */
+TArray<int>& AGroundPlane::GetFieldStrengths(const EFieldType FieldType)
+{
+	if (!FieldTypeToStrengths.IsValidIndex((uint8)FieldType))
+	{
+		FieldTypeToStrengths.SetNum((uint8)FieldType + 1);
+	}
+
+	TArray<int>& Strengths = FieldTypeToStrengths[(uint8)FieldType];
+	if (Strengths.Num() != CellLocations.Num())
+	{
+		Strengths.Init(0, CellLocations.Num());
+	}
+	return Strengths;
+}
+
+/**
+ * Creates the field texture from the current field strengths and gives it to the ground material.
+ */
+void AGroundPlane::CreateFieldTexture()
+{
+	if (GridSize.X <= 0 || GridSize.Y <= 0)
+	{
+		return;
+	}
+
+	FieldTexels.Init(FColor(0, 0, 0, 255), GridSize.X * GridSize.Y);
+	for (int32 GridIndex = 0; GridIndex < GridToCellIndices.Num(); GridIndex++)
+	{
+		const int32 CellIndex = GridToCellIndices[GridIndex];
+		if (CellIndex == INDEX_NONE)
+		{
+			continue;
+		}
+
+		FColor& Texel = FieldTexels[GridIndex];
+		Texel.R = GetFieldStrength(EFieldType::Protection, CellLocations[CellIndex]) > 0 ? 255 : 0;
+		Texel.G = GetFieldStrength(EFieldType::Damage, CellLocations[CellIndex]) > 0 ? 255 : 0;
+		Texel.B = GetFieldStrength(EFieldType::Hole, CellLocations[CellIndex]) > 0 ? 255 : 0;
+	}
+
+	FieldTexture = UTexture2D::CreateTransient(GridSize.Y, GridSize.X, PF_B8G8R8A8);
+	FieldTexture->Filter = TextureFilter::TF_Nearest;
+	FieldTexture->SRGB = false;
+	FieldTexture->AddressX = TextureAddress::TA_Clamp;
+	FieldTexture->AddressY = TextureAddress::TA_Clamp;
+	FieldTexture->CompressionSettings = TextureCompressionSettings::TC_VectorDisplacementmap;
+	FieldTexture->UpdateResource();
+	UpdateFieldTexture(FIntPoint::ZeroValue, GridSize - FIntPoint(1, 1));
+
+	FieldTextureMaterial = UMaterialInstanceDynamic::Create(Material, this);
+	FieldTextureMaterial->SetTextureParameterValue(FName("FieldTexture"), FieldTexture);
+	FieldTextureMaterial->SetVectorParameterValue(FName("FieldTextureBounds"), FLinearColor(GridMinLocation.X, GridMinLocation.Y, GridSize.X, GridSize.Y));
+	FieldTexturePlaneComponent->SetMaterial(0, FieldTextureMaterial);
+}
+
+/**
+ * Uploads a rectangle of the field texels to the field texture.
+ *
+ * @param MinGridOffset - The smallest changed location relative to the grid min location.
+ * @param MaxGridOffset - The largest changed location relative to the grid min location.
+ */
+void AGroundPlane::UpdateFieldTexture(const FIntPoint MinGridOffset, const FIntPoint MaxGridOffset)
+{
+	if (!IsValid(FieldTexture))
+	{
+		return;
+	}
+
+	//Texture rows are grid X and columns are grid Y.
+	const int32 RegionWidth = MaxGridOffset.Y - MinGridOffset.Y + 1;
+	const int32 RegionHeight = MaxGridOffset.X - MinGridOffset.X + 1;
+
+	//Copy the changed texels so that the render thread does not read texels that are changed or freed before it uploads them.
+	FColor* RegionTexels = new FColor[RegionWidth * RegionHeight];
+	for (int32 RowIndex = 0; RowIndex < RegionHeight; RowIndex++)
+	{
+		FMemory::Memcpy(RegionTexels + RowIndex * RegionWidth, FieldTexels.GetData() + (MinGridOffset.X + RowIndex) * GridSize.Y + MinGridOffset.Y, RegionWidth * sizeof(FColor));
+	}
+
+	FUpdateTextureRegion2D* Region = new FUpdateTextureRegion2D(MinGridOffset.Y, MinGridOffset.X, 0, 0, RegionWidth, RegionHeight);
+	FieldTexture->UpdateTextureRegions(0, 1, Region, RegionWidth * sizeof(FColor), sizeof(FColor), (uint8*)RegionTexels, [](uint8* SrcData, const FUpdateTextureRegion2D* Regions)
+		{
+			delete[] (FColor*)SrcData;
+			delete Regions;
+		});
 }
\ No newline at end of file
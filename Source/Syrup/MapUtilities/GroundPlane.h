@@ -45,6 +45,52 @@ public:
 	UFUNCTION(BlueprintCallable)
 	bool RemoveField(const EFieldType Type, const TSet<FIntPoint>& Locations);
 
+	/**
+	 * Holds back uploading field changes to the field texture until the matching EndFieldUpdates. Calls may be nested.
+	 */
+	void BeginFieldUpdates();
+
+	/**
+	 * Ends holding back started by BeginFieldUpdates. Ending the outermost one uploads every field change made during it at once.
+	 */
+	void EndFieldUpdates();
+
+	/**
+	 * Gets the strength of a field at a location.
+	 *
+	 * @param FieldType - The type of the field.
+	 * @param Location - The grid location to get the strength at.
+	 *
+	 * @return The strength of the field. 0 if there is no field or this plane does not cover the location.
+	 */
+	UFUNCTION(BlueprintPure)
+	int GetFieldStrength(const EFieldType FieldType, const FIntPoint Location) const;
+
+	/**
+	 * Gets the index of the cell at a grid location. Cells in the same chunk have consecutive indices.
+	 *
+	 * @param Location - The grid location of the cell.
+	 *
+	 * @return The index of the cell. INDEX_NONE if this plane does not cover the location.
+	 */
+	FORCEINLINE int32 GetCellIndex(const FIntPoint Location) const
+	{
+		const FIntPoint GridOffset = Location - GridMinLocation;
+		if (GridOffset.X < 0 || GridOffset.Y < 0 || GridOffset.X >= GridSize.X || GridOffset.Y >= GridSize.Y)
+		{
+			return INDEX_NONE;
+		}
+		return GridToCellIndices[GridOffset.X * GridSize.Y + GridOffset.Y];
+	};
+
+	/**
+	 * Gets the grid locations covered by this plane.
+	 *
+	 * @return The grid locations covered by this plane.
+	 */
+	UFUNCTION(BlueprintPure)
+	TArray<FIntPoint> GetGridLocations() const;
+
 	/**
 	 * Creates and sets up the ground mesh.
 	 */
@@ -57,11 +103,12 @@ public:
 	 */
 	virtual void OnConstruction(const FTransform& Transform) override;
 
+	/**
+	 * Creates the field texture if it is being used.
+	 */
+	virtual void BeginPlay() override;
+
 protected:
-	//The plane used to render the fields
-	UPROPERTY()
-	UInstancedStaticMeshComponent* GroundMeshComponent;
-	
 	//The mesh spawned at each grid location.
 	UPROPERTY(EditAnywhere)
 	UStaticMesh* GroundMesh;
@@ -70,6 +117,40 @@ protected:
 	UPROPERTY(EditAnywhere)
 	UMaterialInterface* Material;
 
+	//The side length in grid locations of the square chunks the ground is split into. Each chunk is rendered and culled separately.
+	UPROPERTY(EditAnywhere, Meta = (ClampMin = "1"))
+	int ChunkSize = 32;
+
+	//The meshes used to render each chunk.
+	UPROPERTY()
+	TArray<UInstancedStaticMeshComponent*> ChunkComponents = TArray<UInstancedStaticMeshComponent*>();
+
+	//Whether fields are rendered from a texture on a single plane instead of custom data on an instance per grid location.
+	//The material receives the texture as FieldTexture and (min grid X, min grid Y, grid size X, grid size Y) as
+	//FieldTextureBounds. Texel (Y - min Y, X - min X) stores protection, damage, and hole presence in red, green, and blue.
+	UPROPERTY(EditAnywhere, Category = "Field Texture")
+	bool bUseFieldTexture = false;
+
+	//A flat square mesh centered on its origin used to render the ground when using the field texture.
+	UPROPERTY(EditAnywhere, Category = "Field Texture", Meta = (EditCondition = "bUseFieldTexture"))
+	UStaticMesh* FieldTexturePlaneMesh;
+
+	//The side length of the field texture plane mesh.
+	UPROPERTY(EditAnywhere, Category = "Field Texture", Meta = (EditCondition = "bUseFieldTexture", ClampMin = "1"))
+	float FieldTexturePlaneMeshSize = 100;
+
+	//The plane used to render the ground when using the field texture.
+	UPROPERTY()
+	UStaticMeshComponent* FieldTexturePlaneComponent;
+
+	//The presence of each field at each location in the rectangle containing this plane.
+	UPROPERTY(Transient)
+	UTexture2D* FieldTexture;
+
+	//The material the field texture is given to.
+	UPROPERTY(Transient)
+	UMaterialInstanceDynamic* FieldTextureMaterial;
+
 private:
 	/**
 	 * Edits a field's strength in the given area.
@@ -83,12 +164,73 @@ private:
 	UFUNCTION(BlueprintCallable)
 	bool AddFieldStrength(const EFieldType FieldType, const int Strength, const TSet<FIntPoint>& Locations);
 
-	//Stores the grid locations of each ground mesh instance
+	/**
+	 * Gets the strengths of a field at every cell, creating them if needed.
+	 *
+	 * @param FieldType - The type of the field.
+	 *
+	 * @return The strength of the field at each cell index.
+	 */
+	TArray<int>& GetFieldStrengths(const EFieldType FieldType);
+
+	/**
+	 * Creates the instanced mesh of a new chunk.
+	 *
+	 * @return The new chunk's instanced mesh.
+	 */
+	UInstancedStaticMeshComponent* CreateChunkComponent();
+
+	/**
+	 * Creates the field texture from the current field strengths and gives it to the ground material.
+	 */
+	void CreateFieldTexture();
+
+	/**
+	 * Uploads a rectangle of the field texels to the field texture.
+	 *
+	 * @param MinGridOffset - The smallest changed location relative to the grid min location.
+	 * @param MaxGridOffset - The largest changed location relative to the grid min location.
+	 */
+	void UpdateFieldTexture(const FIntPoint MinGridOffset, const FIntPoint MaxGridOffset);
+
+	//The smallest grid location of the rectangle containing this plane.
+	UPROPERTY()
+	FIntPoint GridMinLocation = FIntPoint::ZeroValue;
+
+	//The size of the rectangle containing this plane in grid locations.
+	UPROPERTY()
+	FIntPoint GridSize = FIntPoint::ZeroValue;
+
+	//The cell index at each location in the containing rectangle, stored row by row. INDEX_NONE where this plane does not cover.
+	UPROPERTY()
+	TArray<int32> GridToCellIndices = TArray<int32>();
+
+	//The grid location of each cell.
 	UPROPERTY()
-	TMap<FIntPoint, int32> LocationsToInstanceIndices = TMap<FIntPoint, int32>();
+	TArray<FIntPoint> CellLocations = TArray<FIntPoint>();
+
+	//The chunk each cell is in.
+	UPROPERTY()
+	TArray<int32> CellChunkIndices = TArray<int32>();
+
+	//The index of the first cell in each chunk. A cell's instance index in its chunk is its offset from this.
+	UPROPERTY()
+	TArray<int32> ChunkFirstCellIndices = TArray<int32>();
+
+	//The strengths of each field type at each cell index.
+	TArray<TArray<int>> FieldTypeToStrengths = TArray<TArray<int>>();
+
+	//The texels of the field texture, stored in the same order as the grid to cell indices.
+	TArray<FColor> FieldTexels = TArray<FColor>();
+
+	//The number of field update batches that have begun and not ended.
+	int32 FieldUpdateDepth = 0;
+
+	//The smallest changed location relative to the grid min location that has not been uploaded.
+	FIntPoint PendingMinChangedOffset = FIntPoint::ZeroValue;
 
-	//Stores strengths of all fields.
-	TMap<EFieldType, TMap<FIntPoint, int>> FieldTypeToLocationToStrengths = TMap<EFieldType, TMap<FIntPoint, int>>();
+	//The largest changed location relative to the grid min location that has not been uploaded. Negative if nothing is pending.
+	FIntPoint PendingMaxChangedOffset = FIntPoint(-1, -1);
 };
 /* /\ ============== /\ *\
 |  /\ AGroundPlane /\  |
@@ -4,10 +4,11 @@
 
 #include "Kismet/GameplayStatics.h"
 #include "Syrup/Systems/SyrupGameMode.h"
+#include "Syrup/Systems/TileEffectDispatcher.h"
 #include "Syrup/Tiles/GridLibrary.h"
+#include "Syrup/Tiles/GridOccupancySubsystem.h"
 #include "Syrup/Tiles/Trash.h"
 #include "Components/BoxComponent.h"
-#include "Syrup/Tiles/Trash.h"
 
 /* \/ ================ \/ *\
 |  \/ ATrashfallVolume \/  |
@@ -59,7 +60,25 @@ void ATrashfallVolume::BeginPlay()
 
 	Super::BeginPlay();
 
-	ASyrupGameMode::GetTileEffectTriggerDelegate(this).AddDynamic(this, &ATrashfallVolume::ReceiveEffectTrigger);
+	UTileEffectDispatcher* Dispatcher = UTileEffectDispatcher::Get(this);
+	if (IsValid(Dispatcher))
+	{
+		Dispatcher->RegisterListener(FTileEffectTriggerListener::CreateUObject(this, &ATrashfallVolume::ReceiveEffectTrigger), GetTileEffectTriggerBit(ETileEffectTriggerType::TrashSpawn));
+	}
+
+	BuildSpawnPool();
+}
+
+/**
+ * Stops listening for occupancy changes.
+ *
+ * @param EndPlayReason - Why play is ending.
+ */
+void ATrashfallVolume::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	ClearSpawnPool();
+
+	Super::EndPlay(EndPlayReason);
 }
 
 /**
@@ -67,6 +86,8 @@ void ATrashfallVolume::BeginPlay()
  */
 void ATrashfallVolume::Destroyed()
 {
+	ClearSpawnPool();
+
 	TArray<AActor*> AttachedTrashPieces;
 	GetAttachedActors(AttachedTrashPieces);
 
@@ -84,8 +105,7 @@ void ATrashfallVolume::Destroyed()
 void ATrashfallVolume::OnConstruction(const FTransform& Transform)
 {
 	RNG = FRandomStream(SpawnSeed);
-	NumTiles = FMath::Max(1, SpawnArea->GetScaledBoxExtent().SizeSquared2D() / 1558.845726811990);
-	BadLocations = TSet<FIntPoint>();
+	ClearSpawnPool();
 
 	TArray<AActor*> AttachedTrashPieces;
 	GetAttachedActors(AttachedTrashPieces);
@@ -127,8 +147,6 @@ void ATrashfallVolume::OnConstruction(const FTransform& Transform)
  */
 void ATrashfallVolume::ReceiveEffectTrigger(const ETileEffectTriggerType TriggerType, const ATile* Triggerer, const TSet<FIntPoint>& LocationsToTrigger)
 {
-	BadLocations = TSet<FIntPoint>();
-
 	if (TriggerType == ETileEffectTriggerType::TrashSpawn && NumTrash < NumToMaintain)
 	{
 		int TrashToSpawn = 0;
@@ -145,53 +163,195 @@ void ATrashfallVolume::ReceiveEffectTrigger(const ETileEffectTriggerType Trigger
 		while (TrashToSpawn >= 1)
 		{
 			TrashToSpawn--;
-			SpawnTrashInBox();
+			if (!SpawnTrashInBox())
+			{
+				break;
+			}
 		}
 	}
 }
 
 /**
- * Spawns a single trash inside the spawn area.
+ * Spawns a single trash at a random valid location inside the spawn area.
  * 
- * @param bAttachTrash - Whether or not to attach the trash to this.
+ * @return Whether or not a trash was sucessfuly spawned.
  */
 bool ATrashfallVolume::SpawnTrashInBox()
 {
-	TSet<FIntPoint> RelativeTileLocations = TrashType.GetDefaultObject()->GetRelativeSubTileLocations();
-	int Count = 0;
-	while (Count++ < 50)
+	if (!bIsSpawnPoolValid)
 	{
-		//Gets a random transform in spawn area and converts it to a grid transform.
-		FTransform SpawnWorldTransform = FTransform(FQuat(FVector::UpVector, RNG.FRandRange(0.f, TWO_PI)), GetActorTransform().TransformPosition(RNG.RandPointInBox(FBox(-SpawnArea->GetUnscaledBoxExtent(), SpawnArea->GetUnscaledBoxExtent()))));
+		BuildSpawnPool();
+	}
+
+	if (ValidCandidates.IsEmpty())
+	{
+		UE_LOG(LogLevel, Log, TEXT("%s has no room to spawn trash"), *GetName())
+		return false;
+	}
+
+	FGridTransform SpawnTransform = SpawnCandidates[ValidCandidates[RNG.RandHelper(ValidCandidates.Num())]];
+	ATrash* SpawnedTrash = SpawnTrash(UGridLibrary::GridTransformToWorldTransform(SpawnTransform));
+	if (!IsValid(SpawnedTrash))
+	{
+		return false;
+	}
+	ClaimTrash(SpawnedTrash);
+
+	//Block the new trash's locations right away in case it has not registered its occupancy yet.
+	for (FIntPoint EachSpawnLocation : UGridLibrary::TransformShape(TrashType.GetDefaultObject()->GetRelativeSubTileLocations(), SpawnTransform))
+	{
+		SetLocationBlocked(EachSpawnLocation, true);
+	}
+	return true;
+}
+
+/**
+ * Finds every grid transform that trash could spawn at inside the spawn area and which of them are currently blocked.
+ */
+void ATrashfallVolume::BuildSpawnPool()
+{
+	ClearSpawnPool();
+	if (!IsValid(TrashType))
+	{
+		return;
+	}
+	bIsSpawnPoolValid = true;
+
+	UGridOccupancySubsystem* OccupancySubsystem = UGridOccupancySubsystem::Get(this);
+	if (IsValid(OccupancySubsystem))
+	{
+		OccupancyChangedHandle = OccupancySubsystem->OnOccupancyChanged.AddUObject(this, &ATrashfallVolume::ReceiveOccupancyChanged);
+	}
+
+	//Find the grid locations whose centers are inside the spawn area.
+	const FTransform AreaTransform = SpawnArea->GetComponentTransform();
+	const FVector AreaExtent = SpawnArea->GetUnscaledBoxExtent();
+	const FBox AreaBounds = SpawnArea->Bounds.GetBox();
+	const FIntPoint MinLocation = UGridLibrary::WorldLocationToGridLocation(AreaBounds.Min) - FIntPoint(1, 1);
+	const FIntPoint MaxLocation = UGridLibrary::WorldLocationToGridLocation(AreaBounds.Max) + FIntPoint(1, 1);
+	const TSet<FIntPoint> RelativeTileLocations = TrashType.GetDefaultObject()->GetRelativeSubTileLocations();
+
+	for (int LocationX = MinLocation.X; LocationX <= MaxLocation.X; LocationX++)
+	{
+		for (int LocationY = MinLocation.Y; LocationY <= MaxLocation.Y; LocationY++)
+		{
+			const FIntPoint Location = FIntPoint(LocationX, LocationY);
+			const FVector AreaLocation = AreaTransform.InverseTransformPosition(UGridLibrary::GridLocationToWorldLocation(Location));
+			if (FMath::Abs(AreaLocation.X) > AreaExtent.X || FMath::Abs(AreaLocation.Y) > AreaExtent.Y)
+			{
+				continue;
+			}
+
+			//Add a candidate for each way the trash can be pointed here.
+			for (uint8 DirectionIndex = 0; DirectionIndex < 6; DirectionIndex++)
+			{
+				if (!UGridLibrary::IsDirectionValidAtLocation((EGridDirection)DirectionIndex, Location))
+				{
+					continue;
+				}
 
-		FGridTransform SpawnTransform = UGridLibrary::WorldTransformToGridTransform(SpawnWorldTransform);
+				const FGridTransform Candidate = FGridTransform(Location, (EGridDirection)DirectionIndex);
+				const int CandidateIndex = SpawnCandidates.Add(Candidate);
+				CandidateBlockedCounts.Add(0);
+				CandidateValidIndices.Add(ValidCandidates.Add(CandidateIndex));
+				for (FIntPoint EachCoveredLocation : UGridLibrary::TransformShape(RelativeTileLocations, Candidate))
+				{
+					LocationsToCandidates.FindOrAdd(EachCoveredLocation).Add(CandidateIndex);
+				}
+			}
+		}
+	}
+
+	//Block candidates covering anything already there.
+	TArray<FIntPoint> CoveredLocations = TArray<FIntPoint>();
+	LocationsToCandidates.GetKeys(CoveredLocations);
+	for (FIntPoint EachCoveredLocation : CoveredLocations)
+	{
+		ATile* OverlappingTile = nullptr;
+		SetLocationBlocked(EachCoveredLocation, UGridLibrary::OverlapGridLocation(this, EachCoveredLocation, OverlappingTile, TArray<AActor*>(), ECollisionChannel::ECC_GameTraceChannel2));
+	}
+}
 
-		if (BadLocations.Contains(SpawnTransform.Location))
+/**
+ * Stops listening for occupancy changes and forgets the spawn pool.
+ */
+void ATrashfallVolume::ClearSpawnPool()
+{
+	if (OccupancyChangedHandle.IsValid())
+	{
+		UGridOccupancySubsystem* OccupancySubsystem = UGridOccupancySubsystem::Get(this);
+		if (IsValid(OccupancySubsystem))
 		{
-			continue;
+			OccupancySubsystem->OnOccupancyChanged.Remove(OccupancyChangedHandle);
 		}
+		OccupancyChangedHandle.Reset();
+	}
 
-		TSet<FIntPoint> SpawnLocations = UGridLibrary::TransformShape(RelativeTileLocations, SpawnTransform);
-		if (SpawnLocations.Difference(BadLocations).Num() != SpawnLocations.Num())
+	bIsSpawnPoolValid = false;
+	SpawnCandidates.Empty();
+	CandidateBlockedCounts.Empty();
+	CandidateValidIndices.Empty();
+	ValidCandidates.Empty();
+	LocationsToCandidates.Empty();
+	BlockedLocations.Empty();
+}
+
+/**
+ * Rechecks the locations whose occupancy changed.
+ *
+ * @param Locations - The locations that changed.
+ */
+void ATrashfallVolume::ReceiveOccupancyChanged(const TSet<FIntPoint>& Locations)
+{
+	for (FIntPoint EachLocation : Locations)
+	{
+		if (LocationsToCandidates.Contains(EachLocation))
 		{
-			continue;
+			ATile* OverlappingTile = nullptr;
+			SetLocationBlocked(EachLocation, UGridLibrary::OverlapGridLocation(this, EachLocation, OverlappingTile, TArray<AActor*>(), ECollisionChannel::ECC_GameTraceChannel2));
 		}
+	}
+}
+
+/**
+ * Sets whether a location is blocking trash from spawning and updates the spawn candidates covering it.
+ *
+ * @param Location - The location that changed.
+ * @param bBlocked - Whether the location is now blocked.
+ */
+void ATrashfallVolume::SetLocationBlocked(const FIntPoint Location, const bool bBlocked)
+{
+	const TArray<int>* CoveringCandidates = LocationsToCandidates.Find(Location);
+	if (!CoveringCandidates || bBlocked == BlockedLocations.Contains(Location))
+	{
+		return;
+	}
 
-		for (FIntPoint EachSpawnLocation : SpawnLocations)
+	if (bBlocked)
+	{
+		BlockedLocations.Add(Location);
+	}
+	else
+	{
+		BlockedLocations.Remove(Location);
+	}
+
+	for (int EachCandidate : *CoveringCandidates)
+	{
+		if (bBlocked && CandidateBlockedCounts[EachCandidate]++ == 0)
 		{
-			FVector WorldLocation = UGridLibrary::GridLocationToWorldLocation(EachSpawnLocation);
-			if (GetWorld()->LineTraceTestByChannel(WorldLocation + FVector(0, 0, 1), WorldLocation + FVector(0, 0, -0.05), ECollisionChannel::ECC_GameTraceChannel2))
+			//Remove from the valid candidates by swapping in the last one.
+			const int ValidIndex = CandidateValidIndices[EachCandidate];
+			ValidCandidates.RemoveAtSwap(ValidIndex);
+			if (ValidCandidates.IsValidIndex(ValidIndex))
 			{
-				BadLocations.Add(EachSpawnLocation);
-				goto endOfLoop;
+				CandidateValidIndices[ValidCandidates[ValidIndex]] = ValidIndex;
 			}
+			CandidateValidIndices[EachCandidate] = INDEX_NONE;
+		}
+		else if (!bBlocked && --CandidateBlockedCounts[EachCandidate] == 0)
+		{
+			CandidateValidIndices[EachCandidate] = ValidCandidates.Add(EachCandidate);
 		}
-
-		ATrash* SpawnedTrash = SpawnTrash(SpawnWorldTransform);
-		ClaimTrash(SpawnedTrash);		
-		return true;
-		endOfLoop:;
 	}
-
-	return false;
 }
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "Syrup/Tiles/Effects/TileEffectTrigger.h"
+#include "Syrup/Tiles/GridLibrary.h"
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
@@ -86,6 +87,13 @@ private:
 	 */
 	virtual void BeginPlay() override;
 
+	/**
+	 * Stops listening for occupancy changes.
+	 *
+	 * @param EndPlayReason - Why play is ending.
+	 */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	/**
 	 * Destroys trash spawned by this.
 	 */
@@ -117,24 +125,65 @@ private:
 	FORCEINLINE void ReciveTrashDestoryed(AActor* DestroyedActor) { NumTrash--;};
 
 	/**
-	 * Spawns a single trash inside the spawn area.
+	 * Spawns a single trash at a random valid location inside the spawn area.
 	 * 
 	 * @return Whether or not a trash was sucessfuly spawned.
 	 */
 	UFUNCTION()
 	bool SpawnTrashInBox();
 
+	/**
+	 * Finds every grid transform that trash could spawn at inside the spawn area and which of them are currently blocked.
+	 */
+	void BuildSpawnPool();
+
+	/**
+	 * Stops listening for occupancy changes and forgets the spawn pool.
+	 */
+	void ClearSpawnPool();
+
+	/**
+	 * Rechecks the locations whose occupancy changed.
+	 *
+	 * @param Locations - The locations that changed.
+	 */
+	void ReceiveOccupancyChanged(const TSet<FIntPoint>& Locations);
+
+	/**
+	 * Sets whether a location is blocking trash from spawning and updates the spawn candidates covering it.
+	 *
+	 * @param Location - The location that changed.
+	 * @param bBlocked - Whether the location is now blocked.
+	 */
+	void SetLocationBlocked(const FIntPoint Location, const bool bBlocked);
+
 	//The number of trash existing trash that has been spawned by this.
 	UPROPERTY()
 	int NumTrash = 0;
 
-	//The approximate number of tiles inside this volume.
-	UPROPERTY()
-	int NumTiles = 0;
+	//Every grid transform in the spawn area that trash could be spawned at if nothing was in the way.
+	TArray<FGridTransform> SpawnCandidates = TArray<FGridTransform>();
 
-	//Locations known to block trash spawning.
-	UPROPERTY()
-	TSet<FIntPoint> BadLocations = TSet<FIntPoint>();
+	//The number of blocked locations that each spawn candidate would cover.
+	TArray<int> CandidateBlockedCounts = TArray<int>();
+
+	//The index of each spawn candidate in valid candidates. INDEX_NONE if it is blocked.
+	TArray<int> CandidateValidIndices = TArray<int>();
+
+	//The spawn candidates that are not blocked.
+	TArray<int> ValidCandidates = TArray<int>();
+
+	//The spawn candidates that would cover each location.
+	TMap<FIntPoint, TArray<int>> LocationsToCandidates = TMap<FIntPoint, TArray<int>>();
+
+	//The locations covered by spawn candidates that are blocking trash from spawning.
+	TSet<FIntPoint> BlockedLocations = TSet<FIntPoint>();
+
+	//Whether the spawn pool reflects the current spawn area and trash type.
+	bool bIsSpawnPoolValid = false;
+
+	//The binding to the occupancy subsystem's changes.
+	FDelegateHandle OccupancyChangedHandle = FDelegateHandle();
 
 	//The random number generator used for trash spawning.
 	UPROPERTY()
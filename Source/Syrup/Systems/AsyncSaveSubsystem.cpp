@@ -0,0 +1,245 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AsyncSaveSubsystem.h"
+
+#include "SyrupSaveGame.h"
+#include "SyrupSaveArchive.h"
+#include "Async/Async.h"
+#include "Kismet/GameplayStatics.h"
+#include "PlatformFeatures.h"
+#include "SaveGameSystem.h"
+
+/* \/ =================== \/ *\
+|  \/ UAsyncSaveSubsystem \/  |
+\* \/ =================== \/ */
+
+/**
+ * Gets the async save subsystem of a world.
+ *
+ * @param WorldContext - An object in the world to get the subsystem of.
+ * @return The async save subsystem of the world. Nullptr if the world does not support one.
+ */
+UAsyncSaveSubsystem* UAsyncSaveSubsystem::Get(const UObject* WorldContext)
+{
+	if (!IsValid(WorldContext))
+	{
+		return nullptr;
+	}
+
+	UWorld* World = WorldContext->GetWorld();
+	return IsValid(World) ? World->GetSubsystem<UAsyncSaveSubsystem>() : nullptr;
+}
+
+/**
+ * Saves the entire world state in the background.
+ *
+ * @param WorldContext - An object in the world to save.
+ * @param SlotName - The name of the save slot to put the world in.
+ * @param OnFinished - Called on the game thread once the save has been written or has failed.
+ * @return Whether the world could be captured. If not, OnFinished is not called.
+ */
+bool UAsyncSaveSubsystem::SaveGameInBackground(const UObject* WorldContext, const FString& SlotName, const FDynamicAsyncSaveFinished& OnFinished)
+{
+	UAsyncSaveSubsystem* Subsystem = Get(WorldContext);
+	if (!IsValid(Subsystem))
+	{
+		return false;
+	}
+
+	return Subsystem->SaveGameAsync(SlotName, FAsyncSaveFinished::CreateLambda([OnFinished](const FString& FinishedSlotName, const bool bSucceeded)
+		{
+			OnFinished.ExecuteIfBound(FinishedSlotName, bSucceeded);
+		}));
+}
+
+/**
+ * Captures the state of the world and writes it to a slot in the background.
+ *
+ * @param SlotName - The name of the save slot to put the world in.
+ * @param OnFinished - Called on the game thread once the save has been written, has failed, or has been replaced by a newer save.
+ * @return Whether the world could be captured. If not, OnFinished is not called.
+ */
+bool UAsyncSaveSubsystem::SaveGameAsync(const FString& SlotName, const FAsyncSaveFinished& OnFinished)
+{
+	const double CaptureStartTime = FPlatformTime::Seconds();
+	USyrupSaveGame* Snapshot = USyrupSaveGame::CaptureWorld(this);
+	if (!IsValid(Snapshot))
+	{
+		return false;
+	}
+	UE_LOG(LogSaveGame, Verbose, TEXT("Captured %d tiles for %s in %.2fms."), Snapshot->GetNumTiles(), *SlotName, (FPlatformTime::Seconds() - CaptureStartTime) * 1000);
+
+	if (IsSaving())
+	{
+		//Only the newest waiting save is worth writing, so the one it replaces is reported as not written.
+		if (IsValid(QueuedSnapshot))
+		{
+			QueuedRequest.OnFinished.ExecuteIfBound(QueuedRequest.SlotName, false);
+		}
+
+		QueuedSnapshot = Snapshot;
+		QueuedRequest.SlotName = SlotName;
+		QueuedRequest.OnFinished = OnFinished;
+		return true;
+	}
+
+	ActiveSnapshot = Snapshot;
+	ActiveRequest.SlotName = SlotName;
+	ActiveRequest.OnFinished = OnFinished;
+	StartWrite();
+	return true;
+}
+
+/**
+ * Waits for the save being written and the save waiting after it to finish, such as before reading a slot. Saves
+ * in the generic format are stored by the engine and can not be waited for.
+ */
+void UAsyncSaveSubsystem::WaitForSaves()
+{
+	//Finishing a write starts the queued one, so keep waiting until neither is left.
+	while (IsSaving() && WriteTask.IsValid())
+	{
+		WriteTask.Wait();
+		FinishWrite(WriteTask.GetResult());
+	}
+}
+
+/**
+ * Waits for the save being written and the save waiting after it to finish. The save waiting after one in the generic
+ * format is written on the game thread instead, since the engine can not be waited for.
+ */
+void UAsyncSaveSubsystem::Deinitialize()
+{
+	WaitForSaves();
+
+	if (IsValid(QueuedSnapshot))
+	{
+		const FSaveRequest FinishedRequest = QueuedRequest;
+		USyrupSaveGame* Snapshot = QueuedSnapshot;
+		QueuedSnapshot = nullptr;
+		QueuedRequest = FSaveRequest();
+
+		bool bSucceeded = false;
+		if (USyrupSaveGame::IsCompactFormatEnabled())
+		{
+			TArray<uint8> Bytes = TArray<uint8>();
+			Snapshot->WriteCompact(Bytes);
+			bSucceeded = UGameplayStatics::SaveDataToSlot(Bytes, FinishedRequest.SlotName, 0);
+		}
+		else
+		{
+			bSucceeded = UGameplayStatics::SaveGameToSlot(Snapshot, FinishedRequest.SlotName, 0);
+		}
+
+		if (bSucceeded)
+		{
+			USyrupSaveGame::UpdatePinnedBaseReferences(FinishedRequest.SlotName, FString());
+		}
+		else
+		{
+			UE_LOG(LogSaveGame, Error, TEXT("Saving Failed: Could not write to %s."), *FinishedRequest.SlotName);
+		}
+		FinishedRequest.OnFinished.ExecuteIfBound(FinishedRequest.SlotName, bSucceeded);
+	}
+
+	Super::Deinitialize();
+}
+
+/**
+ * Starts writing the active snapshot to its slot.
+ */
+void UAsyncSaveSubsystem::StartWrite()
+{
+	const uint32 StartedWriteId = ++WriteId;
+	if (!USyrupSaveGame::IsCompactFormatEnabled())
+	{
+		//The generic format has to be serialized on the game thread, but the engine can still store it in the background.
+		UGameplayStatics::AsyncSaveGameToSlot(ActiveSnapshot, ActiveRequest.SlotName, 0, FAsyncSaveGameToSlotDelegate::CreateUObject(this, &UAsyncSaveSubsystem::ReceiveGenericSaveFinished, StartedWriteId));
+		return;
+	}
+
+	//Everything the background task needs from other objects is gathered here so that it only reads the snapshot.
+	TSharedRef<FSyrupSaveObjectTable> ObjectTable = MakeShared<FSyrupSaveObjectTable>();
+	ActiveSnapshot->CollectObjects(ObjectTable.Get());
+	ISaveGameSystem* SaveSystem = IPlatformFeaturesModule::Get().GetSaveGameSystem();
+	USyrupSaveGame* Snapshot = ActiveSnapshot;
+	const FString SlotName = ActiveRequest.SlotName;
+	TWeakObjectPtr<UAsyncSaveSubsystem> WeakThis = this;
+
+	WriteTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Snapshot, SlotName, ObjectTable, SaveSystem, StartedWriteId, WeakThis]()
+		{
+			TArray<uint8> Bytes = TArray<uint8>();
+			Snapshot->WriteCompact(Bytes, nullptr, FString(), 0, &ObjectTable.Get());
+			const bool bSucceeded = SaveSystem && SaveSystem->SaveGame(false, *SlotName, 0, Bytes);
+
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, StartedWriteId, bSucceeded]()
+				{
+					if (WeakThis.IsValid() && WeakThis->WriteId == StartedWriteId)
+					{
+						WeakThis->FinishWrite(bSucceeded);
+					}
+				});
+			return bSucceeded;
+		});
+}
+
+/**
+ * Finishes the active save and starts writing the queued one if there is one.
+ *
+ * @param bSucceeded - Whether the active save was written.
+ */
+void UAsyncSaveSubsystem::FinishWrite(const bool bSucceeded)
+{
+	//Already finished while deinitializing.
+	if (!IsSaving())
+	{
+		return;
+	}
+
+	if (bSucceeded)
+	{
+		//The slot now stores the whole world, so any copy of a base it was stored as differences from may be unused.
+		USyrupSaveGame::UpdatePinnedBaseReferences(ActiveRequest.SlotName, FString());
+	}
+	else
+	{
+		UE_LOG(LogSaveGame, Error, TEXT("Saving Failed: Could not write to %s."), *ActiveRequest.SlotName);
+	}
+
+	//Clear the active save first so that the callback can request another one.
+	const FSaveRequest FinishedRequest = ActiveRequest;
+	ActiveSnapshot = nullptr;
+	ActiveRequest = FSaveRequest();
+	WriteTask = UE::Tasks::TTask<bool>();
+	FinishedRequest.OnFinished.ExecuteIfBound(FinishedRequest.SlotName, bSucceeded);
+
+	if (!IsSaving() && IsValid(QueuedSnapshot))
+	{
+		ActiveSnapshot = QueuedSnapshot;
+		ActiveRequest = QueuedRequest;
+		QueuedSnapshot = nullptr;
+		QueuedRequest = FSaveRequest();
+		StartWrite();
+	}
+}
+
+/**
+ * Finishes the active save once it has been written in the generic format.
+ *
+ * @param SlotName - The slot the save was written to.
+ * @param UserIndex - The user the save was written for.
+ * @param bSucceeded - Whether the save was written.
+ * @param StartedWriteId - The id of the write when it was started.
+ */
+void UAsyncSaveSubsystem::ReceiveGenericSaveFinished(const FString& SlotName, const int32 UserIndex, bool bSucceeded, const uint32 StartedWriteId)
+{
+	if (WriteId == StartedWriteId)
+	{
+		FinishWrite(bSucceeded);
+	}
+}
+
+/* /\ =================== /\ *\
+|  /\ UAsyncSaveSubsystem /\  |
+\* /\ =================== /\ */
@@ -0,0 +1,137 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tasks/Task.h"
+#include "AsyncSaveSubsystem.generated.h"
+
+class USyrupSaveGame;
+
+DECLARE_DELEGATE_TwoParams(FAsyncSaveFinished, const FString& /*SlotName*/, const bool /*bSucceeded*/);
+
+UDELEGATE()
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FDynamicAsyncSaveFinished, const FString&, SlotName, bool, bSucceeded);
+
+/* \/ =================== \/ *\
+|  \/ UAsyncSaveSubsystem \/  |
+\* \/ =================== \/ */
+/**
+ * Saves the world without stalling the game thread on writing it.
+ *
+ * The state of the world is captured on the game thread when a save is requested. Writing it in the compact format,
+ * compressing it, and storing it in its slot is done on a background task. Only one save is written at a time. A
+ * save requested while another is being written waits for it to finish, replacing any other save already waiting.
+ */
+UCLASS()
+class SYRUP_API UAsyncSaveSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Gets the async save subsystem of a world.
+	 *
+	 * @param WorldContext - An object in the world to get the subsystem of.
+	 * @return The async save subsystem of the world. Nullptr if the world does not support one.
+	 */
+	static UAsyncSaveSubsystem* Get(const UObject* WorldContext);
+
+	/**
+	 * Saves the entire world state in the background.
+	 *
+	 * @param WorldContext - An object in the world to save.
+	 * @param SlotName - The name of the save slot to put the world in.
+	 * @param OnFinished - Called on the game thread once the save has been written or has failed.
+	 * @return Whether the world could be captured. If not, OnFinished is not called.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Saving", Meta = (WorldContext = "WorldContext", AutoCreateRefTerm = "OnFinished"))
+	static bool SaveGameInBackground(const UObject* WorldContext, const FString& SlotName, const FDynamicAsyncSaveFinished& OnFinished);
+
+	/**
+	 * Captures the state of the world and writes it to a slot in the background.
+	 *
+	 * @param SlotName - The name of the save slot to put the world in.
+	 * @param OnFinished - Called on the game thread once the save has been written, has failed, or has been replaced by a newer save.
+	 * @return Whether the world could be captured. If not, OnFinished is not called.
+	 */
+	bool SaveGameAsync(const FString& SlotName, const FAsyncSaveFinished& OnFinished = FAsyncSaveFinished());
+
+	/**
+	 * Waits for the save being written and the save waiting after it to finish, such as before reading a slot. Saves
+	 * in the generic format are stored by the engine and can not be waited for.
+	 */
+	void WaitForSaves();
+
+	/**
+	 * Waits for the save being written and the save waiting after it to finish. The save waiting after one in the generic
+	 * format is written on the game thread instead, since the engine can not be waited for.
+	 */
+	virtual void Deinitialize() override;
+
+	/**
+	 * Gets whether a save is being written.
+	 *
+	 * @return Whether a save is being written.
+	 */
+	FORCEINLINE bool IsSaving() const { return IsValid(ActiveSnapshot); };
+
+private:
+	/**
+	 * A save waiting to be written or being written.
+	 */
+	struct FSaveRequest
+	{
+		//The slot to write the save to.
+		FString SlotName = FString();
+
+		//Called once the save has been written or has failed.
+		FAsyncSaveFinished OnFinished = FAsyncSaveFinished();
+	};
+
+	/**
+	 * Starts writing the active snapshot to its slot.
+	 */
+	void StartWrite();
+
+	/**
+	 * Finishes the active save and starts writing the queued one if there is one.
+	 *
+	 * @param bSucceeded - Whether the active save was written.
+	 */
+	void FinishWrite(const bool bSucceeded);
+
+	/**
+	 * Finishes the active save once it has been written in the generic format.
+	 *
+	 * @param SlotName - The slot the save was written to.
+	 * @param UserIndex - The user the save was written for.
+	 * @param bSucceeded - Whether the save was written.
+	 * @param StartedWriteId - The id of the write when it was started.
+	 */
+	void ReceiveGenericSaveFinished(const FString& SlotName, const int32 UserIndex, bool bSucceeded, const uint32 StartedWriteId);
+
+	//The save being written. Kept here so that it is not collected while the background task reads it.
+	UPROPERTY()
+	USyrupSaveGame* ActiveSnapshot = nullptr;
+
+	//Where the save being written goes and who to tell when it is done.
+	FSaveRequest ActiveRequest = FSaveRequest();
+
+	//The save waiting for the active one to be written.
+	UPROPERTY()
+	USyrupSaveGame* QueuedSnapshot = nullptr;
+
+	//Where the queued save goes and who to tell when it is done.
+	FSaveRequest QueuedRequest = FSaveRequest();
+
+	//The background task writing the active save in the compact format. Returns whether it succeeded.
+	UE::Tasks::TTask<bool> WriteTask = UE::Tasks::TTask<bool>();
+
+	//Counts the writes started, so that a write already finished by waiting on it is not finished again by its task or by the engine.
+	uint32 WriteId = 0;
+};
+/* /\ =================== /\ *\
+|  /\ UAsyncSaveSubsystem /\  |
+\* /\ =================== /\ */
@@ -0,0 +1,767 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BoardHistorySubsystem.h"
+
+#include "SyrupGameMode.h"
+#include "Syrup/MapUtilities/TrashfallVolume.h"
+#include "Syrup/Tiles/Plant.h"
+#include "Syrup/Tiles/Trash.h"
+#include "Syrup/Tiles/Resources/ResourcePool.h"
+#include "Syrup/Tiles/Resources/ResourceFaucet.h"
+#include "Syrup/Tiles/Resources/ResourceSink.h"
+#include "Kismet/GameplayStatics.h"
+#include "HAL/IConsoleManager.h"
+
+DEFINE_LOG_CATEGORY(LogBoardHistory);
+
+static TAutoConsoleVariable<int32> CVarMaxHistoryActions(
+	TEXT("Syrup.History.MaxActions"),
+	32,
+	TEXT("The number of player actions that can be undone. The oldest action is forgotten once there are more. 0 disables the history."));
+
+static TAutoConsoleVariable<int32> CVarMaxHistoryChanges(
+	TEXT("Syrup.History.MaxChangesPerAction"),
+	256,
+	TEXT("The number of changes a single player action can make and still be undone."));
+
+/* \/ ====================== \/ *\
+|  \/ UBoardHistorySubsystem \/  |
+\* \/ ====================== \/ */
+
+/**
+ * Gets the board history subsystem of a world.
+ *
+ * @param WorldContext - An object in the world to get the subsystem of.
+ * @return The board history subsystem of the world. Nullptr if the world does not support one.
+ */
+UBoardHistorySubsystem* UBoardHistorySubsystem::Get(const UObject* WorldContext)
+{
+	if (!IsValid(WorldContext))
+	{
+		return nullptr;
+	}
+
+	UWorld* World = WorldContext->GetWorld();
+	return IsValid(World) ? World->GetSubsystem<UBoardHistorySubsystem>() : nullptr;
+}
+
+/* ------------- *\
+\* \/ Actions \/ */
+
+/**
+ * Undoes the last action the player took this turn.
+ *
+ * @param WorldContext - An object in the world to undo the action in.
+ * @param EnergyReserve - The energy reserve of the player. The energy spent on the action is returned to it.
+ * @return Whether there was an action to undo and it was undone.
+ */
+bool UBoardHistorySubsystem::UndoAction(const UObject* WorldContext, int& EnergyReserve)
+{
+	UBoardHistorySubsystem* Subsystem = Get(WorldContext);
+	return IsValid(Subsystem) && Subsystem->Undo(EnergyReserve);
+}
+
+/**
+ * Takes the last action that was undone again.
+ *
+ * @param WorldContext - An object in the world to redo the action in.
+ * @param EnergyReserve - The energy reserve of the player. The energy spent on the action is taken from it.
+ * @return Whether there was an action to redo and it was redone.
+ */
+bool UBoardHistorySubsystem::RedoAction(const UObject* WorldContext, int& EnergyReserve)
+{
+	UBoardHistorySubsystem* Subsystem = Get(WorldContext);
+	return IsValid(Subsystem) && Subsystem->Redo(EnergyReserve);
+}
+
+/**
+ * Undoes the last action the player took this turn.
+ *
+ * @param EnergyReserve - The energy reserve of the player. The energy spent on the action is returned to it.
+ * @return Whether there was an action to undo and it was undone.
+ */
+bool UBoardHistorySubsystem::Undo(int& EnergyReserve)
+{
+	if (!CanUndo() || ActionDepth > 0)
+	{
+		return false;
+	}
+
+	FBoardAction& Action = GetAction(NumDoneActions - 1);
+	bool bSucceeded = true;
+	bIsApplying = true;
+	for (int32 ChangeIndex = Action.Changes.Num() - 1; ChangeIndex >= 0 && bSucceeded; ChangeIndex--)
+	{
+		bSucceeded = UndoChange(Action.Changes[ChangeIndex], EnergyReserve);
+	}
+	bIsApplying = false;
+
+	if (!bSucceeded)
+	{
+		//The board no longer matches the history, so none of it can be trusted.
+		UE_LOG(LogBoardHistory, Warning, TEXT("Could not undo an action. Forgetting the history."));
+		Clear();
+		return false;
+	}
+
+	NumDoneActions--;
+	return true;
+}
+
+/**
+ * Takes the last action that was undone again.
+ *
+ * @param EnergyReserve - The energy reserve of the player. The energy spent on the action is taken from it.
+ * @return Whether there was an action to redo and it was redone. Fails without changing anything if the reserve can't pay for it.
+ */
+bool UBoardHistorySubsystem::Redo(int& EnergyReserve)
+{
+	if (!CanRedo() || ActionDepth > 0)
+	{
+		return false;
+	}
+
+	FBoardAction& Action = GetAction(NumDoneActions);
+	if (EnergyReserve < Action.EnergyCost)
+	{
+		return false;
+	}
+
+	bool bSucceeded = true;
+	bIsApplying = true;
+	for (int32 ChangeIndex = 0; ChangeIndex < Action.Changes.Num() && bSucceeded; ChangeIndex++)
+	{
+		bSucceeded = RedoChange(Action.Changes[ChangeIndex], EnergyReserve);
+	}
+	bIsApplying = false;
+
+	if (!bSucceeded)
+	{
+		UE_LOG(LogBoardHistory, Warning, TEXT("Could not redo an action. Forgetting the history."));
+		Clear();
+		return false;
+	}
+
+	NumDoneActions++;
+	return true;
+}
+
+/**
+ * Forgets every action.
+ */
+void UBoardHistorySubsystem::Clear()
+{
+	for (FBoardAction& EachAction : Actions)
+	{
+		EachAction = FBoardAction();
+	}
+	TileReferences.Empty();
+
+	FirstActionIndex = 0;
+	NumActions = 0;
+	NumDoneActions = 0;
+	bIsGroupStarted = false;
+}
+
+/**
+ * Starts grouping the changes recorded into one action, such as the allocations made by auto allocating. Groups
+ * may be nested, ending when the outermost one does.
+ */
+void UBoardHistorySubsystem::BeginAction()
+{
+	if (ActionDepth++ == 0)
+	{
+		bIsGroupStarted = false;
+		bIsGroupOverflowed = false;
+	}
+}
+
+/**
+ * Ends the group started by the matching call to BeginAction.
+ */
+void UBoardHistorySubsystem::EndAction()
+{
+	if (ActionDepth > 0 && --ActionDepth == 0)
+	{
+		bIsGroupStarted = false;
+		bIsGroupOverflowed = false;
+	}
+}
+
+/* /\ Actions /\ *\
+\* ------------- */
+
+/* --------------- *\
+\* \/ Recording \/ */
+
+/**
+ * Records that the player sowed a plant. Undoing it destroys the plant but does not reverse the effects its
+ * PlantSpawned trigger already caused.
+ *
+ * @param Plant - The plant that was sown.
+ * @param EnergyCost - The energy the player spent sowing it.
+ */
+void UBoardHistorySubsystem::RecordSow(APlant* Plant, const int EnergyCost)
+{
+	if (!IsValid(Plant) || !BeginRecording())
+	{
+		return;
+	}
+
+	FBoardChange Change = FBoardChange();
+	Change.Type = EChangeType::Sow;
+	Change.Tile = GetTileReference(Plant);
+	Change.EnergyCost = EnergyCost;
+	Change.TileClass = Plant->GetClass();
+	Change.Transform = Plant->GetGridTransform();
+	AddChange(MoveTemp(Change));
+}
+
+/**
+ * Records that the player is picking up a piece of trash. Must be called before the trash is destroyed.
+ *
+ * @param Trash - The trash being picked up.
+ * @param EnergyCost - The energy the player spent picking it up.
+ */
+void UBoardHistorySubsystem::RecordPickUp(ATrash* Trash, const int EnergyCost)
+{
+	if (!IsValid(Trash) || !BeginRecording())
+	{
+		return;
+	}
+
+	FBoardChange Change = FBoardChange();
+	Change.Type = EChangeType::PickUp;
+	Change.Tile = GetTileReference(Trash);
+	Change.EnergyCost = EnergyCost;
+	Change.TileClass = Trash->GetClass();
+	Change.Transform = Trash->GetGridTransform();
+	StoreTrash(Trash, Change);
+	AddChange(MoveTemp(Change));
+}
+
+/**
+ * Records that a resource was allocated to a sink. Must be called after the sink's amount has been updated.
+ *
+ * @param Sink - The sink the resource was allocated to.
+ * @param Resource - The resource that was allocated.
+ */
+void UBoardHistorySubsystem::RecordAllocate(UResourceSink* Sink, const FResourceHandle Resource)
+{
+	ATile* SinkTile = IsValid(Sink) ? Cast<ATile>(Sink->GetOwner()) : nullptr;
+	if (!IsValid(SinkTile) || !Resource.IsSet() || !BeginRecording())
+	{
+		return;
+	}
+
+	TInlineComponentArray<UResourceSink*> Sinks = TInlineComponentArray<UResourceSink*>();
+	SinkTile->GetComponents<UResourceSink>(Sinks);
+
+	FBoardChange Change = FBoardChange();
+	Change.Type = EChangeType::Allocate;
+	Change.SinkIndex = Sinks.IndexOfByKey(Sink);
+	if (Change.SinkIndex == INDEX_NONE || !MakeAllocationRecord(Resource, Change.Resource))
+	{
+		return;
+	}
+	Change.Tile = GetTileReference(SinkTile);
+	AddChange(MoveTemp(Change));
+}
+
+/**
+ * Records that a resource was freed from a sink. Must be called before the sink's amount is updated.
+ *
+ * @param Sink - The sink the resource was freed from.
+ * @param Resource - The resource that was freed.
+ * @param bUndoesIncrementThisTurn - Whether freeing only cancels an increment that was deferred until the end of the turn.
+ */
+void UBoardHistorySubsystem::RecordFree(UResourceSink* Sink, const FResourceHandle Resource, const bool bUndoesIncrementThisTurn)
+{
+	ATile* SinkTile = IsValid(Sink) ? Cast<ATile>(Sink->GetOwner()) : nullptr;
+	if (!IsValid(SinkTile) || !Resource.IsSet() || !BeginRecording())
+	{
+		return;
+	}
+
+	TInlineComponentArray<UResourceSink*> Sinks = TInlineComponentArray<UResourceSink*>();
+	SinkTile->GetComponents<UResourceSink>(Sinks);
+
+	FBoardChange Change = FBoardChange();
+	Change.Type = EChangeType::Free;
+	Change.SinkIndex = Sinks.IndexOfByKey(Sink);
+	if (Change.SinkIndex == INDEX_NONE || !MakeAllocationRecord(Resource, Change.Resource))
+	{
+		return;
+	}
+	Change.Tile = GetTileReference(SinkTile);
+	Change.AmountBeforeFree = Sink->GetAllocationAmount();
+	Change.bUndoesIncrementThisTurn = bUndoesIncrementThisTurn;
+	AddChange(MoveTemp(Change));
+}
+
+/* /\ Recording /\ *\
+\* --------------- */
+
+/**
+ * Adds a change to the action being recorded, starting a new one if there is not a group open.
+ *
+ * @param Change - The change to add.
+ */
+void UBoardHistorySubsystem::AddChange(FBoardChange&& Change)
+{
+	if (bIsGroupOverflowed)
+	{
+		return;
+	}
+
+	if (ActionDepth == 0 || !bIsGroupStarted)
+	{
+		//A new action can't be redone on top of the ones that were undone.
+		DropUndoneActions();
+
+		//Forget the oldest action to make room.
+		if (NumActions == Actions.Num())
+		{
+			ResetAction(GetAction(0));
+			FirstActionIndex = (FirstActionIndex + 1) % Actions.Num();
+			NumActions--;
+			NumDoneActions--;
+		}
+
+		NumActions++;
+		NumDoneActions++;
+		bIsGroupStarted = ActionDepth > 0;
+	}
+
+	FBoardAction& Action = GetAction(NumActions - 1);
+	if (Action.Changes.Num() >= CVarMaxHistoryChanges.GetValueOnGameThread())
+	{
+		//Undoing part of an action would leave the board in a state the player never saw, so nothing before it can be undone either.
+		UE_LOG(LogBoardHistory, Warning, TEXT("An action made more than %d changes. Forgetting the history."), CVarMaxHistoryChanges.GetValueOnGameThread());
+		Clear();
+		bIsGroupOverflowed = ActionDepth > 0;
+		return;
+	}
+
+	Action.EnergyCost += Change.EnergyCost;
+	Action.Changes.Add(MoveTemp(Change));
+}
+
+/**
+ * Gets whether changes should be recorded right now, making room for them if the size of the history was changed.
+ *
+ * @return Whether it is the player's turn and the history is not being applied.
+ */
+bool UBoardHistorySubsystem::BeginRecording()
+{
+	if (bIsApplying)
+	{
+		return false;
+	}
+
+	ASyrupGameMode* GameMode = Cast<ASyrupGameMode>(UGameplayStatics::GetGameMode(this));
+	if (!IsValid(GameMode) || !ASyrupGameMode::IsPlayerTurn(GameMode))
+	{
+		return false;
+	}
+
+	const int32 MaxActions = FMath::Max(0, CVarMaxHistoryActions.GetValueOnGameThread());
+	if (Actions.Num() != MaxActions)
+	{
+		Clear();
+		Actions.SetNum(MaxActions);
+	}
+	return MaxActions > 0;
+}
+
+/**
+ * Drops the actions that were undone, making way for a new one.
+ */
+void UBoardHistorySubsystem::DropUndoneActions()
+{
+	for (int32 ActionIndex = NumDoneActions; ActionIndex < NumActions; ActionIndex++)
+	{
+		ResetAction(GetAction(ActionIndex));
+	}
+	NumActions = NumDoneActions;
+}
+
+/**
+ * Empties an action, forgetting any tiles that are no longer referenced by the history.
+ *
+ * @param Action - The action to empty.
+ */
+void UBoardHistorySubsystem::ResetAction(FBoardAction& Action)
+{
+	for (FBoardChange& EachChange : Action.Changes)
+	{
+		ReleaseTileReference(EachChange.Tile);
+		ReleaseTileReference(EachChange.Resource.Faucet);
+		for (TArray<FAllocationRecord>& EachSinkAllocations : EachChange.SinkAllocations)
+		{
+			for (FAllocationRecord& EachAllocation : EachSinkAllocations)
+			{
+				ReleaseTileReference(EachAllocation.Faucet);
+			}
+		}
+	}
+	Action = FBoardAction();
+}
+
+/**
+ * Undoes a change.
+ *
+ * @param Change - The change to undo.
+ * @param EnergyReserve - The energy reserve of the player. The energy spent on the change is returned to it.
+ * @return Whether the change could be undone.
+ */
+bool UBoardHistorySubsystem::UndoChange(FBoardChange& Change, int& EnergyReserve)
+{
+	switch (Change.Type)
+	{
+	case EChangeType::Sow:
+	{
+		ATile* Plant = Change.Tile->Tile.Get();
+		if (!IsValid(Plant))
+		{
+			return false;
+		}
+
+		//Destroying the plant undoes its own effects, but effects that reacted to PlantSpawned, such as spawn timers or
+		//trash range changes, are left as they are.
+		Plant->Destroy();
+		SetTileReference(Change.Tile, nullptr);
+		EnergyReserve += Change.EnergyCost;
+		return true;
+	}
+	case EChangeType::PickUp:
+	{
+		ATrash* Trash = GetWorld()->SpawnActor<ATrash>(Change.TileClass, UGridLibrary::GridTransformToWorldTransform(Change.Transform));
+		if (!IsValid(Trash))
+		{
+			return false;
+		}
+
+		//Restored the same way as loading a save: amounts first, then the links they came from.
+		TInlineComponentArray<UResourceSink*> Sinks = TInlineComponentArray<UResourceSink*>();
+		Trash->GetComponents<UResourceSink>(Sinks);
+		for (int32 SinkIndex = 0; SinkIndex < Sinks.Num() && SinkIndex < Change.SinkAmounts.Num(); SinkIndex++)
+		{
+			Sinks[SinkIndex]->SetAllocationAmount(Change.SinkAmounts[SinkIndex]);
+			for (const FAllocationRecord& EachAllocation : Change.SinkAllocations[SinkIndex])
+			{
+				const FResourceHandle Resource = FindResource(EachAllocation, nullptr);
+				if (Resource.IsSet())
+				{
+					Sinks[SinkIndex]->AllocateResource(Resource, true);
+				}
+			}
+		}
+
+		if (Change.TrashfallVolume.IsValid())
+		{
+			Change.TrashfallVolume->ClaimTrash(Trash);
+		}
+
+		SetTileReference(Change.Tile, Trash);
+		EnergyReserve += Change.EnergyCost;
+		return true;
+	}
+	case EChangeType::Allocate:
+	{
+		UResourceSink* Sink = GetSink(Change.Tile, Change.SinkIndex);
+		const FResourceHandle Resource = FindResource(Change.Resource, Sink);
+		UResourcePool* Pool = UResourcePool::Get(this);
+		if (!IsValid(Sink) || !Resource.IsSet() || !IsValid(Pool))
+		{
+			return false;
+		}
+
+		Pool->FreeResource(Resource);
+		return true;
+	}
+	case EChangeType::Free:
+	{
+		UResourceSink* Sink = GetSink(Change.Tile, Change.SinkIndex);
+		const FResourceHandle Resource = FindResource(Change.Resource, nullptr);
+		if (!IsValid(Sink) || !Resource.IsSet())
+		{
+			return false;
+		}
+
+		if (Change.bUndoesIncrementThisTurn)
+		{
+			return Sink->AllocateResource(Resource);
+		}
+
+		//The resource was sunk on an earlier turn, so it is linked again without counting towards this turn's increments.
+		Sink->AllocateResource(Resource, true);
+		Sink->SetAllocationAmount(Change.AmountBeforeFree);
+		return true;
+	}
+	}
+	return false;
+}
+
+/**
+ * Makes a change again.
+ *
+ * @param Change - The change to make.
+ * @param EnergyReserve - The energy reserve of the player. The energy spent on the change is taken from it.
+ * @return Whether the change could be made.
+ */
+bool UBoardHistorySubsystem::RedoChange(FBoardChange& Change, int& EnergyReserve)
+{
+	switch (Change.Type)
+	{
+	case EChangeType::Sow:
+	{
+		APlant* Plant = APlant::TrySowPlant(this, TSubclassOf<APlant>(Change.TileClass.Get()), Change.Transform);
+		if (!IsValid(Plant))
+		{
+			return false;
+		}
+
+		SetTileReference(Change.Tile, Plant);
+		EnergyReserve -= Change.EnergyCost;
+		return true;
+	}
+	case EChangeType::PickUp:
+	{
+		ATrash* Trash = Cast<ATrash>(Change.Tile->Tile.Get());
+		if (!IsValid(Trash))
+		{
+			return false;
+		}
+
+		StoreTrash(Trash, Change);
+		if (!Trash->PickUp(EnergyReserve))
+		{
+			return false;
+		}
+		SetTileReference(Change.Tile, nullptr);
+		return true;
+	}
+	case EChangeType::Allocate:
+	{
+		UResourceSink* Sink = GetSink(Change.Tile, Change.SinkIndex);
+		const FResourceHandle Resource = FindResource(Change.Resource, nullptr);
+		return IsValid(Sink) && Resource.IsSet() && Sink->AllocateResource(Resource);
+	}
+	case EChangeType::Free:
+	{
+		UResourceSink* Sink = GetSink(Change.Tile, Change.SinkIndex);
+		const FResourceHandle Resource = FindResource(Change.Resource, Sink);
+		UResourcePool* Pool = UResourcePool::Get(this);
+		if (!IsValid(Sink) || !Resource.IsSet() || !IsValid(Pool))
+		{
+			return false;
+		}
+
+		Change.AmountBeforeFree = Sink->GetAllocationAmount();
+		Change.bUndoesIncrementThisTurn = Sink->GetIncrementsThisTurn() > 0;
+		Pool->FreeResource(Resource);
+		return true;
+	}
+	}
+	return false;
+}
+
+/**
+ * Stores the sinks and trashfall volume of a piece of trash about to be picked up.
+ *
+ * @param Trash - The trash being picked up.
+ * @param Change - The change to store the trash in.
+ */
+void UBoardHistorySubsystem::StoreTrash(ATrash* Trash, FBoardChange& Change)
+{
+	for (TArray<FAllocationRecord>& EachSinkAllocations : Change.SinkAllocations)
+	{
+		for (FAllocationRecord& EachAllocation : EachSinkAllocations)
+		{
+			ReleaseTileReference(EachAllocation.Faucet);
+		}
+	}
+	Change.SinkAmounts.Reset();
+	Change.SinkAllocations.Reset();
+
+	TInlineComponentArray<UResourceSink*> Sinks = TInlineComponentArray<UResourceSink*>();
+	Trash->GetComponents<UResourceSink>(Sinks);
+	for (UResourceSink* EachSink : Sinks)
+	{
+		Change.SinkAmounts.Add(EachSink->GetAllocationAmount());
+		TArray<FAllocationRecord>& SinkAllocations = Change.SinkAllocations.AddDefaulted_GetRef();
+		for (const FResourceHandle& EachResource : EachSink->GetAllocatedResourceHandles())
+		{
+			FAllocationRecord Allocation = FAllocationRecord();
+			if (MakeAllocationRecord(EachResource, Allocation))
+			{
+				SinkAllocations.Add(Allocation);
+			}
+		}
+	}
+
+	Change.TrashfallVolume = Cast<ATrashfallVolume>(Trash->GetAttachParentActor());
+}
+
+/* ------------------- *\
+\* \/ Tile Tracking \/ */
+
+/**
+ * Gets the reference shared by the history for a tile.
+ *
+ * @param Tile - The tile to reference.
+ * @return The reference to the tile.
+ */
+TSharedPtr<UBoardHistorySubsystem::FTileReference> UBoardHistorySubsystem::GetTileReference(ATile* Tile)
+{
+	if (!IsValid(Tile))
+	{
+		return nullptr;
+	}
+
+	//The tile a reference is stored under may have been destroyed by something other than the history and its address reused.
+	const TSharedPtr<FTileReference>* FoundReference = TileReferences.Find(Tile);
+	if (FoundReference && (*FoundReference)->Tile.Get() == Tile)
+	{
+		return *FoundReference;
+	}
+
+	TSharedPtr<FTileReference> Reference = MakeShared<FTileReference>();
+	SetTileReference(Reference, Tile);
+	return Reference;
+}
+
+/**
+ * Points a reference at a tile that was spawned in place of the one it referenced.
+ *
+ * @param Reference - The reference to point at the tile.
+ * @param Tile - The tile that was spawned. Null if the tile was removed from the board.
+ */
+void UBoardHistorySubsystem::SetTileReference(const TSharedPtr<FTileReference>& Reference, ATile* Tile)
+{
+	if (!Reference.IsValid())
+	{
+		return;
+	}
+
+	if (Reference->TrackedTile)
+	{
+		const TSharedPtr<FTileReference>* TrackedReference = TileReferences.Find(Reference->TrackedTile);
+		if (TrackedReference && *TrackedReference == Reference)
+		{
+			TileReferences.Remove(Reference->TrackedTile);
+		}
+	}
+
+	Reference->Tile = Tile;
+	Reference->TrackedTile = IsValid(Tile) ? Tile : nullptr;
+	if (Reference->TrackedTile)
+	{
+		TileReferences.Add(Tile, Reference);
+	}
+}
+
+/**
+ * Forgets a tile if nothing in the history references it anymore.
+ *
+ * @param Reference - The reference to the tile.
+ */
+void UBoardHistorySubsystem::ReleaseTileReference(TSharedPtr<FTileReference>& Reference)
+{
+	TSharedPtr<FTileReference> ReleasedReference = MoveTemp(Reference);
+	if (!ReleasedReference.IsValid() || !ReleasedReference->TrackedTile)
+	{
+		return;
+	}
+
+	//Only held by the tile references and here.
+	const TSharedPtr<FTileReference>* TrackedReference = TileReferences.Find(ReleasedReference->TrackedTile);
+	if (TrackedReference && *TrackedReference == ReleasedReference && ReleasedReference.GetSharedReferenceCount() <= 2)
+	{
+		TileReferences.Remove(ReleasedReference->TrackedTile);
+	}
+}
+
+/* /\ Tile Tracking /\ *\
+\* ------------------- */
+
+/* ------------- *\
+\* \/ Helpers \/ */
+
+/**
+ * Gets a sink of a tile by its index in the tile's components.
+ *
+ * @param Reference - The tile the sink is on.
+ * @param SinkIndex - The index of the sink.
+ * @return The sink. Nullptr if it could not be found.
+ */
+UResourceSink* UBoardHistorySubsystem::GetSink(const TSharedPtr<FTileReference>& Reference, const int32 SinkIndex)
+{
+	ATile* Tile = Reference.IsValid() ? Reference->Tile.Get() : nullptr;
+	if (!IsValid(Tile))
+	{
+		return nullptr;
+	}
+
+	TInlineComponentArray<UResourceSink*> Sinks = TInlineComponentArray<UResourceSink*>();
+	Tile->GetComponents<UResourceSink>(Sinks);
+	return Sinks.IsValidIndex(SinkIndex) ? Sinks[SinkIndex] : nullptr;
+}
+
+/**
+ * Finds a resource produced by a faucet that is allocated to a sink, or that is not allocated if the sink is null.
+ *
+ * @param Record - The faucet and type of the resource.
+ * @param Sink - The sink the resource is allocated to. Nullptr to find an unallocated resource.
+ * @return The resource. Nullptr if it could not be found.
+ */
+FResourceHandle UBoardHistorySubsystem::FindResource(const FAllocationRecord& Record, const UResourceSink* Sink)
+{
+	ATile* FaucetTile = Record.Faucet.IsValid() ? Record.Faucet->Tile.Get() : nullptr;
+	const IResourceFaucet* Faucet = Cast<IResourceFaucet>(FaucetTile);
+	const UResourcePool* Pool = UResourcePool::Get(FaucetTile);
+	if (!Faucet || !IsValid(Pool))
+	{
+		return FResourceHandle();
+	}
+
+	for (const FResourceHandle& EachProducedResource : Faucet->GetProducedResourceHandles())
+	{
+		if (Pool->IsAlive(EachProducedResource) && Pool->GetType(EachProducedResource) == Record.Type
+			&& (Sink ? Pool->GetSink(EachProducedResource) == Sink : !Pool->IsAllocated(EachProducedResource)))
+		{
+			return EachProducedResource;
+		}
+	}
+	return FResourceHandle();
+}
+
+/**
+ * Stores the faucet and type of a resource.
+ *
+ * @param Resource - The resource to store.
+ * @param OutRecord - Will be set to the faucet and type of the resource.
+ * @return Whether the resource was produced by a tile.
+ */
+bool UBoardHistorySubsystem::MakeAllocationRecord(const FResourceHandle Resource, FAllocationRecord& OutRecord)
+{
+	const UResourcePool* Pool = UResourcePool::Get(this);
+	ATile* FaucetTile = IsValid(Pool) ? Cast<ATile>(Pool->GetFaucet(Resource)) : nullptr;
+	if (!IsValid(FaucetTile))
+	{
+		return false;
+	}
+
+	OutRecord.Faucet = GetTileReference(FaucetTile);
+	OutRecord.Type = Pool->GetType(Resource);
+	return true;
+}
+
+/* /\ Helpers /\ *\
+\* ------------- */
+
+/* /\ ====================== /\ *\
+|  /\ UBoardHistorySubsystem /\  |
+\* /\ ====================== /\ */
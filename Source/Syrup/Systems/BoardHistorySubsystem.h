@@ -0,0 +1,406 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Syrup/Tiles/GridLibrary.h"
+#include "Syrup/Tiles/Resources/ResourceType.h"
+#include "Syrup/Tiles/Resources/ResourceHandle.h"
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Templates/SubclassOf.h"
+#include "BoardHistorySubsystem.generated.h"
+
+class ATile;
+class APlant;
+class ATrash;
+class ATrashfallVolume;
+class UResourceSink;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogBoardHistory, Log, All);
+
+/* \/ ====================== \/ *\
+|  \/ UBoardHistorySubsystem \/  |
+\* \/ ====================== \/ */
+/**
+ * Records the changes the player makes to the board during their turn so that they can be undone and redone.
+ *
+ * Each player action stores only the tiles and sinks it changed, so undoing or redoing it costs as much as the action
+ * did instead of reloading the whole board. Actions are kept in a ring buffer whose size is set by
+ * Syrup.History.MaxActions, dropping the oldest once it is full. The history only covers the current turn. It is
+ * cleared when the night begins and when a save is loaded, since neither can be undone this way. Undoing a sow removes
+ * the plant but not what other tiles already did in response to it being spawned, such as spawn timers or trash ranges.
+ */
+UCLASS()
+class SYRUP_API UBoardHistorySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Gets the board history subsystem of a world.
+	 *
+	 * @param WorldContext - An object in the world to get the subsystem of.
+	 * @return The board history subsystem of the world. Nullptr if the world does not support one.
+	 */
+	static UBoardHistorySubsystem* Get(const UObject* WorldContext);
+
+	/* ------------- *\
+	\* \/ Actions \/ */
+
+	/**
+	 * Undoes the last action the player took this turn.
+	 *
+	 * @param WorldContext - An object in the world to undo the action in.
+	 * @param EnergyReserve - The energy reserve of the player. The energy spent on the action is returned to it.
+	 * @return Whether there was an action to undo and it was undone.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "History", Meta = (WorldContext = "WorldContext"))
+	static bool UndoAction(const UObject* WorldContext, UPARAM(Ref) int& EnergyReserve);
+
+	/**
+	 * Takes the last action that was undone again.
+	 *
+	 * @param WorldContext - An object in the world to redo the action in.
+	 * @param EnergyReserve - The energy reserve of the player. The energy spent on the action is taken from it.
+	 * @return Whether there was an action to redo and it was redone.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "History", Meta = (WorldContext = "WorldContext"))
+	static bool RedoAction(const UObject* WorldContext, UPARAM(Ref) int& EnergyReserve);
+
+	/**
+	 * Undoes the last action the player took this turn.
+	 *
+	 * @param EnergyReserve - The energy reserve of the player. The energy spent on the action is returned to it.
+	 * @return Whether there was an action to undo and it was undone.
+	 */
+	bool Undo(int& EnergyReserve);
+
+	/**
+	 * Takes the last action that was undone again.
+	 *
+	 * @param EnergyReserve - The energy reserve of the player. The energy spent on the action is taken from it.
+	 * @return Whether there was an action to redo and it was redone. Fails without changing anything if the reserve can't pay for it.
+	 */
+	bool Redo(int& EnergyReserve);
+
+	/**
+	 * Gets whether there is an action that can be undone.
+	 *
+	 * @return Whether there is an action that can be undone.
+	 */
+	UFUNCTION(BlueprintPure, Category = "History")
+	FORCEINLINE bool CanUndo() const { return NumDoneActions > 0; };
+
+	/**
+	 * Gets whether there is an action that can be redone.
+	 *
+	 * @return Whether there is an action that can be redone.
+	 */
+	UFUNCTION(BlueprintPure, Category = "History")
+	FORCEINLINE bool CanRedo() const { return NumActions > NumDoneActions; };
+
+	/**
+	 * Forgets every action.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "History")
+	void Clear();
+
+	/**
+	 * Starts grouping the changes recorded into one action, such as the allocations made by auto allocating. Groups
+	 * may be nested, ending when the outermost one does.
+	 */
+	void BeginAction();
+
+	/**
+	 * Ends the group started by the matching call to BeginAction.
+	 */
+	void EndAction();
+
+	/* /\ Actions /\ *\
+	\* ------------- */
+
+	/* --------------- *\
+	\* \/ Recording \/ */
+
+	/**
+	 * Records that the player sowed a plant. Undoing it destroys the plant but does not reverse the effects its
+	 * PlantSpawned trigger already caused.
+	 *
+	 * @param Plant - The plant that was sown.
+	 * @param EnergyCost - The energy the player spent sowing it.
+	 */
+	void RecordSow(APlant* Plant, const int EnergyCost);
+
+	/**
+	 * Records that the player is picking up a piece of trash. Must be called before the trash is destroyed.
+	 *
+	 * @param Trash - The trash being picked up.
+	 * @param EnergyCost - The energy the player spent picking it up.
+	 */
+	void RecordPickUp(ATrash* Trash, const int EnergyCost);
+
+	/**
+	 * Records that a resource was allocated to a sink. Must be called after the sink's amount has been updated.
+	 *
+	 * @param Sink - The sink the resource was allocated to.
+	 * @param Resource - The resource that was allocated.
+	 */
+	void RecordAllocate(UResourceSink* Sink, const FResourceHandle Resource);
+
+	/**
+	 * Records that a resource was freed from a sink. Must be called before the sink's amount is updated.
+	 *
+	 * @param Sink - The sink the resource was freed from.
+	 * @param Resource - The resource that was freed.
+	 * @param bUndoesIncrementThisTurn - Whether freeing only cancels an increment that was deferred until the end of the turn.
+	 */
+	void RecordFree(UResourceSink* Sink, const FResourceHandle Resource, const bool bUndoesIncrementThisTurn);
+
+	/* /\ Recording /\ *\
+	\* --------------- */
+
+private:
+	/**
+	 * A tile referenced by the history. Shared by every change referencing the tile so that when undoing or redoing
+	 * spawns the tile again, every change sees the new one.
+	 */
+	struct FTileReference
+	{
+		//The tile. Null while the tile is not on the board.
+		TWeakObjectPtr<ATile> Tile;
+
+		//The tile this is stored under in the history's references. Null if it is not stored.
+		const ATile* TrackedTile = nullptr;
+	};
+
+	/**
+	 * A resource allocated to a sink. The faucet and type are stored instead of the resource since the faucet may
+	 * produce a new resource after being spawned again.
+	 */
+	struct FAllocationRecord
+	{
+		//The tile producing the resource.
+		TSharedPtr<FTileReference> Faucet = nullptr;
+
+		//The type of the resource.
+		EResourceType Type = EResourceType::Any;
+	};
+
+	/**
+	 * The kinds of change that can be made to the board.
+	 */
+	enum class EChangeType : uint8
+	{
+		Sow,
+		PickUp,
+		Allocate,
+		Free
+	};
+
+	/**
+	 * One change made to the board.
+	 */
+	struct FBoardChange
+	{
+		//What kind of change this is.
+		EChangeType Type = EChangeType::Sow;
+
+		//The tile sown, picked up, or whose sink was changed.
+		TSharedPtr<FTileReference> Tile = nullptr;
+
+		//The energy spent on the change.
+		int EnergyCost = 0;
+
+		//The class of the tile sown or picked up.
+		TSubclassOf<ATile> TileClass = nullptr;
+
+		//Where the tile was sown or picked up from.
+		FGridTransform Transform = FGridTransform();
+
+		//The amount stored in each sink of the trash picked up.
+		TArray<int> SinkAmounts = TArray<int>();
+
+		//The resources allocated to each sink of the trash picked up.
+		TArray<TArray<FAllocationRecord>> SinkAllocations = TArray<TArray<FAllocationRecord>>();
+
+		//The volume that claimed the trash picked up.
+		TWeakObjectPtr<ATrashfallVolume> TrashfallVolume;
+
+		//The index of the sink changed in the components of the tile.
+		int32 SinkIndex = INDEX_NONE;
+
+		//The resource allocated or freed.
+		FAllocationRecord Resource = FAllocationRecord();
+
+		//The amount stored in the sink before the resource was freed.
+		int AmountBeforeFree = 0;
+
+		//Whether freeing the resource only canceled an increment deferred until the end of the turn.
+		bool bUndoesIncrementThisTurn = false;
+	};
+
+	/**
+	 * The changes made by one player action.
+	 */
+	struct FBoardAction
+	{
+		//The changes in the order they were made.
+		TArray<FBoardChange> Changes = TArray<FBoardChange>();
+
+		//The energy spent on the action.
+		int EnergyCost = 0;
+	};
+
+	/**
+	 * Adds a change to the action being recorded, starting a new one if there is not a group open.
+	 *
+	 * @param Change - The change to add.
+	 */
+	void AddChange(FBoardChange&& Change);
+
+	/**
+	 * Gets whether changes should be recorded right now, making room for them if the size of the history was changed.
+	 *
+	 * @return Whether it is the player's turn and the history is not being applied.
+	 */
+	bool BeginRecording();
+
+	/**
+	 * Gets the action at an index relative to the oldest one kept.
+	 *
+	 * @param Index - The index of the action from the oldest.
+	 * @return The action.
+	 */
+	FORCEINLINE FBoardAction& GetAction(const int32 Index) { return Actions[(FirstActionIndex + Index) % Actions.Num()]; };
+
+	/**
+	 * Drops the actions that were undone, making way for a new one.
+	 */
+	void DropUndoneActions();
+
+	/**
+	 * Empties an action, forgetting any tiles that are no longer referenced by the history.
+	 *
+	 * @param Action - The action to empty.
+	 */
+	void ResetAction(FBoardAction& Action);
+
+	/**
+	 * Undoes a change.
+	 *
+	 * @param Change - The change to undo.
+	 * @param EnergyReserve - The energy reserve of the player. The energy spent on the change is returned to it.
+	 * @return Whether the change could be undone.
+	 */
+	bool UndoChange(FBoardChange& Change, int& EnergyReserve);
+
+	/**
+	 * Makes a change again.
+	 *
+	 * @param Change - The change to make.
+	 * @param EnergyReserve - The energy reserve of the player. The energy spent on the change is taken from it.
+	 * @return Whether the change could be made.
+	 */
+	bool RedoChange(FBoardChange& Change, int& EnergyReserve);
+
+	/**
+	 * Stores the sinks and trashfall volume of a piece of trash about to be picked up.
+	 *
+	 * @param Trash - The trash being picked up.
+	 * @param Change - The change to store the trash in.
+	 */
+	void StoreTrash(ATrash* Trash, FBoardChange& Change);
+
+	/* ------------------- *\
+	\* \/ Tile Tracking \/ */
+
+	/**
+	 * Gets the reference shared by the history for a tile.
+	 *
+	 * @param Tile - The tile to reference.
+	 * @return The reference to the tile.
+	 */
+	TSharedPtr<FTileReference> GetTileReference(ATile* Tile);
+
+	/**
+	 * Points a reference at a tile that was spawned in place of the one it referenced.
+	 *
+	 * @param Reference - The reference to point at the tile.
+	 * @param Tile - The tile that was spawned. Null if the tile was removed from the board.
+	 */
+	void SetTileReference(const TSharedPtr<FTileReference>& Reference, ATile* Tile);
+
+	/**
+	 * Forgets a tile if nothing in the history references it anymore.
+	 *
+	 * @param Reference - The reference to the tile.
+	 */
+	void ReleaseTileReference(TSharedPtr<FTileReference>& Reference);
+
+	/* /\ Tile Tracking /\ *\
+	\* ------------------- */
+
+	/* ------------- *\
+	\* \/ Helpers \/ */
+
+	/**
+	 * Gets a sink of a tile by its index in the tile's components.
+	 *
+	 * @param Reference - The tile the sink is on.
+	 * @param SinkIndex - The index of the sink.
+	 * @return The sink. Nullptr if it could not be found.
+	 */
+	static UResourceSink* GetSink(const TSharedPtr<FTileReference>& Reference, const int32 SinkIndex);
+
+	/**
+	 * Finds a resource produced by a faucet that is allocated to a sink, or that is not allocated if the sink is null.
+	 *
+	 * @param Record - The faucet and type of the resource.
+	 * @param Sink - The sink the resource is allocated to. Nullptr to find an unallocated resource.
+	 * @return The handle of the resource. Unset if it could not be found.
+	 */
+	static FResourceHandle FindResource(const FAllocationRecord& Record, const UResourceSink* Sink);
+
+	/**
+	 * Stores the faucet and type of a resource.
+	 *
+	 * @param Resource - The resource to store.
+	 * @param OutRecord - Will be set to the faucet and type of the resource.
+	 * @return Whether the resource was produced by a tile.
+	 */
+	bool MakeAllocationRecord(const FResourceHandle Resource, FAllocationRecord& OutRecord);
+
+	/* /\ Helpers /\ *\
+	\* ------------- */
+
+	//The actions kept, used as a ring buffer starting at the oldest action.
+	TArray<FBoardAction> Actions = TArray<FBoardAction>();
+
+	//The index in actions of the oldest action kept.
+	int32 FirstActionIndex = 0;
+
+	//The number of actions kept, including the ones that were undone.
+	int32 NumActions = 0;
+
+	//The number of actions kept that have not been undone.
+	int32 NumDoneActions = 0;
+
+	//The number of groups open. Changes recorded while a group is open go into the same action.
+	int32 ActionDepth = 0;
+
+	//Whether the changes of the open group have been given an action yet.
+	bool bIsGroupStarted = false;
+
+	//Whether the open group recorded more changes than an action can hold, so it can't be undone.
+	bool bIsGroupOverflowed = false;
+
+	//Whether an action is being undone or redone, so changes should not be recorded.
+	bool bIsApplying = false;
+
+	//The reference shared by the history for each tile on the board it references.
+	TMap<const ATile*, TSharedPtr<FTileReference>> TileReferences = TMap<const ATile*, TSharedPtr<FTileReference>>();
+};
+/* /\ ====================== /\ *\
+|  /\ UBoardHistorySubsystem /\  |
+\* /\ ====================== /\ */
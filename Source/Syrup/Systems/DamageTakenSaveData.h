@@ -14,15 +14,16 @@ struct SYRUP_API FDamageTakenSaveData
 	GENERATED_BODY()
 	
 public:
-	FDamageTakenSaveData(FIntPoint DamagedLocation = FIntPoint::ZeroValue, int DamagedAmount = 0)
+	FDamageTakenSaveData(int32 DamagedTileId = INDEX_NONE, int DamagedAmount = 0)
 	{
-		Location = DamagedLocation;
+		TileId = DamagedTileId;
 		Amount = DamagedAmount;
 	}
 
+	//The id of the damaged plant.
 	UPROPERTY()
-	FIntPoint Location;
+	int32 TileId;
 
 	UPROPERTY()
 	int Amount;
-};
\ No newline at end of file
+};
@@ -0,0 +1,209 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InstanceCustomDataBatcher.h"
+
+#include "TileEffectDispatcher.h"
+#include "Components/InstancedStaticMeshComponent.h"
+
+/* \/ ========================== \/ *\
+|  \/ UInstanceCustomDataBatcher \/  |
+\* \/ ========================== \/ */
+
+/**
+ * Gets the custom data batcher of a world.
+ *
+ * @param WorldContext - An object in the world to get the batcher of.
+ * @return The custom data batcher of the world. Nullptr if the world does not support one.
+ */
+UInstanceCustomDataBatcher* UInstanceCustomDataBatcher::Get(const UObject* WorldContext)
+{
+	if (!IsValid(WorldContext))
+	{
+		return nullptr;
+	}
+
+	UWorld* World = WorldContext->GetWorld();
+	return IsValid(World) ? World->GetSubsystem<UInstanceCustomDataBatcher>() : nullptr;
+}
+
+/**
+ * Sets a custom data value of an instance, deferring the render state update to the end of the frame when possible.
+ *
+ * @param Component - The instanced mesh to update.
+ * @param InstanceIndex - The index of the instance to update.
+ * @param CustomDataIndex - The index of the custom data value to set.
+ * @param CustomDataValue - The value to set.
+ * @return Whether the value was changed.
+ */
+bool UInstanceCustomDataBatcher::SetCustomDataValue(UInstancedStaticMeshComponent* Component, const int32 InstanceIndex, const int32 CustomDataIndex, const float CustomDataValue)
+{
+	if (!WriteCustomDataValue(Component, InstanceIndex, CustomDataIndex, CustomDataValue))
+	{
+		return false;
+	}
+
+	MarkComponentDirty(Component, 1);
+	return true;
+}
+
+/**
+ * Sets a custom data value of every instance, deferring the render state update to the end of the frame when possible.
+ *
+ * @param Component - The instanced mesh to update.
+ * @param CustomDataIndex - The index of the custom data value to set.
+ * @param CustomDataValue - The value to set.
+ * @return Whether any value was changed.
+ */
+bool UInstanceCustomDataBatcher::SetCustomDataValueForAllInstances(UInstancedStaticMeshComponent* Component, const int32 CustomDataIndex, const float CustomDataValue)
+{
+	if (!IsValid(Component))
+	{
+		return false;
+	}
+
+	int NumWrites = 0;
+	for (int32 InstanceIndex = 0; InstanceIndex < Component->GetInstanceCount(); InstanceIndex++)
+	{
+		NumWrites += WriteCustomDataValue(Component, InstanceIndex, CustomDataIndex, CustomDataValue);
+	}
+
+	if (NumWrites)
+	{
+		MarkComponentDirty(Component, NumWrites);
+	}
+	return NumWrites > 0;
+}
+
+/**
+ * Updates the render state of a component now or at the end of the frame. Use after writing custom data without
+ * marking the render state dirty.
+ *
+ * @param Component - The component that was changed.
+ * @param NumWrites - The number of custom data values that were changed.
+ */
+void UInstanceCustomDataBatcher::MarkComponentDirty(UInstancedStaticMeshComponent* Component, const int NumWrites)
+{
+	UInstanceCustomDataBatcher* Batcher = Get(Component);
+	if (IsValid(Batcher))
+	{
+		Batcher->DirtyComponents.Add(Component);
+		Batcher->NumCustomDataWrites += NumWrites;
+	}
+	else
+	{
+		Component->MarkRenderStateDirty();
+	}
+}
+
+/**
+ * Dirties the render state of every component changed since the last flush.
+ */
+void UInstanceCustomDataBatcher::Flush()
+{
+	for (TWeakObjectPtr<UInstancedStaticMeshComponent> EachComponent : DirtyComponents)
+	{
+		if (EachComponent.IsValid())
+		{
+			EachComponent->MarkRenderStateDirty();
+			NumRenderStateDirties++;
+			NumRenderStateDirtiesThisTurn++;
+		}
+	}
+	DirtyComponents.Empty();
+}
+
+/**
+ * Listens for the start of each turn to count the render state updates done in it.
+ *
+ * @param Collection - The collection of subsystems being initialized.
+ */
+void UInstanceCustomDataBatcher::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	UTileEffectDispatcher* Dispatcher = Collection.InitializeDependency<UTileEffectDispatcher>();
+	if (IsValid(Dispatcher))
+	{
+		Dispatcher->RegisterListener(FTileEffectTriggerListener::CreateUObject(this, &UInstanceCustomDataBatcher::ReceiveEffectTrigger), GetTileEffectTriggerBit(ETileEffectTriggerType::PlayerTurn));
+	}
+}
+
+/**
+ * Flushes the changes made this frame.
+ *
+ * @param DeltaTime - The time since the last tick.
+ */
+void UInstanceCustomDataBatcher::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	Flush();
+}
+
+/**
+ * Gets the stat id of this for profiling ticks.
+ *
+ * @return The stat id of this.
+ */
+TStatId UInstanceCustomDataBatcher::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UInstanceCustomDataBatcher, STATGROUP_Tickables);
+}
+
+/**
+ * Resets the counts of the work done by the batcher.
+ */
+void UInstanceCustomDataBatcher::ResetStats()
+{
+	NumRenderStateDirties = 0;
+	NumCustomDataWrites = 0;
+	NumRenderStateDirtiesThisTurn = 0;
+	NumRenderStateDirtiesLastTurn = 0;
+}
+
+/**
+ * Starts counting a new turn.
+ *
+ * @param TriggerType - The of trigger that was activated.
+ * @param Triggerer - The tile that triggered this effect.
+ * @param LocationsToTrigger - The Locations where the trigger applies an effect.
+ */
+void UInstanceCustomDataBatcher::ReceiveEffectTrigger(const ETileEffectTriggerType TriggerType, const ATile* Triggerer, const TSet<FIntPoint>& LocationsToTrigger)
+{
+	//Count the changes made by the night that just ended.
+	Flush();
+
+	UE_LOG(LogLevel, Verbose, TEXT("%d instanced mesh render state updates last turn"), NumRenderStateDirtiesThisTurn)
+	NumRenderStateDirtiesLastTurn = NumRenderStateDirtiesThisTurn;
+	NumRenderStateDirtiesThisTurn = 0;
+}
+
+/**
+ * Writes a custom data value without updating the render state.
+ *
+ * @param Component - The instanced mesh to update.
+ * @param InstanceIndex - The index of the instance to update.
+ * @param CustomDataIndex - The index of the custom data value to set.
+ * @param CustomDataValue - The value to set.
+ * @return Whether the value was changed.
+ */
+bool UInstanceCustomDataBatcher::WriteCustomDataValue(UInstancedStaticMeshComponent* Component, const int32 InstanceIndex, const int32 CustomDataIndex, const float CustomDataValue)
+{
+	if (!IsValid(Component) || CustomDataIndex < 0 || CustomDataIndex >= Component->NumCustomDataFloats)
+	{
+		return false;
+	}
+
+	const int32 DataIndex = InstanceIndex * Component->NumCustomDataFloats + CustomDataIndex;
+	if (!Component->PerInstanceSMCustomData.IsValidIndex(DataIndex) || Component->PerInstanceSMCustomData[DataIndex] == CustomDataValue)
+	{
+		return false;
+	}
+
+	return Component->SetCustomDataValue(InstanceIndex, CustomDataIndex, CustomDataValue, false);
+}
+
+/* /\ ========================== /\ *\
+|  /\ UInstanceCustomDataBatcher /\  |
+\* /\ ========================== /\ */
@@ -0,0 +1,160 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Syrup/Tiles/Effects/TileEffectTrigger.h"
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "InstanceCustomDataBatcher.generated.h"
+
+class UInstancedStaticMeshComponent;
+
+/* \/ ========================== \/ *\
+|  \/ UInstanceCustomDataBatcher \/  |
+\* \/ ========================== \/ */
+/**
+ * Batches per-instance custom data changes so each instanced mesh has its render state dirtied at most once per frame.
+ */
+UCLASS()
+class SYRUP_API UInstanceCustomDataBatcher : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Gets the custom data batcher of a world.
+	 *
+	 * @param WorldContext - An object in the world to get the batcher of.
+	 * @return The custom data batcher of the world. Nullptr if the world does not support one.
+	 */
+	static UInstanceCustomDataBatcher* Get(const UObject* WorldContext);
+
+	/**
+	 * Sets a custom data value of an instance, deferring the render state update to the end of the frame when possible.
+	 *
+	 * @param Component - The instanced mesh to update.
+	 * @param InstanceIndex - The index of the instance to update.
+	 * @param CustomDataIndex - The index of the custom data value to set.
+	 * @param CustomDataValue - The value to set.
+	 * @return Whether the value was changed.
+	 */
+	static bool SetCustomDataValue(UInstancedStaticMeshComponent* Component, const int32 InstanceIndex, const int32 CustomDataIndex, const float CustomDataValue);
+
+	/**
+	 * Sets a custom data value of every instance, deferring the render state update to the end of the frame when possible.
+	 *
+	 * @param Component - The instanced mesh to update.
+	 * @param CustomDataIndex - The index of the custom data value to set.
+	 * @param CustomDataValue - The value to set.
+	 * @return Whether any value was changed.
+	 */
+	static bool SetCustomDataValueForAllInstances(UInstancedStaticMeshComponent* Component, const int32 CustomDataIndex, const float CustomDataValue);
+
+	/**
+	 * Updates the render state of a component now or at the end of the frame. Use after writing custom data without
+	 * marking the render state dirty.
+	 *
+	 * @param Component - The component that was changed.
+	 * @param NumWrites - The number of custom data values that were changed.
+	 */
+	static void MarkComponentDirty(UInstancedStaticMeshComponent* Component, const int NumWrites);
+
+	/**
+	 * Dirties the render state of every component changed since the last flush.
+	 */
+	void Flush();
+
+	/**
+	 * Listens for the start of each turn to count the render state updates done in it.
+	 *
+	 * @param Collection - The collection of subsystems being initialized.
+	 */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/**
+	 * Flushes the changes made this frame.
+	 *
+	 * @param DeltaTime - The time since the last tick.
+	 */
+	virtual void Tick(float DeltaTime) override;
+
+	/**
+	 * Gets the stat id of this for profiling ticks.
+	 *
+	 * @return The stat id of this.
+	 */
+	virtual TStatId GetStatId() const override;
+
+	/**
+	 * Allows changes made in the editor to be flushed.
+	 *
+	 * @return True.
+	 */
+	FORCEINLINE virtual bool IsTickableInEditor() const override { return true; };
+
+	/**
+	 * Gets the number of render state updates done since the stats were last reset.
+	 *
+	 * @return The number of render state updates done.
+	 */
+	FORCEINLINE int64 GetNumRenderStateDirties() const { return NumRenderStateDirties; };
+
+	/**
+	 * Gets the number of custom data values changed since the stats were last reset.
+	 *
+	 * @return The number of custom data values changed.
+	 */
+	FORCEINLINE int64 GetNumCustomDataWrites() const { return NumCustomDataWrites; };
+
+	/**
+	 * Gets the number of render state updates done during the last full turn.
+	 *
+	 * @return The number of render state updates done during the last full turn.
+	 */
+	FORCEINLINE int GetNumRenderStateDirtiesLastTurn() const { return NumRenderStateDirtiesLastTurn; };
+
+	/**
+	 * Resets the counts of the work done by the batcher.
+	 */
+	void ResetStats();
+
+private:
+	/**
+	 * Starts counting a new turn.
+	 *
+	 * @param TriggerType - The of trigger that was activated.
+	 * @param Triggerer - The tile that triggered this effect.
+	 * @param LocationsToTrigger - The Locations where the trigger applies an effect.
+	 */
+	void ReceiveEffectTrigger(const ETileEffectTriggerType TriggerType, const ATile* Triggerer, const TSet<FIntPoint>& LocationsToTrigger);
+
+	/**
+	 * Writes a custom data value without updating the render state.
+	 *
+	 * @param Component - The instanced mesh to update.
+	 * @param InstanceIndex - The index of the instance to update.
+	 * @param CustomDataIndex - The index of the custom data value to set.
+	 * @param CustomDataValue - The value to set.
+	 * @return Whether the value was changed.
+	 */
+	static bool WriteCustomDataValue(UInstancedStaticMeshComponent* Component, const int32 InstanceIndex, const int32 CustomDataIndex, const float CustomDataValue);
+
+	//The components changed since the last flush.
+	TSet<TWeakObjectPtr<UInstancedStaticMeshComponent>> DirtyComponents = TSet<TWeakObjectPtr<UInstancedStaticMeshComponent>>();
+
+	//The number of render state updates done.
+	int64 NumRenderStateDirties = 0;
+
+	//The number of custom data values changed.
+	int64 NumCustomDataWrites = 0;
+
+	//The number of render state updates done since the current turn started.
+	int NumRenderStateDirtiesThisTurn = 0;
+
+	//The number of render state updates done during the last full turn.
+	int NumRenderStateDirtiesLastTurn = 0;
+};
+/* /\ ========================== /\ *\
+|  /\ UInstanceCustomDataBatcher /\  |
+\* /\ ========================== /\ */
@@ -16,23 +16,21 @@ struct SYRUP_API FResourceSaveData
 	GENERATED_BODY()
 	
 public:
-	FResourceSaveData(FIntPoint ResourceFaucetLocation = FIntPoint::ZeroValue, FIntPoint ResourceSinkLocation = FIntPoint::ZeroValue, FName ResourceSinkName = FName(), EResourceType ResourceType = EResourceType::Any)
+	FResourceSaveData(int32 ResourceFaucetId = INDEX_NONE, int32 ResourceSinkId = INDEX_NONE, EResourceType ResourceType = EResourceType::Any)
 	{
-		FaucetLocation = ResourceFaucetLocation;
-		SinkLocation = ResourceSinkLocation;
-		SinkName = ResourceSinkName;
+		FaucetId = ResourceFaucetId;
+		SinkId = ResourceSinkId;
 		Type = ResourceType;
 	}
 
 	UPROPERTY()
 	EResourceType Type;
 
+	//The id of the tile that produced the resource.
 	UPROPERTY()
-	FIntPoint FaucetLocation;
+	int32 FaucetId;
 
+	//The index of the sink the resource is allocated to in the saved sink data.
 	UPROPERTY()
-	FIntPoint SinkLocation;
-
-	UPROPERTY()
-	FName SinkName;
-};
\ No newline at end of file
+	int32 SinkId;
+};
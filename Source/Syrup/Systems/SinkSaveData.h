@@ -14,19 +14,21 @@ struct SYRUP_API FSinkSaveData
 	GENERATED_BODY()
 	
 public:
-	FSinkSaveData(FIntPoint ResourceSinkLocation = FIntPoint::ZeroValue, FName ResourceSinkName = FName(), int SinkStoredAmount = 0)
+	FSinkSaveData(int32 OwnerTileId = INDEX_NONE, int32 OwnerSinkIndex = INDEX_NONE, int SinkStoredAmount = 0)
 	{
-		Location = ResourceSinkLocation;
-		Name = ResourceSinkName;
+		TileId = OwnerTileId;
+		SinkIndex = OwnerSinkIndex;
 		StoredAmount = SinkStoredAmount;
 	}
 
 	UPROPERTY()
 	int StoredAmount;
 
+	//The id of the tile that owns the sink.
 	UPROPERTY()
-	FIntPoint Location;
+	int32 TileId;
 
+	//The index of the sink among its owner's sinks.
 	UPROPERTY()
-	FName Name;
-};
\ No newline at end of file
+	int32 SinkIndex;
+};
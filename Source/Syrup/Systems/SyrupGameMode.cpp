@@ -3,6 +3,8 @@
 
 #include "SyrupGameMode.h"
 
+#include "TileEffectDispatcher.h"
+#include "BoardHistorySubsystem.h"
 #include "Syrup/UI/Labels/TileLabelContainer.h"
 #include "Syrup/UI/Labels/TileLabel.h"
 #include "Syrup/UI/Labels/TileLabelActor.h"
@@ -73,7 +75,33 @@ FTileEffectTrigger& ASyrupGameMode::GetTileEffectTriggerDelegate(const UObject*
 }
 
 /**
- * Triggers a phase event for the world.
+ * Sends a tile effect trigger to every listener registered with the tile effect dispatcher and to anything bound
+ * to the tile effect trigger delegate. Triggers the dispatcher is deferring are held back instead.
+ *
+ * @param WorldContextObject - An object in the world to trigger the effect in.
+ * @param TriggerType - The type of trigger to activate.
+ * @param Triggerer - The tile that triggered this effect.
+ * @param Locations - The locations of the trigger.
+ */
+void ASyrupGameMode::BroadcastTileEffectTrigger(const UObject* WorldContextObject, const ETileEffectTriggerType TriggerType, const ATile* Triggerer, const TSet<FIntPoint>& Locations)
+{
+	UTileEffectDispatcher* Dispatcher = UTileEffectDispatcher::Get(WorldContextObject);
+	if (IsValid(Dispatcher))
+	{
+		//Deferred triggers are broadcast later by whoever deferred them.
+		if (Dispatcher->DeferTrigger(TriggerType, Triggerer, Locations))
+		{
+			return;
+		}
+		Dispatcher->Dispatch(TriggerType, Triggerer, Locations);
+	}
+
+	GetTileEffectTriggerDelegate(WorldContextObject).Broadcast(TriggerType, Triggerer, Locations);
+}
+
+/**
+ * Triggers a phase event for the world. Triggering the non-player turn forgets the actions that could be undone and
+ * triggering the player turn starts the next day.
  *
  * @param TriggerType - The type of trigger to activate. Must be a phase event trigger.
  */
@@ -88,7 +116,17 @@ void ASyrupGameMode::TriggerPhaseEvent(const ETileEffectTriggerType TriggerType)
 		}
 	)
 
-	TileEffectTriggerDelegate.Broadcast(TriggerType, nullptr, TSet<FIntPoint>());
+	if (TriggerType == ETileEffectTriggerType::NonPlayerTurn)
+	{
+		//The night can't be undone, so neither can anything before it.
+		UBoardHistorySubsystem* History = UBoardHistorySubsystem::Get(this);
+		if (IsValid(History))
+		{
+			History->Clear();
+		}
+	}
+
+	BroadcastTileEffectTrigger(this, TriggerType, nullptr, TSet<FIntPoint>());
 
 	if (TriggerType == LAST_PHASE_TRIGGER)
 	{
@@ -50,6 +50,16 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Player Turn", Meta = (WorldContext = "WorldContextObject"))
 	static bool IsPlayerTurn(const UObject* WorldContextObject);
 
+#if !UE_BUILD_SHIPPING
+	/**
+	 * Sets whether it is the player's turn without beginning the night. For benchmarks and tests that trigger the
+	 * phases of the night themselves.
+	 *
+	 * @param bNewIsPlayerTurn - Whether it is now the player's turn.
+	 */
+	FORCEINLINE void SetPlayerTurnForTesting(const bool bNewIsPlayerTurn) { bIsPlayerTurn = bNewIsPlayerTurn; };
+#endif
+
 	//Number of days that have passed +1.
 	UPROPERTY(BlueprintReadOnly)
 	int DayNumber = 1;
@@ -90,12 +100,23 @@ public:
 	UFUNCTION()
 	static FTileEffectTrigger& GetTileEffectTriggerDelegate(const UObject* WorldContextObject);
 
+	/**
+	 * Sends a tile effect trigger to every listener registered with the tile effect dispatcher and to anything bound
+	 * to the tile effect trigger delegate. Triggers the dispatcher is deferring are held back instead.
+	 *
+	 * @param WorldContextObject - An object in the world to trigger the effect in.
+	 * @param TriggerType - The type of trigger to activate.
+	 * @param Triggerer - The tile that triggered this effect.
+	 * @param Locations - The locations of the trigger.
+	 */
+	static void BroadcastTileEffectTrigger(const UObject* WorldContextObject, const ETileEffectTriggerType TriggerType, const ATile* Triggerer, const TSet<FIntPoint>& Locations);
+
 	UPROPERTY(BlueprintAssignable)
 	FTileEffectTrigger TileEffectTriggerDelegate;
 
-protected:
 	/**
-	 * Triggers a phase event for the world.
+	 * Triggers a phase event for the world. Triggering the non-player turn forgets the actions that could be undone and
+	 * triggering the player turn starts the next day.
 	 * 
 	 * @param TriggerType - The type of trigger to activate. Must be a phase event trigger.
 	 */
@@ -0,0 +1,148 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SyrupLoadTransaction.h"
+
+#include "SyrupGameMode.h"
+#include "TileEffectDispatcher.h"
+#include "Syrup/MapUtilities/GroundPlane.h"
+#include "Syrup/Tiles/GridOccupancySubsystem.h"
+#include "Syrup/Tiles/Tile.h"
+#include "EngineUtils.h"
+
+//The triggers held back while a transaction is open. Tiles send these from begin play.
+static constexpr uint32 LoadDeferredTriggerMask = GetTileEffectTriggerBit(ETileEffectTriggerType::PlantSpawned) | GetTileEffectTriggerBit(ETileEffectTriggerType::TrashSpawned);
+
+/* \/ ===================== \/ *\
+|  \/ FSyrupLoadTransaction \/  |
+\* \/ ===================== \/ */
+
+/**
+ * Opens a transaction in a world.
+ *
+ * @param InWorld - The world to load into.
+ */
+FSyrupLoadTransaction::FSyrupLoadTransaction(UWorld* InWorld) : World(InWorld)
+{
+	if (!IsValid(InWorld))
+	{
+		return;
+	}
+	bIsOpen = true;
+
+	UGridOccupancySubsystem* Occupancy = UGridOccupancySubsystem::Get(InWorld);
+	if (IsValid(Occupancy))
+	{
+		Occupancy->BeginChangeBatch();
+	}
+
+	UTileEffectDispatcher* Dispatcher = UTileEffectDispatcher::Get(InWorld);
+	if (IsValid(Dispatcher))
+	{
+		Dispatcher->BeginDeferringTriggers(LoadDeferredTriggerMask);
+	}
+
+	for (TActorIterator<AGroundPlane> EachGroundPlane(InWorld); EachGroundPlane; ++EachGroundPlane)
+	{
+		EachGroundPlane->BeginFieldUpdates();
+		GroundPlanes.Add(*EachGroundPlane);
+	}
+}
+
+/**
+ * Commits the transaction if it has not been already.
+ */
+FSyrupLoadTransaction::~FSyrupLoadTransaction()
+{
+	Commit();
+}
+
+/**
+ * Spawns a tile without beginning play in it. The tile begins play when FinishSpawning or Commit is called.
+ *
+ * @param TileClass - The class of tile to spawn.
+ * @param Transform - The world transform of the tile.
+ * @return The spawned tile. Nullptr if it could not be spawned.
+ */
+ATile* FSyrupLoadTransaction::SpawnTileDeferred(const TSubclassOf<ATile> TileClass, const FTransform& Transform)
+{
+	if (!bIsOpen || !World.IsValid())
+	{
+		return nullptr;
+	}
+
+	ATile* Tile = World->SpawnActorDeferred<ATile>(TileClass, Transform);
+	if (IsValid(Tile))
+	{
+		PendingTiles.Emplace(Tile, Transform);
+	}
+	return Tile;
+}
+
+/**
+ * Begins play in every tile spawned since this was last called.
+ */
+void FSyrupLoadTransaction::FinishSpawning()
+{
+	//Take the tiles first since beginning play may spawn more.
+	TArray<TPair<ATile*, FTransform>> TilesToFinish = MoveTemp(PendingTiles);
+	PendingTiles.Reset();
+	for (const TPair<ATile*, FTransform>& EachTile : TilesToFinish)
+	{
+		if (IsValid(EachTile.Key))
+		{
+			EachTile.Key->FinishSpawning(EachTile.Value);
+		}
+	}
+}
+
+/**
+ * Sends everything held back by the transaction and closes it.
+ */
+void FSyrupLoadTransaction::Commit()
+{
+	if (!bIsOpen)
+	{
+		return;
+	}
+	FinishSpawning();
+	bIsOpen = false;
+
+	UWorld* LoadedWorld = World.Get();
+	if (!IsValid(LoadedWorld))
+	{
+		return;
+	}
+
+	//Occupancy goes first so that anything reacting to the spawn triggers sees where every tile ended up.
+	UGridOccupancySubsystem* Occupancy = UGridOccupancySubsystem::Get(LoadedWorld);
+	if (IsValid(Occupancy))
+	{
+		Occupancy->EndChangeBatch();
+	}
+
+	UTileEffectDispatcher* Dispatcher = UTileEffectDispatcher::Get(LoadedWorld);
+	if (IsValid(Dispatcher))
+	{
+		TArray<UTileEffectDispatcher::FDeferredTrigger> DeferredTriggers = TArray<UTileEffectDispatcher::FDeferredTrigger>();
+		Dispatcher->EndDeferringTriggers(DeferredTriggers);
+		for (const UTileEffectDispatcher::FDeferredTrigger& EachTrigger : DeferredTriggers)
+		{
+			ASyrupGameMode::BroadcastTileEffectTrigger(LoadedWorld, EachTrigger.TriggerType, EachTrigger.Triggerer.Get(), EachTrigger.Locations);
+		}
+	}
+
+	//Fields are applied by the spawn triggers, so their textures are uploaded last.
+	for (TWeakObjectPtr<AGroundPlane> EachGroundPlane : GroundPlanes)
+	{
+		if (EachGroundPlane.IsValid())
+		{
+			EachGroundPlane->EndFieldUpdates();
+		}
+	}
+	GroundPlanes.Reset();
+}
+
+/* /\ ===================== /\ *\
+|  /\ FSyrupLoadTransaction /\  |
+\* /\ ===================== /\ */
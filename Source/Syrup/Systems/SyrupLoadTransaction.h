@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/SubclassOf.h"
+
+class ATile;
+class AGroundPlane;
+
+/* \/ ===================== \/ *\
+|  \/ FSyrupLoadTransaction \/  |
+\* \/ ===================== \/ */
+/**
+ * Batches the work of putting many tiles into a world at once, such as when loading a save.
+ *
+ * While a transaction is open, the spawn triggers of tiles are held back and combined into one trigger per trigger type
+ * and tile class, occupancy change notifications are combined into one, and ground planes hold back uploading their
+ * field textures. Committing sends everything that was held back, so fields, labels, and effects are rebuilt once for
+ * the final board instead of once per tile. Tiles spawned through the transaction are all constructed before any of them
+ * begins play.
+ */
+class SYRUP_API FSyrupLoadTransaction
+{
+public:
+	/**
+	 * Opens a transaction in a world.
+	 *
+	 * @param InWorld - The world to load into.
+	 */
+	explicit FSyrupLoadTransaction(UWorld* InWorld);
+
+	/**
+	 * Commits the transaction if it has not been already.
+	 */
+	~FSyrupLoadTransaction();
+
+	FSyrupLoadTransaction(const FSyrupLoadTransaction&) = delete;
+	FSyrupLoadTransaction& operator=(const FSyrupLoadTransaction&) = delete;
+
+	/**
+	 * Spawns a tile without beginning play in it. The tile begins play when FinishSpawning or Commit is called.
+	 *
+	 * @param TileClass - The class of tile to spawn.
+	 * @param Transform - The world transform of the tile.
+	 * @return The spawned tile. Nullptr if it could not be spawned.
+	 */
+	ATile* SpawnTileDeferred(const TSubclassOf<ATile> TileClass, const FTransform& Transform);
+
+	/**
+	 * Begins play in every tile spawned since this was last called.
+	 */
+	void FinishSpawning();
+
+	/**
+	 * Sends everything held back by the transaction and closes it.
+	 */
+	void Commit();
+
+	/**
+	 * Gets whether the transaction has not been committed yet.
+	 *
+	 * @return Whether the transaction is open.
+	 */
+	FORCEINLINE bool IsOpen() const { return bIsOpen; };
+
+private:
+	//The world being loaded into.
+	TWeakObjectPtr<UWorld> World = nullptr;
+
+	//The tiles spawned that have not begun play, with the transforms to finish spawning them at.
+	TArray<TPair<ATile*, FTransform>> PendingTiles = TArray<TPair<ATile*, FTransform>>();
+
+	//The ground planes holding back their field texture uploads.
+	TArray<TWeakObjectPtr<AGroundPlane>> GroundPlanes = TArray<TWeakObjectPtr<AGroundPlane>>();
+
+	//Whether the transaction has not been committed yet.
+	bool bIsOpen = false;
+};
+/* /\ ===================== /\ *\
+|  /\ FSyrupLoadTransaction /\  |
+\* /\ ===================== /\ */
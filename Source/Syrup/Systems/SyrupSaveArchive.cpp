@@ -0,0 +1,168 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SyrupSaveArchive.h"
+
+/* \/ ===================== \/ *\
+|  \/ FSyrupSaveObjectTable \/  |
+\* \/ ===================== \/ */
+
+/**
+ * Gets the index of an object, adding it if needed. Objects already in the table are not accessed, so a table filled
+ * on the game thread can be written from another thread.
+ *
+ * @param Object - The object to add.
+ * @return The index of the object. INDEX_NONE if the object is null.
+ */
+int32 FSyrupSaveObjectTable::Add(const UObject* Object)
+{
+	if (!Object)
+	{
+		return INDEX_NONE;
+	}
+
+	//Objects already in the table are found by pointer so that their paths are only built once.
+	if (const int32* ExistingIndex = ObjectsToIndices.Find(Object))
+	{
+		return *ExistingIndex;
+	}
+
+	const int32 Index = Paths.Add(FSoftObjectPath(Object));
+	ObjectsToIndices.Add(Object, Index);
+	return Index;
+}
+
+/**
+ * Gets the object at an index, finding or loading it the first time it is requested.
+ *
+ * @param Index - The index of the object.
+ * @return The object. Nullptr if it could not be found.
+ */
+UObject* FSyrupSaveObjectTable::Resolve(const int32 Index)
+{
+	if (!Paths.IsValidIndex(Index))
+	{
+		return nullptr;
+	}
+
+	if (ResolvedObjects.Num() < Paths.Num())
+	{
+		ResolvedObjects.SetNumZeroed(Paths.Num());
+	}
+
+	UObject*& Object = ResolvedObjects[Index];
+	if (!Object)
+	{
+		Object = Paths[Index].ResolveObject();
+		if (!Object)
+		{
+			Object = Paths[Index].TryLoad();
+		}
+	}
+	return Object;
+}
+
+/* /\ ===================== /\ *\
+|  /\ FSyrupSaveObjectTable /\  |
+\* /\ ===================== /\ */
+
+/* \/ ================= \/ *\
+|  \/ FSyrupSaveArchive \/  |
+\* \/ ================= \/ */
+
+/**
+ * Wraps an archive.
+ *
+ * @param InInnerArchive - The archive to read from or write to.
+ * @param InObjectTable - The table objects are written to and read from.
+ */
+FSyrupSaveArchive::FSyrupSaveArchive(FArchive& InInnerArchive, FSyrupSaveObjectTable& InObjectTable) : FArchiveProxy(InInnerArchive), ObjectTable(InObjectTable)
+{
+}
+
+/**
+ * Reads or writes an unsigned integer using 7 bits per byte.
+ *
+ * @param Value - The value to read into or write.
+ */
+void FSyrupSaveArchive::SerializeVarUInt(uint32& Value)
+{
+	if (IsLoading())
+	{
+		Value = 0;
+		for (int Shift = 0; Shift < 35; Shift += 7)
+		{
+			uint8 Byte = 0;
+			*this << Byte;
+			Value |= (uint32)(Byte & 0x7f) << Shift;
+			if (!(Byte & 0x80) || IsError())
+			{
+				return;
+			}
+		}
+
+		//More than five bytes can only come from corrupt data.
+		SetError();
+	}
+	else
+	{
+		uint32 Remaining = Value;
+		do
+		{
+			uint8 Byte = Remaining & 0x7f;
+			Remaining >>= 7;
+			if (Remaining)
+			{
+				Byte |= 0x80;
+			}
+			*this << Byte;
+		} while (Remaining);
+	}
+}
+
+/**
+ * Reads or writes a signed integer using 7 bits per byte. Values close to zero are shortest.
+ *
+ * @param Value - The value to read into or write.
+ */
+void FSyrupSaveArchive::SerializeVarInt(int32& Value)
+{
+	//Interleave negative and positive values so that small magnitudes have small encodings.
+	uint32 Encoded = ((uint32)Value << 1) ^ (uint32)(Value >> 31);
+	SerializeVarUInt(Encoded);
+	if (IsLoading())
+	{
+		Value = (int32)(Encoded >> 1) ^ -(int32)(Encoded & 1);
+	}
+}
+
+/**
+ * Reads or writes a grid location.
+ *
+ * @param Location - The location to read into or write.
+ */
+void FSyrupSaveArchive::SerializeGridLocation(FIntPoint& Location)
+{
+	SerializeVarInt(Location.X);
+	SerializeVarInt(Location.Y);
+}
+
+/**
+ * Reads or writes a reference to an object through the object table.
+ *
+ * @param Object - The object to read into or write.
+ */
+void FSyrupSaveArchive::SerializeObject(UObject*& Object)
+{
+	//Stored one higher so that null is zero.
+	uint32 EncodedIndex = IsLoading() ? 0 : (uint32)(ObjectTable.Add(Object) + 1);
+	SerializeVarUInt(EncodedIndex);
+	if (IsLoading())
+	{
+		Object = ObjectTable.Resolve((int32)EncodedIndex - 1);
+	}
+}
+
+/* /\ ================= /\ *\
+|  /\ FSyrupSaveArchive /\  |
+\* /\ ================= /\ */
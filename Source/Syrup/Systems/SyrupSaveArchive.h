@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Serialization/ArchiveProxy.h"
+
+/* \/ ===================== \/ *\
+|  \/ FSyrupSaveObjectTable \/  |
+\* \/ ===================== \/ */
+/**
+ * The objects referenced by a compact save, such as tile classes and trashfall volumes. Records store an index into
+ * the table instead of the path of the object.
+ */
+struct SYRUP_API FSyrupSaveObjectTable
+{
+	/**
+	 * Gets the index of an object, adding it if needed. Objects already in the table are not accessed, so a table filled
+	 * on the game thread can be written from another thread.
+	 *
+	 * @param Object - The object to add.
+	 * @return The index of the object. INDEX_NONE if the object is null.
+	 */
+	int32 Add(const UObject* Object);
+
+	/**
+	 * Gets the object at an index, finding or loading it the first time it is requested.
+	 *
+	 * @param Index - The index of the object.
+	 * @return The object. Nullptr if it could not be found.
+	 */
+	UObject* Resolve(const int32 Index);
+
+	//The path of each object.
+	TArray<FSoftObjectPath> Paths = TArray<FSoftObjectPath>();
+
+private:
+	//The index of each object added while writing.
+	TMap<const UObject*, int32> ObjectsToIndices = TMap<const UObject*, int32>();
+
+	//The objects found for each path while loading.
+	TArray<UObject*> ResolvedObjects = TArray<UObject*>();
+};
+/* /\ ===================== /\ *\
+|  /\ FSyrupSaveObjectTable /\  |
+\* /\ ===================== /\ */
+
+/* \/ ================= \/ *\
+|  \/ FSyrupSaveArchive \/  |
+\* \/ ================= \/ */
+/**
+ * Wraps another archive with the encodings used by compact saves. Integers are written as variable length so small
+ * values such as grid coordinates and ids take one or two bytes, and objects are written as indices into a table.
+ */
+class SYRUP_API FSyrupSaveArchive : public FArchiveProxy
+{
+public:
+	/**
+	 * Wraps an archive.
+	 *
+	 * @param InInnerArchive - The archive to read from or write to.
+	 * @param InObjectTable - The table objects are written to and read from.
+	 */
+	FSyrupSaveArchive(FArchive& InInnerArchive, FSyrupSaveObjectTable& InObjectTable);
+
+	/**
+	 * Reads or writes an unsigned integer using 7 bits per byte.
+	 *
+	 * @param Value - The value to read into or write.
+	 */
+	void SerializeVarUInt(uint32& Value);
+
+	/**
+	 * Reads or writes a signed integer using 7 bits per byte. Values close to zero are shortest.
+	 *
+	 * @param Value - The value to read into or write.
+	 */
+	void SerializeVarInt(int32& Value);
+
+	/**
+	 * Reads or writes a grid location.
+	 *
+	 * @param Location - The location to read into or write.
+	 */
+	void SerializeGridLocation(FIntPoint& Location);
+
+	/**
+	 * Reads or writes a reference to an object through the object table.
+	 *
+	 * @param Object - The object to read into or write.
+	 */
+	void SerializeObject(UObject*& Object);
+
+	/**
+	 * Reads or writes a reference to an object through the object table.
+	 *
+	 * @param Object - The object to read into or write. Set to null when read if the object is not of this type.
+	 */
+	template<typename ObjectType>
+	void SerializeObject(ObjectType*& Object)
+	{
+		UObject* BaseObject = Object;
+		SerializeObject(BaseObject);
+		if (IsLoading())
+		{
+			Object = Cast<ObjectType>(BaseObject);
+		}
+	}
+
+	/**
+	 * Gets the table objects are written to and read from.
+	 *
+	 * @return The object table.
+	 */
+	FORCEINLINE FSyrupSaveObjectTable& GetObjectTable() const { return ObjectTable; };
+
+private:
+	//The table objects are written to and read from.
+	FSyrupSaveObjectTable& ObjectTable;
+};
+/* /\ ================= /\ *\
+|  /\ FSyrupSaveArchive /\  |
+\* /\ ================= /\ */
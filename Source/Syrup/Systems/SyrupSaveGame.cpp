@@ -5,16 +5,279 @@
 
 #include "Kismet/GameplayStatics.h"
 #include "EngineUtils.h"
+#include "Syrup/Tiles/GridOccupancySubsystem.h"
 #include "Syrup/Tiles/Plant.h"
 #include "Syrup/Tiles/SpiritPlant.h"
 #include "Syrup/Tiles/Trash.h"
 #include "Syrup/Tiles/Resources/ResourceFaucet.h"
-#include "Syrup/Tiles/Resources/Resource.h"
+#include "Syrup/Tiles/Resources/ResourcePool.h"
+#include "Syrup/Tiles/Resources/ResourceSink.h"
 #include "Syrup/MapUtilities/TrashfallVolume.h"
 #include "SyrupGameMode.h"
+#include "BoardHistorySubsystem.h"
+#include "AsyncSaveSubsystem.h"
+#include "SyrupSaveArchive.h"
+#include "SyrupLoadTransaction.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Compression.h"
+#include "Misc/Crc.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
 
 DEFINE_LOG_CATEGORY(LogSaveGame);
 
+static TAutoConsoleVariable<bool> CVarCompactSaves(
+	TEXT("Syrup.Save.CompactFormat"),
+	true,
+	TEXT("Whether saves should be written in the compact binary format instead of the generic save game format."));
+
+static TAutoConsoleVariable<bool> CVarCompressSaves(
+	TEXT("Syrup.Save.Compress"),
+	true,
+	TEXT("Whether the sections of compact saves should be compressed."));
+
+static TAutoConsoleVariable<bool> CVarBatchedLoads(
+	TEXT("Syrup.Save.BatchedLoad"),
+	true,
+	TEXT("Whether loading a save should hold back spawn triggers and other per tile notifications until every tile is in place."));
+
+static TAutoConsoleVariable<bool> CVarBackgroundSaves(
+	TEXT("Syrup.Save.Background"),
+	true,
+	TEXT("Whether saves that store the whole world, such as autosaves, should be written on a background task after the world is captured."));
+
+//Identifies a save in the compact format.
+constexpr uint32 COMPACT_SAVE_MAGIC = 0x43525953;
+
+//The version of the layout of the compact format around its sections.
+constexpr uint16 COMPACT_SAVE_FORMAT_VERSION = 1;
+
+//The newest version of each section that can be read.
+constexpr uint8 COMPACT_SAVE_SECTION_VERSIONS[(uint8)ESyrupSaveSection::Num] = { 1, 1, 1, 1, 1, 1, 1, 1 };
+
+//Set in the header of a compact save stored as differences from another save.
+constexpr uint8 COMPACT_SAVE_FLAG_DELTA = 1 << 0;
+
+//Set in the header of a compact save whose sections are compressed.
+constexpr uint8 COMPACT_SAVE_FLAG_COMPRESSED = 1 << 1;
+
+//The largest size the sections of a compact save may be decompressed to.
+constexpr uint32 MAX_COMPACT_SAVE_SIZE = 256 * 1024 * 1024;
+
+//The most saves that may need to be read to read one save stored as differences.
+constexpr int32 MAX_COMPACT_SAVE_DELTA_CHAIN = 8;
+
+//The start of the name of a slot holding a copy of a save that others are stored as differences from. Followed by the checksum of the copy.
+static const TCHAR* COMPACT_SAVE_PINNED_BASE_PREFIX = TEXT("DeltaBase_");
+
+//The slot recording which copy of a base each save is stored as differences from, so that unused copies can be deleted.
+static const TCHAR* COMPACT_SAVE_PINNED_BASE_REFERENCES_SLOT = TEXT("DeltaBaseReferences");
+
+namespace SyrupSaveRecords
+{
+	/**
+	 * Reads or writes a record in the compact format.
+	 *
+	 * @param Ar - The archive to read from or write to.
+	 * @param Record - The record to read into or write.
+	 */
+	void Serialize(FSyrupSaveArchive& Ar, FTileSaveData& Record)
+	{
+		Ar.SerializeGridLocation(Record.TileTransfrom.Location);
+		Ar << Record.TileTransfrom.Direction;
+		UClass* TileClass = Record.TileClass.Get();
+		Ar.SerializeObject(TileClass);
+		Record.TileClass = TileClass;
+	}
+
+	void Serialize(FSyrupSaveArchive& Ar, FIntPoint& Record)
+	{
+		Ar.SerializeGridLocation(Record);
+	}
+
+	void Serialize(FSyrupSaveArchive& Ar, FSinkSaveData& Record)
+	{
+		Ar.SerializeVarInt(Record.TileId);
+		Ar.SerializeVarInt(Record.SinkIndex);
+		Ar.SerializeVarInt(Record.StoredAmount);
+	}
+
+	void Serialize(FSyrupSaveArchive& Ar, FResourceSaveData& Record)
+	{
+		Ar << Record.Type;
+		Ar.SerializeVarInt(Record.FaucetId);
+		Ar.SerializeVarInt(Record.SinkId);
+	}
+
+	void Serialize(FSyrupSaveArchive& Ar, FDamageTakenSaveData& Record)
+	{
+		Ar.SerializeVarInt(Record.TileId);
+		Ar.SerializeVarInt(Record.Amount);
+	}
+
+	void Serialize(FSyrupSaveArchive& Ar, FTrashfallSaveData& Record)
+	{
+		Ar.SerializeVarInt(Record.TrashId);
+		Ar.SerializeObject(Record.Volume);
+	}
+
+	/**
+	 * Writes a record on its own.
+	 *
+	 * @param Ar - The archive whose object table the record should use.
+	 * @param Record - The record to write.
+	 * @return The bytes of the record.
+	 */
+	template<typename RecordType>
+	TArray<uint8> ToBytes(FSyrupSaveArchive& Ar, RecordType Record)
+	{
+		TArray<uint8> Bytes = TArray<uint8>();
+		FMemoryWriter Writer = FMemoryWriter(Bytes);
+		FSyrupSaveArchive RecordArchive = FSyrupSaveArchive(Writer, Ar.GetObjectTable());
+		Serialize(RecordArchive, Record);
+		return Bytes;
+	}
+
+	/**
+	 * Reads or writes an array of records. When there is a base, records are stored as runs that are either copied from
+	 * the base or stored in full, so unchanged records cost a few bytes per run no matter where they moved to.
+	 *
+	 * @param Ar - The archive to read from or write to.
+	 * @param Records - The records to read into or write.
+	 * @param BaseRecords - The records of the base save. Nullptr if the records are stored in full.
+	 */
+	template<typename RecordType>
+	void SerializeRecords(FSyrupSaveArchive& Ar, TArray<RecordType>& Records, const TArray<RecordType>* BaseRecords)
+	{
+		uint32 NumRecords = Records.Num();
+		Ar.SerializeVarUInt(NumRecords);
+		if (Ar.IsLoading())
+		{
+			//Every record stored in full takes at least one byte, so a larger count can only come from corrupt data.
+			if (!BaseRecords && NumRecords > (uint32)Ar.TotalSize())
+			{
+				Ar.SetError();
+				return;
+			}
+			Records.Reset(BaseRecords ? FMath::Min(NumRecords, (uint32)(Ar.TotalSize() + BaseRecords->Num())) : NumRecords);
+		}
+
+		if (!BaseRecords)
+		{
+			for (uint32 RecordIndex = 0; RecordIndex < NumRecords && !Ar.IsError(); RecordIndex++)
+			{
+				Serialize(Ar, Ar.IsLoading() ? Records.AddDefaulted_GetRef() : Records[RecordIndex]);
+			}
+			return;
+		}
+
+		if (Ar.IsLoading())
+		{
+			while ((uint32)Records.Num() < NumRecords && !Ar.IsError())
+			{
+				uint32 Header = 0;
+				Ar.SerializeVarUInt(Header);
+				const uint32 Count = Header >> 1;
+				if (Count == 0 || Records.Num() + Count > NumRecords)
+				{
+					Ar.SetError();
+					return;
+				}
+
+				if (Header & 1)
+				{
+					uint32 BaseStart = 0;
+					Ar.SerializeVarUInt(BaseStart);
+					if ((uint64)BaseStart + Count > (uint64)BaseRecords->Num())
+					{
+						Ar.SetError();
+						return;
+					}
+					Records.Append(BaseRecords->GetData() + BaseStart, Count);
+				}
+				else
+				{
+					for (uint32 RecordIndex = 0; RecordIndex < Count && !Ar.IsError(); RecordIndex++)
+					{
+						Serialize(Ar, Records.AddDefaulted_GetRef());
+					}
+				}
+			}
+			return;
+		}
+
+		//Find a base record with the same bytes as each record, preferring the one after the last match.
+		TArray<TArray<uint8>> BaseBytes = TArray<TArray<uint8>>();
+		TMultiMap<uint32, int32> ChecksumsToBaseIndices = TMultiMap<uint32, int32>();
+		BaseBytes.Reserve(BaseRecords->Num());
+		for (const RecordType& EachBaseRecord : *BaseRecords)
+		{
+			const TArray<uint8>& Bytes = BaseBytes.Add_GetRef(ToBytes(Ar, EachBaseRecord));
+			ChecksumsToBaseIndices.Add(FCrc::MemCrc32(Bytes.GetData(), Bytes.Num()), BaseBytes.Num() - 1);
+		}
+
+		TArray<int32> Matches = TArray<int32>();
+		Matches.Reserve(Records.Num());
+		int32 LastMatch = INDEX_NONE;
+		TArray<int32> Candidates = TArray<int32>();
+		for (const RecordType& EachRecord : Records)
+		{
+			const TArray<uint8> Bytes = ToBytes(Ar, EachRecord);
+			int32 Match = INDEX_NONE;
+			if (BaseBytes.IsValidIndex(LastMatch + 1) && BaseBytes[LastMatch + 1] == Bytes)
+			{
+				Match = LastMatch + 1;
+			}
+			else
+			{
+				Candidates.Reset();
+				ChecksumsToBaseIndices.MultiFind(FCrc::MemCrc32(Bytes.GetData(), Bytes.Num()), Candidates, true);
+				for (int32 EachCandidate : Candidates)
+				{
+					if (BaseBytes[EachCandidate] == Bytes)
+					{
+						Match = EachCandidate;
+						break;
+					}
+				}
+			}
+
+			Matches.Add(Match);
+			if (Match != INDEX_NONE)
+			{
+				LastMatch = Match;
+			}
+		}
+
+		int32 RunStart = 0;
+		while (RunStart < Matches.Num())
+		{
+			const bool bCopy = Matches[RunStart] != INDEX_NONE;
+			int32 RunEnd = RunStart + 1;
+			while (RunEnd < Matches.Num() && (bCopy ? Matches[RunEnd] == Matches[RunEnd - 1] + 1 : Matches[RunEnd] == INDEX_NONE))
+			{
+				RunEnd++;
+			}
+
+			uint32 Header = ((uint32)(RunEnd - RunStart) << 1) | (bCopy ? 1 : 0);
+			Ar.SerializeVarUInt(Header);
+			if (bCopy)
+			{
+				uint32 BaseStart = Matches[RunStart];
+				Ar.SerializeVarUInt(BaseStart);
+			}
+			else
+			{
+				for (int32 RecordIndex = RunStart; RecordIndex < RunEnd; RecordIndex++)
+				{
+					Serialize(Ar, Records[RecordIndex]);
+				}
+			}
+			RunStart = RunEnd;
+		}
+	}
+}
+
 USyrupSaveGame::USyrupSaveGame()
 {
 	DynamicTileClasses = TArray<TSubclassOf<ATile>>();
@@ -23,32 +286,215 @@ USyrupSaveGame::USyrupSaveGame()
 }
 
 /**
- * Saves the entire world state.
+ * Saves the entire world state. Unless it is stored as differences, the save is written to its slot on a background
+ * task once the world is captured.
  * 
  * @param WorldContext - An object in the world to save.
  * @param SlotName - The name of the save slot to put the world in.
- * @param DynamicTileClasses - The classes of tile that will be spawned or destroyed during runtime.
+ * @param BaseSlotName - A save slot to store only the differences from, such as the previous night. Leave empty to store the whole world.
+ *                       A copy of the base is kept in its own slot until no save is stored as differences from it, so the base slot can be deleted afterwards.
  */
-void USyrupSaveGame::SaveGame(const UObject* WorldContext, const FString& SlotName)
+void USyrupSaveGame::SaveGame(const UObject* WorldContext, const FString& SlotName, const FString& BaseSlotName)
 {
-	if (!IsValid(WorldContext) || !IsValid(WorldContext->GetWorld()))
+	//The world is still captured now, so the save matches the moment it was requested. Saves storing differences read their base first, so they are written here.
+	UAsyncSaveSubsystem* AsyncSaveSubsystem = BaseSlotName.IsEmpty() && CVarBackgroundSaves.GetValueOnGameThread() ? UAsyncSaveSubsystem::Get(WorldContext) : nullptr;
+	if (IsValid(AsyncSaveSubsystem))
+	{
+		AsyncSaveSubsystem->SaveGameAsync(SlotName);
+		return;
+	}
+
+	USyrupSaveGame* Save = CaptureWorld(WorldContext);
+	if (!IsValid(Save))
 	{
 		return;
 	}
 
+	if (!CVarCompactSaves.GetValueOnGameThread())
+	{
+		if (UGameplayStatics::SaveGameToSlot(Save, SlotName, 0))
+		{
+			UpdatePinnedBaseReferences(SlotName, FString());
+		}
+		return;
+	}
+
+	//Only store differences from a base that can still be read afterwards.
+	TArray<uint8> BaseBytes = TArray<uint8>();
+	USyrupSaveGame* Base = nullptr;
+	if (!BaseSlotName.IsEmpty() && BaseSlotName != SlotName && UGameplayStatics::LoadDataFromSlot(BaseBytes, BaseSlotName, 0))
+	{
+		Base = LoadFromBytes(BaseBytes);
+		if (IsValid(Base) && Base->DeltaChainLength + 1 >= MAX_COMPACT_SAVE_DELTA_CHAIN)
+		{
+			Base = nullptr;
+		}
+	}
+
+	//Store the differences from a copy of the base in a slot named by its checksum. The base slot itself can then be
+	//deleted or overwritten, such as when autosaves are cleared, without breaking this save. Store everything if the
+	//copy can not be written.
+	const uint32 BaseChecksum = IsValid(Base) ? FCrc::MemCrc32(BaseBytes.GetData(), BaseBytes.Num()) : 0;
+	const FString PinnedBaseSlotName = IsValid(Base) ? FString::Printf(TEXT("%s%08X"), COMPACT_SAVE_PINNED_BASE_PREFIX, BaseChecksum) : FString();
+	if (IsValid(Base) && !UGameplayStatics::DoesSaveGameExist(PinnedBaseSlotName, 0) && !UGameplayStatics::SaveDataToSlot(BaseBytes, PinnedBaseSlotName, 0))
+	{
+		UE_LOG(LogSaveGame, Warning, TEXT("Could not keep a copy of %s to store differences from. Saving everything to %s instead."), *BaseSlotName, *SlotName);
+		Base = nullptr;
+	}
+
+	//The copy is stored as differences from whatever its original was, so it keeps that copy alive in turn.
+	if (IsValid(Base))
+	{
+		UpdatePinnedBaseReferences(PinnedBaseSlotName, GetCompactBaseSlotName(BaseBytes));
+	}
+
+	TArray<uint8> Bytes = TArray<uint8>();
+	Save->WriteCompact(Bytes, Base, IsValid(Base) ? PinnedBaseSlotName : FString(), BaseChecksum);
+	if (UGameplayStatics::SaveDataToSlot(Bytes, SlotName, 0))
+	{
+		UpdatePinnedBaseReferences(SlotName, IsValid(Base) ? PinnedBaseSlotName : FString());
+	}
+}
+
+/**
+ * Records which copy of a base a slot is stored as differences from, then deletes every copy no remaining save is
+ * stored as differences from. Copies are also deleted once the saves referencing them are deleted or overwritten,
+ * such as when a chain of differences reaches its longest and the whole world is stored again.
+ *
+ * @param SlotName - The slot that was just written.
+ * @param PinnedBaseSlotName - The copy of a base the slot is stored as differences from. Empty if it is stored in full.
+ */
+void USyrupSaveGame::UpdatePinnedBaseReferences(const FString& SlotName, const FString& PinnedBaseSlotName)
+{
+	TMap<FString, FString> References = TMap<FString, FString>();
+	TArray<uint8> ReferenceBytes = TArray<uint8>();
+	if (UGameplayStatics::LoadDataFromSlot(ReferenceBytes, COMPACT_SAVE_PINNED_BASE_REFERENCES_SLOT, 0))
+	{
+		FMemoryReader Reader = FMemoryReader(ReferenceBytes);
+		Reader << References;
+		if (Reader.IsError())
+		{
+			UE_LOG(LogSaveGame, Warning, TEXT("The record of which saves are stored as differences is corrupt. Copies of bases made before now will not be deleted."));
+			References.Empty();
+		}
+	}
+
+	//Copies of bases are always recorded, even when stored in full, so that they can be found once unused.
+	if (PinnedBaseSlotName.IsEmpty() && !SlotName.StartsWith(COMPACT_SAVE_PINNED_BASE_PREFIX))
+	{
+		References.Remove(SlotName);
+	}
+	else
+	{
+		References.Add(SlotName, PinnedBaseSlotName);
+	}
+
+	//Deleting a copy can leave the copy it was stored as differences from unused, so keep going until nothing changes.
+	bool bRemovedReference = true;
+	while (bRemovedReference)
+	{
+		bRemovedReference = false;
+
+		TSet<FString> ReferencedSlotNames = TSet<FString>();
+		for (const TPair<FString, FString>& Reference : References)
+		{
+			if (UGameplayStatics::DoesSaveGameExist(Reference.Key, 0))
+			{
+				ReferencedSlotNames.Add(Reference.Value);
+			}
+		}
+
+		for (TMap<FString, FString>::TIterator ReferenceIterator = References.CreateIterator(); ReferenceIterator; ++ReferenceIterator)
+		{
+			const FString& ReferencingSlotName = ReferenceIterator.Key();
+			const bool bUnusedCopy = ReferencingSlotName.StartsWith(COMPACT_SAVE_PINNED_BASE_PREFIX) && !ReferencedSlotNames.Contains(ReferencingSlotName);
+			if (bUnusedCopy)
+			{
+				UGameplayStatics::DeleteGameInSlot(ReferencingSlotName, 0);
+			}
+
+			if (bUnusedCopy || !UGameplayStatics::DoesSaveGameExist(ReferencingSlotName, 0))
+			{
+				ReferenceIterator.RemoveCurrent();
+				bRemovedReference = true;
+			}
+		}
+	}
+
+	if (References.Num() > 0)
+	{
+		ReferenceBytes.Reset();
+		FMemoryWriter Writer = FMemoryWriter(ReferenceBytes);
+		Writer << References;
+		UGameplayStatics::SaveDataToSlot(ReferenceBytes, COMPACT_SAVE_PINNED_BASE_REFERENCES_SLOT, 0);
+	}
+	else
+	{
+		UGameplayStatics::DeleteGameInSlot(COMPACT_SAVE_PINNED_BASE_REFERENCES_SLOT, 0);
+	}
+}
+
+/**
+ * Gets whether saves are written in the compact format instead of the generic save game format.
+ *
+ * @return Whether the compact format is used.
+ */
+bool USyrupSaveGame::IsCompactFormatEnabled()
+{
+	return CVarCompactSaves.GetValueOnAnyThread();
+}
+
+/**
+ * Stores the state of a world without writing it to a slot.
+ *
+ * @param WorldContext - An object in the world to save.
+ * @return The save holding the state of the world. Nullptr if the world is invalid.
+ */
+USyrupSaveGame* USyrupSaveGame::CaptureWorld(const UObject* WorldContext)
+{
+	if (!IsValid(WorldContext) || !IsValid(WorldContext->GetWorld()))
+	{
+		return nullptr;
+	}
+
 	USyrupSaveGame* Save = NewObject<USyrupSaveGame>();
 	UWorld* World = WorldContext->GetWorld();
+	Save->SaveVersion = SYRUP_SAVE_VERSION;
 
+	//Walk the world's actors once. The passes below only touch the tiles found.
+	TArray<const ATile*> Tiles = TArray<const ATile*>();
 	for (TActorIterator<ATile> EachTile(World); EachTile; ++EachTile)
 	{
-		Save->StoreTileData(*EachTile);
-		Save->StoreTileSinkData(*EachTile);
-		Save->StoreTileResourceData(*EachTile);
+		Tiles.Add(*EachTile);
+	}
+	Save->TileData.Reserve(Tiles.Num());
+	Save->TileIds.Reserve(Tiles.Num());
+
+	//Dynamic tiles are stored first so that static tiles can be given the ids after them, and sinks before resources so that resources can reference them.
+	for (const ATile* EachTile : Tiles)
+	{
+		Save->StoreTileData(EachTile);
+	}
+	for (const ATile* EachTile : Tiles)
+	{
+		Save->StoreTileSinkData(EachTile);
+	}
+	for (const ATile* EachTile : Tiles)
+	{
+		Save->StoreTileResourceData(EachTile);
+	}
+	APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(WorldContext, 0);
+	if (IsValid(PlayerPawn))
+	{
+		Save->PlayerLocation = PlayerPawn->GetActorLocation();
+	}
+	ASyrupGameMode* GameMode = Cast<ASyrupGameMode>(UGameplayStatics::GetGameMode(WorldContext));
+	if (IsValid(GameMode))
+	{
+		Save->DayNumber = GameMode->DayNumber;
 	}
-	Save->PlayerLocation = UGameplayStatics::GetPlayerPawn(WorldContext, 0)->GetActorLocation();
-	Save->DayNumber = Cast<ASyrupGameMode>(UGameplayStatics::GetGameMode(WorldContext))->DayNumber;
 
-	UGameplayStatics::SaveGameToSlot(Save, SlotName, 0);
+	return Save;
 }
 
 /**
@@ -60,29 +506,428 @@ void USyrupSaveGame::SaveGame(const UObject* WorldContext, const FString& SlotNa
  */
 void USyrupSaveGame::LoadGame(const UObject* WorldContext, const FString& SlotName)
 {
-	USyrupSaveGame* Save = Cast<USyrupSaveGame>(UGameplayStatics::LoadGameFromSlot(SlotName, 0));
+	//The slot may still be being written in the background.
+	UAsyncSaveSubsystem* AsyncSaveSubsystem = UAsyncSaveSubsystem::Get(WorldContext);
+	if (IsValid(AsyncSaveSubsystem))
+	{
+		AsyncSaveSubsystem->WaitForSaves();
+	}
+
+	USyrupSaveGame* Save = LoadFromSlot(SlotName);
 	if (!IsValid(Save) || !IsValid(WorldContext) || !IsValid(WorldContext->GetWorld()))
 	{
 		return;
 	}
+	if (Save->SaveVersion != SYRUP_SAVE_VERSION)
+	{
+		UE_LOG(LogSaveGame, Error, TEXT("Loading Failed: %s was saved with version %d but version %d is required."), *SlotName, Save->SaveVersion, SYRUP_SAVE_VERSION);
+		return;
+	}
 	Save->World = WorldContext->GetWorld();
 
+	//The actions taken before loading refer to tiles that are about to be destroyed.
+	UBoardHistorySubsystem* History = UBoardHistorySubsystem::Get(Save->World);
+	if (IsValid(History))
+	{
+		History->Clear();
+	}
+
+	//Hold back spawn triggers and other per tile notifications until the whole board is in place.
+	TUniquePtr<FSyrupLoadTransaction> Transaction = CVarBatchedLoads.GetValueOnGameThread() ? MakeUnique<FSyrupLoadTransaction>(Save->World) : nullptr;
+
 	Save->DestoryDynamicTiles();
 
-	Save->SpawnTiles();
+	Save->SpawnTiles(Transaction.Get());
+	Save->FindSinks();
 	Save->UpdateSinkAmounts();
 	Save->UpdateDamageTaken();
 	Save->AllocateResources();
 	Save->UpdateTrashfallLinks();
-	UGameplayStatics::GetPlayerPawn(WorldContext, 0)->SetActorLocation(Save->PlayerLocation);
-	Cast<ASyrupGameMode>(UGameplayStatics::GetGameMode(WorldContext))->DayNumber = Save->DayNumber;
+	if (Transaction)
+	{
+		Transaction->Commit();
+	}
+
+	APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(WorldContext, 0);
+	if (IsValid(PlayerPawn))
+	{
+		PlayerPawn->SetActorLocation(Save->PlayerLocation);
+	}
+	ASyrupGameMode* GameMode = Cast<ASyrupGameMode>(UGameplayStatics::GetGameMode(WorldContext));
+	if (IsValid(GameMode))
+	{
+		GameMode->DayNumber = Save->DayNumber;
+	}
+}
+
+/* ------------------- *\
+\* \/ Compact Format \/ */
+
+/**
+ * Writes this in the compact format. Only reads the records of this and the base, so it can be called from another
+ * thread as long as every object they reference is already in the object table and neither save is changed meanwhile.
+ *
+ * @param OutBytes - Will be set to the bytes of the save.
+ * @param Base - The save to only store the differences from. Nullptr to store everything.
+ * @param BaseSlotName - The slot the base save is stored in.
+ * @param BaseChecksum - The checksum of the bytes stored in the base slot.
+ * @param ObjectTable - The table to write objects to, such as one filled by CollectObjects. Nullptr to use a new one.
+ */
+void USyrupSaveGame::WriteCompact(TArray<uint8>& OutBytes, const USyrupSaveGame* Base, const FString& BaseSlotName, const uint32 BaseChecksum, FSyrupSaveObjectTable* ObjectTable)
+{
+	FSyrupSaveObjectTable NewObjectTable = FSyrupSaveObjectTable();
+	FSyrupSaveObjectTable& Objects = ObjectTable ? *ObjectTable : NewObjectTable;
+
+	//Write the record sections first so that the object table is complete before it is written ahead of them.
+	TArray<TArray<uint8>> SectionBytes = TArray<TArray<uint8>>();
+	SectionBytes.SetNum((uint8)ESyrupSaveSection::Num);
+	for (uint8 SectionIndex = (uint8)ESyrupSaveSection::Objects + 1; SectionIndex < (uint8)ESyrupSaveSection::Num; SectionIndex++)
+	{
+		FMemoryWriter SectionWriter = FMemoryWriter(SectionBytes[SectionIndex]);
+		FSyrupSaveArchive SectionArchive = FSyrupSaveArchive(SectionWriter, Objects);
+		SerializeCompactSection(SectionArchive, (ESyrupSaveSection)SectionIndex, Base);
+	}
+	{
+		FMemoryWriter SectionWriter = FMemoryWriter(SectionBytes[(uint8)ESyrupSaveSection::Objects]);
+		FSyrupSaveArchive SectionArchive = FSyrupSaveArchive(SectionWriter, Objects);
+		SerializeCompactSection(SectionArchive, ESyrupSaveSection::Objects, Base);
+	}
+
+	TArray<uint8> BodyBytes = TArray<uint8>();
+	{
+		FMemoryWriter BodyWriter = FMemoryWriter(BodyBytes);
+		FSyrupSaveArchive BodyArchive = FSyrupSaveArchive(BodyWriter, Objects);
+		uint32 NumSections = SectionBytes.Num();
+		BodyArchive.SerializeVarUInt(NumSections);
+		for (uint8 SectionIndex = 0; SectionIndex < (uint8)ESyrupSaveSection::Num; SectionIndex++)
+		{
+			uint8 SectionId = SectionIndex;
+			uint8 SectionVersion = COMPACT_SAVE_SECTION_VERSIONS[SectionIndex];
+			uint32 SectionLength = SectionBytes[SectionIndex].Num();
+			BodyArchive << SectionId;
+			BodyArchive << SectionVersion;
+			BodyArchive.SerializeVarUInt(SectionLength);
+			BodyArchive.Serialize(SectionBytes[SectionIndex].GetData(), SectionLength);
+		}
+	}
+
+	//Fall back to storing the sections as they are if compressing them does not make them smaller.
+	TArray<uint8> CompressedBytes = TArray<uint8>();
+	if (CVarCompressSaves.GetValueOnAnyThread())
+	{
+		int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, BodyBytes.Num());
+		CompressedBytes.SetNumUninitialized(CompressedSize);
+		if (FCompression::CompressMemory(NAME_Zlib, CompressedBytes.GetData(), CompressedSize, BodyBytes.GetData(), BodyBytes.Num()) && CompressedSize < BodyBytes.Num())
+		{
+			CompressedBytes.SetNum(CompressedSize);
+		}
+		else
+		{
+			CompressedBytes.Reset();
+		}
+	}
+
+	OutBytes.Reset();
+	FMemoryWriter Writer = FMemoryWriter(OutBytes);
+	FSyrupSaveArchive Archive = FSyrupSaveArchive(Writer, Objects);
+	uint32 Magic = COMPACT_SAVE_MAGIC;
+	uint16 FormatVersion = COMPACT_SAVE_FORMAT_VERSION;
+	uint8 Flags = (IsValid(Base) ? COMPACT_SAVE_FLAG_DELTA : 0) | (!CompressedBytes.IsEmpty() ? COMPACT_SAVE_FLAG_COMPRESSED : 0);
+	Archive << Magic;
+	Archive << FormatVersion;
+	Archive << Flags;
+	if (Flags & COMPACT_SAVE_FLAG_DELTA)
+	{
+		FString BaseSlot = BaseSlotName;
+		uint32 Checksum = BaseChecksum;
+		Archive << BaseSlot;
+		Archive << Checksum;
+	}
+
+	if (Flags & COMPACT_SAVE_FLAG_COMPRESSED)
+	{
+		uint32 UncompressedSize = BodyBytes.Num();
+		Archive.SerializeVarUInt(UncompressedSize);
+		Archive.Serialize(CompressedBytes.GetData(), CompressedBytes.Num());
+	}
+	else
+	{
+		Archive.Serialize(BodyBytes.GetData(), BodyBytes.Num());
+	}
 }
 
+/**
+ * Adds every object referenced by the records of this to an object table.
+ *
+ * @param ObjectTable - The table to add the objects to.
+ */
+void USyrupSaveGame::CollectObjects(FSyrupSaveObjectTable& ObjectTable) const
+{
+	for (const FTileSaveData& EachTileData : TileData)
+	{
+		ObjectTable.Add(EachTileData.TileClass.Get());
+	}
+	for (const FTrashfallSaveData& EachTrashfallData : TrashfallData)
+	{
+		ObjectTable.Add(EachTrashfallData.Volume);
+	}
+}
+
+/**
+ * Reads a save from a slot in either the compact or the generic format.
+ *
+ * @param SlotName - The slot to read.
+ * @return The save that was read. Nullptr if it could not be read.
+ */
+USyrupSaveGame* USyrupSaveGame::LoadFromSlot(const FString& SlotName)
+{
+	TArray<uint8> Bytes = TArray<uint8>();
+	if (!UGameplayStatics::LoadDataFromSlot(Bytes, SlotName, 0))
+	{
+		return nullptr;
+	}
+	return LoadFromBytes(Bytes);
+}
+
+/**
+ * Reads a save in either the compact or the generic format.
+ *
+ * @param Bytes - The bytes of the save.
+ * @param DeltaDepth - The number of saves that depend on this one being read.
+ * @return The save that was read. Nullptr if it could not be read.
+ */
+USyrupSaveGame* USyrupSaveGame::LoadFromBytes(const TArray<uint8>& Bytes, const int32 DeltaDepth)
+{
+	if (Bytes.Num() >= sizeof(uint32) && FMemory::Memcmp(Bytes.GetData(), &COMPACT_SAVE_MAGIC, sizeof(uint32)) == 0)
+	{
+		return ReadCompact(Bytes, DeltaDepth);
+	}
+	return Cast<USyrupSaveGame>(UGameplayStatics::LoadGameFromMemory(Bytes));
+}
+
+/**
+ * Gets the slot a save in the compact format is stored as differences from.
+ *
+ * @param Bytes - The bytes of the save.
+ * @return The name of the slot holding the base of the save. Empty if it is stored in full or is not a compact save.
+ */
+FString USyrupSaveGame::GetCompactBaseSlotName(const TArray<uint8>& Bytes)
+{
+	FMemoryReader Reader = FMemoryReader(Bytes);
+	uint32 Magic = 0;
+	uint16 FormatVersion = 0;
+	uint8 Flags = 0;
+	Reader << Magic;
+	Reader << FormatVersion;
+	Reader << Flags;
+	if (Reader.IsError() || Magic != COMPACT_SAVE_MAGIC || !(Flags & COMPACT_SAVE_FLAG_DELTA))
+	{
+		return FString();
+	}
+
+	FString BaseSlotName = FString();
+	Reader << BaseSlotName;
+	return Reader.IsError() ? FString() : BaseSlotName;
+}
+
+/**
+ * Reads a save in the compact format.
+ *
+ * @param Bytes - The bytes of the save.
+ * @param DeltaDepth - The number of saves that depend on this one being read.
+ * @return The save that was read. Nullptr if it could not be read.
+ */
+USyrupSaveGame* USyrupSaveGame::ReadCompact(const TArray<uint8>& Bytes, const int32 DeltaDepth)
+{
+	FSyrupSaveObjectTable ObjectTable = FSyrupSaveObjectTable();
+	FMemoryReader Reader = FMemoryReader(Bytes);
+	FSyrupSaveArchive Archive = FSyrupSaveArchive(Reader, ObjectTable);
+	uint32 Magic = 0;
+	uint16 FormatVersion = 0;
+	uint8 Flags = 0;
+	Archive << Magic;
+	Archive << FormatVersion;
+	Archive << Flags;
+	if (Reader.IsError() || Archive.IsError() || Magic != COMPACT_SAVE_MAGIC)
+	{
+		UE_LOG(LogSaveGame, Error, TEXT("Loading Failed: Save is corrupt or is not a compact save."));
+		return nullptr;
+	}
+	if (FormatVersion > COMPACT_SAVE_FORMAT_VERSION)
+	{
+		UE_LOG(LogSaveGame, Error, TEXT("Loading Failed: Compact save format version %d is newer than this build supports."), FormatVersion);
+		return nullptr;
+	}
+	if (Flags & ~(COMPACT_SAVE_FLAG_DELTA | COMPACT_SAVE_FLAG_COMPRESSED))
+	{
+		UE_LOG(LogSaveGame, Error, TEXT("Loading Failed: Save uses unknown header flags %d."), Flags);
+		return nullptr;
+	}
+
+	USyrupSaveGame* Base = nullptr;
+	if (Flags & COMPACT_SAVE_FLAG_DELTA)
+	{
+		FString BaseSlotName = FString();
+		uint32 BaseChecksum = 0;
+		Archive << BaseSlotName;
+		Archive << BaseChecksum;
+
+		TArray<uint8> BaseBytes = TArray<uint8>();
+		if (DeltaDepth >= MAX_COMPACT_SAVE_DELTA_CHAIN || !UGameplayStatics::LoadDataFromSlot(BaseBytes, BaseSlotName, 0) || FCrc::MemCrc32(BaseBytes.GetData(), BaseBytes.Num()) != BaseChecksum)
+		{
+			UE_LOG(LogSaveGame, Error, TEXT("Loading Failed: The save this was stored as differences from in %s is missing or has been overwritten."), *BaseSlotName);
+			return nullptr;
+		}
+
+		Base = LoadFromBytes(BaseBytes, DeltaDepth + 1);
+		if (!IsValid(Base))
+		{
+			return nullptr;
+		}
+	}
+
+	//The sections follow the header, compressed as a whole if the save was written with compression.
+	TArray<uint8> BodyBytes = TArray<uint8>();
+	uint32 UncompressedSize = 0;
+	if (Flags & COMPACT_SAVE_FLAG_COMPRESSED)
+	{
+		Archive.SerializeVarUInt(UncompressedSize);
+	}
+	const int64 BodyOffset = Reader.Tell();
+	if (Reader.IsError() || Archive.IsError() || BodyOffset > Bytes.Num() || UncompressedSize > MAX_COMPACT_SAVE_SIZE)
+	{
+		UE_LOG(LogSaveGame, Error, TEXT("Loading Failed: Save is corrupt."));
+		return nullptr;
+	}
+	if (Flags & COMPACT_SAVE_FLAG_COMPRESSED)
+	{
+		BodyBytes.SetNumUninitialized(UncompressedSize);
+		if (!FCompression::UncompressMemory(NAME_Zlib, BodyBytes.GetData(), UncompressedSize, Bytes.GetData() + BodyOffset, Bytes.Num() - BodyOffset))
+		{
+			UE_LOG(LogSaveGame, Error, TEXT("Loading Failed: Save could not be decompressed."));
+			return nullptr;
+		}
+	}
+	else
+	{
+		BodyBytes.Append(Bytes.GetData() + BodyOffset, Bytes.Num() - BodyOffset);
+	}
+
+	FMemoryReader BodyReader = FMemoryReader(BodyBytes);
+	FSyrupSaveArchive BodyArchive = FSyrupSaveArchive(BodyReader, ObjectTable);
+	USyrupSaveGame* Save = NewObject<USyrupSaveGame>();
+	Save->DeltaChainLength = IsValid(Base) ? Base->DeltaChainLength + 1 : 0;
+	uint32 NumSections = 0;
+	BodyArchive.SerializeVarUInt(NumSections);
+	for (uint32 SectionIndex = 0; SectionIndex < NumSections && !BodyReader.IsError() && !BodyArchive.IsError(); SectionIndex++)
+	{
+		uint8 SectionId = 0;
+		uint8 SectionVersion = 0;
+		uint32 SectionLength = 0;
+		BodyArchive << SectionId;
+		BodyArchive << SectionVersion;
+		BodyArchive.SerializeVarUInt(SectionLength);
+		if (SectionLength > (uint32)(BodyReader.TotalSize() - BodyReader.Tell()))
+		{
+			break;
+		}
+
+		TArray<uint8> SectionBytes = TArray<uint8>();
+		SectionBytes.SetNumUninitialized(SectionLength);
+		BodyArchive.Serialize(SectionBytes.GetData(), SectionLength);
+
+		//Sections added by newer builds are skipped, but a newer version of a known section can't be read.
+		if (SectionId >= (uint8)ESyrupSaveSection::Num)
+		{
+			continue;
+		}
+		if (SectionVersion > COMPACT_SAVE_SECTION_VERSIONS[SectionId])
+		{
+			UE_LOG(LogSaveGame, Error, TEXT("Loading Failed: Save section %d version %d is newer than this build supports."), SectionId, SectionVersion);
+			return nullptr;
+		}
+
+		FMemoryReader SectionReader = FMemoryReader(SectionBytes);
+		FSyrupSaveArchive SectionArchive = FSyrupSaveArchive(SectionReader, ObjectTable);
+		Save->SerializeCompactSection(SectionArchive, (ESyrupSaveSection)SectionId, Base);
+		if (SectionReader.IsError() || SectionArchive.IsError())
+		{
+			UE_LOG(LogSaveGame, Error, TEXT("Loading Failed: Save section %d is corrupt."), SectionId);
+			return nullptr;
+		}
+	}
+
+	if (BodyReader.IsError() || BodyArchive.IsError())
+	{
+		UE_LOG(LogSaveGame, Error, TEXT("Loading Failed: Save is corrupt."));
+		return nullptr;
+	}
+	return Save;
+}
+
+/**
+ * Reads or writes one section of the compact format.
+ *
+ * @param Ar - The archive holding the section.
+ * @param Section - The section to read or write.
+ * @param Base - The save records are stored as differences from. Nullptr if they are stored in full.
+ */
+void USyrupSaveGame::SerializeCompactSection(FSyrupSaveArchive& Ar, const ESyrupSaveSection Section, const USyrupSaveGame* Base)
+{
+	switch (Section)
+	{
+	case ESyrupSaveSection::Objects:
+	{
+		TArray<FSoftObjectPath>& Paths = Ar.GetObjectTable().Paths;
+		uint32 NumPaths = Paths.Num();
+		Ar.SerializeVarUInt(NumPaths);
+		for (uint32 PathIndex = 0; PathIndex < NumPaths && !Ar.IsError(); PathIndex++)
+		{
+			FString Path = Ar.IsLoading() ? FString() : Paths[PathIndex].ToString();
+			Ar << Path;
+			if (Ar.IsLoading())
+			{
+				Paths.Add(FSoftObjectPath(Path));
+			}
+		}
+		break;
+	}
+	case ESyrupSaveSection::Meta:
+		Ar.SerializeVarInt(SaveVersion);
+		Ar.SerializeVarInt(DayNumber);
+		Ar << PlayerLocation;
+		break;
+	case ESyrupSaveSection::Tiles:
+		SyrupSaveRecords::SerializeRecords(Ar, TileData, IsValid(Base) ? &Base->TileData : nullptr);
+		break;
+	case ESyrupSaveSection::StaticTiles:
+		SyrupSaveRecords::SerializeRecords(Ar, StaticTileLocations, IsValid(Base) ? &Base->StaticTileLocations : nullptr);
+		break;
+	case ESyrupSaveSection::Sinks:
+		SyrupSaveRecords::SerializeRecords(Ar, SinkData, IsValid(Base) ? &Base->SinkData : nullptr);
+		break;
+	case ESyrupSaveSection::Resources:
+		SyrupSaveRecords::SerializeRecords(Ar, ResourceData, IsValid(Base) ? &Base->ResourceData : nullptr);
+		break;
+	case ESyrupSaveSection::DamageTaken:
+		SyrupSaveRecords::SerializeRecords(Ar, DamageTakenData, IsValid(Base) ? &Base->DamageTakenData : nullptr);
+		break;
+	case ESyrupSaveSection::Trashfall:
+		SyrupSaveRecords::SerializeRecords(Ar, TrashfallData, IsValid(Base) ? &Base->TrashfallData : nullptr);
+		break;
+	default:
+		break;
+	}
+}
+
+/* /\ Compact Format /\ *\
+\* ------------------- */
+
 /* -------------------- *\
 \* \/ Saving Helpers \/ */
 
 /**
- * Stores a tile's class & transform.
+ * Stores a tile's class & transform if it is dynamic, giving it an id.
  *
  * @param Tile - The tile whose data to store.
  */
@@ -93,19 +938,20 @@ void USyrupSaveGame::StoreTileData(const ATile* Tile)
 		if (Tile->IsA(EachDynamicTileClass.Get()))
 		{
 			TSubclassOf<ATile> TileClass = Tile->GetClass();
-			TileData.Add(FTileSaveData(Tile->GetGridTransform(), TileClass));
+			const int32 TileId = TileData.Add(FTileSaveData(Tile->GetGridTransform(), TileClass));
+			TileIds.Add(Tile, TileId);
 
 			if (Tile->IsA(APlant::StaticClass()))
 			{
 				const APlant* Plant = Cast<APlant>(Tile);
-				DamageTakenData.Add(FDamageTakenSaveData(Tile->GetGridTransform().Location, Plant->GetDamageTaken()));
+				DamageTakenData.Add(FDamageTakenSaveData(TileId, Plant->GetDamageTaken()));
 			}
 			else if (Tile->IsA(ATrash::StaticClass()))
 			{
 				ATrashfallVolume* ParentVolume = Cast<ATrashfallVolume>(Tile->GetRootComponent()->GetAttachParentActor());
 				if (IsValid(ParentVolume))
 				{
-					TrashfallData.Add(FTrashfallSaveData(Tile->GetGridTransform().Location, ParentVolume));
+					TrashfallData.Add(FTrashfallSaveData(TileId, ParentVolume));
 				}
 			}
 			return;
@@ -114,29 +960,30 @@ void USyrupSaveGame::StoreTileData(const ATile* Tile)
 }
 
 /**
- * Stores a tile's resources.
+ * Stores a tile's resources. Must be called after the sinks of every tile are stored.
  * 
  * @param Tile - The tile whose produced resources should be saved.
  */
 void USyrupSaveGame::StoreTileResourceData(const ATile* Tile)
 {
-	if (const IResourceFaucet* EachFaucet = Cast<IResourceFaucet>(Tile))
+	const UResourcePool* Pool = UResourcePool::Get(Tile);
+	if (const IResourceFaucet* EachFaucet = IsValid(Pool) ? Cast<IResourceFaucet>(Tile) : nullptr)
 	{
-		FResourceSaveData DataToSave = FResourceSaveData(Tile->GetGridTransform().Location);
-		for (UResource* EachProducedResource : EachFaucet->GetProducedResources())
+		for (const FResourceHandle& EachProducedResource : EachFaucet->GetProducedResourceHandles())
 		{
-			if (EachProducedResource->IsAllocated())
+			if (Pool->IsAllocated(EachProducedResource))
 			{
-				const UResourceSink* LinkedSink = EachProducedResource->GetLinkedSink();
-				TScriptInterface<IResourceFaucet> LinkedFaucet;
-				EachProducedResource->GetLinkedFaucet(LinkedFaucet);
+				const UResourceSink* LinkedSink = Pool->GetSink(EachProducedResource);
+				const UObject* LinkedFaucet = Pool->GetFaucet(EachProducedResource);
 
-				DataToSave.FaucetLocation = Cast<ATile>(LinkedFaucet.GetObject())->GetGridTransform().Location;
-				DataToSave.SinkLocation = LinkedSink->GetOwner<ATile>()->GetGridTransform().Location;
-				DataToSave.SinkName = LinkedSink->GetFName();
-				DataToSave.Type = EachProducedResource->GetType();
+				const int32* SinkId = SinkIds.Find(LinkedSink);
+				if (!SinkId)
+				{
+					UE_LOG(LogSaveGame, Warning, TEXT("Saving: Skipping resource of %s allocated to a sink that is not on a tile."), *Tile->GetName());
+					continue;
+				}
 
-				ResourceData.Add(DataToSave);
+				ResourceData.Add(FResourceSaveData(GetTileId(Cast<ATile>(LinkedFaucet)), *SinkId, Pool->GetType(EachProducedResource)));
 			}
 		}
 	}
@@ -151,12 +998,42 @@ void USyrupSaveGame::StoreTileSinkData(const ATile* Tile)
 {
 	TArray<UResourceSink*> Sinks;
 	Tile->GetComponents<UResourceSink>(Sinks);
-	for (UResourceSink* EachSink : Sinks)
+	if (Sinks.IsEmpty())
 	{
-		SinkData.Add(FSinkSaveData(Tile->GetGridTransform().Location, EachSink->GetFName(), EachSink->GetAllocationAmount()));
+		return;
+	}
+
+	const int32 TileId = GetTileId(Tile);
+	for (int32 SinkIndex = 0; SinkIndex < Sinks.Num(); SinkIndex++)
+	{
+		SinkIds.Add(Sinks[SinkIndex], SinkData.Add(FSinkSaveData(TileId, SinkIndex, Sinks[SinkIndex]->GetAllocationAmount())));
 	}
 }
 
+/**
+ * Gets the id of a tile, giving it one if it is not dynamic and does not have one yet. Must be called after every
+ * dynamic tile is stored.
+ *
+ * @param Tile - The tile to get the id of.
+ * @return The id of the tile. INDEX_NONE if the tile is invalid.
+ */
+int32 USyrupSaveGame::GetTileId(const ATile* Tile)
+{
+	if (!IsValid(Tile))
+	{
+		return INDEX_NONE;
+	}
+
+	if (const int32* ExistingId = TileIds.Find(Tile))
+	{
+		return *ExistingId;
+	}
+
+	const int32 TileId = TileData.Num() + StaticTileLocations.Add(Tile->GetGridTransform().Location);
+	TileIds.Add(Tile, TileId);
+	return TileId;
+}
+
 /* /\ Saving Helpers /\ *\
 \* -------------------- */
 
@@ -185,16 +1062,67 @@ void USyrupSaveGame::DestoryDynamicTiles() const
 }
 
 /**
- * Spawns the tiles from the data stored.
+ * Spawns the tiles from the data stored and finds the static tiles that were given ids.
+ *
+ * @param Transaction - The transaction to spawn the tiles through. Nullptr to spawn each tile on its own.
  */
-void USyrupSaveGame::SpawnTiles()
+void USyrupSaveGame::SpawnTiles(FSyrupLoadTransaction* Transaction)
 {
+	TilesById.Reset(TileData.Num() + StaticTileLocations.Num());
 	for (FTileSaveData EachTileDatum : TileData)
 	{
 		FTransform ActorTranfrom = UGridLibrary::GridTransformToWorldTransform(EachTileDatum.TileTransfrom);
-		ATile* NewTile = World->SpawnActor<ATile>(EachTileDatum.TileClass, ActorTranfrom);
+		TilesById.Add(Transaction ? Transaction->SpawnTileDeferred(EachTileDatum.TileClass, ActorTranfrom) : World->SpawnActor<ATile>(EachTileDatum.TileClass, ActorTranfrom));
+	}
+	if (Transaction)
+	{
+		//Every dynamic tile exists before any of them begins play. Sinks are only found once they have.
+		Transaction->FinishSpawning();
+	}
+
+	//Static tiles are looked up once here so that every other record can index them directly.
+	UGridOccupancySubsystem* Occupancy = UGridOccupancySubsystem::Get(World);
+	for (FIntPoint EachLocation : StaticTileLocations)
+	{
+		ATile* StaticTile = IsValid(Occupancy) ? Occupancy->GetTileAtLocation(EachLocation) : nullptr;
+		if (!IsValid(StaticTile))
+		{
+			UE_LOG(LogSaveGame, Error, TEXT("Loading Failed: Can't find static tile at %s."), *EachLocation.ToString());
+		}
+		TilesById.Add(StaticTile);
+	}
+}
 
-		LocationsToTiles.Add(EachTileDatum.TileTransfrom.Location, NewTile);
+/**
+ * Finds the sinks from the data stored.
+ */
+void USyrupSaveGame::FindSinks()
+{
+	SinksById.Reset(SinkData.Num());
+
+	//The sinks of a tile are stored next to each other, so only get the components of each tile once.
+	const ATile* LastOwner = nullptr;
+	TArray<UResourceSink*> OwnerSinks = TArray<UResourceSink*>();
+	for (const FSinkSaveData& EachSinkDatum : SinkData)
+	{
+		const ATile* Owner = GetTile(EachSinkDatum.TileId);
+		if (Owner != LastOwner)
+		{
+			OwnerSinks.Reset();
+			if (IsValid(Owner))
+			{
+				Owner->GetComponents<UResourceSink>(OwnerSinks);
+			}
+			LastOwner = Owner;
+		}
+
+		if (!OwnerSinks.IsValidIndex(EachSinkDatum.SinkIndex))
+		{
+			UE_LOG(LogSaveGame, Error, TEXT("Loading Failed: Sink %d not found on tile %d."), EachSinkDatum.SinkIndex, EachSinkDatum.TileId);
+			SinksById.Add(nullptr);
+			continue;
+		}
+		SinksById.Add(OwnerSinks[EachSinkDatum.SinkIndex]);
 	}
 }
 
@@ -205,10 +1133,10 @@ void USyrupSaveGame::UpdateDamageTaken() const
 {
 	for (FDamageTakenSaveData EachDamageTakenDatum : DamageTakenData)
 	{
-		APlant* Plant = Cast<APlant>(GetTileAtLocation(EachDamageTakenDatum.Location));
+		APlant* Plant = Cast<APlant>(GetTile(EachDamageTakenDatum.TileId));
 		if (!IsValid(Plant))
 		{
-			UE_LOG(LogSaveGame, Error, TEXT("Loading Failed: Can't find damaged plant at %s."), *EachDamageTakenDatum.Location.ToString());
+			UE_LOG(LogSaveGame, Error, TEXT("Loading Failed: Can't find damaged plant %d."), EachDamageTakenDatum.TileId);
 			continue;
 		}
 		Plant->SetDamageTaken(EachDamageTakenDatum.Amount);
@@ -220,28 +1148,13 @@ void USyrupSaveGame::UpdateDamageTaken() const
  */
 void USyrupSaveGame::UpdateSinkAmounts() const
 {
-	for (FSinkSaveData EachSinkDatum : SinkData)
+	for (int32 SinkId = 0; SinkId < SinkData.Num(); SinkId++)
 	{
-		AActor* Owner = GetTileAtLocation(EachSinkDatum.Location);
-		if (!IsValid(Owner))
-		{
-			UE_LOG(LogSaveGame, Error, TEXT("Loading Failed: Sink %s Owner not found at %s"), *EachSinkDatum.Name.ToString(), *EachSinkDatum.Location.ToString());
-		}
-
-		TArray<UResourceSink*> Sinks;
-		Owner->GetComponents<UResourceSink>(Sinks);
-
-		for (UResourceSink* EachSink : Sinks)
+		UResourceSink* Sink = GetSink(SinkId);
+		if (IsValid(Sink))
 		{
-			if (EachSink->GetFName() == EachSinkDatum.Name)
-			{
-				EachSink->SetAllocationAmount(EachSinkDatum.StoredAmount);
-				goto nextLoop;
-			}
+			Sink->SetAllocationAmount(SinkData[SinkId].StoredAmount);
 		}
-		UE_LOG(LogSaveGame, Error, TEXT("Loading Failed: Sink %s not found on %s"), *EachSinkDatum.Name.ToString(), *Owner->GetName());
-	nextLoop:
-		;
 	}
 }
 
@@ -250,49 +1163,38 @@ void USyrupSaveGame::UpdateSinkAmounts() const
  */
 void USyrupSaveGame::AllocateResources() const
 {
+	const UResourcePool* Pool = UResourcePool::Get(World);
+	if (!IsValid(Pool))
+	{
+		return;
+	}
+
 	for (FResourceSaveData ResourceDatum : ResourceData)
 	{
-		IResourceFaucet* Faucet = Cast<IResourceFaucet>(GetTileAtLocation(ResourceDatum.FaucetLocation));
+		IResourceFaucet* Faucet = Cast<IResourceFaucet>(GetTile(ResourceDatum.FaucetId));
 		if (!Faucet)
 		{
-			UE_LOG(LogSaveGame, Error, TEXT("Loading Failed: Allocating resource from %s to the %s at %s failed to find faucet."), *ResourceDatum.FaucetLocation.ToString(), *ResourceDatum.SinkName.ToString(), *ResourceDatum.SinkLocation.ToString());
-			continue;
-		}
-
-		ATile* SinkOwner = GetTileAtLocation(ResourceDatum.SinkLocation);
-		if (!IsValid(SinkOwner))
-		{
-			UE_LOG(LogSaveGame, Error, TEXT("Loading Failed: Allocating resource from %s to the %s at %s failed to find sink owner."), *ResourceDatum.FaucetLocation.ToString(), *ResourceDatum.SinkName.ToString(), *ResourceDatum.SinkLocation.ToString());
+			UE_LOG(LogSaveGame, Error, TEXT("Loading Failed: Allocating resource from tile %d to sink %d failed to find faucet."), ResourceDatum.FaucetId, ResourceDatum.SinkId);
 			continue;
 		}
 
-		UResourceSink* Sink = nullptr;
-		TArray<UResourceSink*> Sinks;
-		SinkOwner->GetComponents<UResourceSink>(Sinks);
-		for (UResourceSink* EachSink : Sinks)
-		{
-			if (EachSink->GetFName() == ResourceDatum.SinkName)
-			{
-				Sink = EachSink;
-				break;
-			}
-		}
+		UResourceSink* Sink = GetSink(ResourceDatum.SinkId);
 		if (!IsValid(Sink))
 		{
-			UE_LOG(LogSaveGame, Error, TEXT("Loading Failed: Allocating resource from %s to the %s at %s failed to find sink."), *ResourceDatum.FaucetLocation.ToString(), *ResourceDatum.SinkName.ToString(), *ResourceDatum.SinkLocation.ToString());
+			UE_LOG(LogSaveGame, Error, TEXT("Loading Failed: Allocating resource from tile %d to sink %d failed to find sink."), ResourceDatum.FaucetId, ResourceDatum.SinkId);
 			continue;
 		}
 
-		UResource* ResourceToAllocate = nullptr;
-		for (UResource* EachProducedResource : Faucet->GetProducedResources())
+		FResourceHandle ResourceToAllocate = FResourceHandle();
+		for (const FResourceHandle& EachProducedResource : Faucet->GetProducedResourceHandles())
 		{
-			if (!EachProducedResource->IsAllocated() && EachProducedResource->GetType() == ResourceDatum.Type)
+			if (!Pool->IsAllocated(EachProducedResource) && Pool->GetType(EachProducedResource) == ResourceDatum.Type)
 			{
 				ResourceToAllocate = EachProducedResource;
 				break;
 			}
 		}
-		if (!IsValid(ResourceToAllocate))
+		if (!ResourceToAllocate.IsSet())
 		{
 			ResourceToAllocate = Faucet->ProduceResource(ResourceDatum.Type);
 		}
@@ -315,30 +1217,21 @@ void USyrupSaveGame::UpdateTrashfallLinks() const
 {
 	for (FTrashfallSaveData EachTrashfallDatum : TrashfallData)
 	{
-		if (IsValid(EachTrashfallDatum.Volume))
+		if (!IsValid(EachTrashfallDatum.Volume))
 		{
-			EachTrashfallDatum.Volume->ClaimTrash(Cast<ATrash>(GetTileAtLocation(EachTrashfallDatum.TrashLocation)));
+			UE_LOG(LogSaveGame, Error, TEXT("Loading Failed: Cant find trashfall volume"))
+			continue;
 		}
-		else
+
+		ATrash* Trash = Cast<ATrash>(GetTile(EachTrashfallDatum.TrashId));
+		if (!IsValid(Trash))
 		{
-			UE_LOG(LogSaveGame, Error, TEXT("Loading Failed: Cant find trashfall volume"))
+			UE_LOG(LogSaveGame, Error, TEXT("Loading Failed: Tile %d claimed by %s is not trash"), EachTrashfallDatum.TrashId, *EachTrashfallDatum.Volume->GetName());
+			continue;
 		}
-	}
-}
 
-/**
- * Gets the tile at a given location.
- */
-ATile* USyrupSaveGame::GetTileAtLocation(const FIntPoint& LocationToSearch) const
-{
-	if (LocationsToTiles.Contains(LocationToSearch))
-	{
-		return LocationsToTiles.FindRef(LocationToSearch);
+		EachTrashfallDatum.Volume->ClaimTrash(Trash);
 	}
-
-	ATile* ReturnValue;
-	UGridLibrary::OverlapGridLocation(World, LocationToSearch, ReturnValue, TArray<AActor*>());
-	return ReturnValue;
 }
 
 /* /\ Loading Helpers /\ *\
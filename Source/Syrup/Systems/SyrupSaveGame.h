@@ -12,8 +12,33 @@
 #include "GameFramework/SaveGame.h"
 #include "SyrupSaveGame.generated.h"
 
+class ATile;
+class UResourceSink;
+class FSyrupSaveArchive;
+struct FSyrupSaveObjectTable;
+class FSyrupLoadTransaction;
+
 DECLARE_LOG_CATEGORY_EXTERN(LogSaveGame, Log, All);
 
+//The version of the save format written by this build. Saves with a different version can't be loaded.
+constexpr int32 SYRUP_SAVE_VERSION = 1;
+
+/**
+ * The sections of a compact save. Sections are written in this order and a reader skips any it does not know.
+ */
+enum class ESyrupSaveSection : uint8
+{
+	Objects,
+	Meta,
+	Tiles,
+	StaticTiles,
+	Sinks,
+	Resources,
+	DamageTaken,
+	Trashfall,
+	Num
+};
+
 /**
  * 
  */
@@ -26,14 +51,25 @@ public:
 	USyrupSaveGame();
 
 	/**
-	 * Saves the entire world state.
+	 * Saves the entire world state. Unless it is stored as differences, the save is written to its slot on a background
+	 * task once the world is captured.
 	 * 
 	 * @param WorldContext - An object in the world to save.
 	 * @param SlotName - The name of the save slot to put the world in.
-	 * @param DynamicTileClasses - The classes of tile that will be spawned or destroyed during runtime.
+	 * @param BaseSlotName - A save slot to store only the differences from, such as the previous night. Leave empty to store the whole world.
+	 *                       A copy of the base is kept in its own slot until no save is stored as differences from it, so the base slot can be deleted afterwards.
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Saving", Meta = (WorldContext = "WorldContext"))
-	static void SaveGame(const UObject* WorldContext, const FString& SlotName);
+	static void SaveGame(const UObject* WorldContext, const FString& SlotName, const FString& BaseSlotName = TEXT(""));
+
+	/**
+	 * Records which copy of a base a slot is stored as differences from, then deletes every copy no remaining save is
+	 * stored as differences from. Must be called whenever a slot is written.
+	 *
+	 * @param SlotName - The slot that was just written.
+	 * @param PinnedBaseSlotName - The copy of a base the slot is stored as differences from. Empty if it is stored in full.
+	 */
+	static void UpdatePinnedBaseReferences(const FString& SlotName, const FString& PinnedBaseSlotName);
 
 	/**
 	 * Loads the entire world.
@@ -45,20 +81,109 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Saving", Meta = (WorldContext = "WorldContext"))
 	static void LoadGame(const UObject* WorldContext, const FString& SlotName);
 
+	/**
+	 * Gets whether saves are written in the compact format instead of the generic save game format.
+	 *
+	 * @return Whether the compact format is used.
+	 */
+	static bool IsCompactFormatEnabled();
+
+	/**
+	 * Stores the state of a world without writing it to a slot.
+	 *
+	 * @param WorldContext - An object in the world to save.
+	 * @return The save holding the state of the world. Nullptr if the world is invalid.
+	 */
+	static USyrupSaveGame* CaptureWorld(const UObject* WorldContext);
+
+	/**
+	 * Writes this in the compact format. Only reads the records of this and the base, so it can be called from another
+	 * thread as long as every object they reference is already in the object table and neither save is changed meanwhile.
+	 *
+	 * @param OutBytes - Will be set to the bytes of the save.
+	 * @param Base - The save to only store the differences from. Nullptr to store everything.
+	 * @param BaseSlotName - The slot the base save is stored in.
+	 * @param BaseChecksum - The checksum of the bytes stored in the base slot.
+	 * @param ObjectTable - The table to write objects to, such as one filled by CollectObjects. Nullptr to use a new one.
+	 */
+	void WriteCompact(TArray<uint8>& OutBytes, const USyrupSaveGame* Base = nullptr, const FString& BaseSlotName = FString(), const uint32 BaseChecksum = 0, FSyrupSaveObjectTable* ObjectTable = nullptr);
+
+	/**
+	 * Adds every object referenced by the records of this to an object table.
+	 *
+	 * @param ObjectTable - The table to add the objects to.
+	 */
+	void CollectObjects(FSyrupSaveObjectTable& ObjectTable) const;
+
+	/**
+	 * Reads a save from a slot in either the compact or the generic format.
+	 *
+	 * @param SlotName - The slot to read.
+	 * @return The save that was read. Nullptr if it could not be read.
+	 */
+	static USyrupSaveGame* LoadFromSlot(const FString& SlotName);
+
+	/**
+	 * Reads a save in either the compact or the generic format.
+	 *
+	 * @param Bytes - The bytes of the save.
+	 * @param DeltaDepth - The number of saves that depend on this one being read.
+	 * @return The save that was read. Nullptr if it could not be read.
+	 */
+	static USyrupSaveGame* LoadFromBytes(const TArray<uint8>& Bytes, const int32 DeltaDepth = 0);
+
+	/**
+	 * Gets the number of tiles given ids in this save.
+	 *
+	 * @return The number of dynamic and static tiles stored.
+	 */
+	FORCEINLINE int32 GetNumTiles() const { return TileData.Num() + StaticTileLocations.Num(); };
+
 private:
+	/* ------------------- *\
+	\* \/ Compact Format \/ */
+
+	/**
+	 * Reads a save in the compact format.
+	 *
+	 * @param Bytes - The bytes of the save.
+	 * @param DeltaDepth - The number of saves that depend on this one being read.
+	 * @return The save that was read. Nullptr if it could not be read.
+	 */
+	static USyrupSaveGame* ReadCompact(const TArray<uint8>& Bytes, const int32 DeltaDepth);
+
+	/**
+	 * Gets the slot a save in the compact format is stored as differences from.
+	 *
+	 * @param Bytes - The bytes of the save.
+	 * @return The name of the slot holding the base of the save. Empty if it is stored in full or is not a compact save.
+	 */
+	static FString GetCompactBaseSlotName(const TArray<uint8>& Bytes);
+
+	/**
+	 * Reads or writes one section of the compact format.
+	 *
+	 * @param Ar - The archive holding the section.
+	 * @param Section - The section to read or write.
+	 * @param Base - The save records are stored as differences from. Nullptr if they are stored in full.
+	 */
+	void SerializeCompactSection(FSyrupSaveArchive& Ar, const ESyrupSaveSection Section, const USyrupSaveGame* Base);
+
+	/* /\ Compact Format /\ *\
+	\* ------------------- */
 
 	/* -------------------- *\
 	\* \/ Saving Helpers \/ */
 
 	/**
-	 * Stores a tile's class & transform.
+	 * Stores a tile's class & transform if it is dynamic, giving it an id.
 	 *
 	 * @param Tile - The tile whose data to store.
 	 */
 	void StoreTileData(const ATile* Tile);
 
 	/**
-	 * Stores a tile's resources.
+	 * Stores a tile's resources. Must be called after the sinks of every tile are stored.
 	 *
 	 * @param Tile - The tile whose produced resources should be saved.
 	 */
@@ -71,6 +196,15 @@ private:
 	 */
 	void StoreTileSinkData(const ATile* Tile);
 
+	/**
+	 * Gets the id of a tile, giving it one if it is not dynamic and does not have one yet. Must be called after every
+	 * dynamic tile is stored.
+	 *
+	 * @param Tile - The tile to get the id of.
+	 * @return The id of the tile. INDEX_NONE if the tile is invalid.
+	 */
+	int32 GetTileId(const ATile* Tile);
+
 	/* /\ Saving Helpers /\ *\
 	\* -------------------- */
 
@@ -83,9 +217,16 @@ private:
 	void DestoryDynamicTiles() const;
 
 	/**
-	 * Spawns the tiles from the data stored.
+	 * Spawns the tiles from the data stored and finds the static tiles that were given ids.
+	 *
+	 * @param Transaction - The transaction to spawn the tiles through. Nullptr to spawn each tile on its own.
+	 */
+	void SpawnTiles(FSyrupLoadTransaction* Transaction);
+
+	/**
+	 * Finds the sinks from the data stored.
 	 */
-	void SpawnTiles();
+	void FindSinks();
 
 	/**
 	 * Sets the sink amounts from the data stored.
@@ -108,30 +249,49 @@ private:
 	void UpdateTrashfallLinks() const;
 
 	/**
-	 * Gets the tile at a given location.
+	 * Gets a tile by id.
+	 *
+	 * @param TileId - The id of the tile.
+	 * @return The tile with the id. Nullptr if it could not be found.
+	 */
+	FORCEINLINE ATile* GetTile(const int32 TileId) const { return TilesById.IsValidIndex(TileId) ? TilesById[TileId] : nullptr; };
+
+	/**
+	 * Gets a sink by id.
+	 *
+	 * @param SinkId - The index of the sink in the sink data.
+	 * @return The sink with the id. Nullptr if it could not be found.
 	 */
-	ATile* GetTileAtLocation(const FIntPoint& LocationToSearch) const;
+	FORCEINLINE UResourceSink* GetSink(const int32 SinkId) const { return SinksById.IsValidIndex(SinkId) ? SinksById[SinkId] : nullptr; };
 
 	/* /\ Loading Helpers /\ *\
 	\* --------------------- */
 
-	//Stores the type and position of each dynamic tile.
+	//The version of the save format this was written with.
+	UPROPERTY()
+	int32 SaveVersion = 0;
+
+	//Stores the type and position of each dynamic tile. A dynamic tile's id is its index.
 	UPROPERTY()
 	TArray<FTileSaveData> TileData = TArray<FTileSaveData>();
+
+	//Stores the location of each static tile that was given an id. A static tile's id is its index plus the number of dynamic tiles.
+	UPROPERTY()
+	TArray<FIntPoint> StaticTileLocations = TArray<FIntPoint>();
 	
 	//Stores resources and what they link.
 	UPROPERTY()
 	TArray<FResourceSaveData> ResourceData = TArray<FResourceSaveData>();
 	
-	//Stores the amount stored in each sink.
+	//Stores the amount stored in each sink. A sink's id is its index.
 	UPROPERTY()
 	TArray<FSinkSaveData> SinkData = TArray<FSinkSaveData>();
 	
-	//Stores the amount stored in each sink.
+	//Stores the damage taken by each plant.
 	UPROPERTY()
 	TArray<FDamageTakenSaveData> DamageTakenData = TArray<FDamageTakenSaveData>();
 	
-	//Stores the amount stored in each sink.
+	//Stores the trash claimed by each trashfall volume.
 	UPROPERTY()
 	TArray<FTrashfallSaveData> TrashfallData = TArray<FTrashfallSaveData>();
 
@@ -143,8 +303,20 @@ private:
 	UPROPERTY()
 	int DayNumber = 1;
 
-	//All of the potentially relevant for data loading tile locations.
-	TMap<FIntPoint, ATile*> LocationsToTiles = TMap<FIntPoint, ATile*>();
+	//The id given to each tile while saving.
+	TMap<const ATile*, int32> TileIds = TMap<const ATile*, int32>();
+
+	//The id given to each sink while saving.
+	TMap<const UResourceSink*, int32> SinkIds = TMap<const UResourceSink*, int32>();
+
+	//The number of saves that must be read before this one when it is stored as differences. Zero if stored in full.
+	int32 DeltaChainLength = 0;
+
+	//The tiles found while loading by id.
+	TArray<ATile*> TilesById = TArray<ATile*>();
+
+	//The sinks found while loading by id.
+	TArray<UResourceSink*> SinksById = TArray<UResourceSink*>();
 
 	//The classes to save the tile data for.
 	TArray<TSubclassOf<ATile>> DynamicTileClasses;
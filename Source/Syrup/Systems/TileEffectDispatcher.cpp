@@ -0,0 +1,298 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TileEffectDispatcher.h"
+
+#include "Syrup/Tiles/Tile.h"
+#include "Algo/Unique.h"
+#include "EngineUtils.h"
+
+/* \/ ===================== \/ *\
+|  \/ UTileEffectDispatcher \/  |
+\* \/ ===================== \/ */
+
+/**
+ * Gets the tile effect dispatcher of a world.
+ *
+ * @param WorldContext - An object in the world to get the dispatcher of.
+ * @return The tile effect dispatcher of the world. Nullptr if the world does not support one.
+ */
+UTileEffectDispatcher* UTileEffectDispatcher::Get(const UObject* WorldContext)
+{
+	if (!IsValid(WorldContext))
+	{
+		return nullptr;
+	}
+
+	UWorld* World = WorldContext->GetWorld();
+	return IsValid(World) ? World->GetSubsystem<UTileEffectDispatcher>() : nullptr;
+}
+
+/**
+ * Registers a listener that receives every trigger in a mask regardless of location.
+ *
+ * @param Listener - The function to call when a trigger is dispatched.
+ * @param TriggerMask - The triggers to receive. Use GetTileEffectTriggerBit to build it.
+ * @return The handle of the listener used to update or unregister it.
+ */
+int32 UTileEffectDispatcher::RegisterListener(const FTileEffectTriggerListener& Listener, const uint32 TriggerMask)
+{
+	int32 Handle = NextHandle++;
+
+	FListener& NewListener = HandlesToListeners.Add(Handle);
+	NewListener.Delegate = Listener;
+	NewListener.TriggerMask = TriggerMask;
+	ListenersWithoutFootprints.Add(Handle);
+
+	return Handle;
+}
+
+/**
+ * Registers a listener that only receives global triggers that overlap its footprint. Other triggers in the mask are
+ * received regardless of location.
+ *
+ * @param Listener - The function to call when a trigger is dispatched.
+ * @param TriggerMask - The triggers to receive. Use GetTileEffectTriggerBit to build it.
+ * @param Footprint - The locations the listener cares about.
+ * @return The handle of the listener used to update or unregister it.
+ */
+int32 UTileEffectDispatcher::RegisterListener(const FTileEffectTriggerListener& Listener, const uint32 TriggerMask, const TSet<FIntPoint>& Footprint)
+{
+	int32 Handle = NextHandle++;
+
+	FListener& NewListener = HandlesToListeners.Add(Handle);
+	NewListener.Delegate = Listener;
+	NewListener.TriggerMask = TriggerMask;
+	NewListener.bHasFootprint = true;
+	NewListener.Footprint = Footprint;
+	IndexFootprint(Handle, Footprint, true);
+
+	return Handle;
+}
+
+/**
+ * Changes the footprint of a listener that was registered with one.
+ *
+ * @param Handle - The handle of the listener.
+ * @param Footprint - The new locations the listener cares about.
+ */
+void UTileEffectDispatcher::SetListenerFootprint(const int32 Handle, const TSet<FIntPoint>& Footprint)
+{
+	FListener* Listener = HandlesToListeners.Find(Handle);
+	if (!Listener || !ensureMsgf(Listener->bHasFootprint, TEXT("Can't set the footprint of a listener registered without one.")))
+	{
+		return;
+	}
+
+	IndexFootprint(Handle, Listener->Footprint.Difference(Footprint), false);
+	IndexFootprint(Handle, Footprint.Difference(Listener->Footprint), true);
+	Listener->Footprint = Footprint;
+}
+
+/**
+ * Changes the triggers a listener receives.
+ *
+ * @param Handle - The handle of the listener.
+ * @param TriggerMask - The triggers to receive. Use GetTileEffectTriggerBit to build it.
+ */
+void UTileEffectDispatcher::SetListenerTriggerMask(const int32 Handle, const uint32 TriggerMask)
+{
+	FListener* Listener = HandlesToListeners.Find(Handle);
+	if (Listener)
+	{
+		Listener->TriggerMask = TriggerMask;
+	}
+}
+
+/**
+ * Stops a listener from receiving any more triggers.
+ *
+ * @param Handle - The handle of the listener. Will be set to INDEX_NONE.
+ */
+void UTileEffectDispatcher::UnregisterListener(int32& Handle)
+{
+	FListener RemovedListener;
+	if (HandlesToListeners.RemoveAndCopyValue(Handle, RemovedListener))
+	{
+		if (RemovedListener.bHasFootprint)
+		{
+			IndexFootprint(Handle, RemovedListener.Footprint, false);
+		}
+		else
+		{
+			ListenersWithoutFootprints.Remove(Handle);
+		}
+	}
+
+	Handle = INDEX_NONE;
+}
+
+/**
+ * Delivers a trigger to all the listeners that care about it.
+ *
+ * @param TriggerType - The type of trigger that was activated.
+ * @param Triggerer - The tile that triggered this effect.
+ * @param Locations - The locations of the trigger.
+ */
+void UTileEffectDispatcher::Dispatch(const ETileEffectTriggerType TriggerType, const ATile* Triggerer, const TSet<FIntPoint>& Locations)
+{
+	const uint32 TriggerBit = GetTileEffectTriggerBit(TriggerType);
+	Stats.NumDispatches[(uint8)TriggerType]++;
+
+	//Find who to call before calling anyone as listeners may register or unregister others.
+	TArray<int32> Recipients = TArray<int32>();
+	if ((TriggerBit & GLOBAL_TRIGGER_MASK) && !Locations.IsEmpty())
+	{
+		Recipients = ListenersWithoutFootprints;
+		for (FIntPoint EachLocation : Locations)
+		{
+			if (const TArray<int32>* ListenersAtLocation = LocationsToListeners.Find(EachLocation))
+			{
+				Recipients.Append(*ListenersAtLocation);
+			}
+		}
+		Recipients.Sort();
+		Recipients.SetNum(Algo::Unique(Recipients));
+	}
+	else
+	{
+		HandlesToListeners.GenerateKeyArray(Recipients);
+		Recipients.Sort();
+	}
+
+	TArray<int32> DeadListeners = TArray<int32>();
+	for (int32 EachHandle : Recipients)
+	{
+		const FListener* Listener = HandlesToListeners.Find(EachHandle);
+		if (!Listener || !(Listener->TriggerMask & TriggerBit))
+		{
+			continue;
+		}
+
+		if (!Listener->Delegate.IsBound())
+		{
+			DeadListeners.Add(EachHandle);
+			continue;
+		}
+
+		//Copy the delegate so that it survives any changes to the listeners while it executes.
+		FTileEffectTriggerListener Delegate = Listener->Delegate;
+		Stats.NumListenerCalls[(uint8)TriggerType]++;
+		Delegate.Execute(TriggerType, Triggerer, Locations);
+	}
+
+	for (int32 EachDeadListener : DeadListeners)
+	{
+		UnregisterListener(EachDeadListener);
+	}
+}
+
+/**
+ * Holds back triggers in a mask until the matching EndDeferringTriggers. Calls may be nested.
+ *
+ * @param TriggerMask - The triggers to hold back. Should only include global triggers, as they are combined by location.
+ */
+void UTileEffectDispatcher::BeginDeferringTriggers(const uint32 TriggerMask)
+{
+	DeferralDepth++;
+	DeferredTriggerMask |= TriggerMask;
+}
+
+/**
+ * Holds back a trigger if triggers of its type are being deferred.
+ *
+ * @param TriggerType - The type of trigger that was activated.
+ * @param Triggerer - The tile that triggered this effect.
+ * @param Locations - The locations of the trigger.
+ * @return Whether the trigger was held back. If not, it should be dispatched as usual.
+ */
+bool UTileEffectDispatcher::DeferTrigger(const ETileEffectTriggerType TriggerType, const ATile* Triggerer, const TSet<FIntPoint>& Locations)
+{
+	if (!(DeferredTriggerMask & GetTileEffectTriggerBit(TriggerType)))
+	{
+		return false;
+	}
+
+	//Effects only check the class of the triggerer, so triggers from tiles of the same class can share one.
+	const UClass* TriggererClass = IsValid(Triggerer) ? Triggerer->GetClass() : nullptr;
+	FDeferredTrigger* Existing = DeferredTriggers.FindByPredicate([TriggerType, TriggererClass](const FDeferredTrigger& EachTrigger)
+		{
+			return EachTrigger.TriggerType == TriggerType && EachTrigger.TriggererClass == TriggererClass;
+		});
+	if (!Existing)
+	{
+		Existing = &DeferredTriggers.AddDefaulted_GetRef();
+		Existing->TriggerType = TriggerType;
+		Existing->Triggerer = Triggerer;
+		Existing->TriggererClass = TriggererClass;
+	}
+	Existing->Locations.Append(Locations);
+	return true;
+}
+
+/**
+ * Ends deferral started by BeginDeferringTriggers. Ending the outermost deferral gives back the held triggers.
+ *
+ * @param OutTriggers - Will be set to the held triggers in the order they were first sent. Empty unless this ended the outermost deferral.
+ *                      A trigger whose first tile was destroyed meanwhile is given another live tile of its class.
+ */
+void UTileEffectDispatcher::EndDeferringTriggers(TArray<FDeferredTrigger>& OutTriggers)
+{
+	OutTriggers.Reset();
+	if (DeferralDepth <= 0 || --DeferralDepth > 0)
+	{
+		return;
+	}
+
+	DeferredTriggerMask = 0;
+	OutTriggers = MoveTemp(DeferredTriggers);
+	DeferredTriggers.Reset();
+
+	//Effects filter triggers by the class of the triggerer, so any live tile of the class can stand in for one that is gone.
+	for (FDeferredTrigger& EachTrigger : OutTriggers)
+	{
+		if (EachTrigger.Triggerer.IsValid() || !EachTrigger.TriggererClass)
+		{
+			continue;
+		}
+
+		for (TActorIterator<ATile> TileIterator(GetWorld(), const_cast<UClass*>(EachTrigger.TriggererClass)); TileIterator; ++TileIterator)
+		{
+			if (!TileIterator->IsActorBeingDestroyed())
+			{
+				EachTrigger.Triggerer = *TileIterator;
+				break;
+			}
+		}
+	}
+}
+
+/**
+ * Adds or removes a listener from the location index.
+ *
+ * @param Handle - The handle of the listener.
+ * @param Footprint - The locations to add or remove the listener at.
+ * @param bAdd - Whether the listener is being added or removed.
+ */
+void UTileEffectDispatcher::IndexFootprint(const int32 Handle, const TSet<FIntPoint>& Footprint, const bool bAdd)
+{
+	for (FIntPoint EachLocation : Footprint)
+	{
+		if (bAdd)
+		{
+			LocationsToListeners.FindOrAdd(EachLocation).Add(Handle);
+		}
+		else if (TArray<int32>* ListenersAtLocation = LocationsToListeners.Find(EachLocation))
+		{
+			ListenersAtLocation->RemoveSingleSwap(Handle);
+			if (ListenersAtLocation->IsEmpty())
+			{
+				LocationsToListeners.Remove(EachLocation);
+			}
+		}
+	}
+}
+
+/* /\ ===================== /\ *\
+|  /\ UTileEffectDispatcher /\  |
+\* /\ ===================== /\ */
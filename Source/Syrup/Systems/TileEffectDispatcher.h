@@ -0,0 +1,215 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Syrup/Tiles/Effects/TileEffectTrigger.h"
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TileEffectDispatcher.generated.h"
+
+/* \/ ===================== \/ *\
+|  \/ UTileEffectDispatcher \/  |
+\* \/ ===================== \/ */
+/**
+ * Delivers tile effect triggers to the listeners that care about them.
+ *
+ * Listeners register the trigger types they want to receive and optionally a footprint. Global triggers are only
+ * delivered to listeners with a footprint if it overlaps the locations passed with the trigger. Listeners are always
+ * called in the order they were registered.
+ */
+UCLASS()
+class SYRUP_API UTileEffectDispatcher : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Gets the tile effect dispatcher of a world.
+	 *
+	 * @param WorldContext - An object in the world to get the dispatcher of.
+	 * @return The tile effect dispatcher of the world. Nullptr if the world does not support one.
+	 */
+	static UTileEffectDispatcher* Get(const UObject* WorldContext);
+
+	/**
+	 * Registers a listener that receives every trigger in a mask regardless of location.
+	 *
+	 * @param Listener - The function to call when a trigger is dispatched.
+	 * @param TriggerMask - The triggers to receive. Use GetTileEffectTriggerBit to build it.
+	 * @return The handle of the listener used to update or unregister it.
+	 */
+	int32 RegisterListener(const FTileEffectTriggerListener& Listener, const uint32 TriggerMask);
+
+	/**
+	 * Registers a listener that only receives global triggers that overlap its footprint. Other triggers in the mask are
+	 * received regardless of location.
+	 *
+	 * @param Listener - The function to call when a trigger is dispatched.
+	 * @param TriggerMask - The triggers to receive. Use GetTileEffectTriggerBit to build it.
+	 * @param Footprint - The locations the listener cares about.
+	 * @return The handle of the listener used to update or unregister it.
+	 */
+	int32 RegisterListener(const FTileEffectTriggerListener& Listener, const uint32 TriggerMask, const TSet<FIntPoint>& Footprint);
+
+	/**
+	 * Changes the footprint of a listener that was registered with one.
+	 *
+	 * @param Handle - The handle of the listener.
+	 * @param Footprint - The new locations the listener cares about.
+	 */
+	void SetListenerFootprint(const int32 Handle, const TSet<FIntPoint>& Footprint);
+
+	/**
+	 * Changes the triggers a listener receives.
+	 *
+	 * @param Handle - The handle of the listener.
+	 * @param TriggerMask - The triggers to receive. Use GetTileEffectTriggerBit to build it.
+	 */
+	void SetListenerTriggerMask(const int32 Handle, const uint32 TriggerMask);
+
+	/**
+	 * Stops a listener from receiving any more triggers.
+	 *
+	 * @param Handle - The handle of the listener. Will be set to INDEX_NONE.
+	 */
+	void UnregisterListener(int32& Handle);
+
+	/**
+	 * Delivers a trigger to all the listeners that care about it.
+	 *
+	 * @param TriggerType - The type of trigger that was activated.
+	 * @param Triggerer - The tile that triggered this effect.
+	 * @param Locations - The locations of the trigger.
+	 */
+	void Dispatch(const ETileEffectTriggerType TriggerType, const ATile* Triggerer, const TSet<FIntPoint>& Locations);
+
+	/**
+	 * Global triggers of one type from tiles of one class, combined while triggers were deferred.
+	 */
+	struct FDeferredTrigger
+	{
+		//The type of trigger.
+		ETileEffectTriggerType TriggerType = ETileEffectTriggerType::OnActivated;
+
+		//The first tile that sent the trigger. Stands in for every tile of its class. Replaced by another tile of the class if it is destroyed first.
+		TWeakObjectPtr<const ATile> Triggerer;
+
+		//The class of the tiles that sent the trigger.
+		const UClass* TriggererClass = nullptr;
+
+		//The locations of every trigger combined.
+		TSet<FIntPoint> Locations = TSet<FIntPoint>();
+	};
+
+	/**
+	 * Holds back triggers in a mask until the matching EndDeferringTriggers. Calls may be nested.
+	 *
+	 * @param TriggerMask - The triggers to hold back. Should only include global triggers, as they are combined by location.
+	 */
+	void BeginDeferringTriggers(const uint32 TriggerMask);
+
+	/**
+	 * Holds back a trigger if triggers of its type are being deferred.
+	 *
+	 * @param TriggerType - The type of trigger that was activated.
+	 * @param Triggerer - The tile that triggered this effect.
+	 * @param Locations - The locations of the trigger.
+	 * @return Whether the trigger was held back. If not, it should be dispatched as usual.
+	 */
+	bool DeferTrigger(const ETileEffectTriggerType TriggerType, const ATile* Triggerer, const TSet<FIntPoint>& Locations);
+
+	/**
+	 * Ends deferral started by BeginDeferringTriggers. Ending the outermost deferral gives back the held triggers.
+	 *
+	 * @param OutTriggers - Will be set to the held triggers in the order they were first sent. Empty unless this ended the outermost deferral.
+	 *                      A trigger whose first tile was destroyed meanwhile is given another live tile of its class.
+	 */
+	void EndDeferringTriggers(TArray<FDeferredTrigger>& OutTriggers);
+
+	/**
+	 * Counts of the work done by the dispatcher for each trigger type.
+	 */
+	struct FDispatchStats
+	{
+		//The number of times each trigger type was dispatched.
+		int64 NumDispatches[32] = {};
+
+		//The number of listeners called for each trigger type.
+		int64 NumListenerCalls[32] = {};
+	};
+
+	/**
+	 * Gets the counts of the work done by the dispatcher since the stats were last reset.
+	 *
+	 * @return The counts of the work done by the dispatcher.
+	 */
+	FORCEINLINE const FDispatchStats& GetStats() const { return Stats; };
+
+	/**
+	 * Resets the counts of the work done by the dispatcher.
+	 */
+	FORCEINLINE void ResetStats() { Stats = FDispatchStats(); };
+
+	/**
+	 * Gets the number of registered listeners.
+	 *
+	 * @return The number of registered listeners.
+	 */
+	FORCEINLINE int32 GetNumListeners() const { return HandlesToListeners.Num(); };
+
+private:
+	/**
+	 * A single registered listener.
+	 */
+	struct FListener
+	{
+		//The function to call when a trigger is dispatched.
+		FTileEffectTriggerListener Delegate;
+
+		//The triggers to receive.
+		uint32 TriggerMask = 0;
+
+		//Whether global triggers are filtered by the footprint.
+		bool bHasFootprint = false;
+
+		//The locations the listener cares about.
+		TSet<FIntPoint> Footprint;
+	};
+
+	/**
+	 * Adds or removes a listener from the location index.
+	 *
+	 * @param Handle - The handle of the listener.
+	 * @param Footprint - The locations to add or remove the listener at.
+	 * @param bAdd - Whether the listener is being added or removed.
+	 */
+	void IndexFootprint(const int32 Handle, const TSet<FIntPoint>& Footprint, const bool bAdd);
+
+	//Every registered listener by handle. Handles increase with registration order.
+	TMap<int32, FListener> HandlesToListeners = TMap<int32, FListener>();
+
+	//The listeners without a footprint.
+	TArray<int32> ListenersWithoutFootprints = TArray<int32>();
+
+	//The listeners with a footprint at each location.
+	TMap<FIntPoint, TArray<int32>> LocationsToListeners = TMap<FIntPoint, TArray<int32>>();
+
+	//The number of deferrals that have begun and not ended.
+	int32 DeferralDepth = 0;
+
+	//The triggers being held back.
+	uint32 DeferredTriggerMask = 0;
+
+	//The triggers held back so far.
+	TArray<FDeferredTrigger> DeferredTriggers = TArray<FDeferredTrigger>();
+
+	//The handle that will be given to the next listener.
+	int32 NextHandle = 0;
+
+	//The counts of the work done by the dispatcher.
+	FDispatchStats Stats = FDispatchStats();
+};
+/* /\ ===================== /\ *\
+|  /\ UTileEffectDispatcher /\  |
+\* /\ ===================== /\ */
@@ -16,15 +16,16 @@ struct SYRUP_API FTrashfallSaveData
 	GENERATED_BODY()
 	
 public:
-	FTrashfallSaveData(FIntPoint LinkedTrashLocation = FIntPoint::ZeroValue, ATrashfallVolume* TrashfallVolume = nullptr)
+	FTrashfallSaveData(int32 LinkedTrashId = INDEX_NONE, ATrashfallVolume* TrashfallVolume = nullptr)
 	{
-		TrashLocation = LinkedTrashLocation;
+		TrashId = LinkedTrashId;
 		Volume = TrashfallVolume;
 	}
 
+	//The id of the trash claimed by the volume.
 	UPROPERTY()
-	FIntPoint TrashLocation;
+	int32 TrashId;
 
 	UPROPERTY()
 	ATrashfallVolume* Volume;
-};
\ No newline at end of file
+};
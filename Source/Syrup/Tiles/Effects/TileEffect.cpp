@@ -13,6 +13,12 @@
 |  \/ UTileEffect \/  |
 \* \/ =========== \/ */
 
+//The triggers that register this effect's labels.
+static constexpr uint32 LabelRegistrationTriggerMask = GetTileEffectTriggerBit(ETileEffectTriggerType::OnActivated) | GetTileEffectTriggerBit(ETileEffectTriggerType::PlantSpawned) | GetTileEffectTriggerBit(ETileEffectTriggerType::TrashSpawned);
+
+//The triggers that unregister this effect's labels.
+static constexpr uint32 LabelUnregistrationTriggerMask = GetTileEffectTriggerBit(ETileEffectTriggerType::OnDeactivated) | GetTileEffectTriggerBit(ETileEffectTriggerType::PlantKilled) | GetTileEffectTriggerBit(ETileEffectTriggerType::TrashPickedUp);
+
 /**
  * Registers this effects labels.
  * 
@@ -86,28 +92,60 @@ void UTileEffect::ActivateEffect(const ETileEffectTriggerType TriggerType, const
 		}
 	}
 
-	if ((IsValid(SourceLabel) || IsValid(EffectedLocationLabel)))
+	const uint32 TriggerBit = GetTileEffectTriggerBit(TriggerType);
+
+	if ((LabelTriggerMask & TriggerBit) && (IsValid(SourceLabel) || IsValid(EffectedLocationLabel)))
 	{
-		if (TriggerType == ETileEffectTriggerType::OnActivated || TriggerType == ETileEffectTriggerType::PlantSpawned || TriggerType == ETileEffectTriggerType::TrashSpawned)
+		if (TriggerBit & LabelRegistrationTriggerMask)
 		{
 			RegisterLabels(Locations);
 		}
-		else if (TriggerType == ETileEffectTriggerType::OnDeactivated || TriggerType == ETileEffectTriggerType::PlantKilled || TriggerType == ETileEffectTriggerType::TrashPickedUp)
+		else
 		{
 			UnregisterLabels(Locations);
 		}
 	}
 
-	if (AffectTriggers.Contains(TriggerType))
+	if (AffectTriggerMask & TriggerBit)
 	{
 		Affect(Locations);
 	}
 
-	if (UnaffectTriggers.Contains(TriggerType))
+	if (UnaffectTriggerMask & TriggerBit)
 	{
 		Unaffect(Locations);
 	}
 }
+
+/**
+ * Builds the trigger masks of this effect.
+ */
+void UTileEffect::OnRegister()
+{
+	Super::OnRegister();
+
+	UpdateTriggerMasks();
+}
+
+/**
+ * Rebuilds the trigger masks of this effect from its trigger sets and labels. Must be called if they change after registration.
+ */
+void UTileEffect::UpdateTriggerMasks()
+{
+	AffectTriggerMask = 0;
+	for (ETileEffectTriggerType EachTrigger : AffectTriggers)
+	{
+		AffectTriggerMask |= GetTileEffectTriggerBit(EachTrigger);
+	}
+
+	UnaffectTriggerMask = 0;
+	for (ETileEffectTriggerType EachTrigger : UnaffectTriggers)
+	{
+		UnaffectTriggerMask |= GetTileEffectTriggerBit(EachTrigger);
+	}
+
+	LabelTriggerMask = IsValid(SourceLabel) || IsValid(EffectedLocationLabel) ? LabelRegistrationTriggerMask | LabelUnregistrationTriggerMask : 0;
+}
 //
 ///**
 // * Called when a component is destroyed, and undoes this effect.
@@ -46,6 +46,23 @@ public:
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Effect", Meta = (AutoCreateRefTerm = "Locations"))
 	void ActivateEffect(const ETileEffectTriggerType TriggerType, const ATile* Triggerer, const TSet<FIntPoint>& Locations);
+
+	/**
+	 * Builds the trigger masks of this effect.
+	 */
+	virtual void OnRegister() override;
+
+	/**
+	 * Rebuilds the trigger masks of this effect from its trigger sets and labels. Must be called if they change after registration.
+	 */
+	void UpdateTriggerMasks();
+
+	/**
+	 * Gets all the triggers that this effect will do something in response to.
+	 *
+	 * @return A mask of the triggers that this effect responds to.
+	 */
+	FORCEINLINE uint32 GetRelevantTriggerMask() const { return AffectTriggerMask | UnaffectTriggerMask | LabelTriggerMask; };
 	
 	//The label that will be added to the location of the owner of this.
 	UPROPERTY(Instanced, EditAnywhere, BlueprintReadOnly, Category = "Effect", Meta = (AllowAbstract = "false"))
@@ -110,6 +127,15 @@ private:
 	//Whether or not the source of this has been labeled.
 	UPROPERTY()
 	bool bSourceLabeled = false;
+
+	//The triggers that will activate this effect as a mask.
+	uint32 AffectTriggerMask = 0;
+
+	//The triggers that will undo this effect as a mask.
+	uint32 UnaffectTriggerMask = 0;
+
+	//The triggers that will register or unregister labels as a mask.
+	uint32 LabelTriggerMask = 0;
 };
 /* /\ =========== /\ *\
 |  /\ UTileEffect /\  |
@@ -67,9 +67,35 @@ ENUM_RANGE_BY_COUNT(ETileEffectTriggerType, ETileEffectTriggerType::TrashPickedU
 
 //The last phase effect trigger.
 #define LAST_PHASE_TRIGGER		ETileEffectTriggerType::PlayerTurn
+
+//The first global effect trigger.
+#define FIRST_GLOBAL_TRIGGER	ETileEffectTriggerType::PlantSpawned
+
+/**
+ * Gets the bit representing a trigger type in a trigger mask.
+ *
+ * @param TriggerType - The trigger type to get the bit of.
+ * @return The bit representing the trigger type.
+ */
+constexpr uint32 GetTileEffectTriggerBit(const ETileEffectTriggerType TriggerType)
+{
+	return 1u << (uint8)TriggerType;
+}
+
+//A trigger mask containing every phase trigger.
+constexpr uint32 PHASE_TRIGGER_MASK = (GetTileEffectTriggerBit(LAST_PHASE_TRIGGER) << 1) - 1;
+
+//A trigger mask containing every trigger.
+constexpr uint32 ALL_TRIGGERS_MASK = (GetTileEffectTriggerBit(ETileEffectTriggerType::TrashPickedUp) << 1) - 1;
+
+//A trigger mask containing every global trigger.
+constexpr uint32 GLOBAL_TRIGGER_MASK = ALL_TRIGGERS_MASK & ~(GetTileEffectTriggerBit(FIRST_GLOBAL_TRIGGER) - 1);
 /* /\ ================== /\ *\
 |  /\ ETileEffectTrigger /\  |
 \* /\ ================== /\ */
 
 UDELEGATE()
-DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FTileEffectTrigger, const ETileEffectTriggerType, TriggerType, const ATile*, Triggerer, const TSet<FIntPoint>&, Locations);
\ No newline at end of file
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FTileEffectTrigger, const ETileEffectTriggerType, TriggerType, const ATile*, Triggerer, const TSet<FIntPoint>&, Locations);
+
+//A native listener registered with the tile effect dispatcher.
+DECLARE_DELEGATE_ThreeParams(FTileEffectTriggerListener, const ETileEffectTriggerType, const ATile*, const TSet<FIntPoint>&);
@@ -5,6 +5,7 @@
 
 #include "Components/InstancedStaticMeshComponent.h"
 #include "Syrup/Tiles/GridLibrary.h"
+#include "Syrup/Tiles/GridOccupancySubsystem.h"
 
 /* \/ ====================== \/ *\
 |  \/ AVolumetricEffectActor \/  |
@@ -34,6 +35,17 @@ AVolumetricEffectActor::AVolumetricEffectActor()
 	CollisionMesh->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
 }
 
+/**
+ * Removes this volume's tiles from the grid occupancy index.
+ *
+ * @param EndPlayReason - Why this volume is leaving play.
+ */
+void AVolumetricEffectActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	SetBlockingAllTiles(false);
+	Super::EndPlay(EndPlayReason);
+}
+
 
 /**
  * Sets the channels that this volume will overlap.
@@ -42,6 +54,7 @@ AVolumetricEffectActor::AVolumetricEffectActor()
  */
 void AVolumetricEffectActor::SetCollisionResponses(const TSet<TEnumAsByte<ECollisionChannel>>& OverlapedChannels, const TSet<TEnumAsByte<ECollisionChannel>>& BlockedChannels)
 {
+	SetBlockingAllTiles(false);
 	CollisionMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
 	
 	for (ECollisionChannel EachOverlapedChannel : OverlapedChannels)
@@ -53,6 +66,7 @@ void AVolumetricEffectActor::SetCollisionResponses(const TSet<TEnumAsByte<EColli
 	{
 		CollisionMesh->SetCollisionResponseToChannel(EachBlockedChannel, ECollisionResponse::ECR_Block);
 	}
+	SetBlockingAllTiles(true);
 }
 
 /**
@@ -67,6 +81,12 @@ void AVolumetricEffectActor::AddTiles(const TSet<FIntPoint>& TileLocations)
 		InstanceLocationsToIndices.Add(EachTileLocation);
 		CollisionMesh->AddInstance(UGridLibrary::GridTransformToWorldTransform(EachTileLocation));
 	}
+
+	UGridOccupancySubsystem* OccupancySubsystem = UGridOccupancySubsystem::Get(this);
+	if (IsValid(OccupancySubsystem))
+	{
+		OccupancySubsystem->AddBlocker(TileLocations, UGridOccupancySubsystem::GetBlockedChannels(CollisionMesh));
+	}
 }
 
 /**
@@ -79,11 +99,51 @@ void AVolumetricEffectActor::RemoveTiles(const TSet<FIntPoint> TileLocations)
 	if (!TileLocations.IsEmpty())
 	{
 		TArray<int32> Indices = TArray<int32>();
+		TSet<FIntPoint> RemovedLocations = TSet<FIntPoint>();
 		for (FIntPoint EachTileLocation : TileLocations)
 		{
+			if (InstanceLocationsToIndices.Contains(EachTileLocation))
+			{
+				RemovedLocations.Add(EachTileLocation);
+			}
 			CollisionMesh->RemoveInstance(InstanceLocationsToIndices.Find(EachTileLocation));
 			InstanceLocationsToIndices.RemoveSingle(EachTileLocation);
 		}
+
+		UGridOccupancySubsystem* OccupancySubsystem = UGridOccupancySubsystem::Get(this);
+		if (IsValid(OccupancySubsystem))
+		{
+			OccupancySubsystem->RemoveBlocker(RemovedLocations, UGridOccupancySubsystem::GetBlockedChannels(CollisionMesh));
+		}
+	}
+}
+
+/**
+ * Adds or removes all of this volume's tiles from the grid occupancy index.
+ *
+ * @param bBlocking - Whether the tiles should be added as blockers or removed.
+ */
+void AVolumetricEffectActor::SetBlockingAllTiles(const bool bBlocking)
+{
+	UGridOccupancySubsystem* OccupancySubsystem = UGridOccupancySubsystem::Get(this);
+	if (!IsValid(OccupancySubsystem))
+	{
+		return;
+	}
+
+	uint32 BlockedChannels = UGridOccupancySubsystem::GetBlockedChannels(CollisionMesh);
+	for (FIntPoint EachTileLocation : InstanceLocationsToIndices)
+	{
+		TSet<FIntPoint> Location = TSet<FIntPoint>();
+		Location.Add(EachTileLocation);
+		if (bBlocking)
+		{
+			OccupancySubsystem->AddBlocker(Location, BlockedChannels);
+		}
+		else
+		{
+			OccupancySubsystem->RemoveBlocker(Location, BlockedChannels);
+		}
 	}
 }
 /* /\ ====================== /\ *\
@@ -20,6 +20,13 @@ public:
 	 * Creates the instanced static mesh used for collision
 	 */
 	AVolumetricEffectActor();
+
+	/**
+	 * Removes this volume's tiles from the grid occupancy index.
+	 *
+	 * @param EndPlayReason - Why this volume is leaving play.
+	 */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	
 	/**
 	 * Sets the channels that this volume will overlap.
@@ -53,6 +60,14 @@ public:
 	//The index where the location is stored is the index of the index storing it.
 	UPROPERTY()
 	TArray<FIntPoint> InstanceLocationsToIndices = TArray<FIntPoint>();
+
+private:
+	/**
+	 * Adds or removes all of this volume's tiles from the grid occupancy index.
+	 *
+	 * @param bBlocking - Whether the tiles should be added as blockers or removed.
+	 */
+	void SetBlockingAllTiles(const bool bBlocking);
 };
 /* /\ ====================== /\ *\
 |  /\ AVolumetricEffectActor /\  |
@@ -4,6 +4,104 @@
 #include "GridLibrary.h"
 
 #include "Tile.h"
+#include "GridOccupancySubsystem.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+
+DEFINE_LOG_CATEGORY(LogGrid);
+
+/* \/ ================== \/ *\
+|  \/ ShapeDilationCache \/  |
+\* \/ ================== \/ */
+/**
+ * Remembers the result of scaling up shapes so that repeated calls to UGridLibrary::ScaleShapeUp only need to offset the result.
+ */
+namespace ShapeDilationCache
+{
+	//The maximum number of scaled shapes to keep before the cache is cleared.
+	static constexpr int MaxEntries = 4096;
+
+	/**
+	 * Identifies a shape that has been scaled.
+	 */
+	struct FKey
+	{
+		//The sorted locations of the shape relative to its smallest location.
+		TArray<FIntPoint> NormalizedShape;
+
+		//The number of layers added to the shape.
+		int Size = 0;
+
+		//Whether the points of the scaled shape were chopped.
+		bool bChopPoints = false;
+
+		//Whether the smallest location of the shape was flipped.
+		bool bOriginFlipped = false;
+
+		FKey(TArray<FIntPoint>&& InNormalizedShape, const int InSize, const bool bInChopPoints, const bool bInOriginFlipped)
+			: NormalizedShape(MoveTemp(InNormalizedShape)), Size(InSize), bChopPoints(bInChopPoints), bOriginFlipped(bInOriginFlipped)
+		{
+		}
+
+		bool operator==(const FKey& Other) const
+		{
+			return Size == Other.Size && bChopPoints == Other.bChopPoints && bOriginFlipped == Other.bOriginFlipped && NormalizedShape == Other.NormalizedShape;
+		}
+
+		friend uint32 GetTypeHash(const FKey& Key)
+		{
+			uint32 Hash = HashCombine(GetTypeHash(Key.Size), GetTypeHash((Key.bChopPoints ? 2 : 0) | (Key.bOriginFlipped ? 1 : 0)));
+			for (FIntPoint EachLocation : Key.NormalizedShape)
+			{
+				Hash = HashCombine(Hash, GetTypeHash(EachLocation));
+			}
+			return Hash;
+		}
+	};
+
+	//The scaled offsets of each cached shape.
+	static TMap<FKey, TArray<FIntPoint>> KeysToScaledOffsets = TMap<FKey, TArray<FIntPoint>>();
+
+	//Guards the cache in case shapes are scaled off of the game thread.
+	static FCriticalSection CacheLock;
+
+	//The number of lookups that were found in the cache.
+	static uint64 NumHits = 0;
+
+	//The number of lookups that had to be computed.
+	static uint64 NumMisses = 0;
+
+	/**
+	 * Gets the scaled offsets of a normalized shape, computing them if they are not already cached.
+	 *
+	 * @param Key - The normalized shape and scale parameters.
+	 * @param ScaleShape - Computes the scaled offsets of a key that is not cached.
+	 * @return The locations of the scaled shape relative to the same origin as the normalized shape.
+	 */
+	static TArray<FIntPoint> FindOrAdd(FKey&& Key, TFunctionRef<TArray<FIntPoint>(const FKey&)> ScaleShape)
+	{
+		FScopeLock Lock(&CacheLock);
+
+		if (const TArray<FIntPoint>* ScaledOffsets = KeysToScaledOffsets.Find(Key))
+		{
+			NumHits++;
+			return *ScaledOffsets;
+		}
+		NumMisses++;
+
+		if (KeysToScaledOffsets.Num() >= MaxEntries)
+		{
+			KeysToScaledOffsets.Empty();
+		}
+
+		TArray<FIntPoint> ScaledOffsets = ScaleShape(Key);
+		KeysToScaledOffsets.Add(MoveTemp(Key), ScaledOffsets);
+		return ScaledOffsets;
+	}
+}
+/* /\ ================== /\ *\
+|  /\ ShapeDilationCache /\  |
+\* /\ ================== /\ */
 
 
 /* \/ ============ \/ *\
@@ -251,6 +349,40 @@ bool UGridLibrary::IsDirectionValidAtLocation(const EGridDirection Direction, co
  * @return Where the a given relative location of a tile would be if its root was pointed in a given direction.
  */
 FIntPoint UGridLibrary::PointLocationInDirection(const EGridDirection Direction, const FIntPoint Location)
+{
+	/*
+	 * Pointing a shape is a rotation by a multiple of 120 degrees about the origin tile, optionally followed by a flip through it.
+	 * On each parity of tile this is an affine map with half integer coefficients, so each row stores twice the coefficients of
+	 * X, Y, and whether the location is flipped for both the new X and the new Y. The sums are always even.
+	 */
+	static constexpr int RotationTable[6][6] =
+	{
+		{-2,  0,  0,	 0, -2,  0},	//Down
+		{ 2,  0,  0,	 0,  2,  0},	//Up
+		{ 1, -1,  1,	 3,  1,  1},	//UpLeft
+		{-1, -1, -1,	 3, -1,  1},	//DownRight
+		{ 1,  1,  1,	-3,  1, -1},	//UpRight
+		{-1,  1, -1,	-3, -1, -1}		//DownLeft
+	};
+
+	const int* Row = RotationTable[(uint8)Direction];
+	const int Flipped = IsGridLocationFlipped(Location) ? 1 : 0;
+
+	return FIntPoint(
+		(Row[0] * Location.X + Row[1] * Location.Y + Row[2] * Flipped) / 2,
+		(Row[3] * Location.X + Row[4] * Location.Y + Row[5] * Flipped) / 2
+	);
+}
+
+/*
+ * Gets where the a given relative location of a tile would be if its root was pointed in a given direction by rotating it in world space. Initial direction assumed to be up.
+ * Note: This is much slower than PointLocationInDirection and is only kept as a reference to verify it against.
+ *
+ * @param Direction - The given direction.
+ * @param Location - The given location.
+ * @return Where the a given relative location of a tile would be if its root was pointed in a given direction.
+ */
+FIntPoint UGridLibrary::PointLocationInDirectionInWorldSpace(const EGridDirection Direction, const FIntPoint Location)
 {
 	FIntPoint ReturnValue = Location;
 
@@ -360,6 +492,45 @@ TSet<FIntPoint> UGridLibrary::GetGridLocationsInRange(const FIntPoint Location,
  * @return All the grid locations of a given shape when scaled up.
  */
 TSet<FIntPoint> UGridLibrary::ScaleShapeUp(const TSet<FIntPoint>& ShapeLocations, const int Size, const bool bChopPoints)
+{
+	if (Size < 1 || ShapeLocations.IsEmpty())
+	{
+		return TSet<FIntPoint>(ShapeLocations.Array());
+	}
+
+	/*
+	 * Scaling only depends on which tiles are flipped, so the shape is moved so that its smallest location is at the origin
+	 * (or one tile below it if that location is flipped) and the scaled offsets are cached relative to that.
+	 */
+	TArray<FIntPoint> NormalizedShape = ShapeLocations.Array();
+	NormalizedShape.Sort([](const FIntPoint& A, const FIntPoint& B) { return A.X != B.X ? A.X < B.X : A.Y < B.Y; });
+	const bool bOriginFlipped = IsGridLocationFlipped(NormalizedShape[0]);
+	const FIntPoint Offset = NormalizedShape[0] - (bOriginFlipped ? FIntPoint(1, 0) : FIntPoint::ZeroValue);
+	for (FIntPoint& EachLocation : NormalizedShape)
+	{
+		EachLocation -= Offset;
+	}
+
+	const TArray<FIntPoint> ScaledOffsets = ShapeDilationCache::FindOrAdd(ShapeDilationCache::FKey(MoveTemp(NormalizedShape), Size, bChopPoints, bOriginFlipped),
+		[](const ShapeDilationCache::FKey& Key) { return ScaleShapeUpUncached(TSet<FIntPoint>(Key.NormalizedShape), Key.Size, Key.bChopPoints).Array(); });
+
+	TSet<FIntPoint> ReturnValue = TSet<FIntPoint>();
+	ReturnValue.Reserve(ScaledOffsets.Num());
+	for (FIntPoint EachOffset : ScaledOffsets)
+	{
+		ReturnValue.Add(EachOffset + Offset);
+	}
+	return ReturnValue;
+}
+
+/*
+ * Gets all the grid locations of a given shape when scaled up without using the shape dilation cache.
+ *
+ * @param ShapeLocations - The locations contained shape to scale.
+ * @param Size -  The number of layers to add to the shape.
+ * @return All the grid locations of a given shape when scaled up.
+ */
+TSet<FIntPoint> UGridLibrary::ScaleShapeUpUncached(const TSet<FIntPoint>& ShapeLocations, const int Size, const bool bChopPoints)
 {
 	TSet<FIntPoint> ShapeLocationsRehashed = TSet<FIntPoint>(ShapeLocations.Array());
 
@@ -503,6 +674,13 @@ TSet<FIntPoint> UGridLibrary::GetLocationsInLine(const FIntPoint LineOrigin, con
  */
 bool UGridLibrary::OverlapGridLocation(const UObject* WorldContext, const FIntPoint GridLocation, ATile*& OverlapingTile, const TArray<AActor*>& IgnoredTiles, const ECollisionChannel Channel)
 {
+	UGridOccupancySubsystem* OccupancySubsystem = UGridOccupancySubsystem::Get(WorldContext);
+	if (IsValid(OccupancySubsystem))
+	{
+		return OccupancySubsystem->OverlapGridLocation(GridLocation, OverlapingTile, IgnoredTiles, Channel);
+	}
+
+	//Fall back to physics when the world has no occupancy index.
 	FCollisionQueryParams Params = FCollisionQueryParams();
 	Params.AddIgnoredActors(IgnoredTiles);
 	FHitResult Hit = FHitResult();
@@ -546,4 +724,65 @@ bool UGridLibrary::OverlapShape(const UObject* WorldContext, const TSet<FIntPoin
 }
 /* /\ ============ /\ *\
 |  /\ UGridLibrary /\  |
-\* /\ ============ /\ */
\ No newline at end of file
+\* /\ ============ /\ */
+
+
+#if !UE_BUILD_SHIPPING
+/**
+ * Checks PointLocationInDirection against the world space reference for every direction over a square of locations.
+ * Usage: Syrup.Grid.VerifyPointLocationInDirection [Range]
+ */
+static FAutoConsoleCommand VerifyPointLocationInDirectionCommand(
+	TEXT("Syrup.Grid.VerifyPointLocationInDirection"),
+	TEXT("Checks PointLocationInDirection against the world space reference for all locations within [Range] (default 512) of the origin."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			int Range = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 512;
+			int NumMismatches = 0;
+			for (uint8 DirectionIndex = 0; DirectionIndex < 6; DirectionIndex++)
+			{
+				EGridDirection Direction = (EGridDirection)DirectionIndex;
+				for (int X = -Range; X <= Range; X++)
+				{
+					for (int Y = -Range; Y <= Range; Y++)
+					{
+						FIntPoint Expected = UGridLibrary::PointLocationInDirectionInWorldSpace(Direction, FIntPoint(X, Y));
+						FIntPoint Actual = UGridLibrary::PointLocationInDirection(Direction, FIntPoint(X, Y));
+						if (Expected != Actual)
+						{
+							if (NumMismatches < 16)
+							{
+								UE_LOG(LogGrid, Error, TEXT("PointLocationInDirection(%d, %s) was %s but expected %s"), DirectionIndex, *FIntPoint(X, Y).ToString(), *Actual.ToString(), *Expected.ToString());
+							}
+							NumMismatches++;
+						}
+					}
+				}
+			}
+			UE_LOG(LogGrid, Display, TEXT("PointLocationInDirection verification within %d: %d mismatches"), Range, NumMismatches);
+		})
+);
+
+/**
+ * Prints how well the shape dilation cache is being used.
+ * Usage: Syrup.Grid.ShapeDilationCacheStats [Reset]
+ */
+static FAutoConsoleCommand ShapeDilationCacheStatsCommand(
+	TEXT("Syrup.Grid.ShapeDilationCacheStats"),
+	TEXT("Prints the hit and miss counts of the ScaleShapeUp cache. Pass Reset to clear the counters and the cache."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			FScopeLock Lock(&ShapeDilationCache::CacheLock);
+			uint64 NumLookups = ShapeDilationCache::NumHits + ShapeDilationCache::NumMisses;
+			UE_LOG(LogGrid, Display, TEXT("Shape dilation cache: %llu hits, %llu misses (%.1f%% hit rate), %d shapes cached"),
+				ShapeDilationCache::NumHits, ShapeDilationCache::NumMisses, NumLookups ? 100.0 * ShapeDilationCache::NumHits / NumLookups : 0.0, ShapeDilationCache::KeysToScaledOffsets.Num());
+
+			if (Args.Num() > 0 && Args[0].Equals(TEXT("Reset"), ESearchCase::IgnoreCase))
+			{
+				ShapeDilationCache::NumHits = 0;
+				ShapeDilationCache::NumMisses = 0;
+				ShapeDilationCache::KeysToScaledOffsets.Empty();
+			}
+		})
+);
+#endif
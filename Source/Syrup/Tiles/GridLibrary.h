@@ -8,6 +8,7 @@
 
 class ATile;
 
+DECLARE_LOG_CATEGORY_EXTERN(LogGrid, Log, All);
 
 /* \/ ============== \/ *\
 |  \/ EGridDirection \/  |
@@ -210,6 +211,16 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Transformation|Grid|Direction")
 	static FIntPoint PointLocationInDirection(const EGridDirection Direction, const FIntPoint Location);
 
+	/*
+	 * Gets where the a given relative location of a tile would be if its root was pointed in a given direction by rotating it in world space. Initial direction assumed to be up.
+	 * Note: This is much slower than PointLocationInDirection and is only kept as a reference to verify it against.
+	 *
+	 * @param Direction - The given direction.
+	 * @param Location - The given location.
+	 * @return Where the a given relative location of a tile would be if its root was pointed in a given direction.
+	 */
+	static FIntPoint PointLocationInDirectionInWorldSpace(const EGridDirection Direction, const FIntPoint Location);
+
 	/*
 	 * Gets where the a given set of relative locations of a shape would be if its root was pointed in a given direction. Intial direction assumed to be up.
 	 *
@@ -292,6 +303,15 @@ public:
 	static bool OverlapShape(const UObject* WorldContext, const TSet<FIntPoint>& ShapeGridLocations, TSet<ATile*>& OverlapingTiles, const TArray<AActor*>& IgnoredTiles, const ECollisionChannel Channel = ECC_WorldDynamic);
 
 private:
+	/*
+	 * Gets all the grid locations of a given shape when scaled up without using the shape dilation cache.
+	 *
+	 * @param ShapeLocations - The locations contained shape to scale.
+	 * @param Size -  The number of layers to add to the shape.
+	 * @return All the grid locations of a given shape when scaled up.
+	 */
+	static TSet<FIntPoint> ScaleShapeUpUncached(const TSet<FIntPoint>& ShapeLocations, const int Size, const bool bChopPoints);
+
 	UPROPERTY()
 	double GridHeight = 51.9615242270663188058233902451761710082841576;
 };
@@ -0,0 +1,510 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridOccupancySubsystem.h"
+
+#include "Tile.h"
+#include "GridLibrary.h"
+#include "Components/PrimitiveComponent.h"
+#include "EngineUtils.h"
+
+//The most grid locations a static blocker may cover and still be indexed by them. Larger ones, such as the ground, are checked at every location.
+constexpr int32 MAX_INDEXED_STATIC_BLOCKER_LOCATIONS = 64 * 1024;
+
+/* \/ ======================= \/ *\
+|  \/ UGridOccupancySubsystem \/  |
+\* \/ ======================= \/ */
+
+/**
+ * Gets the occupancy subsystem of a world.
+ *
+ * @param WorldContext - An object in the world to get the subsystem of.
+ * @return The occupancy subsystem of the world. Nullptr if the world does not support one.
+ */
+UGridOccupancySubsystem* UGridOccupancySubsystem::Get(const UObject* WorldContext)
+{
+	if (!IsValid(WorldContext))
+	{
+		return nullptr;
+	}
+
+	UWorld* World = WorldContext->GetWorld();
+	return IsValid(World) ? World->GetSubsystem<UGridOccupancySubsystem>() : nullptr;
+}
+
+/**
+ * Finds the level geometry that blocks grid queries.
+ *
+ * @param InWorld - The world that began play.
+ */
+void UGridOccupancySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	for (TActorIterator<AActor> ActorIterator(&InWorld); ActorIterator; ++ActorIterator)
+	{
+		AddStaticBlockers(*ActorIterator);
+	}
+	ActorSpawnedHandle = InWorld.AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &UGridOccupancySubsystem::AddStaticBlockers));
+}
+
+/**
+ * Stops listening for spawned actors.
+ */
+void UGridOccupancySubsystem::Deinitialize()
+{
+	UWorld* World = GetWorld();
+	if (IsValid(World) && ActorSpawnedHandle.IsValid())
+	{
+		World->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+	}
+	ActorSpawnedHandle.Reset();
+	StaticBlockers.Empty();
+	LocationsToStaticBlockers.Empty();
+	UnindexedStaticBlockers.Empty();
+	ActorsToStaticBlockers.Empty();
+
+	Super::Deinitialize();
+}
+
+/**
+ * Gets the channels blocked by a component as a bit mask.
+ *
+ * @param Component - The component to get the blocked channels of.
+ * @return A bit mask with the bit of each blocked channel set.
+ */
+uint32 UGridOccupancySubsystem::GetBlockedChannels(const UPrimitiveComponent* Component)
+{
+	uint32 ReturnValue = 0;
+	if (!IsValid(Component) || !Component->IsQueryCollisionEnabled())
+	{
+		return ReturnValue;
+	}
+
+	for (int ChannelIndex = 0; ChannelIndex < 32; ChannelIndex++)
+	{
+		if (Component->GetCollisionResponseToChannel((ECollisionChannel)ChannelIndex) == ECollisionResponse::ECR_Block)
+		{
+			ReturnValue |= 1u << ChannelIndex;
+		}
+	}
+	return ReturnValue;
+}
+
+/**
+ * Sets the locations occupied by a tile. Replaces any previously registered locations of that tile.
+ *
+ * @param Tile - The tile occupying the locations.
+ * @param Locations - The grid locations the tile covers.
+ * @param BlockedChannels - A bit mask of the collision channels the tile blocks.
+ */
+void UGridOccupancySubsystem::RegisterTile(ATile* Tile, const TSet<FIntPoint>& Locations, const uint32 BlockedChannels)
+{
+	for (FIntPoint EachLocation : Locations)
+	{
+		TArray<FTileOccupancy, TInlineAllocator<1>>& Occupants = LocationsToTiles.FindOrAdd(EachLocation);
+		Occupants.RemoveAll([Tile](const FTileOccupancy& EachOccupant) { return EachOccupant.Tile.Get() == Tile || !EachOccupant.Tile.IsValid(); });
+
+		FTileOccupancy& Occupancy = Occupants.AddDefaulted_GetRef();
+		Occupancy.Tile = Tile;
+		Occupancy.BlockedChannels = BlockedChannels;
+	}
+
+	if (!Locations.IsEmpty())
+	{
+		NotifyOccupancyChanged(Locations);
+	}
+}
+
+/**
+ * Removes a tile from the locations it was occupying.
+ *
+ * @param Tile - The tile to remove.
+ * @param Locations - The grid locations the tile was registered at.
+ */
+void UGridOccupancySubsystem::UnregisterTile(const ATile* Tile, const TSet<FIntPoint>& Locations)
+{
+	for (FIntPoint EachLocation : Locations)
+	{
+		//Other tiles sharing the location keep occupying it.
+		TArray<FTileOccupancy, TInlineAllocator<1>>* Occupants = LocationsToTiles.Find(EachLocation);
+		if (!Occupants)
+		{
+			continue;
+		}
+
+		Occupants->RemoveAll([Tile](const FTileOccupancy& EachOccupant) { return EachOccupant.Tile.Get() == Tile || !EachOccupant.Tile.IsValid(); });
+		if (Occupants->IsEmpty())
+		{
+			LocationsToTiles.Remove(EachLocation);
+		}
+	}
+
+	if (!Locations.IsEmpty())
+	{
+		NotifyOccupancyChanged(Locations);
+	}
+}
+
+/**
+ * Adds a blocker that is not a tile to the given locations.
+ *
+ * @param Locations - The grid locations being blocked.
+ * @param BlockedChannels - A bit mask of the collision channels being blocked.
+ */
+void UGridOccupancySubsystem::AddBlocker(const TSet<FIntPoint>& Locations, const uint32 BlockedChannels)
+{
+	for (int ChannelIndex = 0; ChannelIndex < 32; ChannelIndex++)
+	{
+		if (BlockedChannels & (1u << ChannelIndex))
+		{
+			TMap<FIntPoint, int>& LocationToBlockerCounts = ChannelToLocationToBlockerCounts.FindOrAdd((ECollisionChannel)ChannelIndex);
+			for (FIntPoint EachLocation : Locations)
+			{
+				LocationToBlockerCounts.FindOrAdd(EachLocation)++;
+			}
+		}
+	}
+
+	if (BlockedChannels && !Locations.IsEmpty())
+	{
+		NotifyOccupancyChanged(Locations);
+	}
+}
+
+/**
+ * Removes a blocker that is not a tile from the given locations.
+ *
+ * @param Locations - The grid locations no longer being blocked.
+ * @param BlockedChannels - A bit mask of the collision channels that were being blocked.
+ */
+void UGridOccupancySubsystem::RemoveBlocker(const TSet<FIntPoint>& Locations, const uint32 BlockedChannels)
+{
+	for (int ChannelIndex = 0; ChannelIndex < 32; ChannelIndex++)
+	{
+		if (BlockedChannels & (1u << ChannelIndex))
+		{
+			TMap<FIntPoint, int>* LocationToBlockerCounts = ChannelToLocationToBlockerCounts.Find((ECollisionChannel)ChannelIndex);
+			if (!LocationToBlockerCounts)
+			{
+				continue;
+			}
+
+			for (FIntPoint EachLocation : Locations)
+			{
+				int* Count = LocationToBlockerCounts->Find(EachLocation);
+				if (Count && --(*Count) <= 0)
+				{
+					LocationToBlockerCounts->Remove(EachLocation);
+				}
+			}
+		}
+	}
+
+	if (BlockedChannels && !Locations.IsEmpty())
+	{
+		NotifyOccupancyChanged(Locations);
+	}
+}
+
+/**
+ * Holds back occupancy change notifications until the matching EndChangeBatch. Batches may be nested.
+ */
+void UGridOccupancySubsystem::BeginChangeBatch()
+{
+	ChangeBatchDepth++;
+}
+
+/**
+ * Ends a batch started by BeginChangeBatch. Ending the outermost batch sends a single notification with every location
+ * changed during it.
+ */
+void UGridOccupancySubsystem::EndChangeBatch()
+{
+	if (ChangeBatchDepth <= 0 || --ChangeBatchDepth > 0)
+	{
+		return;
+	}
+
+	//Take the locations first since listeners may start another batch.
+	const TSet<FIntPoint> ChangedLocations = MoveTemp(BatchedChangedLocations);
+	BatchedChangedLocations.Reset();
+	if (!ChangedLocations.IsEmpty())
+	{
+		OnOccupancyChanged.Broadcast(ChangedLocations);
+	}
+}
+
+/**
+ * Checks a given grid location for anything blocking a channel.
+ *
+ * @param GridLocation - The given grid location to check.
+ * @param OverlapingTile - Will be set to the tile at the given location if there is one, otherwise is nullptr.
+ * @param IgnoredTiles - The tiles to ignore when querying.
+ * @param Channel - The channel to test against.
+ *
+ * @return Whether or not anything was blocking the channel at the given location.
+ */
+bool UGridOccupancySubsystem::OverlapGridLocation(const FIntPoint GridLocation, ATile*& OverlapingTile, const TArray<AActor*>& IgnoredTiles, const ECollisionChannel Channel) const
+{
+	OverlapingTile = nullptr;
+
+	//Check for tiles, preferring the one registered last like a trace would find the tile on top.
+	const TArray<FTileOccupancy, TInlineAllocator<1>>* Occupants = LocationsToTiles.Find(GridLocation);
+	if (Occupants)
+	{
+		for (int32 OccupantIndex = Occupants->Num() - 1; OccupantIndex >= 0; OccupantIndex--)
+		{
+			const FTileOccupancy& Occupancy = (*Occupants)[OccupantIndex];
+			ATile* Tile = Occupancy.Tile.Get();
+			if ((Occupancy.BlockedChannels & (1u << (uint8)Channel)) && IsValid(Tile) && !IgnoredTiles.Contains(Tile))
+			{
+				OverlapingTile = Tile;
+				return true;
+			}
+		}
+	}
+
+	//Check for other blockers
+	const TMap<FIntPoint, int>* LocationToBlockerCounts = ChannelToLocationToBlockerCounts.Find(Channel);
+	if (LocationToBlockerCounts && LocationToBlockerCounts->Contains(GridLocation))
+	{
+		return true;
+	}
+
+	return OverlapStaticBlockers(GridLocation, IgnoredTiles, Channel);
+}
+
+/**
+ * Gets the tile registered at a given grid location regardless of what it blocks.
+ *
+ * @param GridLocation - The given grid location.
+ * @return The tile at the location. Nullptr if there is none.
+ */
+ATile* UGridOccupancySubsystem::GetTileAtLocation(const FIntPoint GridLocation) const
+{
+	const TArray<FTileOccupancy, TInlineAllocator<1>>* Occupants = LocationsToTiles.Find(GridLocation);
+	if (!Occupants)
+	{
+		return nullptr;
+	}
+
+	for (int32 OccupantIndex = Occupants->Num() - 1; OccupantIndex >= 0; OccupantIndex--)
+	{
+		ATile* Tile = (*Occupants)[OccupantIndex].Tile.Get();
+		if (IsValid(Tile))
+		{
+			return Tile;
+		}
+	}
+	return nullptr;
+}
+
+/**
+ * Tells listeners that some locations changed, or remembers them until the current batch ends.
+ *
+ * @param Locations - The locations whose occupancy may have changed.
+ */
+void UGridOccupancySubsystem::NotifyOccupancyChanged(const TSet<FIntPoint>& Locations)
+{
+	if (ChangeBatchDepth > 0)
+	{
+		BatchedChangedLocations.Append(Locations);
+		return;
+	}
+
+	OnOccupancyChanged.Broadcast(Locations);
+}
+
+/**
+ * Adds the components of an actor that block grid queries without moving, unless the actor is a tile.
+ *
+ * @param Actor - The actor to add the components of.
+ */
+void UGridOccupancySubsystem::AddStaticBlockers(AActor* Actor)
+{
+	//Tiles are indexed by location and anything else that moves on the grid registers itself as a blocker.
+	if (!IsValid(Actor) || Actor->IsA<ATile>())
+	{
+		return;
+	}
+
+	TInlineComponentArray<UPrimitiveComponent*> Components = TInlineComponentArray<UPrimitiveComponent*>();
+	Actor->GetComponents<UPrimitiveComponent>(Components);
+	for (UPrimitiveComponent* EachComponent : Components)
+	{
+		if (!IsValid(EachComponent) || EachComponent->Mobility == EComponentMobility::Movable)
+		{
+			continue;
+		}
+
+		const uint32 BlockedChannels = GetBlockedChannels(EachComponent);
+		if (!BlockedChannels)
+		{
+			continue;
+		}
+
+		const FBox Bounds = EachComponent->Bounds.GetBox();
+		FStaticBlocker Blocker = FStaticBlocker();
+		Blocker.Component = EachComponent;
+		Blocker.BlockedChannels = BlockedChannels;
+		Blocker.Bounds = FBox2D(FVector2D(Bounds.Min), FVector2D(Bounds.Max));
+
+		TArray<FIntPoint> Locations = TArray<FIntPoint>();
+		Blocker.bIsIndexed = GetStaticBlockerLocations(Blocker.Bounds, Locations);
+		const int32 BlockerIndex = StaticBlockers.Add(Blocker);
+		if (Blocker.bIsIndexed)
+		{
+			for (FIntPoint EachLocation : Locations)
+			{
+				LocationsToStaticBlockers.FindOrAdd(EachLocation).Add(BlockerIndex);
+			}
+		}
+		else
+		{
+			UnindexedStaticBlockers.Add(BlockerIndex);
+		}
+		ActorsToStaticBlockers.FindOrAdd(Actor).Add(BlockerIndex);
+		StaticBlockedChannels |= BlockedChannels;
+	}
+
+	if (ActorsToStaticBlockers.Contains(Actor))
+	{
+		Actor->OnEndPlay.AddUniqueDynamic(this, &UGridOccupancySubsystem::RemoveStaticBlockers);
+	}
+}
+
+/**
+ * Removes the static blockers of an actor that is leaving play.
+ *
+ * @param Actor - The actor leaving play.
+ * @param EndPlayReason - Why the actor is leaving play.
+ */
+void UGridOccupancySubsystem::RemoveStaticBlockers(AActor* Actor, EEndPlayReason::Type EndPlayReason)
+{
+	TArray<int32> BlockerIndices = TArray<int32>();
+	if (!ActorsToStaticBlockers.RemoveAndCopyValue(Actor, BlockerIndices))
+	{
+		return;
+	}
+
+	for (int32 EachBlockerIndex : BlockerIndices)
+	{
+		const FStaticBlocker& Blocker = StaticBlockers[EachBlockerIndex];
+		TArray<FIntPoint> Locations = TArray<FIntPoint>();
+		if (Blocker.bIsIndexed && GetStaticBlockerLocations(Blocker.Bounds, Locations))
+		{
+			for (FIntPoint EachLocation : Locations)
+			{
+				TArray<int32, TInlineAllocator<1>>* BlockersAtLocation = LocationsToStaticBlockers.Find(EachLocation);
+				if (BlockersAtLocation)
+				{
+					BlockersAtLocation->RemoveSingleSwap(EachBlockerIndex);
+					if (BlockersAtLocation->IsEmpty())
+					{
+						LocationsToStaticBlockers.Remove(EachLocation);
+					}
+				}
+			}
+		}
+		else
+		{
+			UnindexedStaticBlockers.RemoveSingleSwap(EachBlockerIndex);
+		}
+		StaticBlockers.RemoveAt(EachBlockerIndex);
+	}
+
+	StaticBlockedChannels = 0;
+	for (const FStaticBlocker& EachBlocker : StaticBlockers)
+	{
+		StaticBlockedChannels |= EachBlocker.BlockedChannels;
+	}
+}
+
+/**
+ * Gets the grid locations whose centers are covered by the bounds of a static blocker.
+ *
+ * @param Bounds - The area covered by the blocker from above.
+ * @param OutLocations - Will be set to the covered locations.
+ * @return Whether the bounds cover few enough locations to be indexed by them.
+ */
+bool UGridOccupancySubsystem::GetStaticBlockerLocations(const FBox2D& Bounds, TArray<FIntPoint>& OutLocations)
+{
+	OutLocations.Reset();
+
+	//The corners only give the rough range of locations, so check one more location on each side.
+	const FIntPoint MinLocation = UGridLibrary::WorldLocationToGridLocation(FVector(Bounds.Min, 0)) - FIntPoint(1, 1);
+	const FIntPoint MaxLocation = UGridLibrary::WorldLocationToGridLocation(FVector(Bounds.Max, 0)) + FIntPoint(1, 1);
+	if ((int64)(MaxLocation.X - MinLocation.X + 1) * (MaxLocation.Y - MinLocation.Y + 1) > MAX_INDEXED_STATIC_BLOCKER_LOCATIONS)
+	{
+		return false;
+	}
+
+	for (int32 X = MinLocation.X; X <= MaxLocation.X; X++)
+	{
+		for (int32 Y = MinLocation.Y; Y <= MaxLocation.Y; Y++)
+		{
+			const FIntPoint Location = FIntPoint(X, Y);
+			if (Bounds.IsInside(FVector2D(UGridLibrary::GridLocationToWorldLocation(Location))))
+			{
+				OutLocations.Add(Location);
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * Checks whether level geometry blocks a channel at a given grid location.
+ *
+ * @param GridLocation - The given grid location to check.
+ * @param IgnoredActors - The actors to ignore when querying.
+ * @param Channel - The channel to test against.
+ * @return Whether level geometry blocks the channel at the location.
+ */
+bool UGridOccupancySubsystem::OverlapStaticBlockers(const FIntPoint GridLocation, const TArray<AActor*>& IgnoredActors, const ECollisionChannel Channel) const
+{
+	const uint32 ChannelBit = 1u << (uint8)Channel;
+	if (!(StaticBlockedChannels & ChannelBit))
+	{
+		return false;
+	}
+
+	//The same trace the physics query used, but only against the components that could be under the location.
+	const FVector WorldLocation = UGridLibrary::GridLocationToWorldLocation(GridLocation);
+	const FVector2D WorldLocation2D = FVector2D(WorldLocation);
+	//Blockers too large to index by location are checked everywhere.
+	const TArray<int32, TInlineAllocator<1>>* IndexedBlockers = LocationsToStaticBlockers.Find(GridLocation);
+	TArray<int32, TInlineAllocator<8>> CandidateBlockers = TArray<int32, TInlineAllocator<8>>();
+	if (IndexedBlockers)
+	{
+		CandidateBlockers.Append(*IndexedBlockers);
+	}
+	CandidateBlockers.Append(UnindexedStaticBlockers);
+
+	for (int32 EachBlockerIndex : CandidateBlockers)
+	{
+		const FStaticBlocker& EachBlocker = StaticBlockers[EachBlockerIndex];
+		if (!(EachBlocker.BlockedChannels & ChannelBit) || !EachBlocker.Bounds.IsInside(WorldLocation2D))
+		{
+			continue;
+		}
+
+		UPrimitiveComponent* Component = EachBlocker.Component.Get();
+		if (!IsValid(Component) || IgnoredActors.Contains(Component->GetOwner()))
+		{
+			continue;
+		}
+
+		FHitResult Hit = FHitResult();
+		if (Component->LineTraceComponent(Hit, WorldLocation + FVector(0, 0, 100), WorldLocation - FVector(0, 0, 0.05), FCollisionQueryParams()))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/* /\ ======================= /\ *\
+|  /\ UGridOccupancySubsystem /\  |
+\* /\ ======================= /\ */
@@ -0,0 +1,232 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GridOccupancySubsystem.generated.h"
+
+class ATile;
+
+//Called with the locations whose occupancy may have changed.
+DECLARE_MULTICAST_DELEGATE_OneParam(FOccupancyChangedDelegate, const TSet<FIntPoint>&);
+
+/* \/ ======================= \/ *\
+|  \/ UGridOccupancySubsystem \/  |
+\* \/ ======================= \/ */
+/**
+ * Keeps an index of what is occupying each grid location so that grid queries do not need to touch physics.
+ *
+ * Tiles register the locations they cover along with the collision channels they block. Other grid aligned
+ * blockers (like volumetric effects) register how many times they block a channel at a location. Level geometry that
+ * does not move is found when play begins, indexed by the locations its bounds cover, and only traced against at
+ * those locations until it leaves play.
+ */
+UCLASS()
+class SYRUP_API UGridOccupancySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Gets the occupancy subsystem of a world.
+	 *
+	 * @param WorldContext - An object in the world to get the subsystem of.
+	 * @return The occupancy subsystem of the world. Nullptr if the world does not support one.
+	 */
+	static UGridOccupancySubsystem* Get(const UObject* WorldContext);
+
+	/**
+	 * Finds the level geometry that blocks grid queries.
+	 *
+	 * @param InWorld - The world that began play.
+	 */
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/**
+	 * Stops listening for spawned actors.
+	 */
+	virtual void Deinitialize() override;
+
+	/**
+	 * Gets the channels blocked by a component as a bit mask.
+	 *
+	 * @param Component - The component to get the blocked channels of.
+	 * @return A bit mask with the bit of each blocked channel set.
+	 */
+	static uint32 GetBlockedChannels(const UPrimitiveComponent* Component);
+
+	/**
+	 * Sets the locations occupied by a tile. Replaces any previously registered locations of that tile.
+	 *
+	 * @param Tile - The tile occupying the locations.
+	 * @param Locations - The grid locations the tile covers.
+	 * @param BlockedChannels - A bit mask of the collision channels the tile blocks.
+	 */
+	void RegisterTile(ATile* Tile, const TSet<FIntPoint>& Locations, const uint32 BlockedChannels);
+
+	/**
+	 * Removes a tile from the locations it was occupying.
+	 *
+	 * @param Tile - The tile to remove.
+	 * @param Locations - The grid locations the tile was registered at.
+	 */
+	void UnregisterTile(const ATile* Tile, const TSet<FIntPoint>& Locations);
+
+	/**
+	 * Adds a blocker that is not a tile to the given locations.
+	 *
+	 * @param Locations - The grid locations being blocked.
+	 * @param BlockedChannels - A bit mask of the collision channels being blocked.
+	 */
+	void AddBlocker(const TSet<FIntPoint>& Locations, const uint32 BlockedChannels);
+
+	/**
+	 * Removes a blocker that is not a tile from the given locations.
+	 *
+	 * @param Locations - The grid locations no longer being blocked.
+	 * @param BlockedChannels - A bit mask of the collision channels that were being blocked.
+	 */
+	void RemoveBlocker(const TSet<FIntPoint>& Locations, const uint32 BlockedChannels);
+
+	/**
+	 * Holds back occupancy change notifications until the matching EndChangeBatch. Batches may be nested.
+	 */
+	void BeginChangeBatch();
+
+	/**
+	 * Ends a batch started by BeginChangeBatch. Ending the outermost batch sends a single notification with every location
+	 * changed during it.
+	 */
+	void EndChangeBatch();
+
+	/**
+	 * Checks a given grid location for anything blocking a channel.
+	 *
+	 * @param GridLocation - The given grid location to check.
+	 * @param OverlapingTile - Will be set to the tile at the given location if there is one, otherwise is nullptr.
+	 * @param IgnoredTiles - The tiles to ignore when querying.
+	 * @param Channel - The channel to test against.
+	 *
+	 * @return Whether or not anything was blocking the channel at the given location.
+	 */
+	bool OverlapGridLocation(const FIntPoint GridLocation, ATile*& OverlapingTile, const TArray<AActor*>& IgnoredTiles, const ECollisionChannel Channel) const;
+
+	/**
+	 * Gets the tile registered at a given grid location regardless of what it blocks. If several tiles share the
+	 * location, the one registered last is returned.
+	 *
+	 * @param GridLocation - The given grid location.
+	 * @return The tile at the location. Nullptr if there is none.
+	 */
+	ATile* GetTileAtLocation(const FIntPoint GridLocation) const;
+
+	//Called whenever a tile or blocker is added to or removed from some locations.
+	FOccupancyChangedDelegate OnOccupancyChanged;
+
+private:
+	/**
+	 * Tells listeners that some locations changed, or remembers them until the current batch ends.
+	 *
+	 * @param Locations - The locations whose occupancy may have changed.
+	 */
+	void NotifyOccupancyChanged(const TSet<FIntPoint>& Locations);
+
+	/**
+	 * Adds the components of an actor that block grid queries without moving, unless the actor is a tile.
+	 *
+	 * @param Actor - The actor to add the components of.
+	 */
+	void AddStaticBlockers(AActor* Actor);
+
+	/**
+	 * Removes the static blockers of an actor that is leaving play.
+	 *
+	 * @param Actor - The actor leaving play.
+	 * @param EndPlayReason - Why the actor is leaving play.
+	 */
+	UFUNCTION()
+	void RemoveStaticBlockers(AActor* Actor, EEndPlayReason::Type EndPlayReason);
+
+	/**
+	 * Gets the grid locations whose centers are covered by the bounds of a static blocker.
+	 *
+	 * @param Bounds - The area covered by the blocker from above.
+	 * @param OutLocations - Will be set to the covered locations.
+	 * @return Whether the bounds cover few enough locations to be indexed by them.
+	 */
+	static bool GetStaticBlockerLocations(const FBox2D& Bounds, TArray<FIntPoint>& OutLocations);
+
+	/**
+	 * Checks whether level geometry blocks a channel at a given grid location.
+	 *
+	 * @param GridLocation - The given grid location to check.
+	 * @param IgnoredActors - The actors to ignore when querying.
+	 * @param Channel - The channel to test against.
+	 * @return Whether level geometry blocks the channel at the location.
+	 */
+	bool OverlapStaticBlockers(const FIntPoint GridLocation, const TArray<AActor*>& IgnoredActors, const ECollisionChannel Channel) const;
+
+	/**
+	 * A tile occupying a single grid location.
+	 */
+	struct FTileOccupancy
+	{
+		//The tile at the location.
+		TWeakObjectPtr<ATile> Tile;
+
+		//The channels blocked by the tile.
+		uint32 BlockedChannels = 0;
+	};
+
+	/**
+	 * A component of the level that blocks grid queries and does not move.
+	 */
+	struct FStaticBlocker
+	{
+		//The blocking component.
+		TWeakObjectPtr<UPrimitiveComponent> Component;
+
+		//The channels blocked by the component.
+		uint32 BlockedChannels = 0;
+
+		//The area covered by the component from above.
+		FBox2D Bounds = FBox2D(ForceInit);
+
+		//Whether the blocker is indexed by the locations it covers rather than checked at every location.
+		bool bIsIndexed = false;
+	};
+
+	//The tiles occupying each grid location in the order they were registered.
+	TMap<FIntPoint, TArray<FTileOccupancy, TInlineAllocator<1>>> LocationsToTiles = TMap<FIntPoint, TArray<FTileOccupancy, TInlineAllocator<1>>>();
+
+	//The level geometry that blocks grid queries.
+	TSparseArray<FStaticBlocker> StaticBlockers = TSparseArray<FStaticBlocker>();
+
+	//The indices of the static blockers whose bounds cover each grid location.
+	TMap<FIntPoint, TArray<int32, TInlineAllocator<1>>> LocationsToStaticBlockers = TMap<FIntPoint, TArray<int32, TInlineAllocator<1>>>();
+
+	//The indices of the static blockers that cover too many locations to be indexed by them.
+	TArray<int32> UnindexedStaticBlockers = TArray<int32>();
+
+	//The indices of the static blockers of each actor, so they can be removed when it leaves play.
+	TMap<const AActor*, TArray<int32>> ActorsToStaticBlockers = TMap<const AActor*, TArray<int32>>();
+
+	//The channels blocked by any static blocker.
+	uint32 StaticBlockedChannels = 0;
+
+	//The handle of the listener for actors spawned after play began.
+	FDelegateHandle ActorSpawnedHandle = FDelegateHandle();
+
+	//The number of non tile blockers at each location for each channel.
+	TMap<ECollisionChannel, TMap<FIntPoint, int>> ChannelToLocationToBlockerCounts = TMap<ECollisionChannel, TMap<FIntPoint, int>>();
+
+	//The number of change batches that have begun and not ended.
+	int32 ChangeBatchDepth = 0;
+
+	//The locations changed during the current batch.
+	TSet<FIntPoint> BatchedChangedLocations = TSet<FIntPoint>();
+};
+/* /\ ======================= /\ *\
+|  /\ UGridOccupancySubsystem /\  |
+\* /\ ======================= /\ */
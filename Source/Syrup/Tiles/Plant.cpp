@@ -3,9 +3,15 @@
 #include "Plant.h"
 
 #include "Syrup/Systems/SyrupGameMode.h"
+#include "Syrup/Systems/BoardHistorySubsystem.h"
+#include "Syrup/Systems/TileEffectDispatcher.h"
 #include "Effects/TileEffect.h"
 #include "Resources/Resource.h"
+#include "Resources/ResourcePool.h"
+#include "Resources/ResourceNetwork.h"
 #include "Components/InstancedStaticMeshComponent.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
 
 DEFINE_LOG_CATEGORY(LogPlant);
 
@@ -17,44 +23,84 @@ DEFINE_LOG_CATEGORY(LogPlant);
 \* \/ Initialization \/ */
 APlant::APlant()
 {
-	FSinkAmountUpdateDelegate AmountSetter;
-	AmountSetter.BindUFunction(this, FName("SetHealth"));
-	FSinkLocationsDelegate LocationGetter;
-	LocationGetter.BindUFunction(this, FName("GetSubTileLocations"));
-	FSinkAmountDelegate AmountGetter;
-	AmountGetter.BindUFunction(this, FName("GetHealth"));
-
-	HealthResourceSink = UResourceSink::CreateDefaultResourceSinkComponent(this, AmountSetter, LocationGetter, AmountGetter);
-	AmountSetter.BindUFunction(this, FName("SetRange"));
-	AmountGetter.BindUFunction(this, FName("GetRange"));
-	RangeResourceSink = UResourceSink::CreateDefaultResourceSinkComponent(this, AmountSetter, LocationGetter, AmountGetter);
-	AmountSetter.BindUFunction(this, FName("SetProduction"));
-	AmountGetter.BindUFunction(this, FName("GetProduction"));
-	ProductionResourceSink = UResourceSink::CreateDefaultResourceSinkComponent(this, AmountSetter, LocationGetter, AmountGetter);
+	//Sinks keep the names they had when bound by function name so that existing saves still find them.
+	FNativeSinkLocationsDelegate LocationGetter = FNativeSinkLocationsDelegate::CreateUObject(this, &APlant::GetSubTileLocations);
+
+	HealthResourceSink = UResourceSink::CreateDefaultNativeResourceSinkComponent(this, FName("SetHealth_Sink"),
+		FNativeSinkAmountUpdateDelegate::CreateUObject(this, &APlant::SetHealth), LocationGetter, FNativeSinkAmountDelegate::CreateUObject(this, &APlant::GetHealth));
+	RangeResourceSink = UResourceSink::CreateDefaultNativeResourceSinkComponent(this, FName("SetRange_Sink"),
+		FNativeSinkAmountUpdateDelegate::CreateUObject(this, &APlant::SetRange), LocationGetter, FNativeSinkAmountDelegate::CreateUObject(this, &APlant::GetRange));
+	ProductionResourceSink = UResourceSink::CreateDefaultNativeResourceSinkComponent(this, FName("SetProduction_Sink"),
+		FNativeSinkAmountUpdateDelegate::CreateUObject(this, &APlant::SetProduction), LocationGetter, FNativeSinkAmountDelegate::CreateUObject(this, &APlant::GetProduction));
 }
 
 
 /**
- * Binds effect triggers and initializes size.
+ * Binds effect triggers, joins the resource network, and initializes size.
  */
 void APlant::BeginPlay()
 {
+	//Effects are registered by now and sinks may trigger effects while beginning play.
+	UpdateEffectTriggerMask();
+
 	Super::BeginPlay();
 
 	SubtileMesh->SetCollisionResponseToChannel(ECC_Pawn, ECR_Ignore);
+	UpdateOccupancy();
 
 	bIsFinishedPlanting = ASyrupGameMode::IsPlayerTurn(this);
 
-	ASyrupGameMode::GetTileEffectTriggerDelegate(this).AddDynamic(this, &APlant::ReceiveEffectTrigger);
-	ASyrupGameMode::GetTileEffectTriggerDelegate(GetWorld()).Broadcast(ETileEffectTriggerType::PlantSpawned, this, GetSubTileLocations());
+	//Phases handled by the plant itself are always needed. Everything is needed if blueprints handle triggers.
+	uint32 ListenerTriggerMask = EffectTriggerMask | GetTileEffectTriggerBit(ETileEffectTriggerType::TrashDamage) | GetTileEffectTriggerBit(ETileEffectTriggerType::PlayerTurn);
+	if (GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(APlant, ReceiveEffectTrigger)))
+	{
+		ListenerTriggerMask = ALL_TRIGGERS_MASK;
+	}
+
+	UTileEffectDispatcher* Dispatcher = UTileEffectDispatcher::Get(this);
+	if (IsValid(Dispatcher))
+	{
+		EffectTriggerListenerHandle = Dispatcher->RegisterListener(FTileEffectTriggerListener::CreateUObject(this, &APlant::ReceiveEffectTrigger), ListenerTriggerMask & (PHASE_TRIGGER_MASK | GLOBAL_TRIGGER_MASK), GetEffectLocations());
+	}
+	UResourceNetwork* Network = UResourceNetwork::Get(this);
+	if (IsValid(Network))
+	{
+		Network->UpdateFaucet(this);
+	}
+
+	ASyrupGameMode::BroadcastTileEffectTrigger(this, ETileEffectTriggerType::PlantSpawned, this, GetSubTileLocations());
 }
 
 /**
- * Handles undoing effects and deallocating resources,
+ * Handles undoing effects, deallocating and releasing resources, and leaving the resource network.
  */
 void APlant::Destroyed()
 {
 	Died_Implementation();
+
+	//Return the freed resources to the pool.
+	UResourcePool* Pool = UResourcePool::Get(this);
+	if (IsValid(Pool))
+	{
+		for (const FResourceHandle& EachProducedResource : ProducedResources)
+		{
+			Pool->ReleaseResource(EachProducedResource);
+		}
+	}
+	ProducedResources.Empty();
+
+	UTileEffectDispatcher* Dispatcher = UTileEffectDispatcher::Get(this);
+	if (IsValid(Dispatcher))
+	{
+		Dispatcher->UnregisterListener(EffectTriggerListenerHandle);
+	}
+
+	UResourceNetwork* Network = UResourceNetwork::Get(this);
+	if (IsValid(Network))
+	{
+		Network->RemoveFaucet(this);
+	}
+
 	Super::Destroyed();
 }
 
@@ -70,6 +116,7 @@ void APlant::OnConstruction(const FTransform& Transform)
 	Health = 0;
 	Range = 0;
 	Production = 0;
+	InvalidateGridCache();
 
 	SubtileMesh->SetCollisionResponseToChannel(ECollisionChannel::ECC_Pawn, ECollisionResponse::ECR_Ignore);
 }
@@ -143,16 +190,21 @@ void APlant::Died_Implementation()
 	if (!bHasDied)
 	{
 		bHasDied = true;
-		for (UResource* EachAllocatedResource : AllocatedResources)
-		{
-			EachAllocatedResource->Free();
-		}
-		for (UResource* EachAllocatedResource : ProducedResources)
+		UResourcePool* Pool = UResourcePool::Get(this);
+		if (IsValid(Pool))
 		{
-			EachAllocatedResource->Free();
+			for (const FResourceHandle& EachAllocatedResource : AllocatedResources)
+			{
+				Pool->FreeResource(EachAllocatedResource);
+			}
+			for (const FResourceHandle& EachAllocatedResource : ProducedResources)
+			{
+				Pool->FreeResource(EachAllocatedResource);
+			}
 		}
 
 		SubtileMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		UpdateOccupancy();
 		ReceiveEffectTrigger(ETileEffectTriggerType::OnDeactivated, nullptr, TSet<FIntPoint>());
 	}
 }
@@ -185,9 +237,17 @@ bool APlant::SowPlant(UObject* WorldContextObject, int& EnergyReserve, TSubclass
 	int NeededEnergy = DefaultPlant->GetPlantingCost();
 	if (EnergyReserve >= NeededEnergy)
 	{
-		if (SowPlant(WorldContextObject, PlantClass, Transform))
+		APlant* SownPlant = TrySowPlant(WorldContextObject, PlantClass, Transform);
+		if (IsValid(SownPlant))
 		{
 			EnergyReserve -= NeededEnergy;
+
+			//Only sowing that costs energy is done by the player, so only it can be undone.
+			UBoardHistorySubsystem* History = UBoardHistorySubsystem::Get(WorldContextObject);
+			if (IsValid(History))
+			{
+				History->RecordSow(SownPlant, NeededEnergy);
+			}
 			return true;
 		}
 	}
@@ -198,21 +258,34 @@ bool APlant::SowPlant(UObject* WorldContextObject, TSubclassOf<APlant> PlantClas
 	return SowPlant(WorldContextObject, PlantClass, UGridLibrary::WorldTransformToGridTransform(Transform));
 }
 bool APlant::SowPlant(UObject* WorldContextObject, TSubclassOf<APlant> PlantClass, FGridTransform Transform)
+{
+	return IsValid(TrySowPlant(WorldContextObject, PlantClass, Transform));
+}
+
+/**
+ * Plants a plant with the given transform without spending energy.
+ *
+ * @param WoldContextObject - Any object in the would to spawn the plant in.
+ * @param PlantClass - The type of plant to plant.
+ * @param Transform - The location to spawn the plant at.
+ *
+ * @return The plant that was planted. Nullptr if there was not enough space to plant it.
+ */
+APlant* APlant::TrySowPlant(UObject* WorldContextObject, TSubclassOf<APlant> PlantClass, FGridTransform Transform)
 {
 	if (!IsValid(PlantClass) || PlantClass.Get()->HasAnyClassFlags(CLASS_Abstract))
 	{
 		UE_LOG(LogPlant, Error, TEXT("Tried to sow null or abstract plant."))
-		return false;
+		return nullptr;
 	}
 	
 	TSet<ATile*> BlockingTiles;
 	if (!UGridLibrary::OverlapShape(WorldContextObject, UGridLibrary::TransformShape(PlantClass.GetDefaultObject()->GetRelativeSubTileLocations(), Transform), BlockingTiles, TArray<AActor*>(), ECollisionChannel::ECC_GameTraceChannel3))
 	{
-		WorldContextObject->GetWorld()->SpawnActor<APlant>(PlantClass, UGridLibrary::GridTransformToWorldTransform(Transform));
-		return true;
+		return WorldContextObject->GetWorld()->SpawnActor<APlant>(PlantClass, UGridLibrary::GridTransformToWorldTransform(Transform));
 	}
 
-	return false;
+	return nullptr;
 }
 
 /* /\ Growth /\ *\
@@ -231,7 +304,7 @@ bool APlant::SowPlant(UObject* WorldContextObject, TSubclassOf<APlant> PlantClas
 void APlant::SetRange_Implementation(const int NewRange)
 {
 	TSet<FIntPoint> OldEffectLocations = GetEffectLocations();
-	TSet<FIntPoint> NewEffectLocations = UGridLibrary::ScaleShapeUp(GetSubTileLocations(), FMath::Max(0, NewRange));
+	TSet<FIntPoint> NewEffectLocations = GetEffectLocationsAtRange(NewRange);
 
 	TSet<FIntPoint> DeactivatedLocations = OldEffectLocations.Difference(NewEffectLocations);
 	if (!DeactivatedLocations.IsEmpty())
@@ -240,6 +313,9 @@ void APlant::SetRange_Implementation(const int NewRange)
 	}
 
 	Range = FMath::Max(0, NewRange);
+	CachedEffectLocations = NewEffectLocations;
+	bIsEffectLocationCacheValid = true;
+	UpdateEffectTriggerFootprint();
 	TSet<FIntPoint> ActivatedLocations = NewEffectLocations.Difference(OldEffectLocations);
 	if (!ActivatedLocations.IsEmpty())
 	{
@@ -271,7 +347,7 @@ void APlant::ReceiveEffectTrigger_Implementation(const ETileEffectTriggerType Tr
 		DamageTaken += IncomingDamage;
 		if (Health <= DamageTaken)
 		{
-			ASyrupGameMode::GetTileEffectTriggerDelegate(GetWorld()).Broadcast(ETileEffectTriggerType::PlantKilled, this, GetSubTileLocations());
+			ASyrupGameMode::BroadcastTileEffectTrigger(this, ETileEffectTriggerType::PlantKilled, this, GetSubTileLocations());
 			Died();
 		}
 		else if (IncomingDamage > 0)
@@ -281,7 +357,7 @@ void APlant::ReceiveEffectTrigger_Implementation(const ETileEffectTriggerType Tr
 		TilesToIncomingDamages.Empty();
 	}
 
-	if (GetRange() >= 0 && Health > 0 && bIsFinishedPlanting)
+	if ((EffectTriggerMask & GetTileEffectTriggerBit(TriggerType)) && GetRange() >= 0 && Health > 0 && bIsFinishedPlanting)
 	{
 		TSet<FIntPoint> EffectedLocations = GetEffectLocations();
 		TSet<FIntPoint> TriggeredLocations = LocationsToTrigger.IsEmpty() ? EffectedLocations : LocationsToTrigger.Intersect(EffectedLocations);
@@ -295,6 +371,18 @@ void APlant::ReceiveEffectTrigger_Implementation(const ETileEffectTriggerType Tr
 	}
 }
 
+/**
+ * Gets the locations the effects of this plant would apply to at a given range. A range of 0 has no effect locations.
+ *
+ * @param InRange - The range to get the effect locations at.
+ * @return A set of all locations where the effects of this plant would apply.
+ */
+TSet<FIntPoint> APlant::GetEffectLocationsAtRange(const int InRange) const
+{
+	//Scaling by 0 leaves the shape as is, but a plant without range affects nothing.
+	return InRange > 0 ? UGridLibrary::ScaleShapeUp(GetSubTileLocations(), InRange) : TSet<FIntPoint>();
+}
+
 /**
  * Gets the locations where the effects of this plant will apply.
  *
@@ -302,12 +390,65 @@ void APlant::ReceiveEffectTrigger_Implementation(const ETileEffectTriggerType Tr
  */
 TSet<FIntPoint> APlant::GetEffectLocations() const
 {
-	if (Range > 0)
+	if (!bIsEffectLocationCacheValid)
 	{
-		return UGridLibrary::ScaleShapeUp(GetSubTileLocations(), Range);
+		CachedEffectLocations = GetEffectLocationsAtRange(Range);
+		bIsEffectLocationCacheValid = true;
+	}
+#if DO_CHECK
+	else if (ShouldVerifyGridCaches())
+	{
+		TSet<FIntPoint> ActualEffectLocations = GetEffectLocationsAtRange(Range);
+		ensureMsgf(ActualEffectLocations.Num() == CachedEffectLocations.Num() && ActualEffectLocations.Includes(CachedEffectLocations),
+			TEXT("%s has stale cached effect locations."), *GetName());
+	}
+#endif
+
+	return CachedEffectLocations;
+}
+
+/**
+ * Clears the cached effect locations along with the cached grid transform and sub-tile locations.
+ */
+void APlant::InvalidateGridCache()
+{
+	Super::InvalidateGridCache();
+	bIsEffectLocationCacheValid = false;
+	UpdateEffectTriggerFootprint();
+}
+
+/**
+ * Combines the trigger masks of all of this plant's effects.
+ */
+void APlant::UpdateEffectTriggerMask()
+{
+	EffectTriggerMask = 0;
+
+	TInlineComponentArray<UTileEffect*> Effects = TInlineComponentArray<UTileEffect*>();
+	GetComponents<UTileEffect>(Effects);
+	for (UTileEffect* EachEffect : Effects)
+	{
+		EffectTriggerMask |= EachEffect->GetRelevantTriggerMask();
+	}
+}
+
+/**
+ * Updates the locations this plant receives global triggers at and can allocate resources to to match its effect locations.
+ */
+void APlant::UpdateEffectTriggerFootprint()
+{
+	UTileEffectDispatcher* Dispatcher = UTileEffectDispatcher::Get(this);
+	if (EffectTriggerListenerHandle != INDEX_NONE && IsValid(Dispatcher))
+	{
+		Dispatcher->SetListenerFootprint(EffectTriggerListenerHandle, GetEffectLocations());
+	}
+
+	//Resources reach the same locations as effects.
+	UResourceNetwork* Network = UResourceNetwork::Get(this);
+	if (IsValid(Network) && Network->IsFaucetRegistered(this))
+	{
+		Network->UpdateFaucet(this);
 	}
-	
-	return TSet<FIntPoint>();
 }
 
 /* /\ Effect /\ *\
@@ -325,6 +466,12 @@ TSet<FIntPoint> APlant::GetEffectLocations() const
  */
 void APlant::SetProduction_Implementation(int NewProduction)
 {
+	UResourcePool* Pool = UResourcePool::Get(this);
+	if (!IsValid(Pool))
+	{
+		return;
+	}
+
 	NewProduction = FMath::Max(0, NewProduction);
 	while (ProducedResources.Num() < NewProduction)
 	{
@@ -334,40 +481,50 @@ void APlant::SetProduction_Implementation(int NewProduction)
 
 	while (ProducedResources.Num() > NewProduction)
 	{
-		UResource* ResourceToRemove = nullptr;
-		for (UResource* EachProducedResource : ProducedResources)
-		{
-			if (!EachProducedResource->IsAllocated())
-			{
-				ResourceToRemove = EachProducedResource;
-				break;
-			}
-		}
-
-		if (!IsValid(ResourceToRemove))
+		int32 IndexToRemove = ProducedResources.IndexOfByPredicate([Pool](const FResourceHandle& EachProducedResource) { return !Pool->IsAllocated(EachProducedResource); });
+		if (IndexToRemove == INDEX_NONE)
 		{
-			ProducedResources[ProducedResources.Num() - 1]->Free();
+			Pool->FreeResource(ProducedResources.Last());
+			Pool->ReleaseResource(ProducedResources.Last());
 			ProducedResources.SetNum(ProducedResources.Num() - 1);
 			Production--;
 			return;
 		}
-		ResourceToRemove->Free();
-		ProducedResources.RemoveSingle(ResourceToRemove);
+		Pool->FreeResource(ProducedResources[IndexToRemove]);
+		Pool->ReleaseResource(ProducedResources[IndexToRemove]);
+		ProducedResources.RemoveAt(IndexToRemove);
 		Production--;
 	}
 }
 
+/**
+ * Gets all the resources supplied by this plant, creating facades for any that do not have one yet.
+ *
+ * @return The resources supplied by this plant.
+ */
+TArray<UResource*> APlant::GetProducedResources() const
+{
+	UResourcePool* Pool = UResourcePool::Get(this);
+	return IsValid(Pool) ? Pool->GetFacades(ProducedResources) : TArray<UResource*>();
+}
 
 /**
  * Causes this to produce an  additional resource of the given type.
  *
  * @param Type - The type of resource to produce.
  *
- * @return The newly created resource.
+ * @return The handle of the newly created resource.
  */
-UResource* APlant::ProduceResource(const EResourceType& Type)
+FResourceHandle APlant::ProduceResource(const EResourceType& Type)
 {
-	UResource* NewResource = UResource::Create(Type, this);
+	UResourcePool* Pool = UResourcePool::Get(this);
+	if (!IsValid(Pool))
+	{
+		UE_LOG(LogResource, Error, TEXT("%s is not in a world with a resource pool."), *GetName());
+		return FResourceHandle();
+	}
+
+	const FResourceHandle NewResource = Pool->CreateResource(Type, this);
 	ProducedResources.Add(NewResource);
 	return NewResource;
 }
@@ -377,4 +534,43 @@ UResource* APlant::ProduceResource(const EResourceType& Type)
 
 /* /\ ====== /\ *\
 |  /\ APlant /\  |
-\* /\ ====== /\ */
\ No newline at end of file
+\* /\ ====== /\ */
+
+
+#if !UE_BUILD_SHIPPING
+/**
+ * Checks that the cached effect locations of every plant match their range, and optionally that no plant would have
+ * effect locations at range 0. Does not change any plants.
+ * Usage: Syrup.Plants.VerifyEffectLocations [ZeroRange]
+ */
+static FAutoConsoleCommandWithWorldAndArgs VerifyPlantEffectLocationsCommand(
+	TEXT("Syrup.Plants.VerifyEffectLocations"),
+	TEXT("Checks that the cached effect locations of every plant match their range. Pass ZeroRange to also check that each plant would have no effect locations at range 0."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			const bool bZeroRange = Args.Num() > 0 && Args[0].Equals(TEXT("ZeroRange"), ESearchCase::IgnoreCase);
+			int NumPlants = 0;
+			int NumMismatches = 0;
+			for (TActorIterator<APlant> PlantIterator(World); PlantIterator; ++PlantIterator)
+			{
+				const APlant* Plant = *PlantIterator;
+				NumPlants++;
+
+				TSet<FIntPoint> Expected = Plant->GetEffectLocationsAtRange(Plant->GetRange());
+				TSet<FIntPoint> Actual = Plant->GetEffectLocations();
+				if (Expected.Num() != Actual.Num() || !Expected.Includes(Actual))
+				{
+					UE_LOG(LogPlant, Error, TEXT("%s has %d effect locations at range %d but expected %d."), *Plant->GetName(), Actual.Num(), Plant->GetRange(), Expected.Num());
+					NumMismatches++;
+				}
+
+				if (bZeroRange && !Plant->GetEffectLocationsAtRange(0).IsEmpty())
+				{
+					UE_LOG(LogPlant, Error, TEXT("%s would still have effect locations at range 0."), *Plant->GetName());
+					NumMismatches++;
+				}
+			}
+			UE_LOG(LogPlant, Display, TEXT("Effect location verification of %d plants: %d mismatches"), NumPlants, NumMismatches);
+		})
+);
+#endif
@@ -34,12 +34,12 @@ class SYRUP_API APlant : public ATile, public IResourceFaucet
 private:
 
 	/**
-	 * Binds effect triggers and initializes size.
+	 * Binds effect triggers, joins the resource network, and initializes size.
 	 */
 	virtual void BeginPlay() override;
 
 	/**
-	 * Handles undoing effects and deallocating resources,
+	 * Handles undoing effects, deallocating and releasing resources, and leaving the resource network.
 	 */
 	virtual void Destroyed() override;
 
@@ -168,6 +168,17 @@ public:
 	static bool SowPlant(UObject* WorldContextObject, TSubclassOf<APlant> PlantClass, FTransform Transform);
 	static bool SowPlant(UObject* WorldContextObject, TSubclassOf<APlant> PlantClass, FGridTransform Transform);
 
+	/**
+	 * Plants a plant with the given transform without spending energy.
+	 *
+	 * @param WoldContextObject - Any object in the would to spawn the plant in.
+	 * @param PlantClass - The type of plant to plant.
+	 * @param Transform - The location to spawn the plant at.
+	 *
+	 * @return The plant that was planted. Nullptr if there was not enough space to plant it.
+	 */
+	static APlant* TrySowPlant(UObject* WorldContextObject, TSubclassOf<APlant> PlantClass, FGridTransform Transform);
+
 	/**
 	 * Gets cost to plant this plant type.
 	 * 
@@ -210,6 +221,14 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Plant|Effect")
 	FORCEINLINE int GetRange() const { return Range; };
 
+	/**
+	 * Gets the locations the effects of this plant would apply to at a given range. A range of 0 has no effect locations.
+	 *
+	 * @param InRange - The range to get the effect locations at.
+	 * @return A set of all locations where the effects of this plant would apply.
+	 */
+	TSet<FIntPoint> GetEffectLocationsAtRange(const int InRange) const;
+
 protected:
 	
 	/**
@@ -241,6 +260,33 @@ private:
 	UFUNCTION()
 	TSet<FIntPoint> GetEffectLocations() const;
 
+	/**
+	 * Clears the cached effect locations along with the cached grid transform and sub-tile locations.
+	 */
+	virtual void InvalidateGridCache() override;
+
+	//Whether the cached effect locations are up to date.
+	mutable bool bIsEffectLocationCacheValid = false;
+
+	//The locations where the effects of this plant applied when the cache was last updated.
+	mutable TSet<FIntPoint> CachedEffectLocations = TSet<FIntPoint>();
+
+	/**
+	 * Updates the locations this plant receives global triggers at and can allocate resources to to match its effect locations.
+	 */
+	void UpdateEffectTriggerFootprint();
+
+	//The handle of this plant's listener in the tile effect dispatcher.
+	int32 EffectTriggerListenerHandle = INDEX_NONE;
+
+	/**
+	 * Combines the trigger masks of all of this plant's effects.
+	 */
+	void UpdateEffectTriggerMask();
+
+	//The triggers that at least one of this plant's effects responds to.
+	uint32 EffectTriggerMask = 0;
+
 	/* /\ Effect /\ *\
 	\* ------------ */
 
@@ -274,11 +320,18 @@ public:
 	FORCEINLINE EResourceType GetProductionType() const { return ProductionType; };
 
 	/**
-	 * Gets all the resources supplied by this plant.
+	 * Gets all the resources supplied by this plant, creating facades for any that do not have one yet.
 	 * 
 	 * @return The resources supplied by this plant.
 	 */
-	virtual FORCEINLINE TArray<UResource*> GetProducedResources() const override { return ProducedResources; };
+	virtual TArray<UResource*> GetProducedResources() const override;
+
+	/**
+	 * Gets the handles of all the resources supplied by this plant.
+	 *
+	 * @return The handles of the resources supplied by this plant.
+	 */
+	virtual FORCEINLINE TArray<FResourceHandle> GetProducedResourceHandles() const override { return ProducedResources; };
 
 	/**
 	 * Gets the grid locations that this sink takes up.
@@ -293,9 +346,9 @@ public:
      * 
      * @param Type - The type of resource to produce.
      * 
-     * @return The newly created resource.
+     * @return The handle of the newly created resource.
      */
-    virtual UResource* ProduceResource(const EResourceType& Type) override;
+    virtual FResourceHandle ProduceResource(const EResourceType& Type) override;
 protected:
 
 	//The relation of how resources are allocated to production and how that is displayed.
@@ -313,11 +366,11 @@ protected:
 private:
 	//The resources produced by this.
 	UPROPERTY()
-	TArray<UResource*> ProducedResources;
+	TArray<FResourceHandle> ProducedResources;
 	
 	//The resources allocated to this.
 	UPROPERTY()
-	TArray<UResource*> AllocatedResources;
+	TArray<FResourceHandle> AllocatedResources;
 
 	/* /\ Resource /\ *\
 	\* -------------- */
@@ -4,6 +4,7 @@
 #include "Resource.h"
 
 #include "ResourceSink.h"
+#include "ResourcePool.h"
 
 DEFINE_LOG_CATEGORY(LogResource);
 
@@ -21,14 +22,14 @@ UResource* UResource::Create(EResourceType ResourceType, TScriptInterface<IResou
 		return nullptr;
 	}
 
-	UResource* NewResource = NewObject<UResource>(Class);
-	NewResource->FaucetCreatedby = Faucet;
-	NewResource->Type = ResourceType;
-	return NewResource;
-}
-UResource* UResource::Create(EResourceType ResourceType, TScriptInterface<IResourceFaucet> Faucet)
-{
-	return Create(ResourceType, Faucet, UResource::StaticClass());
+	UResourcePool* ResourcePool = UResourcePool::Get(Faucet.GetObject());
+	if (!IsValid(ResourcePool))
+	{
+		UE_LOG(LogResource, Error, TEXT("%s is not in a world with a resource pool."), *Faucet.GetObject()->GetName());
+		return nullptr;
+	}
+
+	return ResourcePool->GetFacade(ResourcePool->CreateResource(ResourceType, Faucet.GetObject()), Class);
 }
 
 /**
@@ -41,33 +42,13 @@ UResource* UResource::Create(EResourceType ResourceType, TScriptInterface<IResou
  */
 bool UResource::Allocate(UResourceSink* LinkedSink, EResourceAllocationType TypeOfAllocation)
 {
-	if (!IsValid(FaucetCreatedby.GetObject()))
+	if (!IsValid(Pool))
 	{
 		UE_LOG(LogResource, Error, TEXT("Invalid Faucet"));
 		return false;
 	}
 
-	if (!IsValid(LinkedSink))
-	{
-		UE_LOG(LogResource, Error, TEXT("Invalid Sink"));
-		return false;
-	}
-
-	if (TypeOfAllocation == EResourceAllocationType::NotAllocated)
-	{
-		UE_LOG(LogResource, Error, TEXT("Cannot allocate resource to NotAllocated. Use Free() to unallocated resources."));
-		return false;
-	}
-
-	if (!CanAllocateTo(LinkedSink))
-	{
-		return false;
-	}
-
-	SinkAllocatedTo = LinkedSink;
-	AllocationType = TypeOfAllocation;
-	OnAllocated.Broadcast(this);
-	return true;
+	return Pool->AllocateResource(Handle, LinkedSink, TypeOfAllocation);
 }
 
 /**
@@ -75,15 +56,21 @@ bool UResource::Allocate(UResourceSink* LinkedSink, EResourceAllocationType Type
  */
 void UResource::Free()
 {
-	if (IsAllocated())
+	if (IsValid(Pool))
 	{
-		AllocationType = EResourceAllocationType::NotAllocated;
-
-		UResourceSink* OldSink = SinkAllocatedTo;
-		SinkAllocatedTo = nullptr;
-		OldSink->FreeResource(this);
+		Pool->FreeResource(Handle);
+	}
+}
 
-		OnFreed.Broadcast(this);
+/**
+ * Returns this resource to the pool. Call when a faucet stops producing it. If it is allocated it will be returned
+ * once it is freed.
+ */
+void UResource::Release()
+{
+	if (IsValid(Pool))
+	{
+		Pool->ReleaseResource(Handle);
 	}
 }
 
@@ -94,7 +81,7 @@ void UResource::Free()
  */
 bool UResource::IsAllocated() const
 {
-	return IsValid(SinkAllocatedTo);
+	return IsValid(Pool) && Pool->IsAllocated(Handle);
 }
 
 /**
@@ -104,24 +91,7 @@ bool UResource::IsAllocated() const
  */
 bool UResource::CanAllocateTo(UResourceSink* LinkedSink) const
 {
-	if (IsAllocated() || !IsValid(FaucetCreatedby.GetObject()) || !IsValid(LinkedSink) || LinkedSink->GetOwner() == FaucetCreatedby.GetObject())
-	{
-		return false;
-	}
-
-	if (Type != EResourceType::Any && LinkedSink->GetRequiredResourceType() != EResourceType::Any && Type != LinkedSink->GetRequiredResourceType())
-	{
-		return false;
-	}
-
-	for (FIntPoint EachAllocationLocation : LinkedSink->GetAllocationLocations())
-	{
-		if (FaucetCreatedby->GetAllocatableLocations().Contains(EachAllocationLocation))
-		{
-			return true;
-		}
-	}
-	return false;
+	return IsValid(Pool) && Pool->CanAllocateTo(Handle, LinkedSink);
 }
 
 
@@ -132,7 +102,7 @@ bool UResource::CanAllocateTo(UResourceSink* LinkedSink) const
  */
 UResourceSink* UResource::GetLinkedSink() const
 {
-	return SinkAllocatedTo;
+	return IsValid(Pool) ? Pool->GetSink(Handle) : nullptr;
 }
 
 
@@ -144,7 +114,7 @@ UResourceSink* UResource::GetLinkedSink() const
  */
 void UResource::GetLinkedFaucet(TScriptInterface<IResourceFaucet>& ReturnValue) const
 {
-	ReturnValue = FaucetCreatedby;
+	ReturnValue = IsValid(Pool) ? Pool->GetFaucet(Handle) : nullptr;
 }
 
 /**
@@ -154,5 +124,15 @@ void UResource::GetLinkedFaucet(TScriptInterface<IResourceFaucet>& ReturnValue)
  */
 EResourceAllocationType UResource::GetAllocationType() const
 {
-	return AllocationType;
+	return IsValid(Pool) ? Pool->GetAllocationType(Handle) : EResourceAllocationType::NotAllocated;
+}
+
+/**
+ * Gets type of resource that this is.
+ *
+ * @return The type of resource that this is.
+ */
+EResourceType UResource::GetType() const
+{
+	return IsValid(Pool) ? Pool->GetType(Handle) : EResourceType::Any;
 }
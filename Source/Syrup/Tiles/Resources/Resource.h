@@ -6,12 +6,14 @@
 #include "ResourceAllocationType.h"
 #include "ResourceSink.h"
 #include "ResourceFaucet.h"
+#include "ResourceHandle.h"
 
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
 #include "Resource.generated.h"
 
 class ATile;
+class UResourcePool;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogResource, Log, All);
 
@@ -22,6 +24,11 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FResourceUpdate, UResource*, Updated
 \* \/ ======== \/ */
 /**
  * Represents a resource that can be linked to a tile to modify it.
+ *
+ * The state of the resource is stored in the world's resource pool; this is the facade blueprints and UI use to access
+ * it. Native code uses the handle directly, so a facade is only created once something asks for it. Once its resource
+ * is released a facade has no faucet or sink, unless facade recycling is on, in which case it may be reused by a new
+ * resource.
  */
 UCLASS(BlueprintType, CustomConstructor)
 class SYRUP_API UResource : public UObject
@@ -40,7 +47,6 @@ public:
 	 */
 	UFUNCTION(BlueprintCallable)
 	static UResource* Create(EResourceType ResourceType, TScriptInterface<IResourceFaucet> Faucet, TSubclassOf<UResource> Class);
-	static UResource* Create(EResourceType ResourceType, TScriptInterface<IResourceFaucet> Faucet);
 
 	/**
 	 * Allocates this resource.
@@ -59,6 +65,13 @@ public:
 	UFUNCTION()
 	void Free();
 
+	/**
+	 * Returns this resource to the pool. Call when a faucet stops producing it. If it is allocated it will be returned
+	 * once it is freed.
+	 */
+	UFUNCTION(BlueprintCallable)
+	void Release();
+
 	/**
 	 * Gets whether this resource is already allocated.
 	 * 
@@ -105,7 +118,15 @@ public:
 	 * @return The type of resource that this is.
 	 */
 	UFUNCTION(BlueprintPure)
-	FORCEINLINE EResourceType GetType() const { return Type; };
+	EResourceType GetType() const;
+
+	/**
+	 * Gets the handle of this resource in the resource pool.
+	 *
+	 * @return The handle of this resource.
+	 */
+	UFUNCTION(BlueprintPure)
+	FORCEINLINE FResourceHandle GetHandle() const { return Handle; };
 
 	//Called when this is freed.
 	UPROPERTY(BlueprintAssignable)
@@ -116,21 +137,15 @@ public:
 	FResourceUpdate OnAllocated;
 
 private:
-	//The sink this is allocated to. Nullptr if unallocated.
-	UPROPERTY()
-	UResourceSink* SinkAllocatedTo = nullptr;
-	
-	//The faucet this supplied by. Should never be null.
-	UPROPERTY()
-	TScriptInterface<IResourceFaucet> FaucetCreatedby = nullptr;
+	friend class UResourcePool;
 
-	//The way this has been allocated.
+	//The handle of this resource in the pool.
 	UPROPERTY()
-	EResourceAllocationType AllocationType = EResourceAllocationType::NotAllocated;
+	FResourceHandle Handle = FResourceHandle();
 
-	//The type of this resource
+	//The pool storing this resource.
 	UPROPERTY()
-	EResourceType Type = EResourceType::Any;
+	UResourcePool* Pool = nullptr;
 };
 /* /\ ======== /\ *\
 |  /\ Resource /\  |
@@ -0,0 +1,652 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ResourceAllocationSolver.h"
+
+#include "ResourcePool.h"
+#include "ResourceFaucet.h"
+#include "ResourceNetwork.h"
+#include "ResourceSink.h"
+#include "Syrup/Tiles/Tile.h"
+#include "Syrup/Systems/BoardHistorySubsystem.h"
+
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+
+/**
+ * A flow network solved with Dinic's algorithm.
+ */
+namespace ResourceFlowNetwork
+{
+	/**
+	 * A directed edge. Every edge is stored next to its reverse so the reverse of edge i is i ^ 1.
+	 */
+	struct FEdge
+	{
+		//The node this edge leads to.
+		int32 To = INDEX_NONE;
+
+		//The remaining capacity of this edge.
+		int32 Capacity = 0;
+	};
+
+	/**
+	 * A graph of nodes connected by edges with capacities.
+	 */
+	struct FNetwork
+	{
+		//Every edge.
+		TArray<FEdge> Edges = TArray<FEdge>();
+
+		//The edges leaving each node.
+		TArray<TArray<int32>> NodesToEdges = TArray<TArray<int32>>();
+
+		//The distance of each node from the source in the current level graph.
+		TArray<int32> Levels = TArray<int32>();
+
+		//The next edge of each node to try in the current level graph.
+		TArray<int32> NextEdges = TArray<int32>();
+
+		/**
+		 * Adds a node.
+		 *
+		 * @return The index of the node.
+		 */
+		int32 AddNode()
+		{
+			return NodesToEdges.AddDefaulted();
+		}
+
+		/**
+		 * Adds an edge and its reverse.
+		 *
+		 * @param From - The node the edge leaves.
+		 * @param To - The node the edge leads to.
+		 * @param Capacity - The capacity of the edge.
+		 * @return The index of the edge.
+		 */
+		int32 AddEdge(const int32 From, const int32 To, const int32 Capacity)
+		{
+			const int32 EdgeIndex = Edges.Add(FEdge{ To, Capacity });
+			Edges.Add(FEdge{ From, 0 });
+			NodesToEdges[From].Add(EdgeIndex);
+			NodesToEdges[To].Add(EdgeIndex + 1);
+			return EdgeIndex;
+		}
+
+		/**
+		 * Builds the level graph of the nodes reachable from the source.
+		 *
+		 * @param Source - The source node.
+		 * @param Target - The target node.
+		 * @return Whether the target can be reached.
+		 */
+		bool BuildLevels(const int32 Source, const int32 Target)
+		{
+			Levels.Init(INDEX_NONE, NodesToEdges.Num());
+			TArray<int32> Queue = TArray<int32>();
+			Queue.Reserve(NodesToEdges.Num());
+			Queue.Add(Source);
+			Levels[Source] = 0;
+			for (int32 QueueIndex = 0; QueueIndex < Queue.Num(); QueueIndex++)
+			{
+				const int32 Node = Queue[QueueIndex];
+				for (int32 EachEdgeIndex : NodesToEdges[Node])
+				{
+					const FEdge& Edge = Edges[EachEdgeIndex];
+					if (Edge.Capacity > 0 && Levels[Edge.To] == INDEX_NONE)
+					{
+						Levels[Edge.To] = Levels[Node] + 1;
+						Queue.Add(Edge.To);
+					}
+				}
+			}
+			return Levels[Target] != INDEX_NONE;
+		}
+
+		/**
+		 * Pushes flow along the level graph.
+		 *
+		 * @param Node - The node to push from.
+		 * @param Target - The target node.
+		 * @param Limit - The most flow that can reach this node.
+		 * @return The amount of flow that reached the target.
+		 */
+		int32 Push(const int32 Node, const int32 Target, const int32 Limit)
+		{
+			if (Node == Target)
+			{
+				return Limit;
+			}
+
+			for (int32& EachNextEdge = NextEdges[Node]; EachNextEdge < NodesToEdges[Node].Num(); EachNextEdge++)
+			{
+				const int32 EdgeIndex = NodesToEdges[Node][EachNextEdge];
+				FEdge& Edge = Edges[EdgeIndex];
+				if (Edge.Capacity <= 0 || Levels[Edge.To] != Levels[Node] + 1)
+				{
+					continue;
+				}
+
+				const int32 Pushed = Push(Edge.To, Target, FMath::Min(Limit, Edge.Capacity));
+				if (Pushed > 0)
+				{
+					Edges[EdgeIndex].Capacity -= Pushed;
+					Edges[EdgeIndex ^ 1].Capacity += Pushed;
+					return Pushed;
+				}
+			}
+			return 0;
+		}
+
+		/**
+		 * Pushes as much additional flow from the source to the target as possible.
+		 *
+		 * @param Source - The source node.
+		 * @param Target - The target node.
+		 * @return The amount of flow added.
+		 */
+		int64 AugmentMaxFlow(const int32 Source, const int32 Target)
+		{
+			int64 ReturnValue = 0;
+			while (BuildLevels(Source, Target))
+			{
+				NextEdges.Init(0, NodesToEdges.Num());
+				while (const int32 Pushed = Push(Source, Target, MAX_int32))
+				{
+					ReturnValue += Pushed;
+				}
+			}
+			return ReturnValue;
+		}
+	};
+
+	/**
+	 * Whether a resource of one type can fill a slot requiring another.
+	 *
+	 * @param ResourceType - The type of the resource.
+	 * @param RequiredType - The type required by the slot.
+	 * @return Whether the resource can fill the slot.
+	 */
+	FORCEINLINE bool IsTypeCompatible(const EResourceType ResourceType, const EResourceType RequiredType)
+	{
+		return ResourceType == RequiredType || ResourceType == EResourceType::Any || RequiredType == EResourceType::Any;
+	}
+}
+
+/* \/ ========================== \/ *\
+|  \/ UResourceAllocationSolver \/  |
+\* \/ ========================== \/ */
+
+/**
+ * Finds the largest allocation from supplies to demands, filling higher priority demands first, then drops the
+ * amounts that would skip an unfilled slot requiring a different type when the slots are filled in order. Dropped
+ * amounts are sent to other slots in further passes, keeping the pass that allocates the most.
+ *
+ * @param Supplies - The resources that can be allocated.
+ * @param Demands - The slots that can be allocated to.
+ * @param OutFlows - Will be set to the amounts allocated, ordered by demand and then slot.
+ * @return The total number of resources allocated by the flows, after the dropped amounts are removed.
+ */
+int32 UResourceAllocationSolver::Solve(const TArray<FSupply>& Supplies, const TArray<FDemand>& Demands, TArray<FFlow>& OutFlows)
+{
+	using namespace ResourceFlowNetwork;
+
+	OutFlows.Empty();
+	FNetwork Network = FNetwork();
+	const int32 Source = Network.AddNode();
+	const int32 Target = Network.AddNode();
+
+	/**
+	 * Consecutive slots of a demand that require the same type.
+	 */
+	struct FSlotGroup
+	{
+		int32 Node = INDEX_NONE;
+		int32 FirstSlot = 0;
+		int32 Capacity = 0;
+		EResourceType Type = EResourceType::Any;
+		int32 DemandEdge = INDEX_NONE;
+		bool bIsOpen = true;
+	};
+
+	//Demands
+	TArray<TArray<FSlotGroup>> DemandSlotGroups = TArray<TArray<FSlotGroup>>();
+	DemandSlotGroups.SetNum(Demands.Num());
+	TArray<int32> DemandTargetEdges = TArray<int32>();
+	DemandTargetEdges.Init(INDEX_NONE, Demands.Num());
+	for (int32 DemandIndex = 0; DemandIndex < Demands.Num(); DemandIndex++)
+	{
+		const FDemand& Demand = Demands[DemandIndex];
+		if (Demand.Capacity <= 0)
+		{
+			continue;
+		}
+
+		const int32 DemandNode = Network.AddNode();
+		TArray<FSlotGroup>& SlotGroups = DemandSlotGroups[DemandIndex];
+		const int32 NumSlotTypes = Demand.SlotTypes.Num();
+		for (int32 SlotIndex = 0; SlotIndex < FMath::Max(1, NumSlotTypes) && SlotIndex < Demand.Capacity; SlotIndex++)
+		{
+			//Every slot from the last listed type onwards requires that type.
+			const bool bIsLastType = SlotIndex >= NumSlotTypes - 1;
+			const EResourceType SlotType = NumSlotTypes ? Demand.SlotTypes[SlotIndex] : EResourceType::Any;
+			const int32 SlotCapacity = bIsLastType ? Demand.Capacity - SlotIndex : 1;
+			if (!SlotGroups.IsEmpty() && SlotGroups.Last().Type == SlotType)
+			{
+				SlotGroups.Last().Capacity += SlotCapacity;
+			}
+			else
+			{
+				SlotGroups.Add(FSlotGroup{ INDEX_NONE, SlotIndex, SlotCapacity, SlotType, INDEX_NONE, true });
+			}
+		}
+
+		for (FSlotGroup& EachSlotGroup : SlotGroups)
+		{
+			EachSlotGroup.Node = Network.AddNode();
+			EachSlotGroup.DemandEdge = Network.AddEdge(EachSlotGroup.Node, DemandNode, EachSlotGroup.Capacity);
+		}
+
+		//Opened once the demand's priority is reached.
+		DemandTargetEdges[DemandIndex] = Network.AddEdge(DemandNode, Target, 0);
+	}
+
+	//Supplies
+	/**
+	 * An edge from a supply to a slot group of a demand.
+	 */
+	struct FSupplyEdge
+	{
+		int32 SupplyIndex = INDEX_NONE;
+		int32 DemandIndex = INDEX_NONE;
+		int32 SlotGroupIndex = INDEX_NONE;
+		int32 EdgeIndex = INDEX_NONE;
+		int32 Capacity = 0;
+	};
+	TArray<FSupplyEdge> SupplyEdges = TArray<FSupplyEdge>();
+	TArray<int32> SupplySourceEdges = TArray<int32>();
+	SupplySourceEdges.Init(INDEX_NONE, Supplies.Num());
+	for (int32 SupplyIndex = 0; SupplyIndex < Supplies.Num(); SupplyIndex++)
+	{
+		const FSupply& Supply = Supplies[SupplyIndex];
+		if (Supply.Amount <= 0)
+		{
+			continue;
+		}
+
+		const int32 SupplyNode = Network.AddNode();
+		SupplySourceEdges[SupplyIndex] = Network.AddEdge(Source, SupplyNode, Supply.Amount);
+		for (int32 EachDemandIndex : Supply.DemandIndices)
+		{
+			if (!DemandSlotGroups.IsValidIndex(EachDemandIndex))
+			{
+				continue;
+			}
+
+			const TArray<FSlotGroup>& SlotGroups = DemandSlotGroups[EachDemandIndex];
+			for (int32 SlotGroupIndex = 0; SlotGroupIndex < SlotGroups.Num(); SlotGroupIndex++)
+			{
+				if (IsTypeCompatible(Supply.Type, SlotGroups[SlotGroupIndex].Type))
+				{
+					const int32 Capacity = FMath::Min(Supply.Amount, SlotGroups[SlotGroupIndex].Capacity);
+					SupplyEdges.Add(FSupplyEdge{ SupplyIndex, EachDemandIndex, SlotGroupIndex, Network.AddEdge(SupplyNode, SlotGroups[SlotGroupIndex].Node, Capacity), Capacity });
+				}
+			}
+		}
+	}
+
+	//Open the demands one priority at a time. Later augmentations never take flow away from the target, so higher priority demands stay filled.
+	TArray<int32> Priorities = TArray<int32>();
+	for (const FDemand& EachDemand : Demands)
+	{
+		Priorities.AddUnique(EachDemand.Priority);
+	}
+	Priorities.Sort(TGreater<int32>());
+
+	auto AugmentByPriority = [&]()
+	{
+		for (int32 EachDemandTargetEdge : DemandTargetEdges)
+		{
+			if (EachDemandTargetEdge != INDEX_NONE)
+			{
+				Network.Edges[EachDemandTargetEdge].Capacity = 0;
+			}
+		}
+
+		for (int32 EachPriority : Priorities)
+		{
+			for (int32 DemandIndex = 0; DemandIndex < Demands.Num(); DemandIndex++)
+			{
+				if (DemandTargetEdges[DemandIndex] != INDEX_NONE && Demands[DemandIndex].Priority == EachPriority)
+				{
+					//The reverse edge holds the amount already flowing to the target.
+					Network.Edges[DemandTargetEdges[DemandIndex]].Capacity = Demands[DemandIndex].Capacity - Network.Edges[DemandTargetEdges[DemandIndex] ^ 1].Capacity;
+				}
+			}
+			Network.AugmentMaxFlow(Source, Target);
+		}
+	};
+	AugmentByPriority();
+
+	//Sinks fill their slots in order, so a resource is skipped when the next open slot requires another type. Keep only
+	//what will be allocated, then take the skipped amounts back out of the network so they can be sent elsewhere. Slot
+	//groups past the first unfilled slot of a demand are closed until that slot is filled, which a later pass may do.
+	TArray<int32> NextSlots = TArray<int32>();
+	TArray<FFlow> BestFlows = TArray<FFlow>();
+	int32 NumAllocated = 0;
+	int32 BestNumAllocated = INDEX_NONE;
+	int32 NumSlotGroups = 0;
+	for (const TArray<FSlotGroup>& EachSlotGroups : DemandSlotGroups)
+	{
+		NumSlotGroups += EachSlotGroups.Num();
+	}
+	for (int32 Pass = 0; Pass <= NumSlotGroups; Pass++)
+	{
+		//Read the flows off of the supply edges.
+		OutFlows.Reset();
+		for (const FSupplyEdge& EachSupplyEdge : SupplyEdges)
+		{
+			const int32 Amount = EachSupplyEdge.Capacity - Network.Edges[EachSupplyEdge.EdgeIndex].Capacity;
+			if (Amount > 0)
+			{
+				OutFlows.Add(FFlow{ EachSupplyEdge.SupplyIndex, EachSupplyEdge.DemandIndex, DemandSlotGroups[EachSupplyEdge.DemandIndex][EachSupplyEdge.SlotGroupIndex].FirstSlot, Amount });
+			}
+		}
+		OutFlows.Sort([](const FFlow& A, const FFlow& B)
+			{
+				return A.DemandIndex != B.DemandIndex ? A.DemandIndex < B.DemandIndex : A.FirstSlot < B.FirstSlot;
+			});
+
+		NumAllocated = 0;
+		NextSlots.Init(0, Demands.Num());
+		bool bSkippedAny = false;
+		for (FFlow& EachFlow : OutFlows)
+		{
+			const FDemand& Demand = Demands[EachFlow.DemandIndex];
+			const EResourceType ResourceType = Supplies[EachFlow.SupplyIndex].Type;
+			int32& NextSlot = NextSlots[EachFlow.DemandIndex];
+			int32 NumKept = 0;
+			for (int32 Count = 0; Count < EachFlow.Amount && NextSlot < Demand.Capacity; Count++)
+			{
+				const EResourceType SlotType = Demand.SlotTypes.IsEmpty() ? EResourceType::Any : Demand.SlotTypes[FMath::Min(NextSlot, Demand.SlotTypes.Num() - 1)];
+				if (IsTypeCompatible(ResourceType, SlotType))
+				{
+					NumKept++;
+					NextSlot++;
+				}
+			}
+			bSkippedAny |= NumKept < EachFlow.Amount;
+			EachFlow.Amount = NumKept;
+			NumAllocated += NumKept;
+		}
+
+		//Sending the skipped amounts elsewhere can move others around, so only keep a pass that allocates more.
+		if (NumAllocated > BestNumAllocated)
+		{
+			BestNumAllocated = NumAllocated;
+			BestFlows = OutFlows;
+		}
+		if (!bSkippedAny)
+		{
+			break;
+		}
+
+		//Open the slot groups up to the first unfilled slot and close the ones after it, returning their flow to the supplies.
+		bool bChangedSlotGroups = false;
+		for (int32 DemandIndex = 0; DemandIndex < Demands.Num(); DemandIndex++)
+		{
+			for (FSlotGroup& EachSlotGroup : DemandSlotGroups[DemandIndex])
+			{
+				const bool bShouldBeOpen = EachSlotGroup.FirstSlot <= NextSlots[DemandIndex];
+				if (EachSlotGroup.bIsOpen != bShouldBeOpen)
+				{
+					EachSlotGroup.bIsOpen = bShouldBeOpen;
+					Network.Edges[EachSlotGroup.DemandEdge].Capacity = bShouldBeOpen ? EachSlotGroup.Capacity : 0;
+					bChangedSlotGroups = true;
+				}
+			}
+		}
+		for (const FSupplyEdge& EachSupplyEdge : SupplyEdges)
+		{
+			const FSlotGroup& SlotGroup = DemandSlotGroups[EachSupplyEdge.DemandIndex][EachSupplyEdge.SlotGroupIndex];
+			const int32 Amount = EachSupplyEdge.Capacity - Network.Edges[EachSupplyEdge.EdgeIndex].Capacity;
+			if (SlotGroup.bIsOpen || Amount <= 0)
+			{
+				continue;
+			}
+
+			//Every path through the network is source, supply, slot group, demand, target, so the flow can be undone edge by edge.
+			for (const int32 EachEdgeIndex : { SupplySourceEdges[EachSupplyEdge.SupplyIndex], EachSupplyEdge.EdgeIndex, SlotGroup.DemandEdge, DemandTargetEdges[EachSupplyEdge.DemandIndex] })
+			{
+				Network.Edges[EachEdgeIndex].Capacity += Amount;
+				Network.Edges[EachEdgeIndex ^ 1].Capacity -= Amount;
+			}
+			Network.Edges[SlotGroup.DemandEdge].Capacity = 0;
+		}
+		if (!bChangedSlotGroups)
+		{
+			break;
+		}
+		AugmentByPriority();
+	}
+	OutFlows = MoveTemp(BestFlows);
+	OutFlows.RemoveAll([](const FFlow& EachFlow) { return EachFlow.Amount <= 0; });
+
+	return FMath::Max(0, BestNumAllocated);
+}
+
+/**
+ * Allocates as many of the free resources in a world as possible.
+ *
+ * @param WorldContext - An object in the world to allocate resources in.
+ * @param bApply - Whether to allocate the resources or only count how many would be allocated.
+ * @return The number of resources allocated.
+ */
+int32 UResourceAllocationSolver::AutoAllocateResources(const UObject* WorldContext, const bool bApply)
+{
+	UWorld* World = IsValid(WorldContext) ? WorldContext->GetWorld() : nullptr;
+	if (!IsValid(World))
+	{
+		return 0;
+	}
+
+	const UResourcePool* Pool = UResourcePool::Get(World);
+	if (!IsValid(Pool))
+	{
+		return 0;
+	}
+
+	TArray<FResourceHandle> Resources = TArray<FResourceHandle>();
+	TArray<UResourceSink*> Sinks = TArray<UResourceSink*>();
+	for (TActorIterator<ATile> TileIterator(World); TileIterator; ++TileIterator)
+	{
+		TInlineComponentArray<UResourceSink*> TileSinks = TInlineComponentArray<UResourceSink*>();
+		TileIterator->GetComponents<UResourceSink>(TileSinks);
+		Sinks.Append(TileSinks);
+
+		if (const IResourceFaucet* Faucet = Cast<IResourceFaucet>(*TileIterator))
+		{
+			Resources.Append(Faucet->GetProducedResourceHandles());
+		}
+	}
+
+	//Auto allocating is one action for the player, so it is undone all at once.
+	UBoardHistorySubsystem* History = bApply ? UBoardHistorySubsystem::Get(World) : nullptr;
+	if (IsValid(History))
+	{
+		History->BeginAction();
+	}
+	const int32 NumAllocated = AutoAllocateResources(Pool, Resources, Sinks, bApply);
+	if (IsValid(History))
+	{
+		History->EndAction();
+	}
+	return NumAllocated;
+}
+
+/**
+ * Allocates as many of the given resources to the given sinks as possible.
+ *
+ * @param Pool - The pool storing the resources.
+ * @param Resources - The handles of the resources to allocate. Allocated resources are ignored.
+ * @param Sinks - The sinks to allocate to.
+ * @param bApply - Whether to allocate the resources or only count how many would be allocated.
+ * @return The number of resources allocated.
+ */
+int32 UResourceAllocationSolver::AutoAllocateResources(const UResourcePool* Pool, const TArray<FResourceHandle>& Resources, const TArray<UResourceSink*>& Sinks, const bool bApply)
+{
+	//Group the free resources by faucet and type since they are interchangeable.
+	TArray<FSupply> Supplies = TArray<FSupply>();
+	TArray<TArray<FResourceHandle>> SupplyResources = TArray<TArray<FResourceHandle>>();
+	TArray<UObject*> SupplyFaucets = TArray<UObject*>();
+	TMap<TPair<UObject*, EResourceType>, int32> FaucetTypesToSupplies = TMap<TPair<UObject*, EResourceType>, int32>();
+	for (const FResourceHandle& EachResource : Resources)
+	{
+		if (!Pool->IsAlive(EachResource) || Pool->IsAllocated(EachResource))
+		{
+			continue;
+		}
+
+		UObject* Faucet = Pool->GetFaucet(EachResource);
+		if (!IsValid(Faucet) || !Cast<IResourceFaucet>(Faucet))
+		{
+			continue;
+		}
+
+		const TPair<UObject*, EResourceType> Key = TPair<UObject*, EResourceType>(Faucet, Pool->GetType(EachResource));
+		int32* SupplyIndex = FaucetTypesToSupplies.Find(Key);
+		if (!SupplyIndex)
+		{
+			FSupply NewSupply = FSupply();
+			NewSupply.Type = Pool->GetType(EachResource);
+			SupplyIndex = &FaucetTypesToSupplies.Add(Key, Supplies.Add(NewSupply));
+			SupplyResources.AddDefaulted();
+			SupplyFaucets.Add(Faucet);
+		}
+		Supplies[*SupplyIndex].Amount++;
+		SupplyResources[*SupplyIndex].Add(EachResource);
+	}
+
+	//Find the open slots of each sink.
+	int32 NumFreeResources = 0;
+	for (const FSupply& EachSupply : Supplies)
+	{
+		NumFreeResources += EachSupply.Amount;
+	}
+	TArray<FDemand> Demands = TArray<FDemand>();
+	TArray<UResourceSink*> DemandSinks = TArray<UResourceSink*>();
+	TMap<FIntPoint, TArray<int32>> LocationsToDemands = TMap<FIntPoint, TArray<int32>>();
+	for (UResourceSink* EachSink : Sinks)
+	{
+		if (!IsValid(EachSink))
+		{
+			continue;
+		}
+
+		const FResourceSinkData& Data = EachSink->Data;
+		const int32 NumAllocated = EachSink->GetAllocatedResourceHandles().Num();
+		int32 Capacity = NumFreeResources;
+		if (Data.bHasMaxIncrement)
+		{
+			Capacity = FMath::Min(Capacity, Data.MaxIncrements - NumAllocated);
+		}
+		if (Data.bHasMaxIncrementmentsPerTurn)
+		{
+			//Only deferred increments count towards the turn's limit.
+			const int32 PerTurnCapacity = Data.bDeferredIncrement ? Data.MaxIncrementmentsPerTurn - EachSink->GetIncrementsThisTurn() : (EachSink->GetIncrementsThisTurn() < Data.MaxIncrementmentsPerTurn ? Capacity : 0);
+			Capacity = FMath::Min(Capacity, PerTurnCapacity);
+		}
+		if (Capacity <= 0)
+		{
+			continue;
+		}
+
+		FDemand NewDemand = FDemand();
+		NewDemand.Capacity = Capacity;
+		NewDemand.Priority = Data.AutoAllocationPriority;
+		if (!Data.RequiredResourceTypes.IsEmpty())
+		{
+			const int32 FirstTypeIndex = FMath::Min(NumAllocated, Data.RequiredResourceTypes.Num() - 1);
+			NewDemand.SlotTypes.Append(&Data.RequiredResourceTypes[FirstTypeIndex], Data.RequiredResourceTypes.Num() - FirstTypeIndex);
+		}
+
+		const int32 DemandIndex = Demands.Add(NewDemand);
+		DemandSinks.Add(EachSink);
+		for (FIntPoint EachLocation : EachSink->GetAllocationLocations())
+		{
+			LocationsToDemands.FindOrAdd(EachLocation).Add(DemandIndex);
+		}
+	}
+
+	//Find the sinks each supply can reach.
+	for (int32 SupplyIndex = 0; SupplyIndex < Supplies.Num(); SupplyIndex++)
+	{
+		UObject* FaucetObject = SupplyFaucets[SupplyIndex];
+		const UResourceNetwork* Network = UResourceNetwork::Get(FaucetObject);
+		const TSet<FIntPoint>* CachedLocations = IsValid(Network) ? Network->GetFaucetLocations(FaucetObject) : nullptr;
+		const TSet<FIntPoint> FaucetLocations = CachedLocations ? *CachedLocations : Cast<IResourceFaucet>(FaucetObject)->GetAllocatableLocations();
+
+		TSet<int32> ReachableDemands = TSet<int32>();
+		for (FIntPoint EachLocation : FaucetLocations)
+		{
+			if (const TArray<int32>* Demand = LocationsToDemands.Find(EachLocation))
+			{
+				ReachableDemands.Append(*Demand);
+			}
+		}
+		for (int32 EachDemandIndex : ReachableDemands)
+		{
+			//Faucets can not allocate to themselves.
+			if (DemandSinks[EachDemandIndex]->GetOwner() != FaucetObject)
+			{
+				Supplies[SupplyIndex].DemandIndices.Add(EachDemandIndex);
+			}
+		}
+	}
+
+	TArray<FFlow> Flows = TArray<FFlow>();
+	const int32 TotalFlow = Solve(Supplies, Demands, Flows);
+	if (!bApply)
+	{
+		return TotalFlow;
+	}
+
+	//Allocate in slot order so each resource meets the type required when it is allocated.
+	int32 NumAllocated = 0;
+	for (const FFlow& EachFlow : Flows)
+	{
+		UResourceSink* Sink = DemandSinks[EachFlow.DemandIndex];
+		TArray<FResourceHandle>& FreeResources = SupplyResources[EachFlow.SupplyIndex];
+		for (int32 Count = 0; Count < EachFlow.Amount && !FreeResources.IsEmpty(); Count++)
+		{
+			const FResourceHandle Resource = FreeResources.Pop(false);
+			if (IsValid(Sink) && Pool->CanAllocateTo(Resource, Sink) && Sink->CanAllocateResource(Resource) && Sink->AllocateResource(Resource))
+			{
+				NumAllocated++;
+			}
+		}
+	}
+	return NumAllocated;
+}
+
+/* /\ ========================== /\ *\
+|  /\ UResourceAllocationSolver /\  |
+\* /\ ========================== /\ */
+
+
+/**
+ * Allocates as many free resources as possible in the current world.
+ * Usage: Syrup.Resources.AutoAllocate [DryRun]
+ */
+static FAutoConsoleCommandWithWorldAndArgs AutoAllocateResourcesCommand(
+	TEXT("Syrup.Resources.AutoAllocate"),
+	TEXT("Allocates as many free resources to sinks as possible. Pass DryRun to only print how many would be allocated."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			const bool bDryRun = Args.Num() > 0 && Args[0].Equals(TEXT("DryRun"), ESearchCase::IgnoreCase);
+			const double StartTime = FPlatformTime::Seconds();
+			const int32 NumAllocated = UResourceAllocationSolver::AutoAllocateResources(World, !bDryRun);
+			UE_LOG(LogResource, Display, TEXT("%s %d resources in %.3f ms"), bDryRun ? TEXT("Could allocate") : TEXT("Allocated"), NumAllocated, (FPlatformTime::Seconds() - StartTime) * 1000);
+		})
+);
@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "ResourceType.h"
+#include "ResourceHandle.h"
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "ResourceAllocationSolver.generated.h"
+
+class UResourcePool;
+class UResourceSink;
+
+/* \/ ========================== \/ *\
+|  \/ UResourceAllocationSolver \/  |
+\* \/ ========================== \/ */
+/**
+ * Finds the largest number of free resources that can be allocated to sinks at once and allocates them.
+ *
+ * The problem is solved as a max flow from groups of resources, through the open slots of each sink, to the sinks
+ * themselves. Sinks with a higher auto allocation priority are filled first without lowering how many resources are
+ * allocated overall. Slots are solved as if they could be filled in any order, so an allocation that would skip an
+ * unfilled slot requiring a different type is then dropped and sent elsewhere in another pass, with the slots past the
+ * gap closed until it is filled. The result is not always the largest allocation possible when slots require different
+ * types, but the number returned is always the number that is actually allocated.
+ */
+UCLASS()
+class SYRUP_API UResourceAllocationSolver : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * A number of interchangeable resources.
+	 */
+	struct FSupply
+	{
+		//The number of resources.
+		int32 Amount = 0;
+
+		//The type of the resources.
+		EResourceType Type = EResourceType::Any;
+
+		//The indices of the demands the resources can be allocated to.
+		TArray<int32> DemandIndices = TArray<int32>();
+	};
+
+	/**
+	 * The open slots of a sink.
+	 */
+	struct FDemand
+	{
+		//The number of resources that can be allocated.
+		int32 Capacity = 0;
+
+		//The type required by each slot in order. The last type is required by every slot after it. Empty if any type is accepted.
+		TArray<EResourceType> SlotTypes = TArray<EResourceType>();
+
+		//Demands with higher priorities are filled first.
+		int32 Priority = 0;
+	};
+
+	/**
+	 * An amount allocated from a supply to a demand.
+	 */
+	struct FFlow
+	{
+		//The index of the supply.
+		int32 SupplyIndex = INDEX_NONE;
+
+		//The index of the demand.
+		int32 DemandIndex = INDEX_NONE;
+
+		//The first slot of the demand that the amount was allocated to.
+		int32 FirstSlot = 0;
+
+		//The number of resources allocated.
+		int32 Amount = 0;
+	};
+
+	/**
+	 * Finds the largest allocation from supplies to demands, filling higher priority demands first, then drops the
+	 * amounts that would skip an unfilled slot requiring a different type when the slots are filled in order. Dropped
+	 * amounts are sent to other slots in further passes, keeping the pass that allocates the most.
+	 *
+	 * @param Supplies - The resources that can be allocated.
+	 * @param Demands - The slots that can be allocated to.
+	 * @param OutFlows - Will be set to the amounts allocated, ordered by demand and then slot.
+	 * @return The total number of resources allocated by the flows, after the dropped amounts are removed.
+	 */
+	static int32 Solve(const TArray<FSupply>& Supplies, const TArray<FDemand>& Demands, TArray<FFlow>& OutFlows);
+
+	/**
+	 * Allocates as many of the free resources in a world as possible.
+	 *
+	 * @param WorldContext - An object in the world to allocate resources in.
+	 * @param bApply - Whether to allocate the resources or only count how many would be allocated.
+	 * @return The number of resources allocated.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Resources", Meta = (WorldContext = "WorldContext"))
+	static int32 AutoAllocateResources(const UObject* WorldContext, const bool bApply = true);
+
+	/**
+	 * Allocates as many of the given resources to the given sinks as possible.
+	 *
+	 * @param Pool - The pool storing the resources.
+	 * @param Resources - The handles of the resources to allocate. Allocated resources are ignored.
+	 * @param Sinks - The sinks to allocate to.
+	 * @param bApply - Whether to allocate the resources or only count how many would be allocated.
+	 * @return The number of resources allocated.
+	 */
+	static int32 AutoAllocateResources(const UResourcePool* Pool, const TArray<FResourceHandle>& Resources, const TArray<UResourceSink*>& Sinks, const bool bApply = true);
+};
+/* /\ ========================== /\ *\
+|  /\ UResourceAllocationSolver /\  |
+\* /\ ========================== /\ */
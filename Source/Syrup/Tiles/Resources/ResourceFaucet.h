@@ -3,6 +3,7 @@
 #pragma once
 
 #include "ResourceAllocationType.h"
+#include "ResourceHandle.h"
 
 #include "ResourceFaucet.generated.h"
 
@@ -36,22 +37,43 @@ public:
     virtual TSet<FIntPoint> GetAllocatableLocations() const = 0;
 
     /**
-     * Gets all the resources produced by this.
+     * Gets all the resources produced by this, creating facades for any that do not have one yet.
      *
      * @return The resources produced by this.
      */
     UFUNCTION(BlueprintPure, Category = "Resources")
     virtual TArray<UResource*> GetProducedResources() const = 0;
 
+    /**
+     * Gets the handles of all the resources produced by this.
+     *
+     * @return The handles of the resources produced by this.
+     */
+    virtual TArray<FResourceHandle> GetProducedResourceHandles() const = 0;
+
     /**
      * Causes this to produce an  additional resource of the given type.
      * 
      * @param Type - The type of resource to produce.
      * 
-     * @return The newly created resource.
+     * @return The handle of the newly created resource.
      */
     UFUNCTION(Category = "Resources")
-    virtual UResource* ProduceResource(const EResourceType& Type) = 0;
+    virtual FResourceHandle ProduceResource(const EResourceType& Type) = 0;
+
+    /**
+     * Called when one of the resources produced by this is allocated.
+     *
+     * @param Handle - The handle of the resource that was allocated.
+     */
+    virtual void ResourceAllocated(const FResourceHandle Handle) {};
+
+    /**
+     * Called when one of the resources produced by this is freed.
+     *
+     * @param Handle - The handle of the resource that was freed.
+     */
+    virtual void ResourceFreed(const FResourceHandle Handle) {};
 };
 /* /\ ============ /\ *\
 |  /\ ResourceSink /\  |
@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ResourceHandle.generated.h"
+
+ /* \/ =============== \/ *\
+ |  \/ FResourceHandle \/  |
+ \* \/ =============== \/ */
+/**
+ * Addresses a resource stored in a resource pool. Stays valid until the resource is released, after which the slot it
+ * points to may be reused by another resource without the old handle ever resolving to it.
+ */
+USTRUCT(BlueprintType)
+struct SYRUP_API FResourceHandle
+{
+	GENERATED_BODY()
+
+	//The index of the resource's slot in the pool.
+	UPROPERTY()
+	int32 Index = INDEX_NONE;
+
+	//The number of times the slot had been released when the resource was created.
+	UPROPERTY()
+	uint32 Generation = 0;
+
+	/**
+	 * Whether this handle has ever been assigned to a resource.
+	 *
+	 * @return Whether this handle has been assigned.
+	 */
+	FORCEINLINE bool IsSet() const { return Index != INDEX_NONE; };
+
+	FORCEINLINE bool operator==(const FResourceHandle& Other) const { return Index == Other.Index && Generation == Other.Generation; };
+	FORCEINLINE bool operator!=(const FResourceHandle& Other) const { return !(*this == Other); };
+
+	friend FORCEINLINE uint32 GetTypeHash(const FResourceHandle& Handle) { return HashCombine(GetTypeHash(Handle.Index), GetTypeHash(Handle.Generation)); };
+};
+/* /\ =============== /\ *\
+|  /\ FResourceHandle /\  |
+\* /\ =============== /\ */
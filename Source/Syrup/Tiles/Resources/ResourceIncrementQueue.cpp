@@ -0,0 +1,167 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ResourceIncrementQueue.h"
+
+#include "ResourceSink.h"
+#include "Syrup/Systems/TileEffectDispatcher.h"
+
+/* \/ ======================= \/ *\
+|  \/ UResourceIncrementQueue \/  |
+\* \/ ======================= \/ */
+
+/**
+ * Gets the increment queue of a world.
+ *
+ * @param WorldContext - An object in the world to get the queue of.
+ * @return The increment queue of the world. Nullptr if the world does not support one.
+ */
+UResourceIncrementQueue* UResourceIncrementQueue::Get(const UObject* WorldContext)
+{
+	if (!IsValid(WorldContext))
+	{
+		return nullptr;
+	}
+
+	UWorld* World = WorldContext->GetWorld();
+	return IsValid(World) ? World->GetSubsystem<UResourceIncrementQueue>() : nullptr;
+}
+
+/**
+ * Registers the listener used to apply increments with the tile effect dispatcher.
+ *
+ * @param Collection - The collection of subsystems being initialized.
+ */
+void UResourceIncrementQueue::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	UTileEffectDispatcher* Dispatcher = Collection.InitializeDependency<UTileEffectDispatcher>();
+	if (IsValid(Dispatcher))
+	{
+		EffectTriggerListenerHandle = Dispatcher->RegisterListener(FTileEffectTriggerListener::CreateUObject(this, &UResourceIncrementQueue::ReceiveEffectTrigger), PendingTriggerMask);
+	}
+}
+
+/**
+ * Adds a sink with deferred increments to the queue. Sinks already in the queue are ignored.
+ *
+ * @param Sink - The sink to add.
+ */
+void UResourceIncrementQueue::AddPendingSink(UResourceSink* Sink)
+{
+	if (!IsValid(Sink) || Sink->bIsIncrementPending)
+	{
+		return;
+	}
+
+	Sink->bIsIncrementPending = true;
+	PendingSinks.Add(Sink);
+
+	const uint32 TriggerBit = GetTileEffectTriggerBit(Sink->Data.IncrementTrigger);
+	if (!(PendingTriggerMask & TriggerBit))
+	{
+		PendingTriggerMask |= TriggerBit;
+		UpdateTriggerMask();
+	}
+}
+
+/**
+ * Removes a sink from the queue without applying its increments.
+ *
+ * @param Sink - The sink to remove.
+ */
+void UResourceIncrementQueue::RemovePendingSink(UResourceSink* Sink)
+{
+	if (!IsValid(Sink) || !Sink->bIsIncrementPending)
+	{
+		return;
+	}
+
+	Sink->bIsIncrementPending = false;
+	PendingSinks.Remove(Sink);
+	UpdateTriggerMask();
+}
+
+/**
+ * Applies the deferred increments of every queued sink waiting on a trigger.
+ *
+ * @param TriggerType - The trigger that was activated.
+ * @return The number of sinks whose amount was changed.
+ */
+int32 UResourceIncrementQueue::ResolveIncrements(const ETileEffectTriggerType TriggerType)
+{
+	//Take the queue first since applying an amount may queue more increments.
+	TArray<TWeakObjectPtr<UResourceSink>> SinksToCheck = MoveTemp(PendingSinks);
+	PendingSinks.Reset();
+
+	TArray<TPair<UResourceSink*, int>> ChangedAmounts = TArray<TPair<UResourceSink*, int>>();
+	for (TWeakObjectPtr<UResourceSink> EachSink : SinksToCheck)
+	{
+		UResourceSink* Sink = EachSink.Get();
+		if (!IsValid(Sink))
+		{
+			continue;
+		}
+
+		if (Sink->Data.IncrementTrigger != TriggerType)
+		{
+			PendingSinks.Add(Sink);
+			continue;
+		}
+
+		Sink->bIsIncrementPending = false;
+		if (Sink->IncrementsThisTurn > 0)
+		{
+			ChangedAmounts.Emplace(Sink, Sink->ApplyDeferredIncrements());
+		}
+	}
+	UpdateTriggerMask();
+
+	for (const TPair<UResourceSink*, int>& EachChange : ChangedAmounts)
+	{
+		if (IsValid(EachChange.Key))
+		{
+			EachChange.Key->EventOnAmountChanged.Broadcast(EachChange.Value);
+		}
+	}
+
+	return ChangedAmounts.Num();
+}
+
+/**
+ * Applies the increments waiting on the trigger that was activated.
+ *
+ * @param TriggerType - The type of trigger that was activated.
+ * @param Triggerer - The tile that triggered this effect.
+ * @param LocationsToTrigger - The Locations where the trigger applies an effect.
+ */
+void UResourceIncrementQueue::ReceiveEffectTrigger(const ETileEffectTriggerType TriggerType, const ATile* Triggerer, const TSet<FIntPoint>& LocationsToTrigger)
+{
+	ResolveIncrements(TriggerType);
+}
+
+/**
+ * Sets the triggers received by the listener to the ones pending sinks are waiting on.
+ */
+void UResourceIncrementQueue::UpdateTriggerMask()
+{
+	PendingTriggerMask = 0;
+	for (TWeakObjectPtr<UResourceSink> EachSink : PendingSinks)
+	{
+		if (EachSink.IsValid())
+		{
+			PendingTriggerMask |= GetTileEffectTriggerBit(EachSink->Data.IncrementTrigger);
+		}
+	}
+
+	UTileEffectDispatcher* Dispatcher = UTileEffectDispatcher::Get(this);
+	if (IsValid(Dispatcher))
+	{
+		Dispatcher->SetListenerTriggerMask(EffectTriggerListenerHandle, PendingTriggerMask);
+	}
+}
+
+/* /\ ======================= /\ *\
+|  /\ UResourceIncrementQueue /\  |
+\* /\ ======================= /\ */
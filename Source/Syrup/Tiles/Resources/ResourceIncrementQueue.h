@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Syrup/Tiles/Effects/TileEffectTrigger.h"
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ResourceIncrementQueue.generated.h"
+
+class UResourceSink;
+
+/* \/ ======================= \/ *\
+|  \/ UResourceIncrementQueue \/  |
+\* \/ ======================= \/ */
+/**
+ * Keeps the sinks that have deferred increments waiting to be applied and applies them when their increment trigger
+ * is activated.
+ *
+ * Sinks join the queue when an allocation defers an increment, so only sinks that have something to apply are visited.
+ * A single listener is registered with the tile effect dispatcher and only receives the triggers pending sinks are
+ * waiting on. All amounts for a trigger are applied before any amount change events are broadcast.
+ */
+UCLASS()
+class SYRUP_API UResourceIncrementQueue : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Gets the increment queue of a world.
+	 *
+	 * @param WorldContext - An object in the world to get the queue of.
+	 * @return The increment queue of the world. Nullptr if the world does not support one.
+	 */
+	static UResourceIncrementQueue* Get(const UObject* WorldContext);
+
+	/**
+	 * Registers the listener used to apply increments with the tile effect dispatcher.
+	 *
+	 * @param Collection - The collection of subsystems being initialized.
+	 */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/**
+	 * Adds a sink with deferred increments to the queue. Sinks already in the queue are ignored.
+	 *
+	 * @param Sink - The sink to add.
+	 */
+	void AddPendingSink(UResourceSink* Sink);
+
+	/**
+	 * Removes a sink from the queue without applying its increments.
+	 *
+	 * @param Sink - The sink to remove.
+	 */
+	void RemovePendingSink(UResourceSink* Sink);
+
+	/**
+	 * Applies the deferred increments of every queued sink waiting on a trigger.
+	 *
+	 * @param TriggerType - The trigger that was activated.
+	 * @return The number of sinks whose amount was changed.
+	 */
+	int32 ResolveIncrements(const ETileEffectTriggerType TriggerType);
+
+	/**
+	 * Gets the number of sinks waiting to have their increments applied.
+	 *
+	 * @return The number of sinks in the queue.
+	 */
+	FORCEINLINE int32 GetNumPendingSinks() const { return PendingSinks.Num(); };
+
+private:
+	/**
+	 * Applies the increments waiting on the trigger that was activated.
+	 *
+	 * @param TriggerType - The type of trigger that was activated.
+	 * @param Triggerer - The tile that triggered this effect.
+	 * @param LocationsToTrigger - The Locations where the trigger applies an effect.
+	 */
+	void ReceiveEffectTrigger(const ETileEffectTriggerType TriggerType, const ATile* Triggerer, const TSet<FIntPoint>& LocationsToTrigger);
+
+	/**
+	 * Sets the triggers received by the listener to the ones pending sinks are waiting on.
+	 */
+	void UpdateTriggerMask();
+
+	//The sinks with deferred increments in the order they were added.
+	TArray<TWeakObjectPtr<UResourceSink>> PendingSinks = TArray<TWeakObjectPtr<UResourceSink>>();
+
+	//The triggers pending sinks are waiting on.
+	uint32 PendingTriggerMask = 0;
+
+	//The handle of this queue's listener in the tile effect dispatcher.
+	int32 EffectTriggerListenerHandle = INDEX_NONE;
+};
+/* /\ ======================= /\ *\
+|  /\ UResourceIncrementQueue /\  |
+\* /\ ======================= /\ */
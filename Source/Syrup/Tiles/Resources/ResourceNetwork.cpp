@@ -0,0 +1,148 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ResourceNetwork.h"
+
+#include "ResourceFaucet.h"
+
+/* \/ ================ \/ *\
+|  \/ UResourceNetwork \/  |
+\* \/ ================ \/ */
+
+/**
+ * Gets the resource network of a world.
+ *
+ * @param WorldContext - An object in the world to get the network of.
+ * @return The resource network of the world. Nullptr if the world does not support one.
+ */
+UResourceNetwork* UResourceNetwork::Get(const UObject* WorldContext)
+{
+	if (!IsValid(WorldContext))
+	{
+		return nullptr;
+	}
+
+	UWorld* World = WorldContext->GetWorld();
+	return IsValid(World) ? World->GetSubsystem<UResourceNetwork>() : nullptr;
+}
+
+/**
+ * Sets the locations a faucet can allocate to from its current allocatable locations, registering it if needed.
+ *
+ * @param Faucet - The faucet to update. Must implement IResourceFaucet.
+ */
+void UResourceNetwork::UpdateFaucet(UObject* Faucet)
+{
+	const IResourceFaucet* FaucetInterface = Cast<IResourceFaucet>(Faucet);
+	if (!IsValid(Faucet) || !FaucetInterface)
+	{
+		return;
+	}
+
+	const TWeakObjectPtr<const UObject> FaucetKey = Faucet;
+	const TSet<FIntPoint> NewLocations = FaucetInterface->GetAllocatableLocations();
+	TSet<FIntPoint>& Locations = FaucetsToLocations.FindOrAdd(FaucetKey);
+
+	//Only touch the locations that changed.
+	for (FIntPoint EachLocation : Locations.Difference(NewLocations))
+	{
+		TArray<TWeakObjectPtr<const UObject>>* Faucets = LocationsToFaucets.Find(EachLocation);
+		if (Faucets)
+		{
+			Faucets->RemoveSwap(FaucetKey);
+			if (Faucets->IsEmpty())
+			{
+				LocationsToFaucets.Remove(EachLocation);
+			}
+		}
+	}
+	for (FIntPoint EachLocation : NewLocations.Difference(Locations))
+	{
+		LocationsToFaucets.FindOrAdd(EachLocation).Add(FaucetKey);
+	}
+
+	Locations = NewLocations;
+}
+
+/**
+ * Removes a faucet from the network.
+ *
+ * @param Faucet - The faucet to remove.
+ */
+void UResourceNetwork::RemoveFaucet(const UObject* Faucet)
+{
+	const TWeakObjectPtr<const UObject> FaucetKey = Faucet;
+	TSet<FIntPoint> Locations = TSet<FIntPoint>();
+	if (!FaucetsToLocations.RemoveAndCopyValue(FaucetKey, Locations))
+	{
+		return;
+	}
+
+	for (FIntPoint EachLocation : Locations)
+	{
+		TArray<TWeakObjectPtr<const UObject>>* Faucets = LocationsToFaucets.Find(EachLocation);
+		if (Faucets)
+		{
+			Faucets->RemoveSwap(FaucetKey);
+			if (Faucets->IsEmpty())
+			{
+				LocationsToFaucets.Remove(EachLocation);
+			}
+		}
+	}
+}
+
+/**
+ * Whether a registered faucet can allocate to any of the given locations.
+ *
+ * @param Faucet - The faucet to check.
+ * @param Locations - The locations to check.
+ * @return Whether the faucet can reach any of the locations. False if the faucet is not registered.
+ */
+bool UResourceNetwork::CanFaucetReach(const UObject* Faucet, const TSet<FIntPoint>& Locations) const
+{
+	const TSet<FIntPoint>* FaucetLocations = FaucetsToLocations.Find(Faucet);
+	if (!FaucetLocations)
+	{
+		return false;
+	}
+
+	//Iterate over the smaller of the two sets.
+	const TSet<FIntPoint>& SmallerSet = FaucetLocations->Num() < Locations.Num() ? *FaucetLocations : Locations;
+	const TSet<FIntPoint>& LargerSet = FaucetLocations->Num() < Locations.Num() ? Locations : *FaucetLocations;
+	for (FIntPoint EachLocation : SmallerSet)
+	{
+		if (LargerSet.Contains(EachLocation))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Gets the faucets that can allocate to a location.
+ *
+ * @param Location - The location to check.
+ * @return The faucets that can allocate to the location.
+ */
+TArray<const UObject*> UResourceNetwork::GetFaucetsReaching(const FIntPoint Location) const
+{
+	TArray<const UObject*> ReturnValue = TArray<const UObject*>();
+	const TArray<TWeakObjectPtr<const UObject>>* Faucets = LocationsToFaucets.Find(Location);
+	if (Faucets)
+	{
+		for (const TWeakObjectPtr<const UObject>& EachFaucet : *Faucets)
+		{
+			if (EachFaucet.IsValid())
+			{
+				ReturnValue.Add(EachFaucet.Get());
+			}
+		}
+	}
+	return ReturnValue;
+}
+
+/* /\ ================ /\ *\
+|  /\ UResourceNetwork /\  |
+\* /\ ================ /\ */
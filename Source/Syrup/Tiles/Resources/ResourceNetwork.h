@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ResourceNetwork.generated.h"
+
+/* \/ ================ \/ *\
+|  \/ UResourceNetwork \/  |
+\* \/ ================ \/ */
+/**
+ * Keeps an index of which grid locations each resource faucet can allocate to and which faucets can reach each
+ * location, so that allocation checks do not need to recompute a faucet's reach.
+ *
+ * Faucets register when they begin play and update their entry whenever their range or position changes. Only the
+ * locations that were gained or lost are touched on an update.
+ */
+UCLASS()
+class SYRUP_API UResourceNetwork : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Gets the resource network of a world.
+	 *
+	 * @param WorldContext - An object in the world to get the network of.
+	 * @return The resource network of the world. Nullptr if the world does not support one.
+	 */
+	static UResourceNetwork* Get(const UObject* WorldContext);
+
+	/**
+	 * Sets the locations a faucet can allocate to from its current allocatable locations, registering it if needed.
+	 *
+	 * @param Faucet - The faucet to update. Must implement IResourceFaucet.
+	 */
+	void UpdateFaucet(UObject* Faucet);
+
+	/**
+	 * Removes a faucet from the network.
+	 *
+	 * @param Faucet - The faucet to remove.
+	 */
+	void RemoveFaucet(const UObject* Faucet);
+
+	/**
+	 * Whether a faucet is in the network.
+	 *
+	 * @param Faucet - The faucet to check.
+	 * @return Whether the faucet is in the network.
+	 */
+	FORCEINLINE bool IsFaucetRegistered(const UObject* Faucet) const { return FaucetsToLocations.Contains(Faucet); };
+
+	/**
+	 * Whether a registered faucet can allocate to any of the given locations.
+	 *
+	 * @param Faucet - The faucet to check.
+	 * @param Locations - The locations to check.
+	 * @return Whether the faucet can reach any of the locations. False if the faucet is not registered.
+	 */
+	bool CanFaucetReach(const UObject* Faucet, const TSet<FIntPoint>& Locations) const;
+
+	/**
+	 * Gets the locations a registered faucet can allocate to.
+	 *
+	 * @param Faucet - The faucet to get the locations of.
+	 * @return The locations the faucet can allocate to. Nullptr if the faucet is not registered.
+	 */
+	FORCEINLINE const TSet<FIntPoint>* GetFaucetLocations(const UObject* Faucet) const { return FaucetsToLocations.Find(Faucet); };
+
+	/**
+	 * Gets the faucets that can allocate to a location.
+	 *
+	 * @param Location - The location to check.
+	 * @return The faucets that can allocate to the location.
+	 */
+	TArray<const UObject*> GetFaucetsReaching(const FIntPoint Location) const;
+
+private:
+	//The locations each faucet can allocate to.
+	TMap<TWeakObjectPtr<const UObject>, TSet<FIntPoint>> FaucetsToLocations = TMap<TWeakObjectPtr<const UObject>, TSet<FIntPoint>>();
+
+	//The faucets that can allocate to each location.
+	TMap<FIntPoint, TArray<TWeakObjectPtr<const UObject>>> LocationsToFaucets = TMap<FIntPoint, TArray<TWeakObjectPtr<const UObject>>>();
+};
+/* /\ ================ /\ *\
+|  /\ UResourceNetwork /\  |
+\* /\ ================ /\ */
@@ -0,0 +1,445 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ResourcePool.h"
+
+#include "Resource.h"
+#include "ResourceSink.h"
+#include "ResourceNetwork.h"
+
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<bool> CVarRecycleResourceFacades(
+	TEXT("Syrup.Resources.RecycleFacades"),
+	false,
+	TEXT("Whether the facade objects of released resources should be reused by new resources instead of being left for garbage collection. Only safe when nothing, such as a selection or details widget, holds onto facades of released resources."));
+
+/* \/ ============= \/ *\
+|  \/ UResourcePool \/  |
+\* \/ ============= \/ */
+
+/**
+ * Gets the resource pool of a world.
+ *
+ * @param WorldContext - An object in the world to get the pool of.
+ * @return The resource pool of the world. Nullptr if the world does not support one.
+ */
+UResourcePool* UResourcePool::Get(const UObject* WorldContext)
+{
+	if (!IsValid(WorldContext))
+	{
+		return nullptr;
+	}
+
+	UWorld* World = WorldContext->GetWorld();
+	return IsValid(World) ? World->GetSubsystem<UResourcePool>() : nullptr;
+}
+
+/**
+ * Creates a resource. No facade is created until one is asked for.
+ *
+ * @param Type - The type of resource to create.
+ * @param Faucet - The object supplying the resource. Must not be null.
+ * @return The handle of the resource that was created. Unset if the faucet was invalid.
+ */
+FResourceHandle UResourcePool::CreateResource(const EResourceType Type, UObject* Faucet)
+{
+	if (!IsValid(Faucet))
+	{
+		return FResourceHandle();
+	}
+
+	int32 Index = INDEX_NONE;
+	if (!FreeIndices.IsEmpty())
+	{
+		Index = FreeIndices.Pop(false);
+	}
+	else
+	{
+		Index = Resources.AddDefaulted();
+		Facades.Add(nullptr);
+	}
+
+	FPooledResource& Resource = Resources[Index];
+	Resource.FaucetIndex = Faucets.AddReference(Faucet);
+	Resource.SinkIndex = INDEX_NONE;
+	Resource.Type = Type;
+	Resource.AllocationType = EResourceAllocationType::NotAllocated;
+	Resource.bInUse = true;
+	Resource.bReleasePending = false;
+	NumResourcesCreated++;
+
+	FResourceHandle Handle = FResourceHandle();
+	Handle.Index = Index;
+	Handle.Generation = Resource.Generation;
+	return Handle;
+}
+
+/**
+ * Releases a resource so that its slot, and its facade if recycling is on, can be reused. If the resource is
+ * allocated it will be released once it is freed.
+ *
+ * @param Handle - The handle of the resource to release.
+ */
+void UResourcePool::ReleaseResource(const FResourceHandle Handle)
+{
+	if (!IsAlive(Handle))
+	{
+		return;
+	}
+
+	FPooledResource& Resource = Resources[Handle.Index];
+	if (IsValid(GetSink(Handle)))
+	{
+		Resource.bReleasePending = true;
+		return;
+	}
+
+	Faucets.RemoveReference(Resource.FaucetIndex);
+	Sinks.RemoveReference(Resource.SinkIndex);
+	Resource = FPooledResource();
+	Resource.Generation = Handle.Generation + 1;
+	FreeIndices.Push(Handle.Index);
+
+	//Without recycling the released facade keeps its bindings and its dead handle, so anything still holding it sees a resource with no faucet or sink instead of a new one.
+	if (!CVarRecycleResourceFacades.GetValueOnGameThread())
+	{
+		Facades[Handle.Index] = nullptr;
+		return;
+	}
+
+	UResource* Facade = Facades[Handle.Index];
+	if (IsValid(Facade))
+	{
+		Facade->OnFreed.Clear();
+		Facade->OnAllocated.Clear();
+	}
+}
+
+/**
+ * Allocates a resource to a sink. Does not update the sink; that is left to the sink allocating it.
+ *
+ * @param Handle - The handle of the resource.
+ * @param Sink - The sink to allocate the resource to.
+ * @param AllocationType - The kind of allocation this was.
+ * @return Whether this allocation was successful.
+ */
+bool UResourcePool::AllocateResource(const FResourceHandle Handle, UResourceSink* Sink, const EResourceAllocationType AllocationType)
+{
+	if (!IsValid(GetFaucet(Handle)))
+	{
+		UE_LOG(LogResource, Error, TEXT("Invalid Faucet"));
+		return false;
+	}
+
+	if (!IsValid(Sink))
+	{
+		UE_LOG(LogResource, Error, TEXT("Invalid Sink"));
+		return false;
+	}
+
+	if (AllocationType == EResourceAllocationType::NotAllocated)
+	{
+		UE_LOG(LogResource, Error, TEXT("Cannot allocate resource to NotAllocated. Use Free() to unallocated resources."));
+		return false;
+	}
+
+	if (!CanAllocateTo(Handle, Sink))
+	{
+		return false;
+	}
+
+	SetAllocation(Handle, Sink, AllocationType);
+
+	IResourceFaucet* Faucet = Cast<IResourceFaucet>(GetFaucet(Handle));
+	if (Faucet)
+	{
+		Faucet->ResourceAllocated(Handle);
+	}
+
+	UResource* Facade = FindFacade(Handle);
+	if (IsValid(Facade))
+	{
+		Facade->OnAllocated.Broadcast(Facade);
+	}
+	return true;
+}
+
+/**
+ * Unallocates a resource, freeing it from the sink it was allocated to.
+ *
+ * @param Handle - The handle of the resource.
+ */
+void UResourcePool::FreeResource(const FResourceHandle Handle)
+{
+	if (!IsAllocated(Handle))
+	{
+		return;
+	}
+
+	//Found first since the faucet may release the resource when told it was freed.
+	UResource* Facade = FindFacade(Handle);
+	UResourceSink* OldSink = GetSink(Handle);
+	SetAllocation(Handle, nullptr, EResourceAllocationType::NotAllocated);
+	OldSink->FreeResource(Handle);
+
+	IResourceFaucet* Faucet = Cast<IResourceFaucet>(GetFaucet(Handle));
+	if (Faucet)
+	{
+		Faucet->ResourceFreed(Handle);
+	}
+
+	if (IsValid(Facade))
+	{
+		Facade->OnFreed.Broadcast(Facade);
+	}
+
+	//Finish a release that was waiting for this to be freed.
+	if (IsReleasePending(Handle))
+	{
+		ReleaseResource(Handle);
+	}
+}
+
+/**
+ * Gets whether a resource can be allocated to a sink.
+ *
+ * @param Handle - The handle of the resource.
+ * @param Sink - The sink to check.
+ * @return Whether the resource can be allocated to the sink.
+ */
+bool UResourcePool::CanAllocateTo(const FResourceHandle Handle, const UResourceSink* Sink) const
+{
+	UObject* FaucetObject = GetFaucet(Handle);
+	const IResourceFaucet* Faucet = Cast<IResourceFaucet>(FaucetObject);
+	if (IsAllocated(Handle) || !IsValid(FaucetObject) || !Faucet || !IsValid(Sink) || Sink->GetOwner() == FaucetObject)
+	{
+		return false;
+	}
+
+	const EResourceType Type = GetType(Handle);
+	if (Type != EResourceType::Any && Sink->GetRequiredResourceType() != EResourceType::Any && Type != Sink->GetRequiredResourceType())
+	{
+		return false;
+	}
+
+	//Use the faucet's cached reach when it is in the resource network.
+	const UResourceNetwork* Network = UResourceNetwork::Get(FaucetObject);
+	if (IsValid(Network) && Network->IsFaucetRegistered(FaucetObject))
+	{
+		return Network->CanFaucetReach(FaucetObject, Sink->GetAllocationLocations());
+	}
+
+	const TSet<FIntPoint> AllocatableLocations = Faucet->GetAllocatableLocations();
+	for (FIntPoint EachAllocationLocation : Sink->GetAllocationLocations())
+	{
+		if (AllocatableLocations.Contains(EachAllocationLocation))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Sets what a resource is allocated to.
+ *
+ * @param Handle - The handle of the resource.
+ * @param Sink - The sink the resource is allocated to. Nullptr if it is being freed.
+ * @param AllocationType - The way the resource has been allocated.
+ */
+void UResourcePool::SetAllocation(const FResourceHandle Handle, UResourceSink* Sink, const EResourceAllocationType AllocationType)
+{
+	if (!IsAlive(Handle))
+	{
+		return;
+	}
+
+	FPooledResource& Resource = Resources[Handle.Index];
+	Sinks.RemoveReference(Resource.SinkIndex);
+	Resource.SinkIndex = IsValid(Sink) ? Sinks.AddReference(Sink) : INDEX_NONE;
+	Resource.AllocationType = IsValid(Sink) ? AllocationType : EResourceAllocationType::NotAllocated;
+}
+
+/**
+ * Gets whether a resource is allocated to a sink.
+ *
+ * @param Handle - The handle of the resource.
+ * @return Whether the resource is allocated.
+ */
+bool UResourcePool::IsAllocated(const FResourceHandle Handle) const
+{
+	return IsValid(GetSink(Handle));
+}
+
+/**
+ * Gets the object supplying a resource.
+ *
+ * @param Handle - The handle of the resource.
+ * @return The faucet of the resource. Nullptr if it has been destroyed.
+ */
+UObject* UResourcePool::GetFaucet(const FResourceHandle Handle) const
+{
+	return IsAlive(Handle) ? Faucets.Get(Resources[Handle.Index].FaucetIndex) : nullptr;
+}
+
+/**
+ * Gets the sink a resource is allocated to.
+ *
+ * @param Handle - The handle of the resource.
+ * @return The sink of the resource. Nullptr if it is unallocated.
+ */
+UResourceSink* UResourcePool::GetSink(const FResourceHandle Handle) const
+{
+	return IsAlive(Handle) ? Cast<UResourceSink>(Sinks.Get(Resources[Handle.Index].SinkIndex)) : nullptr;
+}
+
+/**
+ * Gets the facade of a resource, creating it if this is the first time it was needed.
+ *
+ * @param Handle - The handle of the resource.
+ * @param FacadeClass - The class of the facade to create if there is not one already.
+ * @return The facade of the resource. Nullptr if the resource has been released.
+ */
+UResource* UResourcePool::GetFacade(const FResourceHandle Handle, TSubclassOf<UResource> FacadeClass)
+{
+	if (!IsAlive(Handle))
+	{
+		return nullptr;
+	}
+
+	if (!IsValid(FacadeClass))
+	{
+		FacadeClass = UResource::StaticClass();
+	}
+
+	//A facade left in the slot by a released resource is only reused if it is the right class.
+	UResource*& Facade = Facades[Handle.Index];
+	if (IsValid(Facade) && Facade->Handle == Handle)
+	{
+		return Facade;
+	}
+
+	if (!IsValid(Facade) || Facade->GetClass() != FacadeClass)
+	{
+		Facade = NewObject<UResource>(this, FacadeClass);
+		NumFacadesCreated++;
+	}
+	Facade->Pool = this;
+	Facade->Handle = Handle;
+	return Facade;
+}
+
+/**
+ * Gets the facades of resources, creating any that are needed.
+ *
+ * @param Handles - The handles of the resources.
+ * @return The facades of the resources that have not been released.
+ */
+TArray<UResource*> UResourcePool::GetFacades(const TArray<FResourceHandle>& Handles)
+{
+	TArray<UResource*> ResourceFacades = TArray<UResource*>();
+	ResourceFacades.Reserve(Handles.Num());
+	for (const FResourceHandle& EachHandle : Handles)
+	{
+		UResource* Facade = GetFacade(EachHandle);
+		if (IsValid(Facade))
+		{
+			ResourceFacades.Add(Facade);
+		}
+	}
+	return ResourceFacades;
+}
+
+/**
+ * Gets the facade of a resource if it has one.
+ *
+ * @param Handle - The handle of the resource.
+ * @return The facade of the resource. Nullptr if it does not have one.
+ */
+UResource* UResourcePool::FindFacade(const FResourceHandle Handle) const
+{
+	UResource* Facade = IsAlive(Handle) ? Facades[Handle.Index] : nullptr;
+	return IsValid(Facade) && Facade->Handle == Handle ? Facade : nullptr;
+}
+
+/**
+ * Resets the number of resources and facades created.
+ */
+void UResourcePool::ResetStats()
+{
+	NumResourcesCreated = 0;
+	NumFacadesCreated = 0;
+}
+
+/**
+ * Gets the index of an object, adding it if needed, and adds a reference to it.
+ *
+ * @param Object - The object to reference.
+ * @return The index of the object.
+ */
+int32 UResourcePool::FEndpointTable::AddReference(UObject* Object)
+{
+	int32 Index = INDEX_NONE;
+	const int32* ExistingIndex = ObjectsToIndices.Find(Object);
+	if (ExistingIndex && Objects[*ExistingIndex].Get() != Object)
+	{
+		//The object at this address was destroyed and its memory reused, so stop looking up the old entry by it.
+		Keys[*ExistingIndex] = nullptr;
+		ObjectsToIndices.Remove(Object);
+		ExistingIndex = nullptr;
+	}
+
+	if (ExistingIndex)
+	{
+		Index = *ExistingIndex;
+	}
+	else
+	{
+		if (!FreeIndices.IsEmpty())
+		{
+			Index = FreeIndices.Pop(false);
+			Objects[Index] = Object;
+			Keys[Index] = Object;
+			NumReferences[Index] = 0;
+		}
+		else
+		{
+			Index = Objects.Add(Object);
+			Keys.Add(Object);
+			NumReferences.Add(0);
+		}
+		ObjectsToIndices.Add(Object, Index);
+	}
+
+	NumReferences[Index]++;
+	return Index;
+}
+
+/**
+ * Removes a reference to an object, removing it once it is no longer referenced.
+ *
+ * @param Index - The index of the object.
+ */
+void UResourcePool::FEndpointTable::RemoveReference(const int32 Index)
+{
+	if (!NumReferences.IsValidIndex(Index) || NumReferences[Index] <= 0)
+	{
+		return;
+	}
+
+	if (--NumReferences[Index] == 0)
+	{
+		if (Keys[Index])
+		{
+			ObjectsToIndices.Remove(Keys[Index]);
+		}
+		Objects[Index].Reset();
+		Keys[Index] = nullptr;
+		FreeIndices.Push(Index);
+	}
+}
+
+/* /\ ============= /\ *\
+|  /\ UResourcePool /\  |
+\* /\ ============= /\ */
@@ -0,0 +1,305 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "ResourceType.h"
+#include "ResourceAllocationType.h"
+#include "ResourceHandle.h"
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ResourcePool.generated.h"
+
+class UResource;
+class UResourceSink;
+
+/* \/ ============= \/ *\
+|  \/ UResourcePool \/  |
+\* \/ ============= \/ */
+/**
+ * Stores every resource in a world as a compact struct in one contiguous array addressed by handles.
+ *
+ * Native code only holds handles, so producing and dropping resources creates no objects. A UResource facade is only
+ * created the first time a resource is needed by blueprints or UI. A released facade is left alone with its dead
+ * handle, so anything still holding it sees a resource with no faucet or sink. With Syrup.Resources.RecycleFacades on,
+ * facades are instead reused by the next resource in their slot that needs one. A resource that is released while
+ * allocated stays in the pool until it is freed, so sinks never hold a handle that has been reused.
+ */
+UCLASS()
+class SYRUP_API UResourcePool : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Gets the resource pool of a world.
+	 *
+	 * @param WorldContext - An object in the world to get the pool of.
+	 * @return The resource pool of the world. Nullptr if the world does not support one.
+	 */
+	static UResourcePool* Get(const UObject* WorldContext);
+
+	/**
+	 * Creates a resource. No facade is created until one is asked for.
+	 *
+	 * @param Type - The type of resource to create.
+	 * @param Faucet - The object supplying the resource. Must not be null.
+	 * @return The handle of the resource that was created. Unset if the faucet was invalid.
+	 */
+	FResourceHandle CreateResource(const EResourceType Type, UObject* Faucet);
+
+	/**
+	 * Releases a resource so that its slot, and its facade if recycling is on, can be reused. If the resource is
+	 * allocated it will be released once it is freed.
+	 *
+	 * @param Handle - The handle of the resource to release.
+	 */
+	void ReleaseResource(const FResourceHandle Handle);
+
+	/**
+	 * Allocates a resource to a sink. Does not update the sink; that is left to the sink allocating it.
+	 *
+	 * @param Handle - The handle of the resource.
+	 * @param Sink - The sink to allocate the resource to.
+	 * @param AllocationType - The kind of allocation this was.
+	 * @return Whether this allocation was successful.
+	 */
+	bool AllocateResource(const FResourceHandle Handle, UResourceSink* Sink, const EResourceAllocationType AllocationType);
+
+	/**
+	 * Unallocates a resource, freeing it from the sink it was allocated to.
+	 *
+	 * @param Handle - The handle of the resource.
+	 */
+	void FreeResource(const FResourceHandle Handle);
+
+	/**
+	 * Gets whether a resource can be allocated to a sink.
+	 *
+	 * @param Handle - The handle of the resource.
+	 * @param Sink - The sink to check.
+	 * @return Whether the resource can be allocated to the sink.
+	 */
+	bool CanAllocateTo(const FResourceHandle Handle, const UResourceSink* Sink) const;
+
+	/**
+	 * Whether a handle points to a resource that has not been released.
+	 *
+	 * @param Handle - The handle to check.
+	 * @return Whether the resource is alive.
+	 */
+	FORCEINLINE bool IsAlive(const FResourceHandle Handle) const { return Resources.IsValidIndex(Handle.Index) && Resources[Handle.Index].bInUse && Resources[Handle.Index].Generation == Handle.Generation; };
+
+	/**
+	 * Whether a resource was released while allocated and will be released once it is freed.
+	 *
+	 * @param Handle - The handle of the resource.
+	 * @return Whether the resource is waiting to be released.
+	 */
+	FORCEINLINE bool IsReleasePending(const FResourceHandle Handle) const { return IsAlive(Handle) && Resources[Handle.Index].bReleasePending; };
+
+	/**
+	 * Gets the type of a resource.
+	 *
+	 * @param Handle - The handle of the resource.
+	 * @return The type of the resource.
+	 */
+	FORCEINLINE EResourceType GetType(const FResourceHandle Handle) const { return IsAlive(Handle) ? Resources[Handle.Index].Type : EResourceType::Any; };
+
+	/**
+	 * Gets the way a resource has been allocated.
+	 *
+	 * @param Handle - The handle of the resource.
+	 * @return The way the resource has been allocated.
+	 */
+	FORCEINLINE EResourceAllocationType GetAllocationType(const FResourceHandle Handle) const { return IsAlive(Handle) ? Resources[Handle.Index].AllocationType : EResourceAllocationType::NotAllocated; };
+
+	/**
+	 * Gets whether a resource is allocated to a sink.
+	 *
+	 * @param Handle - The handle of the resource.
+	 * @return Whether the resource is allocated.
+	 */
+	bool IsAllocated(const FResourceHandle Handle) const;
+
+	/**
+	 * Gets the object supplying a resource.
+	 *
+	 * @param Handle - The handle of the resource.
+	 * @return The faucet of the resource. Nullptr if it has been destroyed.
+	 */
+	UObject* GetFaucet(const FResourceHandle Handle) const;
+
+	/**
+	 * Gets the sink a resource is allocated to.
+	 *
+	 * @param Handle - The handle of the resource.
+	 * @return The sink of the resource. Nullptr if it is unallocated.
+	 */
+	UResourceSink* GetSink(const FResourceHandle Handle) const;
+
+	/**
+	 * Gets the facade of a resource, creating it if this is the first time it was needed.
+	 *
+	 * @param Handle - The handle of the resource.
+	 * @param FacadeClass - The class of the facade to create if there is not one already.
+	 * @return The facade of the resource. Nullptr if the resource has been released.
+	 */
+	UResource* GetFacade(const FResourceHandle Handle, TSubclassOf<UResource> FacadeClass = nullptr);
+
+	/**
+	 * Gets the facades of resources, creating any that are needed.
+	 *
+	 * @param Handles - The handles of the resources.
+	 * @return The facades of the resources that have not been released.
+	 */
+	TArray<UResource*> GetFacades(const TArray<FResourceHandle>& Handles);
+
+	/**
+	 * Gets the number of resources that have not been released.
+	 *
+	 * @return The number of resources that have not been released.
+	 */
+	FORCEINLINE int32 GetNumAliveResources() const { return Resources.Num() - FreeIndices.Num(); };
+
+	/**
+	 * Gets the number of slots in the pool.
+	 *
+	 * @return The number of slots in the pool.
+	 */
+	FORCEINLINE int32 GetNumSlots() const { return Resources.Num(); };
+
+	/**
+	 * Gets the number of resources created since the stats were last reset.
+	 *
+	 * @return The number of resources created.
+	 */
+	FORCEINLINE int64 GetNumResourcesCreated() const { return NumResourcesCreated; };
+
+	/**
+	 * Gets the number of facade objects created since the stats were last reset.
+	 *
+	 * @return The number of facade objects created.
+	 */
+	FORCEINLINE int64 GetNumFacadesCreated() const { return NumFacadesCreated; };
+
+	/**
+	 * Resets the number of resources and facades created.
+	 */
+	void ResetStats();
+
+private:
+	/**
+	 * Sets what a resource is allocated to.
+	 *
+	 * @param Handle - The handle of the resource.
+	 * @param Sink - The sink the resource is allocated to. Nullptr if it is being freed.
+	 * @param AllocationType - The way the resource has been allocated.
+	 */
+	void SetAllocation(const FResourceHandle Handle, UResourceSink* Sink, const EResourceAllocationType AllocationType);
+
+	/**
+	 * Gets the facade of a resource if it has one.
+	 *
+	 * @param Handle - The handle of the resource.
+	 * @return The facade of the resource. Nullptr if it does not have one.
+	 */
+	UResource* FindFacade(const FResourceHandle Handle) const;
+
+	/**
+	 * A single resource.
+	 */
+	struct FPooledResource
+	{
+		//The index of the faucet supplying this in the faucet table.
+		int32 FaucetIndex = INDEX_NONE;
+
+		//The index of the sink this is allocated to in the sink table. INDEX_NONE if unallocated.
+		int32 SinkIndex = INDEX_NONE;
+
+		//The number of times this slot has been released.
+		uint32 Generation = 0;
+
+		//The type of this resource.
+		EResourceType Type = EResourceType::Any;
+
+		//The way this has been allocated.
+		EResourceAllocationType AllocationType = EResourceAllocationType::NotAllocated;
+
+		//Whether this slot holds a resource that has not been released.
+		bool bInUse = false;
+
+		//Whether this was released while allocated.
+		bool bReleasePending = false;
+	};
+
+	/**
+	 * The faucets or sinks referenced by resources, stored by index so resources do not need to hold object pointers.
+	 */
+	struct FEndpointTable
+	{
+		/**
+		 * Gets the index of an object, adding it if needed, and adds a reference to it.
+		 *
+		 * @param Object - The object to reference.
+		 * @return The index of the object.
+		 */
+		int32 AddReference(UObject* Object);
+
+		/**
+		 * Removes a reference to an object, removing it once it is no longer referenced.
+		 *
+		 * @param Index - The index of the object.
+		 */
+		void RemoveReference(const int32 Index);
+
+		/**
+		 * Gets an object by index.
+		 *
+		 * @param Index - The index of the object.
+		 * @return The object. Nullptr if it has been destroyed.
+		 */
+		FORCEINLINE UObject* Get(const int32 Index) const { return Objects.IsValidIndex(Index) ? Objects[Index].Get() : nullptr; };
+
+	private:
+		//The objects by index.
+		TArray<TWeakObjectPtr<UObject>> Objects = TArray<TWeakObjectPtr<UObject>>();
+
+		//The key of each object in the index map. Never dereferenced since the object may have been destroyed.
+		TArray<UObject*> Keys = TArray<UObject*>();
+
+		//The number of resources referencing each object.
+		TArray<int32> NumReferences = TArray<int32>();
+
+		//The index of each object.
+		TMap<UObject*, int32> ObjectsToIndices = TMap<UObject*, int32>();
+
+		//The indices that are not being used.
+		TArray<int32> FreeIndices = TArray<int32>();
+	};
+
+	//Every resource slot.
+	TArray<FPooledResource> Resources = TArray<FPooledResource>();
+
+	//The slots that can be reused.
+	TArray<int32> FreeIndices = TArray<int32>();
+
+	//The facade of each slot. Nullptr until one is needed, and kept for reuse after release when recycling.
+	UPROPERTY()
+	TArray<UResource*> Facades = TArray<UResource*>();
+
+	//The faucets referenced by resources.
+	FEndpointTable Faucets = FEndpointTable();
+
+	//The sinks referenced by resources.
+	FEndpointTable Sinks = FEndpointTable();
+
+	//The number of resources created since the stats were last reset.
+	int64 NumResourcesCreated = 0;
+
+	//The number of facade objects created since the stats were last reset.
+	int64 NumFacadesCreated = 0;
+};
+/* /\ ============= /\ *\
+|  /\ UResourcePool /\  |
+\* /\ ============= /\ */
@@ -4,8 +4,10 @@
 #include "ResourceSink.h"
 
 #include "Resource.h"
-#include "Syrup/Tiles/Effects/TileEffectTrigger.h"
+#include "ResourcePool.h"
+#include "ResourceIncrementQueue.h"
 #include "Syrup/Systems/SyrupGameMode.h"
+#include "Syrup/Systems/BoardHistorySubsystem.h"
 
  /* \/ ============ \/ *\
  |  \/ ResourceSink \/  |
@@ -31,6 +33,28 @@ UResourceSink* UResourceSink::CreateDefaultResourceSinkComponent(AActor* Owner,
 	return NewSink;
 }
 
+/**
+ * Adds a default resource sink to an actor that calls its owner's functions directly instead of by name. Use only
+ * in the constructor.
+ *
+ * @param Owner - The actor to add the sink to.
+ * @param SinkName - The name of the sink. Must match the name the sink would have been given by the dynamic version so that saves still find it.
+ * @param UpdateCallback - The function that should be called when the amount produced by this sink changes.
+ * @param GetLocations - The function that should be called to find out what grid locations are occupied by this sink.
+ * @param GetAmount - The function that should be called to find out the amount produced by this sink.
+ *
+ * @return The sink that was created.
+ */
+UResourceSink* UResourceSink::CreateDefaultNativeResourceSinkComponent(AActor* Owner, const FName SinkName, const FNativeSinkAmountUpdateDelegate& UpdateCallback, const FNativeSinkLocationsDelegate& GetLocations, const FNativeSinkAmountDelegate& GetAmount)
+{
+	UResourceSink* NewSink = Owner->CreateDefaultSubobject<UResourceSink>(SinkName);
+	NewSink->NativeOnAmountChanged = UpdateCallback;
+	NewSink->NativeAllocationLocationsGetter = GetLocations;
+	NewSink->NativeAllocatedAmountGetter = GetAmount;
+
+	return NewSink;
+}
+
 /**
  * Adds a default resource sink to an actor. Use only in the constructor.
  *
@@ -49,22 +73,35 @@ UResourceSink* UResourceSink::AddResourceSinkComponent(AActor* Owner, FResourceS
 	NewSink->OnAmountChanged = UpdateCallback;
 	NewSink->AllocationLocationsGetter = GetLocations;
 	NewSink->AllocatedAmountGetter = GetAmount;
-
-	ASyrupGameMode::GetTileEffectTriggerDelegate(Owner).AddDynamic(NewSink, &UResourceSink::ReceiveEffectTrigger);
-	NewSink->OnAmountChanged.Execute(NewSink->Data.IntialValue);
+	NewSink->ExecuteAmountChanged(NewSink->Data.IntialValue);
 
 	return NewSink;
 }
 
 /**
- * Binds appropriate delegates and sets up initial values.
+ * Sets up initial values.
  */
 void UResourceSink::BeginPlay()
 {
 	Super::BeginPlay();
 
-	ASyrupGameMode::GetTileEffectTriggerDelegate(this).AddDynamic(this, &UResourceSink::ReceiveEffectTrigger);
-	OnAmountChanged.Execute(Data.IntialValue);
+	ExecuteAmountChanged(Data.IntialValue);
+}
+
+/**
+ * Leaves the increment queue.
+ *
+ * @param EndPlayReason - Why this sink is leaving play.
+ */
+void UResourceSink::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UResourceIncrementQueue* IncrementQueue = UResourceIncrementQueue::Get(this);
+	if (IsValid(IncrementQueue))
+	{
+		IncrementQueue->RemovePendingSink(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 /**
@@ -75,10 +112,21 @@ void UResourceSink::BeginPlay()
 UFUNCTION(BlueprintPure, Category = "Resources")
 void UResourceSink::SetAllocationAmount(int NewAmount) const
 {
-	OnAmountChanged.Execute(NewAmount);
+	ExecuteAmountChanged(NewAmount);
 	EventOnAmountChanged.Broadcast(NewAmount);
 }
 
+/**
+ * Gets all the resources allocated to this, creating facades for any that do not have one yet.
+ *
+ * @return The resources allocated to this.
+ */
+TArray<UResource*> UResourceSink::GetAllocatedResources() const
+{
+	UResourcePool* Pool = UResourcePool::Get(this);
+	return IsValid(Pool) ? Pool->GetFacades(AllocatedResources) : TArray<UResource*>();
+}
+
 /**
  * Gets whether it is possible to allocate a resource to this.
  *
@@ -88,10 +136,20 @@ void UResourceSink::SetAllocationAmount(int NewAmount) const
  */
 bool UResourceSink::CanAllocateResource(UResource* FreedResource) const
 {
-	return IsValid(FreedResource) //Check validity
-		&& (!Data.bHasMaxIncrement || AllocatedResources.Num() < Data.MaxIncrements) //Check max increment
+	return IsValid(FreedResource) && CanAllocateResource(FreedResource->GetHandle());
+}
+bool UResourceSink::CanAllocateResource(const FResourceHandle FreedResource) const
+{
+	const UResourcePool* Pool = UResourcePool::Get(this);
+	if (!IsValid(Pool) || !Pool->IsAlive(FreedResource)) //Check validity
+	{
+		return false;
+	}
+
+	const EResourceType Type = Pool->GetType(FreedResource);
+	return (!Data.bHasMaxIncrement || AllocatedResources.Num() < Data.MaxIncrements) //Check max increment
 		&& (!Data.bHasMaxIncrementmentsPerTurn || IncrementsThisTurn < Data.MaxIncrementmentsPerTurn) //Check per turn increment
-		&& (FreedResource->GetType() == GetRequiredResourceType() || FreedResource->GetType() == EResourceType::Any || GetRequiredResourceType() == EResourceType::Any); //Check resource type
+		&& (Type == GetRequiredResourceType() || Type == EResourceType::Any || GetRequiredResourceType() == EResourceType::Any); //Check resource type
 }
 
 /**
@@ -103,13 +161,23 @@ bool UResourceSink::CanAllocateResource(UResource* FreedResource) const
  * @return Whether or not the allocation was successful.
  */
 bool UResourceSink::AllocateResource(UResource* ResourceToAllocate, bool bForceAllocation)
+{
+	return IsValid(ResourceToAllocate) && AllocateResource(ResourceToAllocate->GetHandle(), bForceAllocation);
+}
+bool UResourceSink::AllocateResource(const FResourceHandle ResourceToAllocate, bool bForceAllocation)
 {
 	if (!CanAllocateResource(ResourceToAllocate) && !bForceAllocation)
 	{
 		return false;
 	}
 
-	ResourceToAllocate->Allocate(this, Data.AllocationType);
+	UResourcePool* Pool = UResourcePool::Get(this);
+	if (!IsValid(Pool))
+	{
+		return false;
+	}
+
+	Pool->AllocateResource(ResourceToAllocate, this, Data.AllocationType);
 	AllocatedResources.Add(ResourceToAllocate);
 
 	if (bForceAllocation)
@@ -120,14 +188,26 @@ bool UResourceSink::AllocateResource(UResource* ResourceToAllocate, bool bForceA
 	if (Data.bDeferredIncrement)
 	{
 		IncrementsThisTurn++;
+		UResourceIncrementQueue* IncrementQueue = UResourceIncrementQueue::Get(this);
+		if (IsValid(IncrementQueue))
+		{
+			IncrementQueue->AddPendingSink(this);
+		}
 		EventOnAmountChanged.Broadcast(GetAllocationAmount());
 	}
 	else
 	{
 		int NewAmount = GetAllocationAmount() + Data.IncrementPerResource;
-		OnAmountChanged.Execute(NewAmount);
+		ExecuteAmountChanged(NewAmount);
 		EventOnAmountChanged.Broadcast(NewAmount);
 	}
+
+	//Forced allocations restore links, such as when loading or undoing, so they are not recorded. Only the player's own allocations can be undone.
+	UBoardHistorySubsystem* History = UBoardHistorySubsystem::Get(this);
+	if (IsValid(History))
+	{
+		History->RecordAllocate(this, ResourceToAllocate);
+	}
 	return true;
 }
 
@@ -138,11 +218,30 @@ bool UResourceSink::AllocateResource(UResource* ResourceToAllocate, bool bForceA
  */
 void UResourceSink::FreeResource(UResource* FreedResource)
 {
-	FreedResource->Free();
-	AllocatedResources.Remove(FreedResource);
+	if (IsValid(FreedResource))
+	{
+		FreeResource(FreedResource->GetHandle());
+	}
+}
+void UResourceSink::FreeResource(const FResourceHandle FreedResource)
+{
+	UResourcePool* Pool = UResourcePool::Get(this);
+	if (IsValid(Pool))
+	{
+		Pool->FreeResource(FreedResource);
+	}
+
+	//Freeing the resource may have already freed it from this, in which case it was recorded then.
+	const bool bWasAllocated = AllocatedResources.Remove(FreedResource) > 0;
 
 	if (IsValid(this))
 	{
+		UBoardHistorySubsystem* History = bWasAllocated ? UBoardHistorySubsystem::Get(this) : nullptr;
+		if (IsValid(History))
+		{
+			History->RecordFree(this, FreedResource, IncrementsThisTurn > 0);
+		}
+
 		if (IncrementsThisTurn)
 		{
 			IncrementsThisTurn--;
@@ -153,7 +252,7 @@ void UResourceSink::FreeResource(UResource* FreedResource)
 			int NewAmount = GetAllocationAmount() - Data.IncrementPerResource;
 			if (IsValid(GetOwner()))
 			{
-				OnAmountChanged.Execute(NewAmount);
+				ExecuteAmountChanged(NewAmount);
 			}
 			EventOnAmountChanged.Broadcast(NewAmount);
 		}
@@ -161,23 +260,35 @@ void UResourceSink::FreeResource(UResource* FreedResource)
 }
 
 /**
- * Activates the appropriate effects given the trigger.
+ * Calls the function that causes the effects of the amount changing, preferring the native binding.
  *
- * @param TriggerType - The type of trigger that was activated.
- * @param Triggerer - The tile that triggered this effect.
- * @param LocationsToTrigger - The Locations where the trigger applies an effect. If this is empty all effect locations will be effected.
+ * @param NewAmount - The new amount stored in this sink.
  */
-void UResourceSink::ReceiveEffectTrigger(const ETileEffectTriggerType TriggerType, const ATile* Triggerer, const TSet<FIntPoint>& LocationsToTrigger)
+void UResourceSink::ExecuteAmountChanged(const int NewAmount) const
 {
-	if (Data.bDeferredIncrement && TriggerType == Data.IncrementTrigger)
+	if (NativeOnAmountChanged.IsBound())
+	{
+		NativeOnAmountChanged.Execute(NewAmount);
+	}
+	else
 	{
-		int NewAmount = GetAllocationAmount() + IncrementsThisTurn * Data.IncrementPerResource;
-		IncrementsThisTurn = 0;
 		OnAmountChanged.Execute(NewAmount);
-		EventOnAmountChanged.Broadcast(NewAmount);
 	}
 }
 
+/**
+ * Applies the increments deferred this turn without broadcasting the change.
+ *
+ * @return The new amount stored in this sink.
+ */
+int UResourceSink::ApplyDeferredIncrements()
+{
+	int NewAmount = GetAllocationAmount() + IncrementsThisTurn * Data.IncrementPerResource;
+	IncrementsThisTurn = 0;
+	ExecuteAmountChanged(NewAmount);
+	return NewAmount;
+}
+
 /* /\ ============ /\ *\
 |  /\ ResourceSink /\  |
 \* /\ ============ /\ */
\ No newline at end of file
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "ResourceSinkData.h"
+#include "ResourceHandle.h"
 
 #include "ResourceSink.generated.h"
 
@@ -18,6 +19,12 @@ DECLARE_DYNAMIC_DELEGATE_OneParam(FSinkAmountUpdateDelegate, int, NewAmount);
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FBlueprintSinkAmountUpdateDelegate, int, NewAmount);
 
+DECLARE_DELEGATE_RetVal(TSet<FIntPoint>, FNativeSinkLocationsDelegate);
+
+DECLARE_DELEGATE_RetVal(int, FNativeSinkAmountDelegate);
+
+DECLARE_DELEGATE_OneParam(FNativeSinkAmountUpdateDelegate, int);
+
  /* \/ ============ \/ *\
  |  \/ ResourceSink \/  |
  \* \/ ============ \/ */
@@ -43,6 +50,20 @@ public:
     UFUNCTION()
     static UResourceSink* CreateDefaultResourceSinkComponent(AActor* Owner, const FSinkAmountUpdateDelegate& UpdateCallback, const FSinkLocationsDelegate& GetLocations, const FSinkAmountDelegate& GetAmount);
 
+    /**
+     * Adds a default resource sink to an actor that calls its owner's functions directly instead of by name. Use only
+     * in the constructor.
+     *
+     * @param Owner - The actor to add the sink to.
+     * @param SinkName - The name of the sink. Must match the name the sink would have been given by the dynamic version so that saves still find it.
+     * @param UpdateCallback - The function that should be called when the amount produced by this sink changes.
+     * @param GetLocations - The function that should be called to find out what grid locations are occupied by this sink.
+     * @param GetAmount - The function that should be called to find out the amount produced by this sink.
+     *
+     * @return The sink that was created.
+     */
+    static UResourceSink* CreateDefaultNativeResourceSinkComponent(AActor* Owner, const FName SinkName, const FNativeSinkAmountUpdateDelegate& UpdateCallback, const FNativeSinkLocationsDelegate& GetLocations, const FNativeSinkAmountDelegate& GetAmount);
+
     /**
      * Adds a default resource sink to an actor. Use only in the constructor.
      *
@@ -59,17 +80,24 @@ public:
      
 
     /**
-     * Binds appropriate delegates and sets up initial values.
+     * Sets up initial values.
      */
     virtual void BeginPlay() override;
 
+    /**
+     * Leaves the increment queue.
+     *
+     * @param EndPlayReason - Why this sink is leaving play.
+     */
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
     /**
      * Gets the grid locations that this sink takes up.
      *
      * @return The grid locations that this sink takes up.
      */
     UFUNCTION(BlueprintPure, Category = "Resources")
-    FORCEINLINE TSet<FIntPoint> GetAllocationLocations() const { return AllocationLocationsGetter.Execute(); };
+    FORCEINLINE TSet<FIntPoint> GetAllocationLocations() const { return NativeAllocationLocationsGetter.IsBound() ? NativeAllocationLocationsGetter.Execute() : AllocationLocationsGetter.Execute(); };
     
     /**
      * Gets the amount stored in this sink (not to be confused with the number of resources allocated to this).
@@ -77,7 +105,7 @@ public:
      * @return The amount stored in this sink.
      */
     UFUNCTION(BlueprintPure, Category = "Resources")
-    FORCEINLINE int GetAllocationAmount() const { return AllocatedAmountGetter.Execute(); };
+    FORCEINLINE int GetAllocationAmount() const { return NativeAllocatedAmountGetter.IsBound() ? NativeAllocatedAmountGetter.Execute() : AllocatedAmountGetter.Execute(); };
 
     /**
      * Sets the amount stored in this sink (not to be confused with the number of resources allocated to this).
@@ -88,12 +116,19 @@ public:
     void SetAllocationAmount(int NewAmount) const;
 
     /**
-     * Gets all the resources allocated to this.
+     * Gets all the resources allocated to this, creating facades for any that do not have one yet.
      *
      * @return The resources allocated to this.
      */
     UFUNCTION(BlueprintPure, Category = "Resources")
-    FORCEINLINE TArray<UResource*> GetAllocatedResources() const { return AllocatedResources; };
+    TArray<UResource*> GetAllocatedResources() const;
+
+    /**
+     * Gets the handles of all the resources allocated to this.
+     *
+     * @return The handles of the resources allocated to this.
+     */
+    FORCEINLINE TArray<FResourceHandle> GetAllocatedResourceHandles() const { return AllocatedResources; };
     
     /**
      * Gets how many times this was allocated to this turn.
@@ -128,6 +163,7 @@ public:
      */
     UFUNCTION(BlueprintCallable, Category = "Resources")
     bool CanAllocateResource(UResource* FreedResource) const;
+    bool CanAllocateResource(const FResourceHandle FreedResource) const;
 
 
     /**
@@ -140,6 +176,7 @@ public:
      */
     UFUNCTION(BlueprintCallable, Category = "Resources")
     bool AllocateResource(UResource* ResourceToAllocate, bool bForceAllocation = false);
+    bool AllocateResource(const FResourceHandle ResourceToAllocate, bool bForceAllocation = false);
 
     /**
      * Undoes the effect of a resource that was sunk in this.
@@ -148,6 +185,7 @@ public:
      */
     UFUNCTION(BlueprintCallable, Category = "Resources")
     void FreeResource(UResource* FreedResource);
+    void FreeResource(const FResourceHandle FreedResource);
 
     //Called when the amount in the sink changes.
     UPROPERTY(BlueprintAssignable)
@@ -159,14 +197,18 @@ public:
 
 private:
 	/**
-	 * Activates the appropriate effects given the trigger.
-	 * 
-	 * @param TriggerType - The type of trigger that was activated.
-	 * @param Triggerer - The tile that triggered this effect.
-	 * @param LocationsToTrigger - The Locations where the trigger applies an effect. If this is empty all effect locations will be effected.
+	 * Applies the increments deferred this turn without broadcasting the change.
+	 *
+	 * @return The new amount stored in this sink.
+	 */
+	int ApplyDeferredIncrements();
+
+	/**
+	 * Calls the function that causes the effects of the amount changing, preferring the native binding.
+	 *
+	 * @param NewAmount - The new amount stored in this sink.
 	 */
-	UFUNCTION()
-	void ReceiveEffectTrigger(const ETileEffectTriggerType TriggerType, const ATile* Triggerer, const TSet<FIntPoint>& LocationsToTrigger);
+	void ExecuteAmountChanged(const int NewAmount) const;
 
     //The function used to get this sink's locations.
     UPROPERTY()
@@ -180,13 +222,27 @@ private:
     UPROPERTY()
     FSinkAmountUpdateDelegate OnAmountChanged;
 
+    //The function used to get this sink's locations when created by C++. Takes priority over the dynamic getter.
+    FNativeSinkLocationsDelegate NativeAllocationLocationsGetter;
+
+    //The function used to get this sink's amount when created by C++. Takes priority over the dynamic getter.
+    FNativeSinkAmountDelegate NativeAllocatedAmountGetter;
+
+    //The function that causes the effects of the amount changing when created by C++. Takes priority over the dynamic callback.
+    FNativeSinkAmountUpdateDelegate NativeOnAmountChanged;
+
     //The resources that have been allocated to this.
     UPROPERTY()
-    TArray<UResource*> AllocatedResources;
+    TArray<FResourceHandle> AllocatedResources;
 
     //The number of times the amount is to be incremented this turn.
     UPROPERTY()
     int IncrementsThisTurn = 0;
+
+    //Whether this is waiting in the increment queue.
+    bool bIsIncrementPending = false;
+
+    friend class UResourceIncrementQueue;
 };
 /* /\ ============ /\ *\
 |  /\ ResourceSink /\  |
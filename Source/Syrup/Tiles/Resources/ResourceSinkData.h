@@ -64,6 +64,10 @@ struct SYRUP_API FResourceSinkData
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Allocation", Meta = (InvalidEnumValues = "NotAllocated"))
     EResourceAllocationType AllocationType = EResourceAllocationType::NotAllocated;
 
+    //Sinks with higher values are filled first when resources are allocated automatically.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Allocation")
+    int AutoAllocationPriority = 0;
+
     /* /\ Allocation /\ *\
     \* ---------------- */
 
@@ -4,7 +4,10 @@
 #include "SpiritPlant.h"
 
 #include "Syrup/Systems/SyrupGameMode.h"
+#include "Syrup/Systems/TileEffectDispatcher.h"
 #include "Resources/Resource.h"
+#include "Resources/ResourcePool.h"
+#include "Resources/ResourceNetwork.h"
 
 /**
  * Ensures there is one and only one free resource available here.
@@ -12,14 +15,21 @@
 UFUNCTION()
 void ASpiritPlant::EnsureValidResourceQuantity()
 {
+	UResourcePool* Pool = UResourcePool::Get(this);
+	if (!IsValid(Pool))
+	{
+		return;
+	}
+
 	bool bFreeResourceFound = false;
-	for (UResource* EachProducedResource : GetProducedResources())
+	for (const FResourceHandle& EachProducedResource : GetProducedResourceHandles())
 	{
-		if (!EachProducedResource->IsAllocated())
+		if (!Pool->IsAllocated(EachProducedResource))
 		{
 			if (bFreeResourceFound)
 			{
 				ProducedResources.Remove(EachProducedResource);
+				Pool->ReleaseResource(EachProducedResource);
 				OnProductionChanged.Broadcast();
 			}
 			bFreeResourceFound = true;
@@ -33,16 +43,56 @@ void ASpiritPlant::EnsureValidResourceQuantity()
 }
 
 /**
- * Creates a resource.
+ * Joins the resource network and creates a resource.
  */
 void ASpiritPlant::BeginPlay()
 {
 	Super::BeginPlay();
 
+	UResourceNetwork* Network = UResourceNetwork::Get(this);
+	if (IsValid(Network))
+	{
+		Network->UpdateFaucet(this);
+	}
+
 	ProduceResource(ProductionType);
 	OnProductionChanged.Broadcast();
 
-	ASyrupGameMode::GetTileEffectTriggerDelegate(this).AddDynamic(this, &ASpiritPlant::ReceiveEffectTrigger);
+	UTileEffectDispatcher* Dispatcher = UTileEffectDispatcher::Get(this);
+	if (IsValid(Dispatcher))
+	{
+		EffectTriggerListenerHandle = Dispatcher->RegisterListener(FTileEffectTriggerListener::CreateUObject(this, &ASpiritPlant::ReceiveEffectTrigger), GetTileEffectTriggerBit(ETileEffectTriggerType::PlantsGrow));
+	}
+}
+
+/**
+ * Returns the resources produced by this to the pool and leaves the resource network and the tile effect dispatcher.
+ */
+void ASpiritPlant::Destroyed()
+{
+	UTileEffectDispatcher* Dispatcher = UTileEffectDispatcher::Get(this);
+	if (IsValid(Dispatcher))
+	{
+		Dispatcher->UnregisterListener(EffectTriggerListenerHandle);
+	}
+
+	UResourcePool* Pool = UResourcePool::Get(this);
+	if (IsValid(Pool))
+	{
+		for (const FResourceHandle& EachProducedResource : ProducedResources)
+		{
+			Pool->ReleaseResource(EachProducedResource);
+		}
+	}
+	ProducedResources.Empty();
+
+	UResourceNetwork* Network = UResourceNetwork::Get(this);
+	if (IsValid(Network))
+	{
+		Network->RemoveFaucet(this);
+	}
+
+	Super::Destroyed();
 }
 
 /**
@@ -56,11 +106,22 @@ TSet<FIntPoint> ASpiritPlant::GetAllocatableLocations() const
 }
 
 /**
- * Gets all the resources produced by this.
+ * Gets all the resources produced by this, creating facades for any that do not have one yet.
  *
  * @return The resources produced by this.
  */
 TArray<UResource*> ASpiritPlant::GetProducedResources() const
+{
+	UResourcePool* Pool = UResourcePool::Get(this);
+	return IsValid(Pool) ? Pool->GetFacades(ProducedResources) : TArray<UResource*>();
+}
+
+/**
+ * Gets the handles of all the resources produced by this.
+ *
+ * @return The handles of the resources produced by this.
+ */
+TArray<FResourceHandle> ASpiritPlant::GetProducedResourceHandles() const
 {
 	return ProducedResources;
 }
@@ -70,7 +131,7 @@ TArray<UResource*> ASpiritPlant::GetProducedResources() const
  *
  * @param UpdatedResource - The resource that was freed.
  */
-void ASpiritPlant::ResourceFreed(UResource* UpdatedResource)
+void ASpiritPlant::ResourceFreed(const FResourceHandle UpdatedResource)
 {
 	if (bNeedsMoreResource)
 	{
@@ -79,6 +140,11 @@ void ASpiritPlant::ResourceFreed(UResource* UpdatedResource)
 	else
 	{
 		ProducedResources.Remove(UpdatedResource);
+		UResourcePool* Pool = UResourcePool::Get(this);
+		if (IsValid(Pool))
+		{
+			Pool->ReleaseResource(UpdatedResource);
+		}
 		OnProductionChanged.Broadcast();
 	}
 }
@@ -88,7 +154,7 @@ void ASpiritPlant::ResourceFreed(UResource* UpdatedResource)
  *
  * @param UpdatedResource - The resource that was allocated.
  */
-void ASpiritPlant::ResourceAllocated(UResource* UpdatedResource)
+void ASpiritPlant::ResourceAllocated(const FResourceHandle UpdatedResource)
 {
 	bNeedsMoreResource = true;
 	OnProductionChanged.Broadcast();
@@ -99,14 +165,19 @@ void ASpiritPlant::ResourceAllocated(UResource* UpdatedResource)
  *
  * @param Type - The type of resource to produce.
  *
- * @return The newly created resource.
+ * @return The handle of the newly created resource.
  */
-UResource* ASpiritPlant::ProduceResource(const EResourceType& Type)
+FResourceHandle ASpiritPlant::ProduceResource(const EResourceType& Type)
 {
-	UResource* NewResource = UResource::Create(Type, this);
+	UResourcePool* Pool = UResourcePool::Get(this);
+	if (!IsValid(Pool))
+	{
+		UE_LOG(LogResource, Error, TEXT("%s is not in a world with a resource pool."), *GetName());
+		return FResourceHandle();
+	}
+
+	const FResourceHandle NewResource = Pool->CreateResource(Type, this);
 	ProducedResources.Add(NewResource);
-	NewResource->OnFreed.AddDynamic(this, &ASpiritPlant::ResourceFreed);
-	NewResource->OnAllocated.AddDynamic(this, &ASpiritPlant::ResourceAllocated);
 	bNeedsMoreResource = false;
 	OnProductionChanged.Broadcast();
 	return NewResource;
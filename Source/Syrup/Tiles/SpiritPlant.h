@@ -32,10 +32,15 @@ protected:
 
 private:
     /**
-     * Creates a resource.
+     * Joins the resource network and creates a resource.
      */
     virtual void BeginPlay() override;
 
+    /**
+     * Returns the resources produced by this to the pool and leaves the resource network and the tile effect dispatcher.
+     */
+    virtual void Destroyed() override;
+
     /**
      * Gets the gets grid location locations that this faucet can allocate to.
      *
@@ -44,12 +49,19 @@ private:
     virtual TSet<FIntPoint> GetAllocatableLocations() const override;
 
     /**
-     * Gets all the resources produced by this.
+     * Gets all the resources produced by this, creating facades for any that do not have one yet.
      *
      * @return The resources produced by this.
      */
     virtual TArray<UResource*> GetProducedResources() const override;
 
+    /**
+     * Gets the handles of all the resources produced by this.
+     *
+     * @return The handles of the resources produced by this.
+     */
+    virtual TArray<FResourceHandle> GetProducedResourceHandles() const override;
+
     //Called when the resources produced changes.
     UPROPERTY(BlueprintAssignable)
     FFaucetUpdated OnProductionChanged;
@@ -59,16 +71,14 @@ private:
      * 
      * @param UpdatedResource - The resource that was freed.
      */
-    UFUNCTION()
-    void ResourceFreed(UResource* UpdatedResource);
+    virtual void ResourceFreed(const FResourceHandle UpdatedResource) override;
 
     /**
      * Creates a new resource.
      *
      * @param UpdatedResource - The resource that was allocated.
      */
-    UFUNCTION()
-    void ResourceAllocated(UResource* UpdatedResource);
+    virtual void ResourceAllocated(const FResourceHandle UpdatedResource) override;
     
 	/**
 	 * Activates the appropriate effects given the trigger.
@@ -85,9 +95,9 @@ private:
      * 
      * @param Type - The type of resource to produce.
      * 
-     * @return The newly created resource.
+     * @return The handle of the newly created resource.
      */
-    virtual UResource* ProduceResource(const EResourceType& Type) override;
+    virtual FResourceHandle ProduceResource(const EResourceType& Type) override;
 
     //Whether or not another resource needs to be produced.
     UPROPERTY()
@@ -95,5 +105,8 @@ private:
 
     //The resources provided by this
     UPROPERTY()
-    TArray<UResource*> ProducedResources = TArray<UResource*>();
+    TArray<FResourceHandle> ProducedResources = TArray<FResourceHandle>();
+
+    //The handle of this spirit plant's listener in the tile effect dispatcher.
+    int32 EffectTriggerListenerHandle = INDEX_NONE;
 };
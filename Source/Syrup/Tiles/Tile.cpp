@@ -3,9 +3,21 @@
 
 #include "Tile.h"
 
+#include "GridOccupancySubsystem.h"
+#include "TileRenderSubsystem.h"
+#include "Syrup/Systems/InstanceCustomDataBatcher.h"
+
 #include "Components/InstancedStaticMeshComponent.h"
 #include "Components/ArrowComponent.h"
 #include "DrawDebugHelpers.h"
+#include "HAL/IConsoleManager.h"
+
+#if DO_CHECK
+static TAutoConsoleVariable<bool> CVarVerifyGridCaches(
+	TEXT("Syrup.Tiles.VerifyGridCaches"),
+	false,
+	TEXT("Whether cached tile footprints should be checked against freshly computed ones whenever they are read."));
+#endif
 
 
 
@@ -45,6 +57,9 @@ ATile::ATile()
 	//Create Label Root
 	LabelRoot = CreateDefaultSubobject<USceneComponent>(FName("Label Root"));
 	LabelRoot->AttachToComponent(SubtileMesh, FAttachmentTransformRules::KeepRelativeTransform);
+
+	//Keep cached footprint up to date
+	RootComponent->TransformUpdated.AddUObject(this, &ATile::OnRootTransformUpdated);
 }
 
 /**
@@ -55,6 +70,7 @@ ATile::ATile()
 void ATile::OnConstruction(const FTransform& Transform)
 {
 	SetActorTransform(Transform * (FTransform(-FVector(0, 0, Transform.GetTranslation().Z))));
+	InvalidateGridCache();
 	FieldsToStrengths = TMap<EFieldType, int>();
 	if(ensure(IsValid(SubtileMesh)))
 	{
@@ -92,7 +108,83 @@ void ATile::OnConstruction(const FTransform& Transform)
 		}
 
 		SubtileMesh->AddInstances(TileLocalTransforms, false, false);
+
+		//Keep the shared renderer in sync with the rebuilt instances.
+		if (RenderHandle != INDEX_NONE)
+		{
+			UnregisterFromRenderer();
+			RegisterWithRenderer();
+		}
+	}
+
+	UpdateOccupancy();
+}
+
+/**
+ * Registers this tile with the grid occupancy index and the shared tile renderer.
+ */
+void ATile::BeginPlay()
+{
+	Super::BeginPlay();
+
+	UpdateOccupancy();
+	RegisterWithRenderer();
+}
+
+/**
+ * Removes this tile from the grid occupancy index and the shared tile renderer.
+ *
+ * @param EndPlayReason - Why this tile is leaving play.
+ */
+void ATile::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	RemoveOccupancy();
+	UnregisterFromRenderer();
+	Super::EndPlay(EndPlayReason);
+}
+
+/**
+ * Removes this tile from the grid occupancy index.
+ */
+void ATile::Destroyed()
+{
+	RemoveOccupancy();
+	Super::Destroyed();
+}
+
+/**
+ * Updates the locations and channels this tile is registered as occupying. Should be called whenever the
+ * tile's transform or sub-tile collision changes.
+ */
+void ATile::UpdateOccupancy()
+{
+	UGridOccupancySubsystem* OccupancySubsystem = UGridOccupancySubsystem::Get(this);
+	if (!IsValid(OccupancySubsystem))
+	{
+		return;
 	}
+
+	OccupancySubsystem->UnregisterTile(this, OccupiedLocations);
+
+	//Match the locations covered by the sub-tile mesh instances.
+	TSet<FIntPoint> TileLocations = GetRelativeSubTileLocations();
+	TileLocations.Add(FIntPoint::ZeroValue);
+	OccupiedLocations = UGridLibrary::TransformShape(TileLocations, GetGridTransform());
+
+	OccupancySubsystem->RegisterTile(this, OccupiedLocations, UGridOccupancySubsystem::GetBlockedChannels(SubtileMesh));
+}
+
+/**
+ * Removes this tile from all the locations it is registered as occupying.
+ */
+void ATile::RemoveOccupancy()
+{
+	UGridOccupancySubsystem* OccupancySubsystem = UGridOccupancySubsystem::Get(this);
+	if (IsValid(OccupancySubsystem))
+	{
+		OccupancySubsystem->UnregisterTile(this, OccupiedLocations);
+	}
+	OccupiedLocations.Empty();
 }
 
 /**
@@ -102,7 +194,25 @@ void ATile::OnConstruction(const FTransform& Transform)
  */
 FGridTransform ATile::GetGridTransform() const
 {
-	return UGridLibrary::WorldTransformToGridTransform(GetActorTransform());
+	if (!bIsGridCacheValid)
+	{
+		CachedGridTransform = UGridLibrary::WorldTransformToGridTransform(GetActorTransform());
+		CachedSubTileLocations = UGridLibrary::TransformShape(GetRelativeSubTileLocations(), CachedGridTransform);
+		bIsGridCacheValid = true;
+	}
+#if DO_CHECK
+	else if (ShouldVerifyGridCaches())
+	{
+		FGridTransform ActualGridTransform = UGridLibrary::WorldTransformToGridTransform(GetActorTransform());
+		ensureMsgf(ActualGridTransform.Location == CachedGridTransform.Location && ActualGridTransform.Direction == CachedGridTransform.Direction,
+			TEXT("%s has a stale cached grid transform."), *GetName());
+		TSet<FIntPoint> ActualSubTileLocations = UGridLibrary::TransformShape(GetRelativeSubTileLocations(), ActualGridTransform);
+		ensureMsgf(ActualSubTileLocations.Num() == CachedSubTileLocations.Num() && ActualSubTileLocations.Includes(CachedSubTileLocations),
+			TEXT("%s has stale cached sub-tile locations."), *GetName());
+	}
+#endif
+
+	return CachedGridTransform;
 }
 
 /**
@@ -119,10 +229,7 @@ void ATile::ApplyField(EFieldType Type)
 	}
 	FieldsToStrengths.Add(Type,  1);
 	UpdateField(Type, true);
-	for (int InstanceIndex = 0; InstanceIndex < SubtileMesh->PerInstanceSMCustomData.Num(); InstanceIndex++)
-	{
-		SubtileMesh->SetCustomDataValue(InstanceIndex, (uint8)Type, 1, true);
-	}
+	SetFieldShown(Type, true);
 }
 
 /**
@@ -143,14 +250,81 @@ void ATile::RemoveField(EFieldType Type)
 		{
 			FieldsToStrengths.Remove(Type);
 			UpdateField(Type, false);
-			for (int InstanceIndex = 0; InstanceIndex < SubtileMesh->PerInstanceSMCustomData.Num(); InstanceIndex++)
-			{
-				SubtileMesh->SetCustomDataValue(InstanceIndex, (uint8)Type, 0, true);
-			}
+			SetFieldShown(Type, false);
 		}
 	}
 }
 
+/**
+ * Sets whether a field is shown on the sub-tiles of this tile.
+ *
+ * @param Type - The type of field to show or hide.
+ * @param bShown - Whether the field is shown.
+ */
+void ATile::SetFieldShown(const EFieldType Type, const bool bShown)
+{
+	if (RenderHandle != INDEX_NONE)
+	{
+		UTileRenderSubsystem* RenderSubsystem = UTileRenderSubsystem::Get(this);
+		if (IsValid(RenderSubsystem))
+		{
+			RenderSubsystem->SetCustomDataValue(RenderHandle, (uint8)Type, bShown ? 1 : 0);
+		}
+	}
+
+	//Kept up to date even while the shared tile renderer draws the sub-tiles, as they are drawn by the sub-tile mesh again whenever they can not be shared.
+	UInstanceCustomDataBatcher::SetCustomDataValueForAllInstances(SubtileMesh, (uint8)Type, bShown ? 1 : 0);
+}
+
+/**
+ * Draws the sub-tiles of this tile with the shared tile renderer instead of the sub-tile mesh, if it is enabled.
+ */
+void ATile::RegisterWithRenderer()
+{
+	if (RenderHandle != INDEX_NONE || !IsValid(SubtileMesh) || !UTileRenderSubsystem::IsEnabled())
+	{
+		return;
+	}
+
+	UWorld* World = GetWorld();
+	UTileRenderSubsystem* RenderSubsystem = UTileRenderSubsystem::Get(this);
+	if (!IsValid(World) || !World->IsGameWorld() || !IsValid(RenderSubsystem))
+	{
+		return;
+	}
+
+	TArray<float> CustomData = TArray<float>();
+	CustomData.SetNumZeroed(SubtileMesh->NumCustomDataFloats);
+	for (TPair<EFieldType, int> EachField : FieldsToStrengths)
+	{
+		if (CustomData.IsValidIndex((uint8)EachField.Key))
+		{
+			CustomData[(uint8)EachField.Key] = 1;
+		}
+	}
+
+	//The renderer hides the sub-tile mesh, keeping it for collision only, and follows changes made to it.
+	RenderHandle = RenderSubsystem->AddInstances(SubtileMesh, CustomData);
+}
+
+/**
+ * Returns the drawing of the sub-tiles of this tile to the sub-tile mesh.
+ */
+void ATile::UnregisterFromRenderer()
+{
+	if (RenderHandle == INDEX_NONE)
+	{
+		return;
+	}
+
+	UTileRenderSubsystem* RenderSubsystem = UTileRenderSubsystem::Get(this);
+	if (IsValid(RenderSubsystem))
+	{
+		RenderSubsystem->RemoveInstances(RenderHandle);
+	}
+	RenderHandle = INDEX_NONE;
+}
+
 /*
  * The relative locations of all of the sub-tiles of this tile.
  *
@@ -168,7 +342,43 @@ TSet<FIntPoint> ATile::GetRelativeSubTileLocations() const
  */
 TSet<FIntPoint> ATile::GetSubTileLocations() const
 {
-	return UGridLibrary::TransformShape(GetRelativeSubTileLocations(), GetGridTransform());
+	GetGridTransform();
+	return CachedSubTileLocations;
+}
+
+/**
+ * Clears the cached grid transform and sub-tile locations. Should be called whenever the tile moves or its relative
+ * sub-tile locations change. Override to clear any other caches derived from the tile's footprint.
+ */
+void ATile::InvalidateGridCache()
+{
+	bIsGridCacheValid = false;
+}
+
+/**
+ * Whether cached footprints should be checked against freshly computed ones whenever they are read.
+ *
+ * @return Whether the stale cache checks are enabled.
+ */
+bool ATile::ShouldVerifyGridCaches()
+{
+#if DO_CHECK
+	return CVarVerifyGridCaches.GetValueOnAnyThread();
+#else
+	return false;
+#endif
+}
+
+/**
+ * Clears the cached footprint when the root component moves.
+ */
+void ATile::OnRootTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	InvalidateGridCache();
+	if (HasActorBegunPlay())
+	{
+		UpdateOccupancy();
+	}
 }
 /* /\ ===== /\ *\
 |  /\ ATile /\  |
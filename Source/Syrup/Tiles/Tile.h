@@ -37,6 +37,34 @@ public:
 	 */
 	virtual void OnConstruction(const FTransform& Transform) override;
 
+	/**
+	 * Registers this tile with the grid occupancy index and the shared tile renderer.
+	 */
+	virtual void BeginPlay() override;
+
+	/**
+	 * Removes this tile from the grid occupancy index and the shared tile renderer.
+	 *
+	 * @param EndPlayReason - Why this tile is leaving play.
+	 */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/**
+	 * Removes this tile from the grid occupancy index.
+	 */
+	virtual void Destroyed() override;
+
+	/**
+	 * Updates the locations and channels this tile is registered as occupying. Should be called whenever the
+	 * tile's transform or sub-tile collision changes.
+	 */
+	void UpdateOccupancy();
+
+	/**
+	 * Removes this tile from all the locations it is registered as occupying.
+	 */
+	void RemoveOccupancy();
+
 	/**
 	 * Gets the grid transform this tile.
 	 *
@@ -95,15 +123,38 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = "Visuals")
 	UMaterialInterface* TileMaterial;
 
-	//The mesh used to representing the tile's collision and the ground underneath the tile.
+	//The mesh used to representing the tile's collision and the ground underneath the tile. Hidden in game while the tile is drawn by the shared tile renderer, which follows changes to its material, overlay material, visibility and transform.
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
 	UInstancedStaticMeshComponent* SubtileMesh;
 
+	/**
+	 * Draws the sub-tiles of this tile with the shared tile renderer instead of the sub-tile mesh, if it is enabled.
+	 */
+	void RegisterWithRenderer();
+
+	/**
+	 * Returns the drawing of the sub-tiles of this tile to the sub-tile mesh.
+	 */
+	void UnregisterFromRenderer();
+
 
 	//The locations of the subtiles of this tile.
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Visuals")
 	TSet<FIntPoint> RelativeSubTileLocations;
 
+	/**
+	 * Clears the cached grid transform and sub-tile locations. Should be called whenever the tile moves or its relative
+	 * sub-tile locations change. Override to clear any other caches derived from the tile's footprint.
+	 */
+	virtual void InvalidateGridCache();
+
+	/**
+	 * Whether cached footprints should be checked against freshly computed ones whenever they are read.
+	 *
+	 * @return Whether the stale cache checks are enabled.
+	 */
+	static bool ShouldVerifyGridCaches();
+
 private:
 	//The mesh used for each tile as the ground.
 	UPROPERTY()
@@ -112,6 +163,35 @@ private:
 	//The field data for this tile.
 	UPROPERTY()
 	TMap<EFieldType, int> FieldsToStrengths = TMap<EFieldType, int>();
+
+	/**
+	 * Sets whether a field is shown on the sub-tiles of this tile.
+	 *
+	 * @param Type - The type of field to show or hide.
+	 * @param bShown - Whether the field is shown.
+	 */
+	void SetFieldShown(const EFieldType Type, const bool bShown);
+
+	//The handle of the sub-tiles of this tile in the shared tile renderer. INDEX_NONE if they are drawn by the sub-tile mesh.
+	int32 RenderHandle = INDEX_NONE;
+
+	/**
+	 * Clears the cached footprint when the root component moves.
+	 */
+	void OnRootTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+	//Whether the cached grid transform and sub-tile locations are up to date.
+	mutable bool bIsGridCacheValid = false;
+
+	//The grid transform of this tile when the cache was last updated.
+	mutable FGridTransform CachedGridTransform = FGridTransform();
+
+	//The locations of the sub-tiles of this tile when the cache was last updated.
+	mutable TSet<FIntPoint> CachedSubTileLocations = TSet<FIntPoint>();
+
+	//The locations this tile is registered as occupying in the grid occupancy index.
+	UPROPERTY(Transient)
+	TSet<FIntPoint> OccupiedLocations = TSet<FIntPoint>();
 };
 /* /\ ===== /\ *\
 |  /\ ATile /\  |
@@ -0,0 +1,420 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TileRenderSubsystem.h"
+
+#include "Syrup/Systems/InstanceCustomDataBatcher.h"
+
+#include "Components/InstancedStaticMeshComponent.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<bool> CVarSharedTileRenderer(
+	TEXT("Syrup.Tiles.SharedRenderer"),
+	true,
+	TEXT("Whether tiles that begin play should be rendered by one shared instanced mesh per mesh and material instead of their own meshes."));
+
+/* \/ ==================== \/ *\
+|  \/ UTileRenderSubsystem \/  |
+\* \/ ==================== \/ */
+
+/**
+ * Gets the tile render subsystem of a world.
+ *
+ * @param WorldContext - An object in the world to get the subsystem of.
+ * @return The tile render subsystem of the world. Nullptr if the world does not support one.
+ */
+UTileRenderSubsystem* UTileRenderSubsystem::Get(const UObject* WorldContext)
+{
+	if (!IsValid(WorldContext))
+	{
+		return nullptr;
+	}
+
+	UWorld* World = WorldContext->GetWorld();
+	return IsValid(World) ? World->GetSubsystem<UTileRenderSubsystem>() : nullptr;
+}
+
+/**
+ * Whether tiles should be rendered by the shared renderer instead of their own meshes.
+ *
+ * @return Whether the shared renderer is enabled.
+ */
+bool UTileRenderSubsystem::IsEnabled()
+{
+	return CVarSharedTileRenderer.GetValueOnGameThread();
+}
+
+/**
+ * Draws the instances of an instanced mesh with the shared mesh of its mesh and material.
+ *
+ * @param Source - The instanced mesh to draw the instances of.
+ * @param CustomData - The custom data given to every instance.
+ * @return The handle of the instances used to update or remove them.
+ */
+int32 UTileRenderSubsystem::AddInstances(UInstancedStaticMeshComponent* Source, const TArray<float>& CustomData)
+{
+	if (!IsValid(Source))
+	{
+		return INDEX_NONE;
+	}
+
+	const int32 Handle = NextHandle++;
+	FRegistration& Registration = HandlesToRegistrations.Add(Handle);
+	Registration.Source = Source;
+	Registration.CustomData = CustomData;
+	SyncRegistration(Registration, Handle);
+	return Handle;
+}
+
+/**
+ * Removes instances that were added together and lets their instanced mesh draw itself again.
+ *
+ * @param Handle - The handle of the instances. Will be set to INDEX_NONE.
+ */
+void UTileRenderSubsystem::RemoveInstances(int32& Handle)
+{
+	FRegistration Registration;
+	if (!HandlesToRegistrations.RemoveAndCopyValue(Handle, Registration))
+	{
+		Handle = INDEX_NONE;
+		return;
+	}
+	Handle = INDEX_NONE;
+
+	RemoveRegistrationInstances(Registration);
+	if (Registration.Source.IsValid())
+	{
+		Registration.Source->SetHiddenInGame(false);
+	}
+}
+
+/**
+ * Sets a custom data value of every instance that was added together. Does not change the instanced mesh they
+ * were added from.
+ *
+ * @param Handle - The handle of the instances.
+ * @param CustomDataIndex - The index of the custom data value to set.
+ * @param CustomDataValue - The value to set.
+ */
+void UTileRenderSubsystem::SetCustomDataValue(const int32 Handle, const int32 CustomDataIndex, const float CustomDataValue)
+{
+	FRegistration* Registration = HandlesToRegistrations.Find(Handle);
+	if (!Registration)
+	{
+		return;
+	}
+
+	if (Registration->CustomData.IsValidIndex(CustomDataIndex))
+	{
+		Registration->CustomData[CustomDataIndex] = CustomDataValue;
+	}
+
+	if (Registration->BatchIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	UInstancedStaticMeshComponent* Component = Batches[Registration->BatchIndex].Component;
+	for (int32 EachInstanceIndex : Registration->InstanceIndices)
+	{
+		UInstanceCustomDataBatcher::SetCustomDataValue(Component, EachInstanceIndex, CustomDataIndex, CustomDataValue);
+	}
+}
+
+/**
+ * Gets the number of instances across all shared meshes.
+ *
+ * @return The number of instances across all shared meshes.
+ */
+int32 UTileRenderSubsystem::GetNumInstances() const
+{
+	int32 ReturnValue = 0;
+	for (const FBatch& EachBatch : Batches)
+	{
+		ReturnValue += EachBatch.InstancesToHandles.Num();
+	}
+	return ReturnValue;
+}
+
+/**
+ * Copies changes made directly to the registered instanced meshes to the shared meshes.
+ *
+ * @param DeltaTime - The time since the last tick.
+ */
+void UTileRenderSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	for (TPair<int32, FRegistration>& EachHandleToRegistration : HandlesToRegistrations)
+	{
+		FRegistration& Registration = EachHandleToRegistration.Value;
+		if (NeedsResync(Registration))
+		{
+			SyncRegistration(Registration, EachHandleToRegistration.Key);
+		}
+		else if (Registration.BatchIndex != INDEX_NONE && !Registration.Source->GetComponentTransform().Equals(Registration.Transform, 0))
+		{
+			UpdateRegistrationTransforms(Registration);
+		}
+	}
+}
+
+/**
+ * Gets the stat id of this for profiling ticks.
+ *
+ * @return The stat id of this.
+ */
+TStatId UTileRenderSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTileRenderSubsystem, STATGROUP_Tickables);
+}
+
+/**
+ * Whether the instances of an instanced mesh can be drawn by a shared mesh.
+ *
+ * @param Source - The instanced mesh to check.
+ * @return Whether nothing about the instanced mesh needs it to draw itself.
+ */
+bool UTileRenderSubsystem::CanShareInstances(const UInstancedStaticMeshComponent* Source)
+{
+	if (!IsValid(Source) || !IsValid(Source->GetStaticMesh()) || Source->GetInstanceCount() == 0)
+	{
+		return false;
+	}
+
+	//Shared meshes can not hide single instances or draw an overlay for only some of them.
+	const AActor* Owner = Source->GetOwner();
+	return Source->GetVisibleFlag() && !(IsValid(Owner) && Owner->IsHidden()) && !IsValid(Source->GetOverlayMaterial());
+}
+
+/**
+ * Whether an instanced mesh was changed since it was last synced.
+ *
+ * @param Registration - The registration of the instanced mesh.
+ * @return Whether anything other than the transform of the instanced mesh changed.
+ */
+bool UTileRenderSubsystem::NeedsResync(const FRegistration& Registration)
+{
+	const UInstancedStaticMeshComponent* Source = Registration.Source.Get();
+	if (!IsValid(Source))
+	{
+		return Registration.BatchIndex != INDEX_NONE;
+	}
+
+	const AActor* Owner = Source->GetOwner();
+	return Source->GetStaticMesh() != Registration.Mesh
+		|| Source->GetMaterial(0) != Registration.Material
+		|| Source->GetOverlayMaterial() != Registration.OverlayMaterial
+		|| (Source->GetVisibleFlag() && !(IsValid(Owner) && Owner->IsHidden())) != Registration.bVisible
+		|| (Registration.BatchIndex != INDEX_NONE && Source->GetInstanceCount() != Registration.InstanceIndices.Num());
+}
+
+/**
+ * Moves the instances of a registration to the shared mesh of its source's current mesh and material, or gives
+ * them back to the source if they cannot be shared.
+ *
+ * @param Registration - The registration to sync.
+ * @param Handle - The handle of the registration.
+ */
+void UTileRenderSubsystem::SyncRegistration(FRegistration& Registration, const int32 Handle)
+{
+	RemoveRegistrationInstances(Registration);
+
+	UInstancedStaticMeshComponent* Source = Registration.Source.Get();
+	if (!IsValid(Source))
+	{
+		return;
+	}
+
+	const AActor* Owner = Source->GetOwner();
+	Registration.Mesh = Source->GetStaticMesh();
+	Registration.Material = Source->GetMaterial(0);
+	Registration.OverlayMaterial = Source->GetOverlayMaterial();
+	Registration.bVisible = Source->GetVisibleFlag() && !(IsValid(Owner) && Owner->IsHidden());
+	Registration.Transform = Source->GetComponentTransform();
+
+	const int32 BatchIndex = CanShareInstances(Source) ? FindOrAddBatch(Registration.Mesh, Registration.Material, Source->NumCustomDataFloats) : INDEX_NONE;
+	if (BatchIndex == INDEX_NONE)
+	{
+		Source->SetHiddenInGame(false);
+		return;
+	}
+
+	//Copy the instances of the source.
+	TArray<FTransform> WorldTransforms = TArray<FTransform>();
+	WorldTransforms.Reserve(Source->GetInstanceCount());
+	for (int32 InstanceIndex = 0; InstanceIndex < Source->GetInstanceCount(); InstanceIndex++)
+	{
+		FTransform InstanceTransform = FTransform();
+		Source->GetInstanceTransform(InstanceIndex, InstanceTransform, true);
+		WorldTransforms.Add(InstanceTransform);
+	}
+
+	FBatch& Batch = Batches[BatchIndex];
+	Registration.BatchIndex = BatchIndex;
+	Registration.InstanceIndices = Batch.Component->AddInstances(WorldTransforms, true, true);
+	for (int32 EachInstanceIndex : Registration.InstanceIndices)
+	{
+		Batch.InstancesToHandles.Add(Handle);
+		if (Registration.CustomData.Num() == Batch.Component->NumCustomDataFloats && !Registration.CustomData.IsEmpty())
+		{
+			Batch.Component->SetCustomData(EachInstanceIndex, Registration.CustomData, false);
+		}
+	}
+
+	//Keep the source for collision only.
+	Source->SetHiddenInGame(true);
+}
+
+/**
+ * Copies the current world transforms of the source's instances to the shared instances of a registration.
+ *
+ * @param Registration - The registration to update.
+ */
+void UTileRenderSubsystem::UpdateRegistrationTransforms(FRegistration& Registration)
+{
+	UInstancedStaticMeshComponent* Source = Registration.Source.Get();
+	UInstancedStaticMeshComponent* Component = Batches[Registration.BatchIndex].Component;
+	for (int32 InstanceIndex = 0; InstanceIndex < Registration.InstanceIndices.Num(); InstanceIndex++)
+	{
+		FTransform InstanceTransform = FTransform();
+		Source->GetInstanceTransform(InstanceIndex, InstanceTransform, true);
+		Component->UpdateInstanceTransform(Registration.InstanceIndices[InstanceIndex], InstanceTransform, true, false, true);
+	}
+	Component->MarkRenderStateDirty();
+	Registration.Transform = Source->GetComponentTransform();
+}
+
+/**
+ * Removes the shared instances of a registration.
+ *
+ * @param Registration - The registration to remove the instances of.
+ */
+void UTileRenderSubsystem::RemoveRegistrationInstances(FRegistration& Registration)
+{
+	const int32 BatchIndex = Registration.BatchIndex;
+	TArray<int32> InstanceIndices = MoveTemp(Registration.InstanceIndices);
+	Registration.BatchIndex = INDEX_NONE;
+	Registration.InstanceIndices = TArray<int32>();
+	if (BatchIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	//Remove from the highest index down so that no index of this registration is moved before it is removed.
+	InstanceIndices.Sort(TGreater<int32>());
+	for (int32 EachInstanceIndex : InstanceIndices)
+	{
+		RemoveInstanceAtSwap(BatchIndex, EachInstanceIndex);
+	}
+}
+
+/**
+ * Gets the batch of a mesh and material pair, creating it if needed.
+ *
+ * @param Mesh - The mesh of the batch.
+ * @param Material - The material of the batch.
+ * @param NumCustomDataFloats - The number of custom data values per instance.
+ * @return The index of the batch.
+ */
+int32 UTileRenderSubsystem::FindOrAddBatch(UStaticMesh* Mesh, UMaterialInterface* Material, const int32 NumCustomDataFloats)
+{
+	const TPair<UStaticMesh*, UMaterialInterface*> Key = TPair<UStaticMesh*, UMaterialInterface*>(Mesh, Material);
+	if (const int32* ExistingBatchIndex = MeshMaterialsToBatches.Find(Key))
+	{
+		return *ExistingBatchIndex;
+	}
+
+	UWorld* World = GetWorld();
+	if (!IsValid(World))
+	{
+		return INDEX_NONE;
+	}
+
+	//Create the actor owning every shared mesh.
+	if (!IsValid(RendererActor))
+	{
+		FActorSpawnParameters SpawnParams = FActorSpawnParameters();
+		SpawnParams.Name = FName("TileRenderer");
+		SpawnParams.NameMode = FActorSpawnParameters::ESpawnActorNameMode::Requested;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		RendererActor = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams);
+		if (!IsValid(RendererActor))
+		{
+			return INDEX_NONE;
+		}
+
+		USceneComponent* Root = NewObject<USceneComponent>(RendererActor, FName("Root"));
+		RendererActor->SetRootComponent(Root);
+		Root->RegisterComponent();
+	}
+
+	//Create the shared mesh.
+	UInstancedStaticMeshComponent* Component = NewObject<UInstancedStaticMeshComponent>(RendererActor);
+	Component->SetupAttachment(RendererActor->GetRootComponent());
+	Component->SetStaticMesh(Mesh);
+	Component->SetMaterial(0, Material);
+	Component->NumCustomDataFloats = NumCustomDataFloats;
+	Component->CastShadow = false;
+	Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Component->RegisterComponent();
+	RendererActor->AddInstanceComponent(Component);
+
+	FBatch NewBatch = FBatch();
+	NewBatch.Component = Component;
+	BatchComponents.Add(Component);
+	const int32 BatchIndex = Batches.Add(NewBatch);
+	MeshMaterialsToBatches.Add(Key, BatchIndex);
+	return BatchIndex;
+}
+
+/**
+ * Removes an instance from a batch by moving the batch's last instance into its place.
+ *
+ * @param BatchIndex - The batch to remove from.
+ * @param InstanceIndex - The index of the instance to remove.
+ */
+void UTileRenderSubsystem::RemoveInstanceAtSwap(const int32 BatchIndex, const int32 InstanceIndex)
+{
+	FBatch& Batch = Batches[BatchIndex];
+	if (!IsValid(Batch.Component) || !Batch.InstancesToHandles.IsValidIndex(InstanceIndex))
+	{
+		return;
+	}
+
+	const int32 LastInstanceIndex = Batch.InstancesToHandles.Num() - 1;
+	if (InstanceIndex != LastInstanceIndex)
+	{
+		//Move the last instance into the removed slot.
+		FTransform LastTransform = FTransform();
+		Batch.Component->GetInstanceTransform(LastInstanceIndex, LastTransform, true);
+		Batch.Component->UpdateInstanceTransform(InstanceIndex, LastTransform, true, false, true);
+
+		const int32 NumCustomDataFloats = Batch.Component->NumCustomDataFloats;
+		if (NumCustomDataFloats > 0)
+		{
+			TArray<float> LastCustomData = TArray<float>();
+			LastCustomData.Append(&Batch.Component->PerInstanceSMCustomData[LastInstanceIndex * NumCustomDataFloats], NumCustomDataFloats);
+			Batch.Component->SetCustomData(InstanceIndex, LastCustomData, false);
+		}
+
+		//Point the owner of the moved instance at its new index.
+		const int32 MovedHandle = Batch.InstancesToHandles[LastInstanceIndex];
+		if (FRegistration* MovedRegistration = HandlesToRegistrations.Find(MovedHandle))
+		{
+			const int32 MovedIndex = MovedRegistration->InstanceIndices.Find(LastInstanceIndex);
+			if (MovedIndex != INDEX_NONE)
+			{
+				MovedRegistration->InstanceIndices[MovedIndex] = InstanceIndex;
+			}
+		}
+		Batch.InstancesToHandles[InstanceIndex] = MovedHandle;
+	}
+
+	Batch.Component->RemoveInstance(LastInstanceIndex);
+	Batch.InstancesToHandles.RemoveAt(LastInstanceIndex);
+}
+
+/* /\ ==================== /\ *\
+|  /\ UTileRenderSubsystem /\  |
+\* /\ ==================== /\ */
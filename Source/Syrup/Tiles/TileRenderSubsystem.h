@@ -0,0 +1,226 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TileRenderSubsystem.generated.h"
+
+class UInstancedStaticMeshComponent;
+
+/* \/ ==================== \/ *\
+|  \/ UTileRenderSubsystem \/  |
+\* \/ ==================== \/ */
+/**
+ * Renders the sub-tiles of every tile in a world using one shared instanced mesh per mesh and material pair.
+ *
+ * Tiles register their sub-tile meshes and get back a handle used to update or remove them. A registered mesh is hidden
+ * in game while its instances are drawn by a shared mesh. Every frame the registered meshes are checked for changes
+ * made to them directly, such as by highlighting. Moves are copied to the shared instances and material changes move
+ * the instances to the shared mesh of the new material. While a mesh is hidden, its actor is hidden or it has an
+ * overlay material, its instances are taken out of the shared meshes and it draws itself again.
+ *
+ * Removing instances moves the last instance of the shared mesh into the freed slot so that removal does not shift
+ * every later instance.
+ */
+UCLASS()
+class SYRUP_API UTileRenderSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Gets the tile render subsystem of a world.
+	 *
+	 * @param WorldContext - An object in the world to get the subsystem of.
+	 * @return The tile render subsystem of the world. Nullptr if the world does not support one.
+	 */
+	static UTileRenderSubsystem* Get(const UObject* WorldContext);
+
+	/**
+	 * Whether tiles should be rendered by the shared renderer instead of their own meshes.
+	 *
+	 * @return Whether the shared renderer is enabled.
+	 */
+	static bool IsEnabled();
+
+	/**
+	 * Draws the instances of an instanced mesh with the shared mesh of its mesh and material.
+	 *
+	 * @param Source - The instanced mesh to draw the instances of.
+	 * @param CustomData - The custom data given to every instance.
+	 * @return The handle of the instances used to update or remove them.
+	 */
+	int32 AddInstances(UInstancedStaticMeshComponent* Source, const TArray<float>& CustomData);
+
+	/**
+	 * Removes instances that were added together and lets their instanced mesh draw itself again.
+	 *
+	 * @param Handle - The handle of the instances. Will be set to INDEX_NONE.
+	 */
+	void RemoveInstances(int32& Handle);
+
+	/**
+	 * Sets a custom data value of every instance that was added together. Does not change the instanced mesh they
+	 * were added from.
+	 *
+	 * @param Handle - The handle of the instances.
+	 * @param CustomDataIndex - The index of the custom data value to set.
+	 * @param CustomDataValue - The value to set.
+	 */
+	void SetCustomDataValue(const int32 Handle, const int32 CustomDataIndex, const float CustomDataValue);
+
+	/**
+	 * Gets the number of shared meshes.
+	 *
+	 * @return The number of shared meshes.
+	 */
+	FORCEINLINE int32 GetNumBatches() const { return Batches.Num(); };
+
+	/**
+	 * Gets the number of instances across all shared meshes.
+	 *
+	 * @return The number of instances across all shared meshes.
+	 */
+	int32 GetNumInstances() const;
+
+	/**
+	 * Copies changes made directly to the registered instanced meshes to the shared meshes.
+	 *
+	 * @param DeltaTime - The time since the last tick.
+	 */
+	virtual void Tick(float DeltaTime) override;
+
+	/**
+	 * Gets the stat id of this for profiling ticks.
+	 *
+	 * @return The stat id of this.
+	 */
+	virtual TStatId GetStatId() const override;
+
+private:
+	/**
+	 * The shared mesh of a mesh and material pair.
+	 */
+	struct FBatch
+	{
+		//The component rendering the instances.
+		UInstancedStaticMeshComponent* Component = nullptr;
+
+		//The handle that owns each instance.
+		TArray<int32> InstancesToHandles;
+	};
+
+	/**
+	 * Instances that were added together.
+	 */
+	struct FRegistration
+	{
+		//The instanced mesh the instances were added from.
+		TWeakObjectPtr<UInstancedStaticMeshComponent> Source;
+
+		//The custom data given to every instance.
+		TArray<float> CustomData;
+
+		//The batch the instances are in. INDEX_NONE while the source draws its own instances.
+		int32 BatchIndex = INDEX_NONE;
+
+		//The current index of each of the source's instances in the batch's component, in the source's order.
+		TArray<int32> InstanceIndices;
+
+		//The mesh of the source when it was last synced.
+		UStaticMesh* Mesh = nullptr;
+
+		//The material of the source when it was last synced.
+		UMaterialInterface* Material = nullptr;
+
+		//The overlay material of the source when it was last synced.
+		UMaterialInterface* OverlayMaterial = nullptr;
+
+		//Whether the source and its actor were visible when it was last synced.
+		bool bVisible = false;
+
+		//The world transform of the source when it was last synced.
+		FTransform Transform = FTransform::Identity;
+	};
+
+	/**
+	 * Whether the instances of an instanced mesh can be drawn by a shared mesh.
+	 *
+	 * @param Source - The instanced mesh to check.
+	 * @return Whether nothing about the instanced mesh needs it to draw itself.
+	 */
+	static bool CanShareInstances(const UInstancedStaticMeshComponent* Source);
+
+	/**
+	 * Whether an instanced mesh was changed since it was last synced.
+	 *
+	 * @param Registration - The registration of the instanced mesh.
+	 * @return Whether anything other than the transform of the instanced mesh changed.
+	 */
+	static bool NeedsResync(const FRegistration& Registration);
+
+	/**
+	 * Moves the instances of a registration to the shared mesh of its source's current mesh and material, or gives
+	 * them back to the source if they cannot be shared.
+	 *
+	 * @param Registration - The registration to sync.
+	 * @param Handle - The handle of the registration.
+	 */
+	void SyncRegistration(FRegistration& Registration, const int32 Handle);
+
+	/**
+	 * Copies the current world transforms of the source's instances to the shared instances of a registration.
+	 *
+	 * @param Registration - The registration to update.
+	 */
+	void UpdateRegistrationTransforms(FRegistration& Registration);
+
+	/**
+	 * Removes the shared instances of a registration.
+	 *
+	 * @param Registration - The registration to remove the instances of.
+	 */
+	void RemoveRegistrationInstances(FRegistration& Registration);
+
+	/**
+	 * Gets the batch of a mesh and material pair, creating it if needed.
+	 *
+	 * @param Mesh - The mesh of the batch.
+	 * @param Material - The material of the batch.
+	 * @param NumCustomDataFloats - The number of custom data values per instance.
+	 * @return The index of the batch.
+	 */
+	int32 FindOrAddBatch(UStaticMesh* Mesh, UMaterialInterface* Material, const int32 NumCustomDataFloats);
+
+	/**
+	 * Removes an instance from a batch by moving the batch's last instance into its place.
+	 *
+	 * @param BatchIndex - The batch to remove from.
+	 * @param InstanceIndex - The index of the instance to remove.
+	 */
+	void RemoveInstanceAtSwap(const int32 BatchIndex, const int32 InstanceIndex);
+
+	//The actor that owns the shared meshes.
+	UPROPERTY()
+	AActor* RendererActor = nullptr;
+
+	//The component of each batch, referenced here so they are not garbage collected.
+	UPROPERTY()
+	TArray<UInstancedStaticMeshComponent*> BatchComponents = TArray<UInstancedStaticMeshComponent*>();
+
+	//Every batch.
+	TArray<FBatch> Batches = TArray<FBatch>();
+
+	//The batch of each mesh and material pair.
+	TMap<TPair<UStaticMesh*, UMaterialInterface*>, int32> MeshMaterialsToBatches = TMap<TPair<UStaticMesh*, UMaterialInterface*>, int32>();
+
+	//The instances added together by handle.
+	TMap<int32, FRegistration> HandlesToRegistrations = TMap<int32, FRegistration>();
+
+	//The handle that will be given to the next registration.
+	int32 NextHandle = 0;
+};
+/* /\ ==================== /\ *\
+|  /\ UTileRenderSubsystem /\  |
+\* /\ ==================== /\ */
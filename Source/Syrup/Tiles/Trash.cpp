@@ -4,6 +4,8 @@
 #include "Trash.h"
 
 #include "Syrup/Systems/SyrupGameMode.h"
+#include "Syrup/Systems/BoardHistorySubsystem.h"
+#include "Syrup/Systems/TileEffectDispatcher.h"
 #include "Effects/TileEffect.h"
 #include "Components/InstancedStaticMeshComponent.h"
 #include "Resources/Resource.h"
@@ -20,20 +22,15 @@
  */
 ATrash::ATrash()
 {
-	FSinkAmountUpdateDelegate AmountSetter;
-	AmountSetter.BindUFunction(this, FName("SetDamage"));
-	FSinkLocationsDelegate LocationGetter;
-	LocationGetter.BindUFunction(this, FName("GetSubTileLocations"));
-	FSinkAmountDelegate AmountGetter;
-	AmountGetter.BindUFunction(this, FName("GetDamage"));
-
-	DamageResourceSink = UResourceSink::CreateDefaultResourceSinkComponent(this, AmountSetter, LocationGetter, AmountGetter);
-	AmountSetter.BindUFunction(this, FName("SetRange"));
-	AmountGetter.BindUFunction(this, FName("GetRange"));
-	RangeResourceSink = UResourceSink::CreateDefaultResourceSinkComponent(this, AmountSetter, LocationGetter, AmountGetter);
-	AmountSetter.BindUFunction(this, FName("SetPickUpCost"));
-	AmountGetter.BindUFunction(this, FName("GetPickUpCost"));
-	PickUpCostResourceSink = UResourceSink::CreateDefaultResourceSinkComponent(this, AmountSetter, LocationGetter, AmountGetter);
+	//Sinks keep the names they had when bound by function name so that existing saves still find them.
+	FNativeSinkLocationsDelegate LocationGetter = FNativeSinkLocationsDelegate::CreateUObject(this, &ATrash::GetSubTileLocations);
+
+	DamageResourceSink = UResourceSink::CreateDefaultNativeResourceSinkComponent(this, FName("SetDamage_Sink"),
+		FNativeSinkAmountUpdateDelegate::CreateUObject(this, &ATrash::SetDamage), LocationGetter, FNativeSinkAmountDelegate::CreateUObject(this, &ATrash::GetDamage));
+	RangeResourceSink = UResourceSink::CreateDefaultNativeResourceSinkComponent(this, FName("SetRange_Sink"),
+		FNativeSinkAmountUpdateDelegate::CreateUObject(this, &ATrash::SetRange), LocationGetter, FNativeSinkAmountDelegate::CreateUObject(this, &ATrash::GetRange));
+	PickUpCostResourceSink = UResourceSink::CreateDefaultNativeResourceSinkComponent(this, FName("SetPickUpCost_Sink"),
+		FNativeSinkAmountUpdateDelegate::CreateUObject(this, &ATrash::SetPickUpCost), LocationGetter, FNativeSinkAmountDelegate::CreateUObject(this, &ATrash::GetPickUpCost));
 }
 
 /**
@@ -50,10 +47,18 @@ void ATrash::OnFinishedFalling()
  */
 void ATrash::BeginPlay()
 {
+	//Effects are registered by now and sinks may trigger effects while beginning play.
+	UpdateEffectTriggerMask();
+
 	Super::BeginPlay();
 
-	ASyrupGameMode::GetTileEffectTriggerDelegate(GetWorld()).Broadcast(ETileEffectTriggerType::TrashSpawned, this, GetSubTileLocations());
-	ASyrupGameMode::GetTileEffectTriggerDelegate(this).AddDynamic(this, &ATrash::ReceiveEffectTrigger);
+	ASyrupGameMode::BroadcastTileEffectTrigger(this, ETileEffectTriggerType::TrashSpawned, this, GetSubTileLocations());
+
+	UTileEffectDispatcher* Dispatcher = UTileEffectDispatcher::Get(this);
+	if (IsValid(Dispatcher))
+	{
+		EffectTriggerListenerHandle = Dispatcher->RegisterListener(FTileEffectTriggerListener::CreateUObject(this, &ATrash::ReceiveEffectTrigger), EffectTriggerMask & (PHASE_TRIGGER_MASK | GLOBAL_TRIGGER_MASK), GetEffectLocations());
+	}
 }
 
 /**
@@ -62,6 +67,13 @@ void ATrash::BeginPlay()
 void ATrash::Destroyed()
 {
 	ReceiveEffectTrigger(ETileEffectTriggerType::OnDeactivated, nullptr, TSet<FIntPoint>());
+
+	UTileEffectDispatcher* Dispatcher = UTileEffectDispatcher::Get(this);
+	if (IsValid(Dispatcher))
+	{
+		Dispatcher->UnregisterListener(EffectTriggerListenerHandle);
+	}
+
 	Super::Destroyed();
 }
 
@@ -78,6 +90,7 @@ void ATrash::OnConstruction(const FTransform& Transform)
 
 	SetDamage(Damage);
 	RelativeSubTileLocations.Add(FIntPoint::ZeroValue);
+	InvalidateGridCache();
 }
 
 /* /\ Initialization /\ *\
@@ -99,7 +112,15 @@ bool ATrash::PickUp(int& EnergyReserve)
 	if (EnergyReserve >= PickUpCost)
 	{
 		EnergyReserve -= PickUpCost;
-		ASyrupGameMode::GetTileEffectTriggerDelegate(GetWorld()).Broadcast(ETileEffectTriggerType::TrashPickedUp, this, GetSubTileLocations());
+
+		//Recorded before the pick up trigger so that the sinks are stored as the player saw them.
+		UBoardHistorySubsystem* History = UBoardHistorySubsystem::Get(this);
+		if (IsValid(History))
+		{
+			History->RecordPickUp(this, PickUpCost);
+		}
+
+		ASyrupGameMode::BroadcastTileEffectTrigger(this, ETileEffectTriggerType::TrashPickedUp, this, GetSubTileLocations());
 		Destroy();
 		return true;
 	}
@@ -132,6 +153,9 @@ void ATrash::SetRange_Implementation(const int NewRange)
 	}
 
 	Range = FMath::Max(0, NewRange);
+	CachedEffectLocations = NewEffectLocations;
+	bIsEffectLocationCacheValid = true;
+	UpdateEffectTriggerFootprint();
 	TSet<FIntPoint> ActivatedLocations = NewEffectLocations.Difference(OldEffectLocations);
 	if (!ActivatedLocations.IsEmpty())
 	{
@@ -148,7 +172,7 @@ void ATrash::SetRange_Implementation(const int NewRange)
  */
 void ATrash::ReceiveEffectTrigger(const ETileEffectTriggerType TriggerType, const ATile* Triggerer, const TSet<FIntPoint>& LocationsToTrigger)
 {
-	if (bActive)
+	if (bActive && (EffectTriggerMask & GetTileEffectTriggerBit(TriggerType)))
 	{
 		TSet<FIntPoint> EffectedLocations = GetEffectLocations();
 		TSet<FIntPoint> TriggeredLocations = LocationsToTrigger.IsEmpty() ? EffectedLocations : LocationsToTrigger.Intersect(EffectedLocations);
@@ -172,7 +196,58 @@ void ATrash::ReceiveEffectTrigger(const ETileEffectTriggerType TriggerType, cons
  */
 TSet<FIntPoint> ATrash::GetEffectLocations() const
 {
-	return UGridLibrary::ScaleShapeUp(GetSubTileLocations(), Range);
+	if (!bIsEffectLocationCacheValid)
+	{
+		CachedEffectLocations = UGridLibrary::ScaleShapeUp(GetSubTileLocations(), Range);
+		bIsEffectLocationCacheValid = true;
+	}
+#if DO_CHECK
+	else if (ShouldVerifyGridCaches())
+	{
+		TSet<FIntPoint> ActualEffectLocations = UGridLibrary::ScaleShapeUp(GetSubTileLocations(), Range);
+		ensureMsgf(ActualEffectLocations.Num() == CachedEffectLocations.Num() && ActualEffectLocations.Includes(CachedEffectLocations),
+			TEXT("%s has stale cached effect locations."), *GetName());
+	}
+#endif
+
+	return CachedEffectLocations;
+}
+
+/**
+ * Clears the cached effect locations along with the cached grid transform and sub-tile locations.
+ */
+void ATrash::InvalidateGridCache()
+{
+	Super::InvalidateGridCache();
+	bIsEffectLocationCacheValid = false;
+	UpdateEffectTriggerFootprint();
+}
+
+/**
+ * Combines the trigger masks of all of this trash's effects.
+ */
+void ATrash::UpdateEffectTriggerMask()
+{
+	EffectTriggerMask = 0;
+
+	TInlineComponentArray<UTileEffect*> Effects = TInlineComponentArray<UTileEffect*>();
+	GetComponents<UTileEffect>(Effects);
+	for (UTileEffect* EachEffect : Effects)
+	{
+		EffectTriggerMask |= EachEffect->GetRelevantTriggerMask();
+	}
+}
+
+/**
+ * Updates the locations this trash receives global triggers at to match its effect locations.
+ */
+void ATrash::UpdateEffectTriggerFootprint()
+{
+	UTileEffectDispatcher* Dispatcher = UTileEffectDispatcher::Get(this);
+	if (EffectTriggerListenerHandle != INDEX_NONE && IsValid(Dispatcher))
+	{
+		Dispatcher->SetListenerFootprint(EffectTriggerListenerHandle, GetEffectLocations());
+	}
 }
 
 /* /\ Effect /\ *\
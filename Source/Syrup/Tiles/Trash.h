@@ -167,6 +167,33 @@ protected:
 	//The scale applied to the shape of this trash to get all effected locations of this trash's effects.
 	UPROPERTY(VisibleInstanceOnly, Category = "Trash|Effect", Meta = (ClampMin = "0"))
 	int Range = 1;
+
+	/**
+	 * Clears the cached effect locations along with the cached grid transform and sub-tile locations.
+	 */
+	virtual void InvalidateGridCache() override;
+
+	//Whether the cached effect locations are up to date.
+	mutable bool bIsEffectLocationCacheValid = false;
+
+	//The locations where the effects of this trash applied when the cache was last updated.
+	mutable TSet<FIntPoint> CachedEffectLocations = TSet<FIntPoint>();
+
+	/**
+	 * Updates the locations this trash receives global triggers at to match its effect locations.
+	 */
+	void UpdateEffectTriggerFootprint();
+
+	//The handle of this trash's listener in the tile effect dispatcher.
+	int32 EffectTriggerListenerHandle = INDEX_NONE;
+
+	/**
+	 * Combines the trigger masks of all of this trash's effects.
+	 */
+	void UpdateEffectTriggerMask();
+
+	//The triggers that at least one of this trash's effects responds to.
+	uint32 EffectTriggerMask = 0;
 	
 	//The sink used to change the pickup cost though resource allocation.
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Trash|Damage")
@@ -8,6 +8,7 @@
 #include "Syrup/Tiles/GridLibrary.h"
 #include "Syrup/Tiles/Tile.h"
 #include "Syrup/Systems/SyrupGameMode.h"
+#include "Syrup/Systems/TileEffectDispatcher.h"
 
 // Sets default values
 ATileLabelActor::ATileLabelActor()
@@ -38,7 +39,13 @@ UTileLabelContainer* ATileLabelActor::Create(const UObject* WorldContextObject,
     CreatedContainer->Location = Location;
     CreatedActor->GridLocation = Location;
 
-    ASyrupGameMode::GetTileEffectTriggerDelegate(WorldContextObject).AddDynamic(CreatedActor, &ATileLabelActor::ReceiveEffectTrigger);
+    UTileEffectDispatcher* Dispatcher = UTileEffectDispatcher::Get(WorldContextObject);
+    if (IsValid(Dispatcher))
+    {
+        TSet<FIntPoint> Footprint = TSet<FIntPoint>();
+        Footprint.Add(Location);
+        CreatedActor->EffectTriggerListenerHandle = Dispatcher->RegisterListener(FTileEffectTriggerListener::CreateUObject(CreatedActor, &ATileLabelActor::ReceiveEffectTrigger), GLOBAL_TRIGGER_MASK, Footprint);
+    }
     CreatedContainer->OnContainerEmptied.AddUObject(CreatedActor, &ATileLabelActor::DestroyLabel);
     CreatedActor->Snap();
 
@@ -95,5 +102,10 @@ void ATileLabelActor::Snap()
 
 void ATileLabelActor::DestroyLabel()
 {
+    UTileEffectDispatcher* Dispatcher = UTileEffectDispatcher::Get(this);
+    if (IsValid(Dispatcher))
+    {
+        Dispatcher->UnregisterListener(EffectTriggerListenerHandle);
+    }
     Destroy();
 }
\ No newline at end of file
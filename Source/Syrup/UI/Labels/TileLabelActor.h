@@ -60,4 +60,7 @@ private:
 	//The widget component used to render the labels
 	UPROPERTY(VisibleAnywhere)
 	UWidgetComponent* WidgetComponent;
+
+	//The handle of this label's listener in the tile effect dispatcher.
+	int32 EffectTriggerListenerHandle = INDEX_NONE;
 };